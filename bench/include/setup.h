@@ -0,0 +1,28 @@
+#ifndef BENCH_SETUP_H
+#define BENCH_SETUP_H
+
+extern void trie_benches();
+extern void btree_benches();
+extern void sorted_array_benches();
+extern void sorted_vec_benches();
+extern void radix_trie_benches();
+extern void concurrent_btree_benches();
+extern void concurrent_radix_trie_benches();
+extern void persistent_btree_benches();
+extern void paged_btree_benches();
+extern void durable_btree_benches();
+
+void setup_benches() {
+    trie_benches();
+    btree_benches();
+    sorted_array_benches();
+    sorted_vec_benches();
+    radix_trie_benches();
+    concurrent_btree_benches();
+    concurrent_radix_trie_benches();
+    persistent_btree_benches();
+    paged_btree_benches();
+    durable_btree_benches();
+}
+
+#endif
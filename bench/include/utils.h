@@ -0,0 +1,51 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#define BENCH_FAILURE 1
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unordered_map>
+
+/**
+ * Fails the current benchmark if the condition does not hold. Benchmarks use this to turn
+ * a complexity regression (e.g. linear instead of logarithmic growth) into a failure.
+ */
+#define bench_expect(cond) \
+    if (!(cond)) { \
+        fprintf(stderr, "%s: regression at line %d: %s\n", __FILE__, __LINE__, #cond); \
+        throw BENCH_FAILURE; \
+    }
+
+namespace data {
+    namespace bench {
+        typedef void (*BenchFunc)(void);
+
+        extern std::unordered_map<const char *, std::unordered_map<const char *, BenchFunc>> benches;
+
+        /**
+         * Upper bound on the number of elements a benchmark should work with. Can be set with the
+         * BENCH_MAX_KEYS environment variable.
+         */
+        size_t max_keys();
+
+        class Stopwatch {
+            private:
+                std::chrono::steady_clock::time_point start;
+
+            public:
+                Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+                void reset() {
+                    this->start = std::chrono::steady_clock::now();
+                }
+
+                double elapsed_ns() const {
+                    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - this->start).count();
+                }
+        };
+    }
+}
+
+#endif
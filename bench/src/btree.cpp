@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/btree.h"
+
+namespace {
+    typedef data::BTree<uint32_t, uint32_t, 64> bench_tree;
+
+    /**
+     * A value as big as a cache line, so that values stored next to keys would push the keys apart.
+     */
+    struct wide_val {
+        uint64_t words[8];
+    };
+
+    /**
+     * Inserts keys produced by `make_key` into a single tree and reports the average cost of an
+     * insert within each decade [10^k, 10^(k + 1)). The cost is also normalized by log2(n), which
+     * should stay roughly flat if inserts are logarithmic. Returns the normalized costs.
+     */
+    template <typename F>
+    std::vector<double> insert_decades(bench_tree &tree, F make_key) {
+        std::vector<double> normalized;
+        const size_t max = data::bench::max_keys();
+        size_t i = 0;
+
+        printf("%12s %14s %14s\n", "keys", "ns/insert", "ns/insert/lg n");
+
+        for (size_t decade_end = 10000; decade_end <= max; decade_end *= 10) {
+            data::bench::Stopwatch watch;
+            const size_t decade_start = i;
+
+            for (; i < decade_end; i++) {
+                const uint32_t key = make_key(i);
+                tree.put(key, key);
+            }
+
+            const double ns = watch.elapsed_ns() / (decade_end - decade_start);
+            const double norm = ns / log2((double) decade_end);
+            normalized.push_back(norm);
+
+            printf("%12ld %14.1f %14.2f\n", decade_end, ns, norm);
+            fflush(stdout);
+        }
+
+        return normalized;
+    }
+}
+
+void btree_benches() {
+    data::bench::benches["btree"]["ascending inserts stay logarithmic"] = []() {
+        bench_tree tree;
+
+        // Ascending keys split a node on the rightmost path every few inserts, but that path
+        // is always hot in cache. Anything that grows faster than log n here is algorithmic,
+        // e.g. a split that costs time proportional to the size of the subtree being split.
+        std::vector<double> normalized = insert_decades(tree, [](size_t i) {
+            return (uint32_t) i;
+        });
+
+        for (size_t i = 1; i < normalized.size(); i++) {
+            bench_expect(normalized[i] < normalized[0] * 4);
+        }
+    };
+
+    data::bench::benches["btree"]["random inserts"] = []() {
+        bench_tree tree;
+
+        // A multiplicative hash gives a fixed pseudorandom permutation of the keys. This case is
+        // reported but not checked: once the tree no longer fits in cache, every level
+        // costs a miss and the normalized cost grows with the memory hierarchy.
+        insert_decades(tree, [](size_t i) {
+            return (uint32_t) (i * 2654435761u);
+        });
+    };
+
+    data::bench::benches["btree"]["bulk loading stays linear"] = []() {
+        const size_t max = data::bench::max_keys();
+        std::vector<double> per_key;
+
+        printf("%12s %14s %14s\n", "keys", "ns/key", "ns/key (puts)");
+
+        for (size_t count = 10000; count <= max; count *= 10) {
+            std::vector<std::pair<uint32_t, uint32_t>> pairs;
+            pairs.reserve(count);
+
+            for (size_t i = 0; i < count; i++) {
+                pairs.push_back({ (uint32_t) i, (uint32_t) i });
+            }
+
+            data::bench::Stopwatch watch;
+            bench_tree tree(pairs);
+            const double ns = watch.elapsed_ns() / count;
+
+            bench_expect(tree.size() == count);
+
+            // Compare with inserting the same keys one at a time, up to a size that doesn't take too long
+            double put_ns = 0;
+
+            if (count <= 10000000) {
+                bench_tree put_tree;
+                watch.reset();
+
+                for (size_t i = 0; i < count; i++) {
+                    put_tree.put(pairs[i].first, pairs[i].second);
+                }
+
+                put_ns = watch.elapsed_ns() / count;
+            }
+
+            per_key.push_back(ns);
+            printf("%12ld %14.1f %14.1f\n", count, ns, put_ns);
+            fflush(stdout);
+        }
+
+        // Bulk loading writes every key once and never searches, so the cost per key should not grow
+        // with n beyond cache effects
+        for (size_t i = 1; i < per_key.size(); i++) {
+            bench_expect(per_key[i] < per_key[0] * 4);
+        }
+    };
+
+    data::bench::benches["btree"]["lookups with wide values"] = []() {
+        typedef data::BTree<uint64_t, wide_val, 32> wide_tree;
+
+        const size_t count = std::min<size_t>(data::bench::max_keys(), 1000000);
+        const size_t lookups = 2000000;
+        std::vector<std::pair<uint64_t, wide_val>> pairs;
+        pairs.reserve(count);
+
+        for (size_t i = 0; i < count; i++) {
+            pairs.push_back({ i * 2, wide_val{ { i } } });
+        }
+
+        wide_tree tree(pairs);
+        uint64_t state = 1;
+        size_t found = 0;
+
+        data::bench::Stopwatch watch;
+
+        for (size_t i = 0; i < lookups; i++) {
+            state = state * 6364136223846793005u + 1442695040888963407u;
+            const uint64_t key = (state >> 33) % count * 2;
+
+            found += tree.get(key).value().words[0] == key / 2;
+        }
+
+        // Reported but not checked, since it depends on the machine's caches
+        printf("%12ld keys, %.1f ns/get\n", count, watch.elapsed_ns() / lookups);
+
+        bench_expect(found == lookups);
+    };
+}
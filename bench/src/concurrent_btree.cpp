@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/btree.h"
+#include "../../include/structures/concurrent_btree.h"
+
+namespace {
+    typedef data::ConcurrentBTree<uint32_t, uint32_t, 64> bench_tree;
+
+    /**
+     * A BTree behind one mutex, which is what the concurrent tree replaces.
+     */
+    struct locked_tree {
+        data::BTree<uint32_t, uint32_t, 64> tree;
+        std::mutex mutex;
+
+        std::optional<uint32_t> get(uint32_t key) {
+            std::lock_guard<std::mutex> guard(this->mutex);
+            return this->tree.get(key);
+        }
+
+        std::optional<uint32_t> put(uint32_t key, uint32_t val) {
+            std::lock_guard<std::mutex> guard(this->mutex);
+            return this->tree.put(key, val);
+        }
+    };
+
+    /**
+     * Runs `total_ops` random operations on the tree, split evenly across the given number of threads.
+     * One in `write_every` operations is a put, and the rest are gets. Returns millions of operations
+     * per second.
+     */
+    template <typename T>
+    double run_threads(T &tree, size_t threads, size_t total_ops, uint32_t key_range, size_t write_every) {
+        std::vector<std::thread> workers;
+        const size_t ops = total_ops / threads;
+        data::bench::Stopwatch watch;
+
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&tree, t, ops, key_range, write_every]() {
+                uint64_t state = t * 0x9e3779b97f4a7c15u + 1;
+                uint32_t found = 0;
+
+                for (size_t i = 0; i < ops; i++) {
+                    state = state * 6364136223846793005u + 1442695040888963407u;
+                    const uint32_t key = (state >> 33) % key_range;
+
+                    if (i % write_every == 0) {
+                        tree.put(key, key);
+                    } else {
+                        found += tree.get(key).has_value();
+                    }
+                }
+
+                // Keep the reads from being optimized out
+                bench_expect(found <= ops);
+            });
+        }
+
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+
+        return (ops * threads) / (watch.elapsed_ns() / 1000);
+    }
+}
+
+void concurrent_btree_benches() {
+    data::bench::benches["concurrent btree"]["throughput by thread count"] = []() {
+        const uint32_t key_range = (uint32_t) std::min<size_t>(data::bench::max_keys(), 1000000);
+        const size_t total_ops = 4000000;
+        bench_tree tree;
+        locked_tree baseline;
+
+        for (uint32_t i = 0; i < key_range; i += 2) {
+            const uint32_t key = i * 2654435761u % key_range;
+            tree.put(key, key);
+            baseline.put(key, key);
+        }
+
+        printf("%d hardware threads\n", std::thread::hardware_concurrency());
+        printf("%8s %16s %16s %16s %16s\n", "threads", "Mops/s (95% r)", "mutex (95% r)", "Mops/s (50% r)", "mutex (50% r)");
+
+        // Reported but not checked, since scaling depends on how many cores the machine has
+        for (size_t threads = 1; threads <= 64; threads *= 2) {
+            const double read_mostly = run_threads(tree, threads, total_ops, key_range, 20);
+            const double read_mostly_locked = run_threads(baseline, threads, total_ops, key_range, 20);
+            const double mixed = run_threads(tree, threads, total_ops, key_range, 2);
+            const double mixed_locked = run_threads(baseline, threads, total_ops, key_range, 2);
+
+            printf("%8ld %16.2f %16.2f %16.2f %16.2f\n", threads, read_mostly, read_mostly_locked, mixed, mixed_locked);
+            fflush(stdout);
+        }
+    };
+}
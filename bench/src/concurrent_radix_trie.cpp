@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/concurrent_radix_trie.h"
+#include "../../include/structures/radix_trie.h"
+
+namespace {
+    /**
+     * A RadixTrie behind one mutex, which is what the concurrent trie replaces.
+     */
+    struct locked_trie {
+        data::RadixTrie<char, uint32_t> trie;
+        std::mutex mutex;
+
+        std::optional<uint32_t> get(std::string_view key) {
+            std::lock_guard<std::mutex> guard(this->mutex);
+            return this->trie.get(key);
+        }
+
+        std::optional<uint32_t> put(std::string_view key, uint32_t val) {
+            std::lock_guard<std::mutex> guard(this->mutex);
+            return this->trie.put(key, val);
+        }
+    };
+
+    /**
+     * Splits `total_reads` lookups across the given number of threads while one more thread writes a
+     * key every `write_interval_ns`. Returns millions of reads per second.
+     */
+    template <typename T>
+    double run_readers(T &trie, const std::vector<std::string> &keys, size_t threads, size_t total_reads, size_t write_interval_ns) {
+        std::vector<std::thread> readers;
+        std::atomic<bool> done(false);
+        const size_t reads = total_reads / threads;
+
+        std::thread writer([&]() {
+            size_t i = 0;
+
+            while (!done.load()) {
+                const std::string &key = keys[i++ % keys.size()];
+                trie.put(std::string_view(key), (uint32_t) i);
+                std::this_thread::sleep_for(std::chrono::nanoseconds(write_interval_ns));
+            }
+        });
+
+        data::bench::Stopwatch watch;
+
+        for (size_t t = 0; t < threads; t++) {
+            readers.emplace_back([&, t]() {
+                uint64_t state = t * 0x9e3779b97f4a7c15u + 1;
+                size_t found = 0;
+
+                for (size_t i = 0; i < reads; i++) {
+                    state = state * 6364136223846793005u + 1442695040888963407u;
+                    found += trie.get(std::string_view(keys[(state >> 33) % keys.size()])).has_value();
+                }
+
+                bench_expect(found == reads);
+            });
+        }
+
+        for (std::thread &reader : readers) {
+            reader.join();
+        }
+
+        const double mops = (reads * threads) / (watch.elapsed_ns() / 1000);
+
+        done.store(true);
+        writer.join();
+
+        return mops;
+    }
+}
+
+void concurrent_radix_trie_benches() {
+    data::bench::benches["concurrent radix trie"]["read throughput by thread count"] = []() {
+        const size_t count = std::min<size_t>(data::bench::max_keys(), 100000);
+        const size_t total_reads = 4000000;
+        std::vector<std::string> keys;
+        data::ConcurrentRadixTrie<char, uint32_t> trie;
+        locked_trie baseline;
+
+        // Dotted keys that share prefixes, like routes or hostnames
+        for (size_t i = 0; i < count; i++) {
+            keys.push_back(std::to_string(i % 256) + "." + std::to_string(i / 256 % 256) + "." + std::to_string(i * 2654435761u % 1000));
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            trie.put(std::string_view(keys[i]), (uint32_t) i);
+            baseline.put(std::string_view(keys[i]), (uint32_t) i);
+        }
+
+        printf("%d hardware threads\n", std::thread::hardware_concurrency());
+        printf("%8s %16s %16s\n", "threads", "Mreads/s", "mutex Mreads/s");
+
+        // Reported but not checked, since scaling depends on how many cores the machine has
+        for (size_t threads = 1; threads <= 64; threads *= 2) {
+            const double lock_free = run_readers(trie, keys, threads, total_reads, 1000000);
+            const double locked = run_readers(baseline, keys, threads, total_reads, 1000000);
+
+            printf("%8ld %16.2f %16.2f\n", threads, lock_free, locked);
+            fflush(stdout);
+        }
+    };
+}
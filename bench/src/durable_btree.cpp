@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+#include "../include/utils.h"
+#include "../../include/structures/durable_btree.h"
+
+namespace {
+    /**
+     * Returns the average time of a put into a new durable btree with the given sync policy, and
+     * prints it along with how many puts shared each sync.
+     */
+    double time_puts(const char * name, data::WalSyncPolicy policy, size_t group_size, size_t puts) {
+        char dir[] = "/tmp/durable_btree_bench_XXXXXX";
+
+        bench_expect(mkdtemp(dir) != nullptr);
+
+        const std::string path = std::string(dir) + "/tree";
+        double put_ns;
+
+        {
+            data::DurableBTree<uint32_t, uint32_t, 64> tree(path.c_str(), policy, group_size);
+            data::bench::Stopwatch watch;
+
+            for (size_t i = 0; i < puts; i++) {
+                const uint32_t key = (uint32_t) (i * 2654435761u);
+                tree.put(key, key);
+            }
+
+            tree.sync();
+            put_ns = watch.elapsed_ns() / puts;
+
+            printf("%16s %12ld %14.1f %14.1f\n", name, puts, put_ns, (double) puts / tree.log().syncs());
+            fflush(stdout);
+        }
+
+        unlink(path.c_str());
+        unlink((path + ".wal").c_str());
+        rmdir(dir);
+
+        return put_ns;
+    }
+}
+
+void durable_btree_benches() {
+    data::bench::benches["durable btree"]["group commit"] = []() {
+        const size_t puts = std::min(data::bench::max_keys(), (size_t) 200000);
+
+        printf("%16s %12s %14s %14s\n", "policy", "puts", "ns/put", "puts/sync");
+
+        // Syncing every put is slow, so it gets fewer puts
+        const double always_ns = time_puts("always", data::WalSyncPolicy::ALWAYS, 1, puts / 100);
+        const double group_8_ns = time_puts("group of 8", data::WalSyncPolicy::GROUP, 8, puts / 10);
+        const double group_64_ns = time_puts("group of 64", data::WalSyncPolicy::GROUP, 64, puts);
+        time_puts("group of 512", data::WalSyncPolicy::GROUP, 512, puts);
+        const double never_ns = time_puts("never", data::WalSyncPolicy::NEVER, 1, puts);
+
+        // A group shares one sync, so bigger groups should cost less per put, down to about the cost
+        // of not syncing at all
+        bench_expect(group_8_ns < always_ns);
+        bench_expect(group_64_ns < group_8_ns);
+        bench_expect(never_ns < group_64_ns);
+    };
+}
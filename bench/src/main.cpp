@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <optional>
+
+#include "../include/utils.h"
+#include "../include/setup.h"
+
+std::unordered_map<const char *, std::unordered_map<const char *, data::bench::BenchFunc>> data::bench::benches;
+
+size_t data::bench::max_keys() {
+    static constexpr size_t DEFAULT_MAX_KEYS = 100000000;
+    const char * const env = getenv("BENCH_MAX_KEYS");
+
+    if (!env) {
+        return DEFAULT_MAX_KEYS;
+    }
+
+    return strtoull(env, nullptr, 10);
+}
+
+void run_benches(std::optional<std::string> pattern) {
+    size_t passed = 0;
+    size_t total = 0;
+
+    for (auto &suite_pair : data::bench::benches) {
+        for (auto &case_pair : suite_pair.second) {
+            if (pattern.has_value()) {
+                std::string &str = pattern.value();
+                std::string suite_name(suite_pair.first);
+                std::string case_name(case_pair.first);
+
+                if (!suite_name.contains(str) && !case_name.contains(str)) {
+                    continue;
+                }
+            }
+
+            total++;
+            printf("%s > %s\n", suite_pair.first, case_pair.first);
+            fflush(stdout);
+
+            try {
+                case_pair.second();
+                printf("(PASS)\n\n");
+                passed++;
+            } catch (int err) {
+                printf("(FAIL)\n\n");
+            }
+        }
+    }
+
+    printf("=============== SUMMARY ===============\n");
+    printf("%ld/%ld benchmarks passed\n", passed, total);
+}
+
+std::optional<std::string> get_bench_pattern(int argc, char ** argv) {
+    if (argc < 2) {
+        return std::nullopt;
+    }
+
+    std::string str(argv[1]);
+
+    return std::optional<std::string>(str);
+}
+
+int main(int argc, char ** argv) {
+    std::optional<std::string> pattern = get_bench_pattern(argc, argv);
+    setup_benches();
+    run_benches(pattern);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/paged_btree.h"
+
+void paged_btree_benches() {
+    data::bench::benches["paged btree"]["gets with a bounded buffer pool"] = []() {
+        typedef data::PagedBTree<uint32_t, uint32_t, 255> bench_tree;
+
+        // Every level above the leaves fits in the frames, so a get reads at most one page
+        const size_t frames = 256;
+        const size_t max = std::min(data::bench::max_keys(), (size_t) 1000000);
+        const size_t lookups = 100000;
+        char path[] = "/tmp/paged_btree_bench_XXXXXX";
+        const int fd = mkstemp(path);
+
+        bench_expect(fd >= 0);
+        close(fd);
+
+        std::vector<double> get_costs;
+        size_t i = 0;
+
+        {
+            bench_tree tree(path, frames);
+
+            printf("%12s %10s %14s %10s %10s\n", "keys", "pages", "ns/get", "hit rate", "ns/put");
+
+            for (size_t decade_end = 10000; decade_end <= max; decade_end *= 10) {
+                const size_t start = i;
+                data::bench::Stopwatch watch;
+
+                for (; i < decade_end; i++) {
+                    const uint32_t key = (uint32_t) (i * 2654435761u);
+                    tree.put(key, key);
+                }
+
+                const double put_ns = watch.elapsed_ns() / (decade_end - start);
+                const size_t hits = tree.buffer_pool().hits();
+                const size_t misses = tree.buffer_pool().misses();
+
+                watch.reset();
+
+                for (size_t r = 0; r < lookups; r++) {
+                    const uint32_t key = (uint32_t) ((r * 7919 % decade_end) * 2654435761u);
+                    bench_expect(tree.get(key) == key);
+                }
+
+                const double get_ns = watch.elapsed_ns() / lookups;
+                const size_t get_hits = tree.buffer_pool().hits() - hits;
+                const size_t get_misses = tree.buffer_pool().misses() - misses;
+
+                get_costs.push_back(get_ns);
+
+                printf("%12ld %10ld %14.1f %10.3f %10.1f\n", decade_end, tree.page_count(), get_ns, (double) get_hits / (get_hits + get_misses), put_ns);
+                fflush(stdout);
+            }
+        }
+
+        unlink(path);
+
+        // The first tree fits in the frames. After that, each get reads about one leaf from the page
+        // cache, which shouldn't get much more expensive as the tree grows.
+        for (size_t d = 2; d < get_costs.size(); d++) {
+            bench_expect(get_costs[d] < get_costs[1] * 8);
+        }
+    };
+}
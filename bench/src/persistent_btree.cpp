@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/persistent_btree.h"
+
+void persistent_btree_benches() {
+    data::bench::benches["persistent btree"]["snapshots don't grow with the tree"] = []() {
+        typedef data::PersistentBTree<uint32_t, uint32_t, 64> bench_tree;
+
+        const size_t max = data::bench::max_keys();
+        const size_t rounds = 10000;
+        std::vector<double> snapshot_costs;
+        std::vector<double> write_costs;
+        bench_tree tree;
+        size_t i = 0;
+
+        printf("%12s %14s %18s %14s\n", "keys", "ns/snapshot", "ns/first write", "ns/write");
+
+        for (size_t decade_end = 10000; decade_end <= max; decade_end *= 10) {
+            for (; i < decade_end; i++) {
+                const uint32_t key = (uint32_t) (i * 2654435761u);
+                tree.put(key, key);
+            }
+
+            // Single operations are too short to time one at a time, so each kind is timed as a batch
+            // of `rounds` and averaged
+            std::vector<bench_tree> snapshots;
+            snapshots.reserve(rounds);
+
+            data::bench::Stopwatch watch;
+
+            for (size_t r = 0; r < rounds; r++) {
+                snapshots.push_back(tree.snapshot());
+            }
+
+            const double snapshot_ns = watch.elapsed_ns() / rounds;
+
+            snapshots.clear();
+
+            // Each round takes a snapshot and then writes to the tree, which copies the path to the
+            // written key
+            watch.reset();
+
+            for (size_t r = 0; r < rounds; r++) {
+                const uint32_t key = (uint32_t) (r * 7919 % decade_end * 2654435761u);
+
+                snapshots.push_back(tree.snapshot());
+                tree.put(key, (uint32_t) r);
+            }
+
+            const double first_write_ns = watch.elapsed_ns() / rounds - snapshot_ns;
+
+            // Once the snapshots are gone, the tree owns its nodes again and writes don't copy anything
+            snapshots.clear();
+            watch.reset();
+
+            for (size_t r = 0; r < rounds; r++) {
+                const uint32_t key = (uint32_t) (r * 7919 % decade_end * 2654435761u);
+                tree.put(key, (uint32_t) r + 1);
+            }
+
+            const double write_ns = watch.elapsed_ns() / rounds;
+
+            snapshot_costs.push_back(snapshot_ns);
+            write_costs.push_back(first_write_ns);
+
+            printf("%12ld %14.1f %18.1f %14.1f\n", decade_end, snapshot_ns, first_write_ns, write_ns);
+            fflush(stdout);
+        }
+
+        // A snapshot copies nothing, so it shouldn't get slower as the tree grows. A write copies one
+        // node per level, so it gets slower as the tree outgrows the caches, but far less than the 10x
+        // per decade that copying the whole tree would cost.
+        for (size_t d = 1; d < snapshot_costs.size(); d++) {
+            bench_expect(snapshot_costs[d] < snapshot_costs[0] * 4);
+            bench_expect(write_costs[d] < write_costs[d - 1] * 5);
+        }
+    };
+}
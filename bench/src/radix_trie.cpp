@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/utils.h"
+#include "../../include/structures/mapped_radix_trie.h"
+#include "../../include/structures/radix_trie.h"
+
+namespace {
+    typedef data::RadixTrie<char, uint32_t> bench_trie;
+
+    /**
+     * Writes a pseudorandom 8 digit hex key for `i` into `out`.
+     */
+    void make_key(size_t i, char out[8]) {
+        const uint32_t hash = (uint32_t) (i * 2654435761u);
+
+        for (size_t d = 0; d < 8; d++) {
+            out[d] = "0123456789abcdef"[(hash >> (28 - 4 * d)) & 0xf];
+        }
+    }
+}
+
+void radix_trie_benches() {
+    data::bench::benches["radix trie"]["full scans"] = []() {
+        // Nodes are allocated in insertion order, which is random with respect to key order, so a scan
+        // misses the cache on nearly every node once the trie is big enough. This case is reported but
+        // not checked, like random btree inserts; the cost per entry follows the memory hierarchy.
+        //
+        // Radix trie nodes are much bigger than btree entries, so stop an order of magnitude sooner.
+        const size_t max = std::min(data::bench::max_keys(), (size_t) 10000000);
+        bench_trie trie;
+        size_t i = 0;
+
+        printf("%12s %14s\n", "keys", "ns/entry");
+
+        for (size_t decade_end = 10000; decade_end <= max; decade_end *= 10) {
+            for (; i < decade_end; i++) {
+                char key[8];
+                make_key(i, key);
+                trie.put(std::span<const char>(key, 8), (uint32_t) i);
+            }
+
+            data::bench::Stopwatch watch;
+            size_t count = 0;
+            size_t checksum = 0;
+
+            for (auto entry : trie) {
+                checksum += entry.first[7] + *entry.second;
+                count++;
+            }
+
+            const double ns = watch.elapsed_ns() / count;
+
+            bench_expect(count == decade_end);
+
+            printf("%12ld %14.1f (checksum %ld)\n", decade_end, ns, checksum);
+            fflush(stdout);
+        }
+    };
+
+    data::bench::benches["radix trie"]["opening a saved trie"] = []() {
+        // Opening a saved trie only maps the file, so it should beat rebuilding the trie with puts by a
+        // wide margin. Lookups through the mapping are reported next to lookups in the heap trie.
+        const size_t count = std::min(data::bench::max_keys(), (size_t) 1000000);
+        char path[] = "/tmp/radix_trie_bench_XXXXXX";
+        const int fd = mkstemp(path);
+
+        bench_expect(fd >= 0);
+        close(fd);
+
+        data::bench::Stopwatch watch;
+        bench_trie trie;
+
+        for (size_t i = 0; i < count; i++) {
+            char key[8];
+            make_key(i, key);
+            trie.put(std::span<const char>(key, 8), (uint32_t) i);
+        }
+
+        const double build_ms = watch.elapsed_ns() / 1e6;
+
+        watch.reset();
+        trie.save(path);
+        const double save_ms = watch.elapsed_ns() / 1e6;
+
+        watch.reset();
+        const data::MappedRadixTrie<char, uint32_t> mapped(path);
+        const double open_ms = watch.elapsed_ns() / 1e6;
+
+        unlink(path);
+
+        size_t checksums[2] = {};
+        double ns[2];
+
+        watch.reset();
+        for (size_t i = 0; i < count; i++) {
+            char key[8];
+            make_key(i, key);
+            checksums[0] += trie.get(std::span<const char>(key, 8)).value();
+        }
+        ns[0] = watch.elapsed_ns() / count;
+
+        watch.reset();
+        for (size_t i = 0; i < count; i++) {
+            char key[8];
+            make_key(i, key);
+            checksums[1] += mapped.get(std::span<const char>(key, 8)).value();
+        }
+        ns[1] = watch.elapsed_ns() / count;
+
+        printf("%12s %14ld\n", "keys", count);
+        printf("%12s %14.1f\n", "build ms", build_ms);
+        printf("%12s %14.1f\n", "save ms", save_ms);
+        printf("%12s %14.3f\n", "open ms", open_ms);
+        printf("%12s %14.1f\n", "heap ns/get", ns[0]);
+        printf("%12s %14.1f\n", "mapped ns/get", ns[1]);
+
+        bench_expect(checksums[0] == checksums[1]);
+        bench_expect(open_ms * 100 < build_ms);
+    };
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/sorted_array.h"
+
+namespace {
+    /**
+     * Searches a sorted array of `len` items for pseudorandom needles, so that the branches in a
+     * plain binary search can't be predicted. Returns the average time per search.
+     */
+    template <typename T, typename F>
+    double time_searches(const std::vector<T> &items, F search) {
+        const size_t searches = 2000000;
+        uint64_t state = 1;
+        size_t sum = 0;
+
+        data::bench::Stopwatch watch;
+
+        for (size_t i = 0; i < searches; i++) {
+            state = state * 6364136223846793005u + 1442695040888963407u;
+            sum += search(items, (T) ((state >> 33) % (items.size() * 2)));
+        }
+
+        const double ns = watch.elapsed_ns() / searches;
+
+        // Keeps the searches from being optimized away
+        bench_expect(sum > 0);
+
+        return ns;
+    }
+
+    template <typename T>
+    void compare_searches(const char * type_name) {
+        printf("%8s %8s %14s %14s\n", "type", "len", "ns (kernel)", "ns (std)");
+
+        for (size_t len = 8; len <= 1024; len *= 2) {
+            std::vector<T> items;
+
+            for (size_t i = 0; i < len; i++) {
+                items.push_back((T) (i * 2));
+            }
+
+            const double kernel_ns = time_searches(items, [](const std::vector<T> &items, T needle) {
+                return data::lower_bound(items.data(), items.size(), needle);
+            });
+            const double std_ns = time_searches(items, [](const std::vector<T> &items, T needle) {
+                return (size_t) (std::lower_bound(std::begin(items), std::end(items), needle) - std::begin(items));
+            });
+
+            printf("%8s %8ld %14.2f %14.2f\n", type_name, len, kernel_ns, std_ns);
+            fflush(stdout);
+        }
+    }
+}
+
+void sorted_array_benches() {
+    data::bench::benches["sorted array"]["searching arithmetic types"] = []() {
+        // Reported but not checked, since the kernel that runs depends on the instruction sets the
+        // build targets
+        compare_searches<int32_t>("int32");
+        compare_searches<int64_t>("int64");
+        compare_searches<double>("double");
+    };
+}
@@ -0,0 +1,61 @@
+#include <stdint.h>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/sorted_vec.h"
+
+void sorted_vec_benches() {
+    data::bench::benches["sorted vec"]["batch inserts stay linear"] = []() {
+        const size_t max = data::bench::max_keys();
+        const size_t batch_size = 10000;
+        std::vector<double> per_item;
+
+        printf("%12s %16s %16s\n", "keys", "ns/item (batch)", "ns/item (puts)");
+
+        for (size_t count = 10000; count <= max; count *= 10) {
+            data::SortedVec<uint32_t> vec;
+            std::vector<uint32_t> batch;
+
+            for (size_t i = 0; i < count; i++) {
+                batch.push_back((uint32_t) (i * 2654435761u));
+            }
+
+            vec.put_batch(batch);
+            batch.clear();
+
+            for (size_t i = 0; i < batch_size; i++) {
+                batch.push_back((uint32_t) ((i + count) * 2654435761u));
+            }
+
+            // One batch costs a pass over the whole vector, so divide by the size of the result
+            data::bench::Stopwatch watch;
+            vec.put_batch(batch);
+            const double ns = watch.elapsed_ns() / (count + batch_size);
+
+            bench_expect(vec.size() == count + batch_size);
+
+            // Compare with putting the batch one item at a time, up to a size that doesn't take too long
+            double put_ns = 0;
+
+            if (count <= 1000000) {
+                data::SortedVec<uint32_t> put_vec;
+                put_vec.merge(vec);
+                watch.reset();
+
+                for (uint32_t item : batch) {
+                    put_vec.put(item);
+                }
+
+                put_ns = watch.elapsed_ns() / batch_size;
+            }
+
+            per_item.push_back(ns);
+            printf("%12ld %16.2f %16.1f\n", count, ns, put_ns);
+            fflush(stdout);
+        }
+
+        for (size_t i = 1; i < per_item.size(); i++) {
+            bench_expect(per_item[i] < per_item[0] * 4);
+        }
+    };
+}
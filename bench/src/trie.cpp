@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/double_array_trie.h"
+#include "../../include/structures/radix_trie.h"
+#include "../../include/structures/trie.h"
+
+namespace {
+    const size_t KEY_LEN = 12;
+
+    /**
+     * Fills `keys` with `count` pseudorandom keys of KEY_LEN symbols, each one taken from `alphabet`.
+     */
+    void make_keys(size_t count, const std::vector<uint8_t> &alphabet, std::vector<uint8_t> &keys) {
+        uint64_t state = 88172645463325252ull;
+
+        for (size_t i = 0; i < count * KEY_LEN; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            keys.push_back(alphabet[state % alphabet.size()]);
+        }
+    }
+
+    /**
+     * Returns the average time in nanoseconds to look up every key once.
+     */
+    template <typename C>
+    double time_lookups(size_t count, const std::vector<uint8_t> &keys) {
+        data::Trie<uint8_t, uint32_t, C> trie;
+
+        for (size_t i = 0; i < count; i++) {
+            trie.put(&keys[i * KEY_LEN], KEY_LEN, (uint32_t) i);
+        }
+
+        data::bench::Stopwatch watch;
+        size_t found = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            found += trie.get(&keys[i * KEY_LEN], KEY_LEN).has_value();
+        }
+
+        const double ns = watch.elapsed_ns() / count;
+
+        bench_expect(found == count);
+
+        return ns;
+    }
+}
+
+void trie_benches() {
+    data::bench::benches["trie"]["lookups by child index"] = []() {
+        // Every level of a byte-keyed trie near the root has up to 256 children, which a list has to
+        // scan and a bitmap finds with a popcount. DNA keys only have 4 symbols, so the list is short
+        // there, and the dense index is a single load.
+        const size_t count = std::min(data::bench::max_keys(), (size_t) 200000);
+        std::vector<uint8_t> bytes;
+        std::vector<uint8_t> byte_keys;
+        std::vector<uint8_t> dna_keys;
+
+        for (size_t i = 0; i < 256; i++) {
+            bytes.push_back((uint8_t) i);
+        }
+
+        make_keys(count, bytes, byte_keys);
+        make_keys(count, { 0, 1, 2, 3 }, dna_keys);
+
+        printf("%12s %10s %14s\n", "alphabet", "index", "ns/lookup");
+
+        const double byte_list = time_lookups<data::ListChildren>(count, byte_keys);
+        const double byte_bitmap = time_lookups<data::BitmapChildren>(count, byte_keys);
+        printf("%12s %10s %14.1f\n", "bytes", "list", byte_list);
+        printf("%12s %10s %14.1f\n", "bytes", "bitmap", byte_bitmap);
+
+        const double dna_list = time_lookups<data::ListChildren>(count, dna_keys);
+        const double dna_bitmap = time_lookups<data::BitmapChildren>(count, dna_keys);
+        const double dna_dense = time_lookups<data::DenseChildren<4>>(count, dna_keys);
+        printf("%12s %10s %14.1f\n", "dna", "list", dna_list);
+        printf("%12s %10s %14.1f\n", "dna", "bitmap", dna_bitmap);
+        printf("%12s %10s %14.1f\n", "dna", "dense", dna_dense);
+
+        bench_expect(byte_bitmap < byte_list);
+    };
+
+    data::bench::benches["trie"]["frozen lookups"] = []() {
+        // A vocabulary of short lowercase words, like the pieces a tokenizer looks up
+        const size_t count = std::min(data::bench::max_keys(), (size_t) 200000);
+        std::vector<std::string> words;
+        uint64_t state = 88172645463325252ull;
+
+        for (size_t i = 0; i < count; i++) {
+            std::string word;
+
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            for (size_t len = 2 + state % 9; len > 0; len--) {
+                word.push_back('a' + (state >> (len * 5)) % 26);
+            }
+
+            words.push_back(word);
+        }
+
+        data::Trie<char, uint32_t> trie;
+        data::RadixTrie<char, uint32_t> radix_trie;
+
+        for (size_t i = 0; i < count; i++) {
+            trie.put(words[i].data(), words[i].size(), (uint32_t) i);
+            radix_trie.put(std::string_view(words[i]), (uint32_t) i);
+        }
+
+        data::bench::Stopwatch watch;
+        const data::DoubleArrayTrie<char, uint32_t> frozen = trie.freeze();
+        const double build_ms = watch.elapsed_ns() / 1e6;
+
+        size_t checksums[3] = {};
+        double ns[3];
+
+        watch.reset();
+        for (const std::string &word : words) {
+            checksums[0] += trie.get(word.data(), word.size()).value();
+        }
+        ns[0] = watch.elapsed_ns() / count;
+
+        watch.reset();
+        for (const std::string &word : words) {
+            checksums[1] += radix_trie.get(std::string_view(word)).value();
+        }
+        ns[1] = watch.elapsed_ns() / count;
+
+        watch.reset();
+        for (const std::string &word : words) {
+            checksums[2] += frozen.get(std::string_view(word)).value();
+        }
+        ns[2] = watch.elapsed_ns() / count;
+
+        printf("%12s %14s\n", "trie", "ns/lookup");
+        printf("%12s %14.1f\n", "trie", ns[0]);
+        printf("%12s %14.1f\n", "radix trie", ns[1]);
+        printf("%12s %14.1f\n", "frozen", ns[2]);
+        printf("froze %ld keys into %ld cells in %.1f ms\n", frozen.size(), frozen.cell_count(), build_ms);
+
+        bench_expect(checksums[0] == checksums[1] && checksums[1] == checksums[2]);
+        bench_expect(ns[2] < ns[0] && ns[2] < ns[1]);
+    };
+}
@@ -0,0 +1,307 @@
+#ifndef INCLUDE_STRUCTURES_ARENA_H
+#define INCLUDE_STRUCTURES_ARENA_H
+
+#include <new>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+namespace data {
+    /**
+     * A slab allocator for the many small, similarly sized objects that make up a trie. Small blocks
+     * are carved out of large chunks, and freed blocks go on a free list for their size class so that
+     * they can be reused. Blocks that are too big for a size class get their own allocation.
+     *
+     * Destroying the arena releases all of its memory in O(chunks) time without running any destructors,
+     * so a structure whose nodes are trivially destructible (apart from memory that also lives in the
+     * arena) can be torn down without visiting its nodes.
+     *
+     * Every block is aligned to `ALIGNMENT` bytes.
+     */
+    class Arena {
+        public:
+            static constexpr size_t ALIGNMENT = 16;
+
+        private:
+            static constexpr size_t CHUNK_SIZE = 64 * 1024;
+            static constexpr size_t SIZE_CLASSES = 128;
+            static constexpr size_t MAX_SMALL_SIZE = SIZE_CLASSES * ALIGNMENT;
+
+            struct FreeBlock {
+                FreeBlock * next;
+            };
+
+            /**
+             * Header in front of every large block, which links it into a list so that the arena
+             * can free it.
+             */
+            struct alignas(ALIGNMENT) LargeBlock {
+                LargeBlock * prev;
+                LargeBlock * next;
+            };
+
+            std::vector<char *> chunks;
+            char * cursor;
+            char * limit;
+            FreeBlock * free_lists[SIZE_CLASSES];
+            LargeBlock * large_blocks;
+
+            static size_t size_class(size_t bytes);
+
+            void release();
+
+        public:
+            Arena();
+
+            Arena(const Arena &other) = delete;
+
+            Arena(Arena &&other);
+
+            ~Arena();
+
+            void operator=(const Arena &other) = delete;
+
+            void operator=(Arena &&other);
+
+            void * allocate(size_t bytes);
+
+            /**
+             * Returns a block to the arena. `bytes` must be the size that the block was allocated with.
+             */
+            void deallocate(void * ptr, size_t bytes);
+
+            /**
+             * Allocates and constructs an object in the arena.
+             */
+            template <typename T, typename... Args>
+            T * create(Args &&... args);
+
+            /**
+             * Destroys an object that was created with `create` and returns its memory to the arena.
+             */
+            template <typename T>
+            void destroy(T * ptr);
+
+            /**
+             * Returns the number of chunks that small blocks are carved out of.
+             */
+            size_t chunk_count() const;
+    };
+
+    /**
+     * Adapts an Arena to the standard allocator interface, so that standard containers can allocate
+     * from it. The arena must outlive every container using it.
+     */
+    template <typename T>
+    class ArenaAllocator {
+        template <typename U>
+        friend class ArenaAllocator;
+
+        private:
+            Arena * arena;
+
+        public:
+            using value_type = T;
+
+            ArenaAllocator(Arena * arena);
+
+            template <typename U>
+            ArenaAllocator(const ArenaAllocator<U> &other);
+
+            T * allocate(size_t n);
+
+            void deallocate(T * ptr, size_t n);
+
+            template <typename U>
+            bool operator==(const ArenaAllocator<U> &other) const;
+    };
+}
+
+inline data::Arena::Arena() : chunks(std::vector<char *>()), cursor(nullptr), limit(nullptr), free_lists{}, large_blocks(nullptr) {}
+
+inline data::Arena::Arena(Arena &&other)
+    : chunks(std::move(other.chunks)), cursor(other.cursor), limit(other.limit), large_blocks(other.large_blocks)
+{
+    for (size_t i = 0; i < SIZE_CLASSES; i++) {
+        this->free_lists[i] = other.free_lists[i];
+        other.free_lists[i] = nullptr;
+    }
+
+    other.chunks.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.large_blocks = nullptr;
+}
+
+inline data::Arena::~Arena() {
+    this->release();
+}
+
+inline void data::Arena::operator=(Arena &&other) {
+    if (this == &other) {
+        return;
+    }
+
+    this->release();
+
+    this->chunks = std::move(other.chunks);
+    this->cursor = other.cursor;
+    this->limit = other.limit;
+    this->large_blocks = other.large_blocks;
+
+    for (size_t i = 0; i < SIZE_CLASSES; i++) {
+        this->free_lists[i] = other.free_lists[i];
+        other.free_lists[i] = nullptr;
+    }
+
+    other.chunks.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.large_blocks = nullptr;
+}
+
+inline void data::Arena::release() {
+    for (char * chunk : this->chunks) {
+        ::operator delete(chunk, std::align_val_t(ALIGNMENT));
+    }
+
+    while (this->large_blocks) {
+        LargeBlock * next = this->large_blocks->next;
+        ::operator delete(this->large_blocks, std::align_val_t(ALIGNMENT));
+        this->large_blocks = next;
+    }
+
+    this->chunks.clear();
+    this->cursor = nullptr;
+    this->limit = nullptr;
+
+    for (size_t i = 0; i < SIZE_CLASSES; i++) {
+        this->free_lists[i] = nullptr;
+    }
+}
+
+inline size_t data::Arena::size_class(size_t bytes) {
+    if (!bytes) {
+        return 0;
+    }
+
+    return (bytes - 1) / ALIGNMENT;
+}
+
+inline void * data::Arena::allocate(size_t bytes) {
+    if (bytes > MAX_SMALL_SIZE) {
+        void * mem = ::operator new(sizeof(LargeBlock) + bytes, std::align_val_t(ALIGNMENT));
+        LargeBlock * block = static_cast<LargeBlock *>(mem);
+
+        block->prev = nullptr;
+        block->next = this->large_blocks;
+
+        if (this->large_blocks) {
+            this->large_blocks->prev = block;
+        }
+
+        this->large_blocks = block;
+
+        return block + 1;
+    }
+
+    const size_t cls = size_class(bytes);
+
+    if (this->free_lists[cls]) {
+        FreeBlock * block = this->free_lists[cls];
+        this->free_lists[cls] = block->next;
+
+        return block;
+    }
+
+    const size_t size = (cls + 1) * ALIGNMENT;
+
+    if (!this->cursor || (size_t) (this->limit - this->cursor) < size) {
+        char * chunk = static_cast<char *>(::operator new(CHUNK_SIZE, std::align_val_t(ALIGNMENT)));
+        this->chunks.push_back(chunk);
+        this->cursor = chunk;
+        this->limit = chunk + CHUNK_SIZE;
+    }
+
+    void * out = this->cursor;
+    this->cursor += size;
+
+    return out;
+}
+
+inline void data::Arena::deallocate(void * ptr, size_t bytes) {
+    if (!ptr) {
+        return;
+    }
+
+    if (bytes > MAX_SMALL_SIZE) {
+        LargeBlock * block = static_cast<LargeBlock *>(ptr) - 1;
+
+        if (block->prev) {
+            block->prev->next = block->next;
+        } else {
+            this->large_blocks = block->next;
+        }
+
+        if (block->next) {
+            block->next->prev = block->prev;
+        }
+
+        ::operator delete(block, std::align_val_t(ALIGNMENT));
+        return;
+    }
+
+    const size_t cls = size_class(bytes);
+    FreeBlock * block = static_cast<FreeBlock *>(ptr);
+
+    block->next = this->free_lists[cls];
+    this->free_lists[cls] = block;
+}
+
+template <typename T, typename... Args>
+T * data::Arena::create(Args &&... args) {
+    static_assert(alignof(T) <= ALIGNMENT, "Arena blocks are not aligned enough for this type");
+
+    return new (this->allocate(sizeof(T))) T(std::forward<Args>(args)...);
+}
+
+template <typename T>
+void data::Arena::destroy(T * ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    ptr->~T();
+    this->deallocate(ptr, sizeof(T));
+}
+
+inline size_t data::Arena::chunk_count() const {
+    return this->chunks.size();
+}
+
+template <typename T>
+data::ArenaAllocator<T>::ArenaAllocator(Arena * arena) : arena(arena) {}
+
+template <typename T>
+template <typename U>
+data::ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+template <typename T>
+T * data::ArenaAllocator<T>::allocate(size_t n) {
+    static_assert(alignof(T) <= Arena::ALIGNMENT, "Arena blocks are not aligned enough for this type");
+
+    return static_cast<T *>(this->arena->allocate(n * sizeof(T)));
+}
+
+template <typename T>
+void data::ArenaAllocator<T>::deallocate(T * ptr, size_t n) {
+    this->arena->deallocate(ptr, n * sizeof(T));
+}
+
+template <typename T>
+template <typename U>
+bool data::ArenaAllocator<T>::operator==(const ArenaAllocator<U> &other) const {
+    return this->arena == other.arena;
+}
+
+#endif
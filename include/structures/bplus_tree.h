@@ -0,0 +1,681 @@
+#ifndef INCLUDE_STRUCTURES_BPLUS_TREE_H
+#define INCLUDE_STRUCTURES_BPLUS_TREE_H
+
+#include <optional>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+#include "../traits.h"
+#include "bplus_tree_iterator.h"
+#include "bplus_tree_node.h"
+
+namespace data {
+    /**
+     * B+ tree implementation. Unlike BTree, values are only stored in the leaves, and internal nodes
+     * only hold separator keys, so more of an internal node fits in cache. Leaves are linked to their
+     * neighbors, which makes range scans a sequential walk along the bottom of the tree.
+     *
+     * A node holds at most N - 1 keys, and every node other than the root holds at least `MIN_KEYS`.
+     */
+    template <Ord K, typename V, const size_t N>
+    class BPlusTree {
+        private:
+            static constexpr size_t MIN_KEYS = N / 2 > 1 ? N / 2 - 1 : 1;
+
+            static_assert(N >= 3, "A B+ tree node needs room for at least 3 keys");
+
+            typedef BPlusTreeNode<K, V, N> node_type;
+            typedef BPlusTreeLeaf<K, V, N> leaf_type;
+            typedef BPlusTreeInternal<K, V, N> internal_type;
+
+            node_type * root;
+            size_t len;
+
+            static leaf_type * as_leaf(node_type * node);
+
+            static const leaf_type * as_leaf(const node_type * node);
+
+            static internal_type * as_internal(node_type * node);
+
+            static const internal_type * as_internal(const node_type * node);
+
+            /**
+             * Returns the index of the child of `node` that can hold the given key.
+             */
+            static size_t child_index(const internal_type * node, const K &key);
+
+            static void destroy(node_type * node);
+
+            /**
+             * Returns the leaf that can hold the given key. If `parents` and `indices` are given, they
+             * are filled with the path to the leaf: `indices[i]` is the position of the child of
+             * `parents[i]` that was followed.
+             */
+            leaf_type * find_leaf(const K &key, std::vector<internal_type *> * parents = nullptr, std::vector<size_t> * indices = nullptr) const;
+
+            leaf_type * first_leaf() const;
+
+            void split_leaf(std::vector<internal_type *> &parents, leaf_type * leaf);
+
+            void split_internal(std::vector<internal_type *> &parents, internal_type * node);
+
+            /**
+             * Adds a separator and the new node to its right into the parent of `left`, which is the last
+             * node in `parents`, or grows a new root if `left` is the root.
+             */
+            void insert_into_parent(std::vector<internal_type *> &parents, node_type * left, const K &sep, node_type * right);
+
+            void rebalance(std::vector<internal_type *> &parents, std::vector<size_t> &indices, node_type * node);
+
+            void borrow_left(internal_type * parent, size_t index);
+
+            void borrow_right(internal_type * parent, size_t index);
+
+            void merge_children(internal_type * parent, size_t index);
+
+        public:
+            typedef BPlusTreeIterator<K, V, N> iterator;
+            typedef BPlusTreeIterator<K, V, N, true> const_iterator;
+
+            BPlusTree();
+
+            BPlusTree(const BPlusTree<K, V, N> &other) = delete;
+
+            BPlusTree(BPlusTree<K, V, N> &&other);
+
+            ~BPlusTree();
+
+            void operator=(const BPlusTree<K, V, N> &other) = delete;
+
+            void operator=(BPlusTree<K, V, N> &&other);
+
+            std::optional<V> get(const K &key) const;
+
+            /**
+             * Inserts a KV pair into the tree. If the key already exists, returns the previous value and
+             * replaces it.
+             */
+            std::optional<V> put(const K &key, const V val);
+
+            std::optional<V> del(const K &key);
+
+            size_t size() const;
+
+            iterator begin();
+
+            iterator end();
+
+            const_iterator begin() const;
+
+            const_iterator end() const;
+
+            /**
+             * Returns an iterator at the first entry whose key is not less than the given key.
+             */
+            iterator lower_bound(const K &key);
+
+            const_iterator lower_bound(const K &key) const;
+
+            /**
+             * Returns an iterator at the first entry whose key is greater than the given key.
+             */
+            iterator upper_bound(const K &key);
+
+            const_iterator upper_bound(const K &key) const;
+
+            /**
+             * Returns the entries with keys in [lo, hi), in order.
+             */
+            BPlusTreeRange<K, V, N> range(const K &lo, const K &hi);
+
+            BPlusTreeRange<K, V, N, true> range(const K &lo, const K &hi) const;
+
+#ifdef TEST
+            /**
+             * Returns the number of levels in the tree. A tree whose root is a leaf has height 1.
+             */
+            size_t height() const;
+
+            /**
+             * Checks that every leaf is at the same depth, that every node other than the root has at
+             * least `MIN_KEYS` keys, and that every key is within the bounds set by the separators above it.
+             */
+            bool is_valid() const;
+
+            bool is_valid(const node_type * node, size_t depth, size_t leaf_depth, const K * lo, const K * hi) const;
+
+            /**
+             * Checks that following the leaf links visits every leaf, in order, in both directions.
+             */
+            bool leaves_are_linked() const;
+#endif
+    };
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::BPlusTree<K, V, N>::BPlusTree() : root(new leaf_type()), len(0) {}
+
+template <data::Ord K, typename V, const size_t N>
+data::BPlusTree<K, V, N>::BPlusTree(BPlusTree<K, V, N> &&other) : root(other.root), len(other.len) {
+    other.root = new leaf_type();
+    other.len = 0;
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::BPlusTree<K, V, N>::~BPlusTree() {
+    destroy(this->root);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::operator=(BPlusTree<K, V, N> &&other) {
+    if (this == &other) {
+        return;
+    }
+
+    destroy(this->root);
+
+    this->root = other.root;
+    this->len = other.len;
+
+    other.root = new leaf_type();
+    other.len = 0;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::leaf_type * data::BPlusTree<K, V, N>::as_leaf(node_type * node) {
+    return static_cast<leaf_type *>(node);
+}
+
+template <data::Ord K, typename V, const size_t N>
+const typename data::BPlusTree<K, V, N>::leaf_type * data::BPlusTree<K, V, N>::as_leaf(const node_type * node) {
+    return static_cast<const leaf_type *>(node);
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::internal_type * data::BPlusTree<K, V, N>::as_internal(node_type * node) {
+    return static_cast<internal_type *>(node);
+}
+
+template <data::Ord K, typename V, const size_t N>
+const typename data::BPlusTree<K, V, N>::internal_type * data::BPlusTree<K, V, N>::as_internal(const node_type * node) {
+    return static_cast<const internal_type *>(node);
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::BPlusTree<K, V, N>::child_index(const internal_type * node, const K &key) {
+    const size_t index = node->keys.lower_bound(key);
+
+    // Keys equal to a separator are in the subtree to its right
+    if (index < node->keys.size() && node->keys[index] == key) {
+        return index + 1;
+    }
+
+    return index;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::destroy(node_type * node) {
+    if (node->leaf) {
+        delete as_leaf(node);
+        return;
+    }
+
+    internal_type * internal = as_internal(node);
+
+    for (size_t i = 0; i <= internal->keys.size(); i++) {
+        destroy(internal->children[i]);
+    }
+
+    delete internal;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::leaf_type * data::BPlusTree<K, V, N>::find_leaf(const K &key, std::vector<internal_type *> * parents, std::vector<size_t> * indices) const {
+    node_type * node = this->root;
+
+    while (!node->leaf) {
+        internal_type * internal = as_internal(node);
+        const size_t index = child_index(internal, key);
+
+        if (parents) {
+            parents->push_back(internal);
+            indices->push_back(index);
+        }
+
+        node = internal->children[index];
+    }
+
+    return as_leaf(node);
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::leaf_type * data::BPlusTree<K, V, N>::first_leaf() const {
+    node_type * node = this->root;
+
+    while (!node->leaf) {
+        node = as_internal(node)->children[0];
+    }
+
+    return as_leaf(node);
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::BPlusTree<K, V, N>::get(const K &key) const {
+    const leaf_type * leaf = this->find_leaf(key);
+    const size_t index = leaf->keys.lower_bound(key);
+
+    if (index < leaf->keys.size() && leaf->keys[index] == key) {
+        return std::optional(leaf->vals[index]);
+    }
+
+    return std::nullopt;
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::BPlusTree<K, V, N>::put(const K &key, const V val) {
+    std::vector<internal_type *> parents;
+    std::vector<size_t> indices;
+    leaf_type * leaf = this->find_leaf(key, &parents, &indices);
+    const size_t index = leaf->keys.lower_bound(key);
+
+    if (index < leaf->keys.size() && leaf->keys[index] == key) {
+        std::optional<V> out = std::optional(std::move(leaf->vals[index]));
+        leaf->vals[index] = val;
+
+        return out;
+    }
+
+    leaf->put(key, val);
+    this->len++;
+
+    if (leaf->keys.size() == N) {
+        this->split_leaf(parents, leaf);
+    }
+
+    return std::nullopt;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::split_leaf(std::vector<internal_type *> &parents, leaf_type * leaf) {
+    leaf_type * right = new leaf_type();
+    const size_t mid = N / 2;
+
+    for (size_t i = mid; i < N; i++) {
+        right->vals[i - mid] = std::move(leaf->vals[i]);
+    }
+
+    right->keys = leaf->keys.split_off(mid);
+
+    right->prev = leaf;
+    right->next = leaf->next;
+
+    if (leaf->next) {
+        leaf->next->prev = right;
+    }
+
+    leaf->next = right;
+
+    // The separator is a copy of the right leaf's first key, which stays in the leaf
+    this->insert_into_parent(parents, leaf, right->keys[0], right);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::split_internal(std::vector<internal_type *> &parents, internal_type * node) {
+    internal_type * right = new internal_type();
+    const size_t mid = N / 2;
+
+    right->keys = node->keys.split_off(mid + 1);
+
+    for (size_t i = 0; i <= right->keys.size(); i++) {
+        right->children[i] = node->children[mid + 1 + i];
+        node->children[mid + 1 + i] = nullptr;
+    }
+
+    // Unlike a leaf split, the separator moves up instead of being copied
+    const K pivot = node->keys.del(mid);
+
+    this->insert_into_parent(parents, node, pivot, right);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::insert_into_parent(std::vector<internal_type *> &parents, node_type * left, const K &sep, node_type * right) {
+    if (!parents.size()) {
+        internal_type * new_root = new internal_type();
+        new_root->keys.put(sep);
+        new_root->children[0] = left;
+        new_root->children[1] = right;
+        this->root = new_root;
+
+        return;
+    }
+
+    internal_type * parent = parents.back();
+    parents.pop_back();
+
+    parent->put(sep, right);
+
+    if (parent->keys.size() == N) {
+        this->split_internal(parents, parent);
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::BPlusTree<K, V, N>::del(const K &key) {
+    std::vector<internal_type *> parents;
+    std::vector<size_t> indices;
+    leaf_type * leaf = this->find_leaf(key, &parents, &indices);
+    const size_t index = leaf->keys.lower_bound(key);
+
+    if (index == leaf->keys.size() || !(leaf->keys[index] == key)) {
+        return std::nullopt;
+    }
+
+    // Separators equal to the deleted key can stay. They still divide the keys correctly.
+    std::optional<V> out = std::optional(leaf->del(index));
+    this->len--;
+
+    this->rebalance(parents, indices, leaf);
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::rebalance(std::vector<internal_type *> &parents, std::vector<size_t> &indices, node_type * node) {
+    while (node != this->root && node->keys.size() < MIN_KEYS) {
+        internal_type * parent = parents.back();
+        const size_t index = indices.back();
+        parents.pop_back();
+        indices.pop_back();
+
+        if (index > 0 && parent->children[index - 1]->keys.size() > MIN_KEYS) {
+            this->borrow_left(parent, index);
+            return;
+        }
+
+        if (index < parent->keys.size() && parent->children[index + 1]->keys.size() > MIN_KEYS) {
+            this->borrow_right(parent, index);
+            return;
+        }
+
+        if (index > 0) {
+            this->merge_children(parent, index - 1);
+        } else {
+            this->merge_children(parent, index);
+        }
+
+        node = parent;
+    }
+
+    if (!this->root->leaf && !this->root->keys.size()) {
+        // The root lost its last separator in a merge, so its only child becomes the new root
+        internal_type * old_root = as_internal(this->root);
+        this->root = old_root->children[0];
+
+        delete old_root;
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::borrow_left(internal_type * parent, size_t index) {
+    node_type * node = parent->children[index];
+
+    if (node->leaf) {
+        leaf_type * left = as_leaf(parent->children[index - 1]);
+        const size_t last = left->keys.size() - 1;
+        const K key = left->keys[last];
+
+        as_leaf(node)->put(key, left->del(last));
+        parent->keys[index - 1] = key;
+
+        return;
+    }
+
+    // Rotate through the parent: the separator comes down in front of the node's keys along with the
+    // left sibling's last child, and the left sibling's last key replaces it
+    internal_type * internal = as_internal(node);
+    internal_type * left = as_internal(parent->children[index - 1]);
+    const size_t last = left->keys.size() - 1;
+    node_type * moved = left->children[last + 1];
+
+    left->children[last + 1] = nullptr;
+    internal->put(parent->keys[index - 1], internal->children[0]);
+    internal->children[0] = moved;
+    parent->keys[index - 1] = left->keys.del(last);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::borrow_right(internal_type * parent, size_t index) {
+    node_type * node = parent->children[index];
+
+    if (node->leaf) {
+        leaf_type * right = as_leaf(parent->children[index + 1]);
+        const K key = right->keys[0];
+
+        as_leaf(node)->put(key, right->del(0));
+        parent->keys[index] = right->keys[0];
+
+        return;
+    }
+
+    internal_type * internal = as_internal(node);
+    internal_type * right = as_internal(parent->children[index + 1]);
+
+    internal->put(parent->keys[index], right->children[0]);
+    parent->keys[index] = right->keys[0];
+
+    // Removing the right sibling's first separator also drops the child after it, so that child
+    // moves into the first slot first
+    right->children[0] = right->children[1];
+    right->del(0);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BPlusTree<K, V, N>::merge_children(internal_type * parent, size_t index) {
+    node_type * left_node = parent->children[index];
+    node_type * right_node = parent->children[index + 1];
+
+    if (left_node->leaf) {
+        leaf_type * left = as_leaf(left_node);
+        leaf_type * right = as_leaf(right_node);
+
+        for (size_t i = 0; i < right->keys.size(); i++) {
+            left->put(right->keys[i], std::move(right->vals[i]));
+        }
+
+        left->next = right->next;
+
+        if (right->next) {
+            right->next->prev = left;
+        }
+
+        parent->del(index);
+        delete right;
+
+        return;
+    }
+
+    internal_type * left = as_internal(left_node);
+    internal_type * right = as_internal(right_node);
+
+    left->put(parent->keys[index], right->children[0]);
+
+    for (size_t i = 0; i < right->keys.size(); i++) {
+        left->put(right->keys[i], right->children[i + 1]);
+    }
+
+    parent->del(index);
+    delete right;
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::BPlusTree<K, V, N>::size() const {
+    return this->len;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::iterator data::BPlusTree<K, V, N>::begin() {
+    return iterator(this->first_leaf(), 0);
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::iterator data::BPlusTree<K, V, N>::end() {
+    return iterator();
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::const_iterator data::BPlusTree<K, V, N>::begin() const {
+    return const_iterator(this->first_leaf(), 0);
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::const_iterator data::BPlusTree<K, V, N>::end() const {
+    return const_iterator();
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::iterator data::BPlusTree<K, V, N>::lower_bound(const K &key) {
+    leaf_type * leaf = this->find_leaf(key);
+
+    return iterator(leaf, leaf->keys.lower_bound(key));
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::const_iterator data::BPlusTree<K, V, N>::lower_bound(const K &key) const {
+    const leaf_type * leaf = this->find_leaf(key);
+
+    return const_iterator(leaf, leaf->keys.lower_bound(key));
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::iterator data::BPlusTree<K, V, N>::upper_bound(const K &key) {
+    leaf_type * leaf = this->find_leaf(key);
+    size_t index = leaf->keys.lower_bound(key);
+
+    if (index < leaf->keys.size() && leaf->keys[index] == key) {
+        index++;
+    }
+
+    return iterator(leaf, index);
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BPlusTree<K, V, N>::const_iterator data::BPlusTree<K, V, N>::upper_bound(const K &key) const {
+    const leaf_type * leaf = this->find_leaf(key);
+    size_t index = leaf->keys.lower_bound(key);
+
+    if (index < leaf->keys.size() && leaf->keys[index] == key) {
+        index++;
+    }
+
+    return const_iterator(leaf, index);
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::BPlusTreeRange<K, V, N> data::BPlusTree<K, V, N>::range(const K &lo, const K &hi) {
+    if (!(lo < hi)) {
+        return BPlusTreeRange<K, V, N>();
+    }
+
+    return BPlusTreeRange<K, V, N>(this->lower_bound(lo), this->lower_bound(hi));
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::BPlusTreeRange<K, V, N, true> data::BPlusTree<K, V, N>::range(const K &lo, const K &hi) const {
+    if (!(lo < hi)) {
+        return BPlusTreeRange<K, V, N, true>();
+    }
+
+    return BPlusTreeRange<K, V, N, true>(this->lower_bound(lo), this->lower_bound(hi));
+}
+
+#ifdef TEST
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::BPlusTree<K, V, N>::height() const {
+    size_t out = 1;
+    const node_type * node = this->root;
+
+    while (!node->leaf) {
+        node = as_internal(node)->children[0];
+        out++;
+    }
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::BPlusTree<K, V, N>::is_valid() const {
+    return this->is_valid(this->root, 1, this->height(), nullptr, nullptr);
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::BPlusTree<K, V, N>::is_valid(const node_type * node, size_t depth, size_t leaf_depth, const K * lo, const K * hi) const {
+    if (node->keys.size() >= N || (node != this->root && node->keys.size() < MIN_KEYS)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < node->keys.size(); i++) {
+        if ((lo && node->keys[i] < *lo) || (hi && !(node->keys[i] < *hi))) {
+            return false;
+        }
+
+        if (i > 0 && !(node->keys[i - 1] < node->keys[i])) {
+            return false;
+        }
+    }
+
+    if (node->leaf) {
+        return depth == leaf_depth;
+    }
+
+    const internal_type * internal = as_internal(node);
+
+    for (size_t i = 0; i <= internal->keys.size(); i++) {
+        const K * child_lo = i > 0 ? &internal->keys[i - 1] : lo;
+        const K * child_hi = i < internal->keys.size() ? &internal->keys[i] : hi;
+
+        if (!internal->children[i] || !this->is_valid(internal->children[i], depth + 1, leaf_depth, child_lo, child_hi)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::BPlusTree<K, V, N>::leaves_are_linked() const {
+    std::vector<const leaf_type *> leaves;
+    std::vector<const node_type *> stack = { this->root };
+
+    // Collect the leaves in order without using the links
+    while (stack.size()) {
+        const node_type * node = stack.back();
+        stack.pop_back();
+
+        if (node->leaf) {
+            leaves.push_back(as_leaf(node));
+            continue;
+        }
+
+        const internal_type * internal = as_internal(node);
+
+        for (size_t i = internal->keys.size() + 1; i > 0; i--) {
+            stack.push_back(internal->children[i - 1]);
+        }
+    }
+
+    for (size_t i = 0; i < leaves.size(); i++) {
+        const leaf_type * prev = i > 0 ? leaves[i - 1] : nullptr;
+        const leaf_type * next = i + 1 < leaves.size() ? leaves[i + 1] : nullptr;
+
+        if (leaves[i]->prev != prev || leaves[i]->next != next) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif
+#endif
@@ -0,0 +1,160 @@
+#ifndef INCLUDE_STRUCTURES_BPLUS_TREE_ITERATOR_H
+#define INCLUDE_STRUCTURES_BPLUS_TREE_ITERATOR_H
+
+#include <iterator>
+#include <ranges>
+#include <stdlib.h>
+#include <type_traits>
+#include <utility>
+
+#include "bplus_tree_node.h"
+
+namespace data {
+    /**
+     * Iterator over the entries of a BPlusTree in key order. The "value type" is a pair where the first
+     * item is a reference to the key and the second item is a pointer to the value. The iterator walks
+     * along the linked leaves, so moving to the next entry never goes back up the tree.
+     *
+     * If IS_CONST is true, the iterator only gives out const pointers to values.
+     */
+    template <PartialOrd K, typename V, const size_t N, const bool IS_CONST = false>
+    class BPlusTreeIterator {
+        private:
+            typedef std::conditional_t<IS_CONST, const BPlusTreeLeaf<K, V, N>, BPlusTreeLeaf<K, V, N>> leaf_type;
+
+            // Null at the end
+            leaf_type * leaf;
+            size_t index;
+
+            constexpr void check_impl();
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<const K &, std::conditional_t<IS_CONST, const V, V> *>;
+            using difference_type = ptrdiff_t;
+            using pointer = value_type *;
+            using reference = value_type&;
+
+            /**
+             * Creates an end iterator.
+             */
+            BPlusTreeIterator();
+
+            /**
+             * Creates an iterator at the given index of a leaf. If the index is past the end of the leaf,
+             * the iterator starts at the beginning of the next leaf.
+             */
+            BPlusTreeIterator(leaf_type * leaf, size_t index);
+
+            BPlusTreeIterator<K, V, N, IS_CONST>& operator++();
+
+            BPlusTreeIterator<K, V, N, IS_CONST> operator++(int);
+
+            bool operator==(const BPlusTreeIterator<K, V, N, IS_CONST> &it) const;
+
+            bool operator!=(const BPlusTreeIterator<K, V, N, IS_CONST> &it) const;
+
+            value_type operator*() const;
+    };
+
+    /**
+     * A range of BPlusTree entries between two iterators. It can be passed to std::ranges algorithms
+     * and views.
+     */
+    template <PartialOrd K, typename V, const size_t N, const bool IS_CONST = false>
+    class BPlusTreeRange : public std::ranges::view_interface<BPlusTreeRange<K, V, N, IS_CONST>> {
+        private:
+            BPlusTreeIterator<K, V, N, IS_CONST> first;
+            BPlusTreeIterator<K, V, N, IS_CONST> last;
+
+        public:
+            BPlusTreeRange();
+
+            BPlusTreeRange(BPlusTreeIterator<K, V, N, IS_CONST> first, BPlusTreeIterator<K, V, N, IS_CONST> last);
+
+            BPlusTreeIterator<K, V, N, IS_CONST> begin() const;
+
+            BPlusTreeIterator<K, V, N, IS_CONST> end() const;
+    };
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+constexpr void data::BPlusTreeIterator<K, V, N, IS_CONST>::check_impl() {
+    // See RadixTrieIterator::check_impl
+    static_assert(std::forward_iterator<BPlusTreeIterator<K, V, N, IS_CONST>>);
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+data::BPlusTreeIterator<K, V, N, IS_CONST>::BPlusTreeIterator() : leaf(nullptr), index(0) {
+    this->check_impl();
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+data::BPlusTreeIterator<K, V, N, IS_CONST>::BPlusTreeIterator(leaf_type * leaf, size_t index) : leaf(leaf), index(index) {
+    this->check_impl();
+
+    // Only the root can be an empty leaf, and it has no next leaf
+    while (this->leaf && this->index == this->leaf->keys.size()) {
+        this->leaf = this->leaf->next;
+        this->index = 0;
+    }
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+data::BPlusTreeIterator<K, V, N, IS_CONST>& data::BPlusTreeIterator<K, V, N, IS_CONST>::operator++() {
+    if (!this->leaf) {
+        return *this;
+    }
+
+    this->index++;
+
+    if (this->index == this->leaf->keys.size()) {
+        this->leaf = this->leaf->next;
+        this->index = 0;
+    }
+
+    return *this;
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+data::BPlusTreeIterator<K, V, N, IS_CONST> data::BPlusTreeIterator<K, V, N, IS_CONST>::operator++(int) {
+    BPlusTreeIterator<K, V, N, IS_CONST> it = BPlusTreeIterator<K, V, N, IS_CONST>(*this);
+
+    ++(*this);
+
+    return it;
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+bool data::BPlusTreeIterator<K, V, N, IS_CONST>::operator==(const BPlusTreeIterator<K, V, N, IS_CONST> &it) const {
+    return this->leaf == it.leaf && this->index == it.index;
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+bool data::BPlusTreeIterator<K, V, N, IS_CONST>::operator!=(const BPlusTreeIterator<K, V, N, IS_CONST> &it) const {
+    return !(*this == it);
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+typename data::BPlusTreeIterator<K, V, N, IS_CONST>::value_type data::BPlusTreeIterator<K, V, N, IS_CONST>::operator*() const {
+    return value_type(this->leaf->keys[this->index], &this->leaf->vals[this->index]);
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+data::BPlusTreeRange<K, V, N, IS_CONST>::BPlusTreeRange() : first(), last() {}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+data::BPlusTreeRange<K, V, N, IS_CONST>::BPlusTreeRange(BPlusTreeIterator<K, V, N, IS_CONST> first, BPlusTreeIterator<K, V, N, IS_CONST> last)
+    : first(first), last(last) {}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+data::BPlusTreeIterator<K, V, N, IS_CONST> data::BPlusTreeRange<K, V, N, IS_CONST>::begin() const {
+    return this->first;
+}
+
+template <data::PartialOrd K, typename V, const size_t N, const bool IS_CONST>
+data::BPlusTreeIterator<K, V, N, IS_CONST> data::BPlusTreeRange<K, V, N, IS_CONST>::end() const {
+    return this->last;
+}
+
+#endif
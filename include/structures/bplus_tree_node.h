@@ -0,0 +1,133 @@
+#ifndef INCLUDE_STRUCTURES_BPLUS_TREE_NODE_H
+#define INCLUDE_STRUCTURES_BPLUS_TREE_NODE_H
+
+#include <stdlib.h>
+#include <utility>
+
+#include "sorted_array.h"
+#include "../traits.h"
+
+namespace data {
+    /**
+     * The part of a B+ tree node shared by leaves and internal nodes. Keys are kept in a SortedArray
+     * by themselves, so a search only touches keys. Whether a node is a leaf is fixed when it is
+     * created, and the tree casts to the right kind of node based on it.
+     */
+    template <PartialOrd K, typename V, const size_t N>
+    struct BPlusTreeNode {
+        SortedArray<K, N> keys;
+        const bool leaf;
+
+        BPlusTreeNode(bool leaf);
+    };
+
+    /**
+     * A leaf holds every value in the tree. `vals[i]` is the value for `keys[i]`. Leaves are linked to
+     * their neighbors in key order, so a range scan walks along the bottom of the tree without going
+     * back through the internal nodes.
+     */
+    template <PartialOrd K, typename V, const size_t N>
+    struct BPlusTreeLeaf : BPlusTreeNode<K, V, N> {
+        V vals[N];
+        BPlusTreeLeaf<K, V, N> * prev;
+        BPlusTreeLeaf<K, V, N> * next;
+
+        BPlusTreeLeaf();
+
+        /**
+         * Inserts a key that is not in the leaf and returns its index.
+         */
+        size_t put(const K &key, V val);
+
+        /**
+         * Removes the key at the given index and returns its value.
+         */
+        V del(size_t index);
+    };
+
+    /**
+     * An internal node only holds separator keys. `children[i]` holds the keys less than `keys[i]`,
+     * and `children[keys.size()]` holds the keys greater than or equal to the last separator.
+     */
+    template <PartialOrd K, typename V, const size_t N>
+    struct BPlusTreeInternal : BPlusTreeNode<K, V, N> {
+        BPlusTreeNode<K, V, N> * children[N + 1];
+
+        BPlusTreeInternal();
+
+        /**
+         * Inserts a separator and the child to its right. Returns the separator's index.
+         */
+        size_t put(const K &key, BPlusTreeNode<K, V, N> * right);
+
+        /**
+         * Removes the separator at the given index along with the child to its right, and returns
+         * the child.
+         */
+        BPlusTreeNode<K, V, N> * del(size_t index);
+    };
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+data::BPlusTreeNode<K, V, N>::BPlusTreeNode(bool leaf) : keys(), leaf(leaf) {}
+
+template <data::PartialOrd K, typename V, const size_t N>
+data::BPlusTreeLeaf<K, V, N>::BPlusTreeLeaf() : BPlusTreeNode<K, V, N>(true), prev(nullptr), next(nullptr) {}
+
+template <data::PartialOrd K, typename V, const size_t N>
+size_t data::BPlusTreeLeaf<K, V, N>::put(const K &key, V val) {
+    const size_t index = this->keys.put(key);
+
+    for (size_t i = this->keys.size() - 1; i > index; i--) {
+        this->vals[i] = std::move(this->vals[i - 1]);
+    }
+
+    this->vals[index] = std::move(val);
+
+    return index;
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+V data::BPlusTreeLeaf<K, V, N>::del(size_t index) {
+    V out = std::move(this->vals[index]);
+
+    for (size_t i = index; i + 1 < this->keys.size(); i++) {
+        this->vals[i] = std::move(this->vals[i + 1]);
+    }
+
+    this->keys.del(index);
+
+    return out;
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+data::BPlusTreeInternal<K, V, N>::BPlusTreeInternal() : BPlusTreeNode<K, V, N>(false), children{} {}
+
+template <data::PartialOrd K, typename V, const size_t N>
+size_t data::BPlusTreeInternal<K, V, N>::put(const K &key, BPlusTreeNode<K, V, N> * right) {
+    const size_t index = this->keys.put(key);
+
+    for (size_t i = this->keys.size(); i > index + 1; i--) {
+        this->children[i] = this->children[i - 1];
+    }
+
+    this->children[index + 1] = right;
+
+    return index;
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+data::BPlusTreeNode<K, V, N> * data::BPlusTreeInternal<K, V, N>::del(size_t index) {
+    BPlusTreeNode<K, V, N> * out = this->children[index + 1];
+
+    for (size_t i = index + 1; i < this->keys.size(); i++) {
+        this->children[i] = this->children[i + 1];
+    }
+
+    this->children[this->keys.size()] = nullptr;
+    this->keys.del(index);
+
+    return out;
+}
+
+#endif
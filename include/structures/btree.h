@@ -1,10 +1,15 @@
 #ifndef INCLUDE_STRUCTURES_BTREE_H
 #define INCLUDE_STRUCTURES_BTREE_H
 
+#include <algorithm>
+#include <iterator>
+#include <math.h>
+#include <ranges>
 #include <stdlib.h>
 #include <vector>
 
 #include "../traits.h"
+#include "btree_iterator.h"
 #include "btree_node.h"
 
 #ifdef TEST
@@ -27,14 +32,73 @@ namespace data {
     template <Ord K, typename V, const size_t N>
     class BTree {
         private:
+            /**
+             * The minimum number of keys in any node other than the root. A split leaves at least
+             * this many keys on both sides, and deletion borrows or merges to maintain it.
+             */
+            static constexpr size_t MIN_KEYS = N / 2 > 1 ? N / 2 - 1 : 1;
+
+            static_assert(N >= 3, "A btree node needs room for at least 3 keys");
+
             BTreeNode<K, V, N> * root;
             size_t len;
 
             void split_node(std::vector<BTreeNode<K, V, N> *> &parents, BTreeNode<K, V, N> * node);
 
+            /**
+             * Restores the minimum occupancy of `node` after a key was removed from it. `parents` and
+             * `indices` are the path from the root to `node`: `indices[i]` is the position of the
+             * child of `parents[i]` that was followed.
+             */
+            void rebalance(std::vector<BTreeNode<K, V, N> *> &parents, std::vector<size_t> &indices, BTreeNode<K, V, N> * node);
+
+            /**
+             * Moves the last key of the child before `index` up into the parent, and the separating
+             * key down into the front of the child at `index`.
+             */
+            void borrow_left(BTreeNode<K, V, N> * parent, size_t index);
+
+            /**
+             * Moves the first key of the child after `index` up into the parent, and the separating
+             * key down into the back of the child at `index`.
+             */
+            void borrow_right(BTreeNode<K, V, N> * parent, size_t index);
+
+            /**
+             * Merges the child after `index` and the separating key into the child at `index`, and
+             * deletes the emptied child.
+             */
+            void merge_children(BTreeNode<K, V, N> * parent, size_t index);
+
+            /**
+             * Returns how many nodes to spread `count` slots over when building a level bottom up, where
+             * a slot is a child of an internal node or a key of a leaf plus the separator after it. Each
+             * node gets about `target` slots, but never fewer than a non-root node needs or more than a
+             * node can hold.
+             */
+            static size_t group_count(size_t count, size_t target);
+
         public:
+            typedef BTreeIterator<K, V, N> iterator;
+            typedef BTreeIterator<K, V, N, true> const_iterator;
+
             BTree();
 
+            /**
+             * Builds a btree from a range of key-value pairs sorted by key, without any splits. Leaves
+             * are packed to `fill` times their capacity and the internal levels are built directly on top
+             * of them, so loading n pairs takes O(n) time. Throws if the keys are not strictly increasing.
+             *
+             * A fill factor below 1 leaves room in every node, so that later inserts don't immediately
+             * split them.
+             */
+            template <std::forward_iterator It>
+            BTree(It first, It last, double fill = 1.0);
+
+            template <std::ranges::forward_range R>
+            requires std::ranges::common_range<R>
+            BTree(R &&range, double fill = 1.0);
+
             ~BTree();
 
             std::optional<V> get(const K &key) const;
@@ -49,6 +113,42 @@ namespace data {
 
             size_t size() const;
 
+            iterator begin();
+
+            iterator end();
+
+            const_iterator begin() const;
+
+            const_iterator end() const;
+
+            /**
+             * Returns an iterator at the first entry whose key is not less than the given key.
+             */
+            iterator lower_bound(const K &key);
+
+            const_iterator lower_bound(const K &key) const;
+
+            /**
+             * Returns an iterator at the first entry whose key is greater than the given key.
+             */
+            iterator upper_bound(const K &key);
+
+            const_iterator upper_bound(const K &key) const;
+
+            /**
+             * Returns the range of entries with the given key, which is empty if the key is not in the tree.
+             */
+            std::pair<iterator, iterator> equal_range(const K &key);
+
+            std::pair<const_iterator, const_iterator> equal_range(const K &key) const;
+
+            /**
+             * Returns the entries with keys in [lo, hi), in order.
+             */
+            BTreeRange<K, V, N> range(const K &lo, const K &hi);
+
+            BTreeRange<K, V, N, true> range(const K &lo, const K &hi) const;
+
 #ifdef TEST
             void debug_print() const;
 
@@ -59,10 +159,16 @@ namespace data {
 
             DepthResult depth(BTreeNode<K, V, N> * node) const;
 
+            /**
+             * Returns the number of levels in the btree. A btree whose root is a leaf has height 1.
+             */
+            size_t height() const;
+
             /**
              * Checks that the btree satisfies the property that every internal node (non leaf and non root) has
              * at least N / 2 children. Simultaneously checks that every internal node has k + 1 children where k
-             * is the number of keys in the node.
+             * is the number of keys in the node, and that every leaf other than the root has at least
+             * `MIN_KEYS` keys.
              */
             bool is_full_enough() const;
             bool is_full_enough(BTreeNode<K, V, N> * node) const;
@@ -73,6 +179,103 @@ namespace data {
 template <data::Ord K, typename V, const size_t N>
 data::BTree<K, V, N>::BTree() : root(new BTreeNode<K, V, N>()), len(0) {}
 
+template <data::Ord K, typename V, const size_t N>
+template <std::forward_iterator It>
+data::BTree<K, V, N>::BTree(It first, It last, double fill) : root(nullptr), len(0) {
+    if (!(fill > 0 && fill <= 1)) {
+        throw "Fill factor must be greater than 0 and at most 1";
+    }
+
+    const size_t count = std::distance(first, last);
+    const size_t target = std::clamp<size_t>(lround(fill * (N - 1)), 1, N - 1) + 1;
+
+    std::vector<BTreeNode<K, V, N> *> nodes;
+    std::vector<std::pair<K, V>> seps;
+
+    // Every leaf but the last is followed by a separator, so n keys fill n + 1 slots
+    const size_t leaves = group_count(count + 1, target);
+    It prev = last;
+
+    nodes.reserve(leaves);
+    seps.reserve(leaves - 1);
+
+    for (size_t i = 0; i < leaves; i++) {
+        const size_t slots = (count + 1) / leaves + (i < (count + 1) % leaves);
+        const size_t keys = i == leaves - 1 ? slots - 1 : slots;
+        BTreeNode<K, V, N> * leaf = new BTreeNode<K, V, N>();
+        nodes.push_back(leaf);
+
+        for (size_t j = 0; j < keys; j++, ++first) {
+            const auto &[key, val] = *first;
+
+            if (prev != last && !((*prev).first < key)) {
+                for (BTreeNode<K, V, N> * node : nodes) {
+                    delete node;
+                }
+
+                throw "Bulk loaded keys must be sorted and unique";
+            }
+
+            prev = first;
+
+            if (j < slots - 1) {
+                leaf->put(key, val);
+            } else {
+                seps.push_back({ key, val });
+            }
+        }
+    }
+
+    // Group each level under a new level of parents until there is only one node
+    while (nodes.size() > 1) {
+        const size_t parents = group_count(nodes.size(), target);
+        std::vector<BTreeNode<K, V, N> *> next_nodes;
+        std::vector<std::pair<K, V>> next_seps;
+        size_t c = 0;
+
+        next_nodes.reserve(parents);
+        next_seps.reserve(parents - 1);
+
+        for (size_t i = 0; i < parents; i++) {
+            const size_t children = nodes.size() / parents + (i < nodes.size() % parents);
+            BTreeNode<K, V, N> * parent = new BTreeNode<K, V, N>();
+
+            parent->child(0) = nodes[c];
+
+            for (size_t j = 0; j < children - 1; j++, c++) {
+                parent->put(seps[c].first, std::move(seps[c].second), nodes[c + 1]);
+            }
+
+            if (i < parents - 1) {
+                next_seps.push_back(std::move(seps[c]));
+            }
+
+            c++;
+            next_nodes.push_back(parent);
+        }
+
+        nodes = std::move(next_nodes);
+        seps = std::move(next_seps);
+    }
+
+    this->root = nodes[0];
+    this->len = count;
+}
+
+template <data::Ord K, typename V, const size_t N>
+template <std::ranges::forward_range R>
+requires std::ranges::common_range<R>
+data::BTree<K, V, N>::BTree(R &&range, double fill) : BTree(std::ranges::begin(range), std::ranges::end(range), fill) {}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::BTree<K, V, N>::group_count(size_t count, size_t target) {
+    // Fewer groups than this would overfill them, and more would leave them with too few slots
+    const size_t min_groups = (count + N - 1) / N;
+    const size_t max_groups = std::max<size_t>(count / (MIN_KEYS + 1), 1);
+
+    return std::clamp<size_t>((count + target - 1) / target, min_groups, max_groups);
+}
+
 template <data::Ord K, typename V, const size_t N>
 data::BTree<K, V, N>::~BTree() {
     delete this->root;
@@ -82,26 +285,20 @@ template <data::Ord K, typename V, const size_t N>
 std::optional<V> data::BTree<K, V, N>::get(const K &key) const {
     const BTreeNode<K, V, N> * curr_node = this->root;
 
-    while (!curr_node->is_leaf()) {
-        size_t index = curr_node->items.lower_bound(key);
+    while (true) {
+        // Only the keys are searched, so the values and children of the nodes on the way down are
+        // never loaded
+        const size_t index = curr_node->keys.lower_bound(key);
 
-        if (index == curr_node->items.size()) {
-            curr_node = curr_node->post;
-        } else if (curr_node->items[index].key == key) {
-            return std::optional(curr_node->items[index].val);
-        } else {
-            curr_node = curr_node->items[index].pre;
+        if (index < curr_node->keys.size() && curr_node->keys[index] == key) {
+            return std::optional(curr_node->vals[index]);
         }
-    }
 
-    size_t index = curr_node->items.lower_bound(key);
+        if (curr_node->is_leaf()) {
+            return std::nullopt;
+        }
 
-    if (index == curr_node->items.size()) {
-        return std::nullopt;
-    } else if (curr_node->items[index].key == key) {
-        return std::optional(curr_node->items[index].val);
-    } else {
-        return std::nullopt;
+        curr_node = curr_node->child(index);
     }
 }
 
@@ -111,36 +308,26 @@ std::optional<V> data::BTree<K, V, N>::put(const K key, const V val) {
     BTreeNode<K, V, N> * curr_node = this->root;
 
     // First we have to find the right place to insert the key
-    while (!curr_node->is_leaf()) {
-        size_t index = curr_node->items.lower_bound(key);
+    while (true) {
+        const size_t index = curr_node->keys.lower_bound(key);
 
-        if (index == curr_node->items.size()) {
-            parents.push_back(curr_node);
-            curr_node = curr_node->post;
-        } else if (curr_node->items[index].key == key) {
+        if (index < curr_node->keys.size() && curr_node->keys[index] == key) {
             // The key already exists, update and return early
-            const V old_val = curr_node->items[index].val;
-            curr_node->items[index].val = val;
+            const V old_val = curr_node->vals[index];
+            curr_node->vals[index] = val;
 
             return std::optional<V>(old_val);
-        } else {
-            parents.push_back(curr_node);
-            curr_node = curr_node->items[index].pre;
         }
-    }
 
-    size_t index = curr_node->items.lower_bound(key);
-
-    if (index < curr_node->items.size() && curr_node->items[index].key == key) {
-        const V old_val = curr_node->items[index].val;
-        curr_node->items[index].val = val;
+        if (curr_node->is_leaf()) {
+            break;
+        }
 
-        return std::optional<V>(old_val);
+        parents.push_back(curr_node);
+        curr_node = curr_node->child(index);
     }
 
-    // `pre` is null because this is a leaf node
-    BTreeEntry<K, V, N> entry(key, val, nullptr);
-    curr_node->items.put(entry);
+    curr_node->put(key, val);
     this->len++;
 
     if (curr_node->is_overflowed()) {
@@ -153,33 +340,32 @@ std::optional<V> data::BTree<K, V, N>::put(const K key, const V val) {
 
 template <data::Ord K, typename V, const size_t N>
 void data::BTree<K, V, N>::split_node(std::vector<BTreeNode<K, V, N> *> &parents, BTreeNode<K, V, N> * left_node) {
-    BTreeEntry<K, V, N> pivot = left_node->items[N / 2];
+    // Ownership of every subtree is transferred by moving entries and reassigning child
+    // pointers, so a split costs O(N) regardless of how much of the tree hangs below this node
     BTreeNode<K, V, N> * right_node = new BTreeNode<K, V, N>();
-    right_node->items = left_node->items.substr(N / 2 + 1);
-    left_node->items.truncate(N / 2);
+    right_node->keys = left_node->keys.split_off(N / 2 + 1);
 
-    if (!left_node->is_leaf()) {
-        right_node->post = new BTreeNode<K, V, N>(*left_node->post);
-
-        if (left_node->post) {
-            delete left_node->post;
-        }
-
-        left_node->post = new BTreeNode<K, V, N>(*pivot.pre);
+    for (size_t i = 0; i < right_node->keys.size(); i++) {
+        right_node->vals[i] = std::move(left_node->vals[N / 2 + 1 + i]);
+    }
 
-        if (pivot.pre) {
-            delete pivot.pre;
-            pivot.pre = nullptr;
+    if (!left_node->is_leaf()) {
+        for (size_t i = 0; i <= right_node->keys.size(); i++) {
+            right_node->child(i) = left_node->child(N / 2 + 1 + i);
+            left_node->child(N / 2 + 1 + i) = nullptr;
         }
     }
 
+    // The pivot is now the last key in the left node, and its right child has already moved
+    const K pivot_key = left_node->keys[N / 2];
+    V pivot_val = left_node->del(N / 2);
+
     if (!parents.size()) {
         // Split the root
 
         BTreeNode<K, V, N> * new_root = new BTreeNode<K, V, N>();
-        size_t index = new_root->items.put(pivot);
-        new_root->items[index].pre = left_node;
-        new_root->post = right_node;
+        new_root->child(0) = left_node;
+        new_root->put(pivot_key, std::move(pivot_val), right_node);
         this->root = new_root;
 
         return;
@@ -187,26 +373,10 @@ void data::BTree<K, V, N>::split_node(std::vector<BTreeNode<K, V, N> *> &parents
 
     BTreeNode<K, V, N> * parent = parents.back();
     parents.pop_back();
-    pivot.pre = nullptr;
- 
-    // TODO: Find a better way to do this
-    for (size_t i = 0; i < parent->items.size(); i++) {
-        if (parent->items[i].pre == left_node) {
-            parent->items[i].pre = nullptr;
-            break;
-        }
-    }
 
-    size_t index = parent->items.put(pivot);
-    parent->items[index].pre = left_node;
-
-    // Now find pivot's right sibling and update its `pre` pointer, or `post` if it has
-    // no right sibling
-    if (index == (parent->items.size() - 1)) {
-        parent->post = right_node;
-    } else {
-        parent->items[index + 1].pre = right_node;
-    }
+    // The left node is already the child before the pivot's position, so only the right node needs
+    // to be linked in
+    parent->put(pivot_key, std::move(pivot_val), right_node);
 
     if (parent->is_overflowed()) {
         // Split parent
@@ -217,36 +387,155 @@ void data::BTree<K, V, N>::split_node(std::vector<BTreeNode<K, V, N> *> &parents
 template <data::Ord K, typename V, const size_t N>
 std::optional<V> data::BTree<K, V, N>::del(const K key) {
     std::vector<BTreeNode<K, V, N> *> parents;
+    std::vector<size_t> indices;
     BTreeNode<K, V, N> * curr_node = this->root;
+    size_t index = curr_node->keys.lower_bound(key);
+
+    while (index == curr_node->keys.size() || !(curr_node->keys[index] == key)) {
+        if (curr_node->is_leaf()) {
+            return std::nullopt;
+        }
+
+        parents.push_back(curr_node);
+        indices.push_back(index);
+        curr_node = curr_node->child(index);
+        index = curr_node->keys.lower_bound(key);
+    }
+
+    std::optional<V> out = std::optional<V>(std::move(curr_node->vals[index]));
+    this->len--;
+
+    if (curr_node->is_leaf()) {
+        // No need to worry about children because this is a leaf node
+        curr_node->del(index);
+        this->rebalance(parents, indices, curr_node);
 
-    while (!curr_node->is_leaf()) {
-        size_t index = curr_node->items.lower_bound(key);
+        return out;
+    }
+
+    // Delete an internal key by replacing it with its predecessor or successor, which is always
+    // in a leaf. Take it from the side whose child next to the key can spare a key. That child is
+    // the leaf only when the key is just above the leaves, so higher up this is only a guess at
+    // which side needs less rebalancing.
+    BTreeNode<K, V, N> * key_node = curr_node;
+    parents.push_back(key_node);
 
-        if (index == curr_node->items.size()) {
+    if (key_node->child(index)->keys.size() > MIN_KEYS || key_node->child(index + 1)->keys.size() <= MIN_KEYS) {
+        indices.push_back(index);
+        curr_node = key_node->child(index);
+
+        while (!curr_node->is_leaf()) {
             parents.push_back(curr_node);
-            curr_node = curr_node->post;
-        } else if (curr_node->items[index].key == key) {
-            // TODO: Delete an internal key
-        } else {
+            indices.push_back(curr_node->keys.size());
+            curr_node = curr_node->child(curr_node->keys.size());
+        }
+
+        const size_t last = curr_node->keys.size() - 1;
+        key_node->keys[index] = std::move(curr_node->keys[last]);
+        key_node->vals[index] = curr_node->del(last);
+    } else {
+        indices.push_back(index + 1);
+        curr_node = key_node->child(index + 1);
+
+        while (!curr_node->is_leaf()) {
             parents.push_back(curr_node);
-            curr_node = curr_node->items[index].pre;
+            indices.push_back(0);
+            curr_node = curr_node->child(0);
         }
+
+        key_node->keys[index] = std::move(curr_node->keys[0]);
+        key_node->vals[index] = curr_node->del(0);
     }
 
-    size_t index = curr_node->items.lower_bound(key);
+    this->rebalance(parents, indices, curr_node);
 
-    if (index < curr_node->items.size() && curr_node->items[index].key == key) {
-        // Delete a leaf key
-        if (curr_node->items.size() > 1) {
-            BTreeEntry<K, V, N> entry = curr_node->items.del(index);
-            this->len--;
+    return out;
+}
 
-            // No need to worry about pre and post pointers because this is a leaf node
-            return std::optional<V>(entry.val);
-        } // TODO: Handle this case
+template <data::Ord K, typename V, const size_t N>
+void data::BTree<K, V, N>::rebalance(std::vector<BTreeNode<K, V, N> *> &parents, std::vector<size_t> &indices, BTreeNode<K, V, N> * node) {
+    while (node != this->root && node->keys.size() < MIN_KEYS) {
+        BTreeNode<K, V, N> * parent = parents.back();
+        const size_t index = indices.back();
+        parents.pop_back();
+        indices.pop_back();
+
+        if (index > 0 && parent->child(index - 1)->keys.size() > MIN_KEYS) {
+            this->borrow_left(parent, index);
+            return;
+        }
+
+        if (index < parent->keys.size() && parent->child(index + 1)->keys.size() > MIN_KEYS) {
+            this->borrow_right(parent, index);
+            return;
+        }
+
+        if (index > 0) {
+            this->merge_children(parent, index - 1);
+        } else {
+            this->merge_children(parent, index);
+        }
+
+        node = parent;
     }
 
-    return std::nullopt;
+    if (!this->root->keys.size() && !this->root->is_leaf()) {
+        // The root lost its last key in a merge, so its only child becomes the new root
+        BTreeNode<K, V, N> * old_root = this->root;
+        this->root = old_root->child(0);
+        old_root->child(0) = nullptr;
+
+        delete old_root;
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BTree<K, V, N>::borrow_left(BTreeNode<K, V, N> * parent, size_t index) {
+    BTreeNode<K, V, N> * left = parent->child(index - 1);
+    BTreeNode<K, V, N> * node = parent->child(index);
+    const size_t last = left->keys.size() - 1;
+    BTreeNode<K, V, N> * moved_child = left->child(last + 1);
+
+    // The separator goes to the front of `node`, and the last child of `left` goes before it
+    node->put(parent->keys[index - 1], std::move(parent->vals[index - 1]), node->child(0));
+    node->child(0) = moved_child;
+
+    parent->keys[index - 1] = std::move(left->keys[last]);
+    parent->vals[index - 1] = left->del(last);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BTree<K, V, N>::borrow_right(BTreeNode<K, V, N> * parent, size_t index) {
+    BTreeNode<K, V, N> * node = parent->child(index);
+    BTreeNode<K, V, N> * right = parent->child(index + 1);
+
+    node->put(parent->keys[index], std::move(parent->vals[index]), right->child(0));
+
+    // Removing the first key of `right` drops the child after it, so shift that child into first place
+    right->child(0) = right->child(1);
+    parent->keys[index] = std::move(right->keys[0]);
+    parent->vals[index] = right->del(0);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::BTree<K, V, N>::merge_children(BTreeNode<K, V, N> * parent, size_t index) {
+    BTreeNode<K, V, N> * left = parent->child(index);
+    BTreeNode<K, V, N> * right = parent->child(index + 1);
+    const K sep_key = parent->keys[index];
+
+    // Removing the separator also unlinks `right`, which was the child after it
+    left->put(sep_key, parent->del(index), right->child(0));
+
+    for (size_t i = 0; i < right->keys.size(); i++) {
+        left->put(right->keys[i], std::move(right->vals[i]), right->child(i + 1));
+    }
+
+    // Every child of `right` has moved, so deleting it doesn't touch them
+    for (size_t i = 0; i <= right->keys.size(); i++) {
+        right->child(i) = nullptr;
+    }
+
+    delete right;
 }
 
 template <data::Ord K, typename V, const size_t N>
@@ -254,6 +543,107 @@ size_t data::BTree<K, V, N>::size() const {
     return this->len;
 }
 
+template <data::Ord K, typename V, const size_t N>
+typename data::BTree<K, V, N>::iterator data::BTree<K, V, N>::begin() {
+    iterator out(this->root, {});
+    out.push_first(this->root);
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BTree<K, V, N>::iterator data::BTree<K, V, N>::end() {
+    return iterator(this->root, {});
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BTree<K, V, N>::const_iterator data::BTree<K, V, N>::begin() const {
+    const_iterator out(this->root, {});
+    out.push_first(this->root);
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BTree<K, V, N>::const_iterator data::BTree<K, V, N>::end() const {
+    return const_iterator(this->root, {});
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BTree<K, V, N>::iterator data::BTree<K, V, N>::lower_bound(const K &key) {
+    iterator out(this->root, {});
+    out.seek(key, true);
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BTree<K, V, N>::const_iterator data::BTree<K, V, N>::lower_bound(const K &key) const {
+    const_iterator out(this->root, {});
+    out.seek(key, true);
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BTree<K, V, N>::iterator data::BTree<K, V, N>::upper_bound(const K &key) {
+    iterator out(this->root, {});
+    out.seek(key, false);
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::BTree<K, V, N>::const_iterator data::BTree<K, V, N>::upper_bound(const K &key) const {
+    const_iterator out(this->root, {});
+    out.seek(key, false);
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::pair<typename data::BTree<K, V, N>::iterator, typename data::BTree<K, V, N>::iterator> data::BTree<K, V, N>::equal_range(const K &key) {
+    iterator first = this->lower_bound(key);
+    iterator last = first;
+
+    // Keys are unique, so the range holds at most one entry
+    if (last != this->end() && (*last).first == key) {
+        ++last;
+    }
+
+    return { first, last };
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::pair<typename data::BTree<K, V, N>::const_iterator, typename data::BTree<K, V, N>::const_iterator> data::BTree<K, V, N>::equal_range(const K &key) const {
+    const_iterator first = this->lower_bound(key);
+    const_iterator last = first;
+
+    if (last != this->end() && (*last).first == key) {
+        ++last;
+    }
+
+    return { first, last };
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::BTreeRange<K, V, N> data::BTree<K, V, N>::range(const K &lo, const K &hi) {
+    if (!(lo < hi)) {
+        return BTreeRange<K, V, N>(this->end(), this->end());
+    }
+
+    return BTreeRange<K, V, N>(this->lower_bound(lo), this->lower_bound(hi));
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::BTreeRange<K, V, N, true> data::BTree<K, V, N>::range(const K &lo, const K &hi) const {
+    if (!(lo < hi)) {
+        return BTreeRange<K, V, N, true>(this->end(), this->end());
+    }
+
+    return BTreeRange<K, V, N, true>(this->lower_bound(lo), this->lower_bound(hi));
+}
+
 #ifdef TEST
 
 template <data::Ord K, typename V, const size_t N>
@@ -280,15 +670,13 @@ void data::BTree<K, V, N>::debug_print() const {
         i++;
 
         if (!node->is_leaf()) {
-            for (size_t i = 0; i < node->items.size(); i++) {
-                nodes.push(node->items[i].pre);
+            for (size_t i = 0; i <= node->keys.size(); i++) {
+                nodes.push(node->child(i));
             }
-
-            nodes.push(node->post);
         }
 
         if (node == last) {
-            last = node->post;
+            last = node->child(node->keys.size());
             nodes.push(nullptr);
         }
     }
@@ -303,20 +691,14 @@ template <data::Ord K, typename V, const size_t N>
 DepthResult data::BTree<K, V, N>::depth(BTreeNode<K, V, N> * node) const {
     std::vector<DepthResult> depths;
 
-    for (size_t i = 0; i < node->items.size(); i++) {
-        if (node->items[i].pre) {
-            depths.push_back(this->depth(node->items[i].pre));
+    for (size_t i = 0; i <= node->keys.size(); i++) {
+        if (node->child(i)) {
+            depths.push_back(this->depth(node->child(i)));
         } else {
             depths.push_back(DepthResult(0, true));
         }
     }
 
-    if (node->post) {
-        depths.push_back(this->depth(node->post));
-    } else {
-        depths.push_back(DepthResult(0, true));
-    }
-
     if (!depths.size()) {
         return DepthResult(0, true);
     }
@@ -341,6 +723,11 @@ DepthResult data::BTree<K, V, N>::depth(BTreeNode<K, V, N> * node) const {
     return DepthResult(max_depth + 1, is_only_depth);
 }
 
+template <data::Ord K, typename V, const size_t N>
+size_t data::BTree<K, V, N>::height() const {
+    return this->depth(this->root).max_depth;
+}
+
 template <data::Ord K, typename V, const size_t N>
 bool data::BTree<K, V, N>::is_full_enough() const {
     return this->is_full_enough(this->root);
@@ -348,30 +735,26 @@ bool data::BTree<K, V, N>::is_full_enough() const {
 
 template <data::Ord K, typename V, const size_t N>
 bool data::BTree<K, V, N>::is_full_enough(BTreeNode<K, V, N> * node) const {
-    if (node->is_leaf() || node == this->root) {
-        return true;
+    if (node->is_leaf()) {
+        return node == this->root || node->keys.size() >= MIN_KEYS;
     }
 
-    for (size_t i = 0; i < node->items.size(); i++) {
-        if (!node->items[i].pre) {
+    for (size_t i = 0; i <= node->keys.size(); i++) {
+        if (!node->child(i)) {
             return false;
         }
     }
 
-    if (!node->post) {
-        return false;
-    }
-
-    if ((node->items.size() + 1) < (N / 2)) {
+    if (node != this->root && (node->keys.size() < MIN_KEYS || (node->keys.size() + 1) < (N / 2))) {
         return false;
     }
 
     bool acc = true;
-    for (size_t i = 0; i < node->items.size(); i++) {
-        acc = acc && this->is_full_enough(node->items[i].pre);
+    for (size_t i = 0; i <= node->keys.size(); i++) {
+        acc = acc && this->is_full_enough(node->child(i));
     }
 
-    return acc && this->is_full_enough(node->post);
+    return acc;
 }
 
 #endif
@@ -0,0 +1,334 @@
+#ifndef INCLUDE_STRUCTURES_BTREE_ITERATOR_H
+#define INCLUDE_STRUCTURES_BTREE_ITERATOR_H
+
+#include <iterator>
+#include <ranges>
+#include <stdlib.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "btree_node.h"
+#include "../traits.h"
+
+namespace data {
+    template <Ord K, typename V, const size_t N>
+    class BTree;
+
+    /**
+     * Bidirectional iterator over the entries of a BTree in key order. The "value type" is a pair where
+     * the first item is a reference to the key and the second item is a pointer to the value.
+     *
+     * The iterator keeps the path from the root to the current entry. Each frame holds a node and an
+     * index: in the last frame the index is the current entry, and in the frames above it the index is
+     * the child that the path goes through, which is also the entry that comes after that child's
+     * subtree. Moving to a neighboring entry only pushes or pops the frames that change, so a full scan
+     * visits each node a constant number of times and advancing is amortized O(1).
+     *
+     * Any change to the tree invalidates its iterators. If IS_CONST is true, the iterator only gives out
+     * const pointers to values.
+     */
+    template <Ord K, typename V, const size_t N, const bool IS_CONST = false>
+    class BTreeIterator {
+        private:
+            typedef std::conditional_t<IS_CONST, const BTreeNode<K, V, N>, BTreeNode<K, V, N>> node_type;
+
+            struct Frame {
+                node_type * node;
+                size_t index;
+
+                bool operator==(const Frame &other) const = default;
+            };
+
+            node_type * root;
+            // Empty at the end
+            std::vector<Frame> path;
+
+            /**
+             * Follows the first children down from `node` and stops at its first entry.
+             */
+            void push_first(node_type * node);
+
+            /**
+             * Follows the last children down from `node` and stops at its last entry.
+             */
+            void push_last(node_type * node);
+
+            /**
+             * Pops the current frame and any frames whose subtrees have been fully visited, stopping at
+             * the next entry in an ancestor.
+             */
+            void climb();
+
+            /**
+             * Moves to the first entry whose key is not less than `key`, or greater than `key` if
+             * `inclusive` is false.
+             */
+            void seek(const K &key, bool inclusive);
+
+            constexpr void check_impl();
+
+            BTreeIterator(node_type * root, std::vector<Frame> path);
+
+            friend class BTree<K, V, N>;
+
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = std::pair<const K &, std::conditional_t<IS_CONST, const V, V> *>;
+            using difference_type = ptrdiff_t;
+            using pointer = value_type *;
+            using reference = value_type&;
+
+            /**
+             * Creates an end iterator that doesn't belong to any tree. It can't be decremented.
+             */
+            BTreeIterator();
+
+            BTreeIterator<K, V, N, IS_CONST>& operator++();
+
+            BTreeIterator<K, V, N, IS_CONST> operator++(int);
+
+            /**
+             * Moves to the previous entry. Decrementing an end iterator moves to the last entry.
+             */
+            BTreeIterator<K, V, N, IS_CONST>& operator--();
+
+            BTreeIterator<K, V, N, IS_CONST> operator--(int);
+
+            bool operator==(const BTreeIterator<K, V, N, IS_CONST> &it) const;
+
+            bool operator!=(const BTreeIterator<K, V, N, IS_CONST> &it) const;
+
+            value_type operator*() const;
+    };
+
+    /**
+     * A range of BTree entries between two iterators. It can be passed to std::ranges algorithms and
+     * views, including std::views::reverse.
+     */
+    template <Ord K, typename V, const size_t N, const bool IS_CONST = false>
+    class BTreeRange : public std::ranges::view_interface<BTreeRange<K, V, N, IS_CONST>> {
+        private:
+            BTreeIterator<K, V, N, IS_CONST> first;
+            BTreeIterator<K, V, N, IS_CONST> last;
+
+        public:
+            BTreeRange();
+
+            BTreeRange(BTreeIterator<K, V, N, IS_CONST> first, BTreeIterator<K, V, N, IS_CONST> last);
+
+            BTreeIterator<K, V, N, IS_CONST> begin() const;
+
+            BTreeIterator<K, V, N, IS_CONST> end() const;
+    };
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+constexpr void data::BTreeIterator<K, V, N, IS_CONST>::check_impl() {
+    // See RadixTrieIterator::check_impl
+    static_assert(std::bidirectional_iterator<BTreeIterator<K, V, N, IS_CONST>>);
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeIterator<K, V, N, IS_CONST>::BTreeIterator() : root(nullptr), path() {
+    this->check_impl();
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeIterator<K, V, N, IS_CONST>::BTreeIterator(node_type * root, std::vector<Frame> path) : root(root), path(std::move(path)) {
+    this->check_impl();
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+void data::BTreeIterator<K, V, N, IS_CONST>::push_first(node_type * node) {
+    while (!node->is_leaf()) {
+        this->path.push_back({ node, 0 });
+        node = node->child(0);
+    }
+
+    if (node->keys.size()) {
+        this->path.push_back({ node, 0 });
+    } else {
+        // Only an empty root can be an empty leaf
+        this->path.clear();
+    }
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+void data::BTreeIterator<K, V, N, IS_CONST>::push_last(node_type * node) {
+    while (!node->is_leaf()) {
+        this->path.push_back({ node, node->keys.size() });
+        node = node->child(node->keys.size());
+    }
+
+    if (node->keys.size()) {
+        this->path.push_back({ node, node->keys.size() - 1 });
+    } else {
+        this->path.clear();
+    }
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+void data::BTreeIterator<K, V, N, IS_CONST>::climb() {
+    this->path.pop_back();
+
+    while (this->path.size() && this->path.back().index == this->path.back().node->keys.size()) {
+        this->path.pop_back();
+    }
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+void data::BTreeIterator<K, V, N, IS_CONST>::seek(const K &key, bool inclusive) {
+    node_type * node = this->root;
+
+    while (true) {
+        size_t index = node->keys.lower_bound(key);
+
+        if (index < node->keys.size() && node->keys[index] == key) {
+            this->path.push_back({ node, index });
+
+            if (!inclusive) {
+                ++(*this);
+            }
+
+            return;
+        }
+
+        this->path.push_back({ node, index });
+
+        if (node->is_leaf()) {
+            break;
+        }
+
+        node = node->child(index);
+    }
+
+    if (this->path.back().index == this->path.back().node->keys.size()) {
+        // Every key in the leaf is smaller, so the next entry is in an ancestor
+        this->climb();
+    }
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeIterator<K, V, N, IS_CONST>& data::BTreeIterator<K, V, N, IS_CONST>::operator++() {
+    if (!this->path.size()) {
+        return *this;
+    }
+
+    Frame &frame = this->path.back();
+
+    if (!frame.node->is_leaf()) {
+        // The next entry is the first one in the subtree after the current entry
+        frame.index++;
+        this->push_first(frame.node->child(frame.index));
+
+        return *this;
+    }
+
+    if (frame.index + 1 < frame.node->keys.size()) {
+        frame.index++;
+
+        return *this;
+    }
+
+    this->climb();
+
+    return *this;
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeIterator<K, V, N, IS_CONST> data::BTreeIterator<K, V, N, IS_CONST>::operator++(int) {
+    BTreeIterator<K, V, N, IS_CONST> it = BTreeIterator<K, V, N, IS_CONST>(*this);
+
+    ++(*this);
+
+    return it;
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeIterator<K, V, N, IS_CONST>& data::BTreeIterator<K, V, N, IS_CONST>::operator--() {
+    if (!this->path.size()) {
+        if (this->root) {
+            this->push_last(this->root);
+        }
+
+        return *this;
+    }
+
+    Frame &frame = this->path.back();
+
+    if (!frame.node->is_leaf()) {
+        // The previous entry is the last one in the subtree before the current entry
+        this->push_last(frame.node->child(frame.index));
+
+        return *this;
+    }
+
+    if (frame.index > 0) {
+        frame.index--;
+
+        return *this;
+    }
+
+    // Climb until the path came down through a child that has an entry before it
+    this->path.pop_back();
+
+    while (this->path.size() && this->path.back().index == 0) {
+        this->path.pop_back();
+    }
+
+    if (this->path.size()) {
+        this->path.back().index--;
+    }
+
+    return *this;
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeIterator<K, V, N, IS_CONST> data::BTreeIterator<K, V, N, IS_CONST>::operator--(int) {
+    BTreeIterator<K, V, N, IS_CONST> it = BTreeIterator<K, V, N, IS_CONST>(*this);
+
+    --(*this);
+
+    return it;
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+bool data::BTreeIterator<K, V, N, IS_CONST>::operator==(const BTreeIterator<K, V, N, IS_CONST> &it) const {
+    if (!this->path.size() || !it.path.size()) {
+        return this->path.size() == it.path.size();
+    }
+
+    return this->path.back() == it.path.back();
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+bool data::BTreeIterator<K, V, N, IS_CONST>::operator!=(const BTreeIterator<K, V, N, IS_CONST> &it) const {
+    return !(*this == it);
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+typename data::BTreeIterator<K, V, N, IS_CONST>::value_type data::BTreeIterator<K, V, N, IS_CONST>::operator*() const {
+    const Frame &frame = this->path.back();
+
+    return value_type(frame.node->keys[frame.index], &frame.node->vals[frame.index]);
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeRange<K, V, N, IS_CONST>::BTreeRange() : first(), last() {}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeRange<K, V, N, IS_CONST>::BTreeRange(BTreeIterator<K, V, N, IS_CONST> first, BTreeIterator<K, V, N, IS_CONST> last)
+    : first(first), last(last) {}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeIterator<K, V, N, IS_CONST> data::BTreeRange<K, V, N, IS_CONST>::begin() const {
+    return this->first;
+}
+
+template <data::Ord K, typename V, const size_t N, const bool IS_CONST>
+data::BTreeIterator<K, V, N, IS_CONST> data::BTreeRange<K, V, N, IS_CONST>::end() const {
+    return this->last;
+}
+
+#endif
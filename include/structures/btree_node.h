@@ -1,8 +1,8 @@
 #ifndef INCLUDE_STRUCTURES_BTREE_NODES_H
 #define INCLUDE_STRUCTURES_BTREE_NODES_H
 
-#include <optional>
 #include <stdlib.h>
+#include <utility>
 
 #include "sorted_array.h"
 #include "../traits.h"
@@ -12,38 +12,22 @@
 #endif
 
 namespace data {
-    template <PartialOrd K, typename V, const size_t N>
-    struct BTreeNode;
-
-    template <PartialOrd K, typename V, const size_t N>
-    struct BTreeEntry {
-        K key;
-        V val;
-        BTreeNode<K, V, N> * pre;
-
-        BTreeEntry();
-
-        BTreeEntry(const BTreeEntry<K, V, N> &other);
-
-        BTreeEntry(BTreeEntry<K, V, N> &&other);
-
-        void operator=(const BTreeEntry<K, V, N> &other);
-
-        void operator=(BTreeEntry<K, V, N> &&other);
-
-        ~BTreeEntry();
-
-        BTreeEntry(K key);
-
-        BTreeEntry(K key, V val, BTreeNode<K, V, N> * pre = nullptr);
-
-        bool operator<(const BTreeEntry<K, V, N> &other) const;
-    };
-
+    /**
+     * A btree node. Keys, child pointers and values are kept in separate arrays, each starting on its
+     * own cache line, so searching a node only touches the lines that hold keys. The value and child
+     * that go with a key are only loaded once the search has found it.
+     *
+     * `vals[i]` is the value for `keys[i]`. `children[i]` holds the keys less than `keys[i]`, and
+     * `children[keys.size()]` holds the keys greater than the last key. Every child is null in a leaf.
+     * A node owns its children, and copying a node copies its whole subtree.
+     */
     template <PartialOrd K, typename V, const size_t N>
     struct BTreeNode {
-        SortedArray<BTreeEntry<K, V, N>, N> items;
-        BTreeNode<K, V, N> * post;
+        static constexpr size_t CACHE_LINE = 64;
+
+        alignas(CACHE_LINE) SortedArray<K, N> keys;
+        alignas(CACHE_LINE) BTreeNode<K, V, N> * children[N + 1];
+        alignas(CACHE_LINE) V vals[N];
 
         BTreeNode();
 
@@ -61,6 +45,30 @@ namespace data {
 
         bool is_overflowed() const;
 
+        /**
+         * Returns the child at the given position.
+         */
+        BTreeNode<K, V, N> *& child(size_t i);
+
+        BTreeNode<K, V, N> * child(size_t i) const;
+
+        /**
+         * Inserts a key that is not in the node along with the child to its right, and returns the
+         * key's index.
+         */
+        size_t put(const K &key, V val, BTreeNode<K, V, N> * right = nullptr);
+
+        /**
+         * Removes the key at the given index and returns its value. The child to the right of the key
+         * is dropped from the node without being deleted, so the caller must take it first.
+         */
+        V del(size_t index);
+
+        /**
+         * Deletes the children and empties the node.
+         */
+        void clear();
+
 #ifdef TEST
         void debug_print() const;
 #endif
@@ -68,122 +76,141 @@ namespace data {
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeEntry<K, V, N>::BTreeEntry() : key(K()), val(V()), pre(nullptr) {}
+data::BTreeNode<K, V, N>::BTreeNode() : keys(), children{} {}
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeEntry<K, V, N>::BTreeEntry(const BTreeEntry<K, V, N> &other) : key(K(other.key)), val(V(other.val)), pre(nullptr) {
-    if (other.pre) {
-        this->pre = new BTreeNode<K, V, N>(*other.pre);
+data::BTreeNode<K, V, N>::BTreeNode(const BTreeNode<K, V, N> &other) : keys(other.keys), children{} {
+    for (size_t i = 0; i < other.keys.size(); i++) {
+        this->vals[i] = other.vals[i];
     }
-}
 
-template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeEntry<K, V, N>::BTreeEntry(BTreeEntry<K, V, N> &&other) : key(K(std::move(other.key))), val(V(std::move(other.val))), pre(other.pre) {
-    other.pre = nullptr;
+    if (!other.is_leaf()) {
+        for (size_t i = 0; i <= other.keys.size(); i++) {
+            this->children[i] = new BTreeNode<K, V, N>(*other.children[i]);
+        }
+    }
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-void data::BTreeEntry<K, V, N>::operator=(const data::BTreeEntry<K, V, N> &other) {
-    if (this->pre) {
-        delete this->pre;
+data::BTreeNode<K, V, N>::BTreeNode(BTreeNode<K, V, N> &&other) : keys(std::move(other.keys)), children{} {
+    for (size_t i = 0; i < this->keys.size(); i++) {
+        this->vals[i] = std::move(other.vals[i]);
     }
 
-    if (other.pre) {
-        this->pre = new BTreeNode<K, V, N>(*other.pre);
-    } else {
-        this->pre = nullptr;
+    for (size_t i = 0; i <= N; i++) {
+        this->children[i] = other.children[i];
+        other.children[i] = nullptr;
     }
 
-    this->key = K(other.key);
-    this->val = V(other.val);
+    other.keys.truncate(0);
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-void data::BTreeEntry<K, V, N>::operator=(data::BTreeEntry<K, V, N> &&other) {
-    if (this->pre) {
-        delete this->pre;
+void data::BTreeNode<K, V, N>::operator=(const BTreeNode<K, V, N> &other) {
+    if (this == &other) {
+        return;
     }
 
-    this->pre = other.pre;
-    other.pre = nullptr;
+    this->clear();
+    this->keys = other.keys;
+
+    for (size_t i = 0; i < other.keys.size(); i++) {
+        this->vals[i] = other.vals[i];
+    }
 
-    this->key = other.key;
-    this->val = other.val;
+    if (!other.is_leaf()) {
+        for (size_t i = 0; i <= other.keys.size(); i++) {
+            this->children[i] = new BTreeNode<K, V, N>(*other.children[i]);
+        }
+    }
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeEntry<K, V, N>::BTreeEntry(K key) : key(key), val(V()), pre(nullptr) {}
+void data::BTreeNode<K, V, N>::operator=(BTreeNode<K, V, N> &&other) {
+    if (this == &other) {
+        return;
+    }
+
+    this->clear();
+    this->keys = std::move(other.keys);
+
+    for (size_t i = 0; i < this->keys.size(); i++) {
+        this->vals[i] = std::move(other.vals[i]);
+    }
+
+    for (size_t i = 0; i <= N; i++) {
+        this->children[i] = other.children[i];
+        other.children[i] = nullptr;
+    }
+
+    other.keys.truncate(0);
+}
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeEntry<K, V, N>::BTreeEntry(K key, V val, BTreeNode<K, V, N> * pre) : key(key), val(val), pre(pre) {}
+data::BTreeNode<K, V, N>::~BTreeNode() {
+    this->clear();
+}
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeEntry<K, V, N>::~BTreeEntry() {
-    if (this->pre) {
-        delete this->pre;
+void data::BTreeNode<K, V, N>::clear() {
+    for (size_t i = 0; i <= N; i++) {
+        if (this->children[i]) {
+            delete this->children[i];
+            this->children[i] = nullptr;
+        }
     }
+
+    this->keys.truncate(0);
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-bool data::BTreeEntry<K, V, N>::operator<(const BTreeEntry<K, V, N> &other) const {
-    return this->key < other.key;
+bool data::BTreeNode<K, V, N>::is_leaf() const {
+    return !this->children[0];
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeNode<K, V, N>::BTreeNode() : items({}), post(nullptr) {}
+bool data::BTreeNode<K, V, N>::is_overflowed() const {
+    return this->keys.size() == N;
+}
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeNode<K, V, N>::BTreeNode(const BTreeNode<K, V, N> &other) : items(SortedArray<BTreeEntry<K, V, N>, N>(other.items)) {
-    if (other.post) {
-        this->post = new BTreeNode<K, V, N>(*other.post);
-    } else {
-        this->post = nullptr;
-    }
+data::BTreeNode<K, V, N> *& data::BTreeNode<K, V, N>::child(size_t i) {
+    return this->children[i];
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeNode<K, V, N>::BTreeNode(BTreeNode<K, V, N> &&other) : items(other.items), post(other.post) {
-    other.post = nullptr;
+data::BTreeNode<K, V, N> * data::BTreeNode<K, V, N>::child(size_t i) const {
+    return this->children[i];
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-void data::BTreeNode<K, V, N>::operator=(const BTreeNode<K, V, N> &other) {
-    if (this->post) {
-        delete this->post;
-    }
+size_t data::BTreeNode<K, V, N>::put(const K &key, V val, BTreeNode<K, V, N> * right) {
+    const size_t index = this->keys.put(key);
 
-    if (other.post) {
-        this->post = new BTreeNode<K, V, N>(*other.post);
-    } else {
-        this->post = nullptr;
+    for (size_t i = this->keys.size() - 1; i > index; i--) {
+        this->vals[i] = std::move(this->vals[i - 1]);
+        this->children[i + 1] = this->children[i];
     }
 
-    this->items = SortedArray<BTreeEntry<K, V, N>, N>(other.items);
-}
+    this->vals[index] = std::move(val);
+    this->children[index + 1] = right;
 
-template <data::PartialOrd K, typename V, const size_t N>
-void data::BTreeNode<K, V, N>::operator=(BTreeNode<K, V, N> &&other) {
-    this->post = other.post;
-    this->items = std::move(other.items);
-
-    other.post = nullptr;
+    return index;
 }
 
 template <data::PartialOrd K, typename V, const size_t N>
-data::BTreeNode<K, V, N>::~BTreeNode() {
-    if (this->post) {
-        delete this->post;
+V data::BTreeNode<K, V, N>::del(size_t index) {
+    V out = std::move(this->vals[index]);
+
+    for (size_t i = index; i + 1 < this->keys.size(); i++) {
+        this->vals[i] = std::move(this->vals[i + 1]);
+        this->children[i + 1] = this->children[i + 2];
     }
-}
 
-template <data::PartialOrd K, typename V, const size_t N>
-bool data::BTreeNode<K, V, N>::is_leaf() const {
-    return !this->post;
-}
+    this->children[this->keys.size()] = nullptr;
+    this->keys.del(index);
 
-template <data::PartialOrd K, typename V, const size_t N>
-bool data::BTreeNode<K, V, N>::is_overflowed() const {
-    return this->items.size() == N;
+    return out;
 }
 
 #ifdef TEST
@@ -191,8 +218,8 @@ bool data::BTreeNode<K, V, N>::is_overflowed() const {
 template <data::PartialOrd K, typename V, const size_t N>
 void data::BTreeNode<K, V, N>::debug_print() const {
     printf("|");
-    for (size_t i = 0; i < this->items.size(); i++) {
-        printf("%d|", this->items[i].key);
+    for (size_t i = 0; i < this->keys.size(); i++) {
+        printf("%d|", this->keys[i]);
     }
 }
 
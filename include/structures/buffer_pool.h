@@ -0,0 +1,399 @@
+#ifndef INCLUDE_STRUCTURES_BUFFER_POOL_H
+#define INCLUDE_STRUCTURES_BUFFER_POOL_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace data {
+    /**
+     * A fixed number of page-sized frames that cache the pages of a file. Pages are pinned while they
+     * are in use, and a pinned page stays in its frame. When a page that isn't cached is pinned, a frame
+     * is chosen with the CLOCK policy: the clock hand sweeps over the frames, giving every recently used
+     * frame a second chance, and takes the first unpinned frame that hasn't been used since the last
+     * sweep. Dirty pages are written back when their frame is taken or when the pool is flushed.
+     *
+     * Pages are read and written with pread and pwrite. Pages past the end of the file read as zeros,
+     * so a new page can be used by pinning it.
+     */
+    class BufferPool {
+        public:
+            typedef uint64_t page_id;
+
+            /**
+             * A pin on a page. The page stays in its frame until the pin is dropped, and its memory can be
+             * used directly until then. Call `mark_dirty` after changing the page so that it is written back.
+             */
+            class Page {
+                friend class BufferPool;
+
+                private:
+                    BufferPool * pool;
+                    size_t frame;
+
+                    Page(BufferPool * pool, size_t frame);
+
+                public:
+                    /**
+                     * Creates an empty pin that does not hold any page.
+                     */
+                    Page();
+
+                    Page(const Page &other) = delete;
+
+                    Page(Page &&other);
+
+                    ~Page();
+
+                    void operator=(const Page &other) = delete;
+
+                    void operator=(Page &&other);
+
+                    page_id id() const;
+
+                    unsigned char * data() const;
+
+                    template <typename T>
+                    T * as() const;
+
+                    void mark_dirty() const;
+
+                    /**
+                     * Drops the pin early.
+                     */
+                    void reset();
+            };
+
+        private:
+            struct Frame {
+                page_id id;
+                uint32_t pins;
+                bool used;
+                bool dirty;
+                // Set when the frame is pinned, and cleared when the clock hand passes over it
+                bool referenced;
+            };
+
+            int fd;
+            size_t page_size_;
+            unsigned char * memory;
+            std::vector<Frame> frames;
+            std::unordered_map<page_id, size_t> table;
+            size_t hand;
+            size_t hits_;
+            size_t misses_;
+
+            unsigned char * frame_data(size_t frame) const;
+
+            /**
+             * Returns an unpinned frame for a new page, writing back the page that was in it if it was
+             * dirty. Throws if every frame is pinned.
+             */
+            size_t evict();
+
+            void read_page(size_t frame);
+
+            void write_page(size_t frame);
+
+            void unpin(size_t frame);
+
+            void release();
+
+        public:
+            /**
+             * Opens or creates the file at the given path with room for `frame_count` pages in memory.
+             * The page size must be a multiple of 4096.
+             */
+            BufferPool(const char * path, size_t page_size, size_t frame_count);
+
+            // Pins point back to the pool, so it can't be moved
+            BufferPool(const BufferPool &other) = delete;
+
+            BufferPool(BufferPool &&other) = delete;
+
+            /**
+             * Writes back dirty pages, but does not sync the file. Call `flush` first to find out about
+             * errors.
+             */
+            ~BufferPool();
+
+            void operator=(const BufferPool &other) = delete;
+
+            void operator=(BufferPool &&other) = delete;
+
+            /**
+             * Pins the given page, reading it from the file if it isn't in a frame.
+             */
+            Page pin(page_id id);
+
+            /**
+             * Writes back every dirty page and syncs the file.
+             */
+            void flush();
+
+            size_t page_size() const;
+
+            size_t frame_count() const;
+
+            /**
+             * Returns the number of pins that found their page in a frame.
+             */
+            size_t hits() const;
+
+            /**
+             * Returns the number of pins that had to read their page from the file.
+             */
+            size_t misses() const;
+    };
+}
+
+inline data::BufferPool::Page::Page() : pool(nullptr), frame(0) {}
+
+inline data::BufferPool::Page::Page(BufferPool * pool, size_t frame) : pool(pool), frame(frame) {}
+
+inline data::BufferPool::Page::Page(Page &&other) : pool(other.pool), frame(other.frame) {
+    other.pool = nullptr;
+}
+
+inline data::BufferPool::Page::~Page() {
+    this->reset();
+}
+
+inline void data::BufferPool::Page::operator=(Page &&other) {
+    if (this == &other) {
+        return;
+    }
+
+    this->reset();
+    this->pool = other.pool;
+    this->frame = other.frame;
+    other.pool = nullptr;
+}
+
+inline data::BufferPool::page_id data::BufferPool::Page::id() const {
+    return this->pool->frames[this->frame].id;
+}
+
+inline unsigned char * data::BufferPool::Page::data() const {
+    return this->pool->frame_data(this->frame);
+}
+
+template <typename T>
+T * data::BufferPool::Page::as() const {
+    return reinterpret_cast<T *>(this->data());
+}
+
+inline void data::BufferPool::Page::mark_dirty() const {
+    this->pool->frames[this->frame].dirty = true;
+}
+
+inline void data::BufferPool::Page::reset() {
+    if (this->pool) {
+        this->pool->unpin(this->frame);
+        this->pool = nullptr;
+    }
+}
+
+inline data::BufferPool::BufferPool(const char * path, size_t page_size, size_t frame_count)
+    : fd(-1), page_size_(page_size), memory(nullptr), frames(frame_count, Frame{ 0, 0, false, false, false }), table(), hand(0), hits_(0), misses_(0)
+{
+    if (!page_size || page_size % 4096 || !frame_count) {
+        throw "Buffer pool pages must be a multiple of 4096 bytes, and there must be at least one frame";
+    }
+
+    this->fd = open(path, O_RDWR | O_CREAT, 0644);
+
+    if (this->fd < 0) {
+        throw "Could not open buffer pool file";
+    }
+
+    this->memory = static_cast<unsigned char *>(aligned_alloc(4096, page_size * frame_count));
+
+    if (!this->memory) {
+        close(this->fd);
+        throw "Could not allocate buffer pool frames";
+    }
+}
+
+inline data::BufferPool::~BufferPool() {
+    this->release();
+}
+
+inline void data::BufferPool::release() {
+    if (this->fd < 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < this->frames.size(); i++) {
+        if (this->frames[i].used && this->frames[i].dirty) {
+            try {
+                this->write_page(i);
+            } catch (const char * err) {
+                // Nothing can be done about it here
+            }
+        }
+    }
+
+    close(this->fd);
+    free(this->memory);
+    this->fd = -1;
+    this->memory = nullptr;
+}
+
+inline unsigned char * data::BufferPool::frame_data(size_t frame) const {
+    return this->memory + frame * this->page_size_;
+}
+
+inline size_t data::BufferPool::evict() {
+    // Two full sweeps clear every reference bit, so a frame is found by then if any is unpinned
+    for (size_t steps = 0; steps < 2 * this->frames.size(); steps++) {
+        const size_t i = this->hand;
+        Frame &frame = this->frames[i];
+
+        this->hand = (this->hand + 1) % this->frames.size();
+
+        if (!frame.used) {
+            return i;
+        }
+
+        if (frame.pins) {
+            continue;
+        }
+
+        if (frame.referenced) {
+            frame.referenced = false;
+            continue;
+        }
+
+        if (frame.dirty) {
+            this->write_page(i);
+        }
+
+        this->table.erase(frame.id);
+        frame.used = false;
+
+        return i;
+    }
+
+    throw "Every buffer pool frame is pinned";
+}
+
+inline void data::BufferPool::read_page(size_t frame) {
+    unsigned char * buf = this->frame_data(frame);
+    const off_t offset = (off_t) (this->frames[frame].id * this->page_size_);
+    size_t done = 0;
+
+    while (done < this->page_size_) {
+        const ssize_t n = pread(this->fd, buf + done, this->page_size_ - done, offset + done);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw "Could not read page";
+        }
+
+        if (!n) {
+            // Past the end of the file
+            memset(buf + done, 0, this->page_size_ - done);
+            break;
+        }
+
+        done += n;
+    }
+}
+
+inline void data::BufferPool::write_page(size_t frame) {
+    const unsigned char * buf = this->frame_data(frame);
+    const off_t offset = (off_t) (this->frames[frame].id * this->page_size_);
+    size_t done = 0;
+
+    while (done < this->page_size_) {
+        const ssize_t n = pwrite(this->fd, buf + done, this->page_size_ - done, offset + done);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw "Could not write page";
+        }
+
+        done += n;
+    }
+
+    this->frames[frame].dirty = false;
+}
+
+inline void data::BufferPool::unpin(size_t frame) {
+    this->frames[frame].pins--;
+}
+
+inline data::BufferPool::Page data::BufferPool::pin(page_id id) {
+    auto it = this->table.find(id);
+
+    if (it != std::end(this->table)) {
+        Frame &frame = this->frames[it->second];
+
+        frame.pins++;
+        frame.referenced = true;
+        this->hits_++;
+
+        return Page(this, it->second);
+    }
+
+    const size_t i = this->evict();
+    Frame &frame = this->frames[i];
+
+    frame = Frame{ id, 0, true, false, true };
+    this->table[id] = i;
+    this->misses_++;
+
+    try {
+        this->read_page(i);
+    } catch (const char * err) {
+        this->table.erase(id);
+        frame.used = false;
+        throw;
+    }
+
+    frame.pins++;
+
+    return Page(this, i);
+}
+
+inline void data::BufferPool::flush() {
+    for (size_t i = 0; i < this->frames.size(); i++) {
+        if (this->frames[i].used && this->frames[i].dirty) {
+            this->write_page(i);
+        }
+    }
+
+    if (fsync(this->fd)) {
+        throw "Could not sync buffer pool file";
+    }
+}
+
+inline size_t data::BufferPool::page_size() const {
+    return this->page_size_;
+}
+
+inline size_t data::BufferPool::frame_count() const {
+    return this->frames.size();
+}
+
+inline size_t data::BufferPool::hits() const {
+    return this->hits_;
+}
+
+inline size_t data::BufferPool::misses() const {
+    return this->misses_;
+}
+
+#endif
@@ -0,0 +1,460 @@
+#ifndef INCLUDE_STRUCTURES_CONCURRENT_BTREE_H
+#define INCLUDE_STRUCTURES_CONCURRENT_BTREE_H
+
+#include <atomic>
+#include <optional>
+#include <stdint.h>
+#include <stdlib.h>
+#include <type_traits>
+
+#include "../traits.h"
+#include "concurrent_btree_node.h"
+
+namespace data {
+    /**
+     * A B+ tree that can be used by many threads at once, using optimistic lock coupling. Every node
+     * has a version lock (see OptimisticLock). Readers never write to shared memory: they check each
+     * node's version after reading it and start over from the root if a writer got in the way. Writers
+     * descend the same way and only lock the nodes they change, which is a leaf, or a node that is being
+     * split and its parent.
+     *
+     * Full nodes are split on the way down, so a split never needs to go further up than the parent of
+     * the split node, and a writer never holds more than two locks. Unlike BTree, this means a split
+     * doesn't need the whole path in a `parents` vector.
+     *
+     * Deleted keys are removed from their leaves, but nodes are never merged or freed while the tree is
+     * alive. A reader can still be looking at a node after it leaves the tree, so freeing nodes would
+     * need some form of deferred reclamation, and underfull leaves are cheap by comparison.
+     *
+     * Readers can see keys and values while they are being written, and only find out afterward when
+     * validation fails, so both must be trivially copyable.
+     */
+    template <Ord K, typename V, const size_t N>
+    class ConcurrentBTree {
+        private:
+            static_assert(N >= 4, "A concurrent btree node needs room for at least 4 keys");
+            static_assert(
+                std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+                "Keys and values in a concurrent btree must be trivially copyable"
+            );
+
+            typedef BPlusTreeNode<K, V, N> node_type;
+            typedef ConcurrentBTreeLeaf<K, V, N> leaf_type;
+            typedef ConcurrentBTreeInternal<K, V, N> internal_type;
+
+            std::atomic<node_type *> root;
+            std::atomic<size_t> len;
+
+            static OptimisticLock& lock_of(node_type * node);
+
+            /**
+             * Returns the index of the child of `node` that can hold the given key.
+             */
+            static size_t child_index(const internal_type * node, const K &key);
+
+            static void destroy(node_type * node);
+
+            /**
+             * Finds the leaf that can hold the given key, along with its parent and the versions of both.
+             * If `stop_at_full` is true, stops early at the first full internal node instead. Returns false
+             * if the operation has to start over.
+             */
+            bool descend(const K &key, bool stop_at_full, node_type *& node, uint64_t &version, internal_type *& parent, uint64_t &parent_version) const;
+
+            /**
+             * Splits a full node, as long as neither it nor its parent changed since their versions were
+             * read. If the node is the root, a new root is added above it.
+             */
+            void split(internal_type * parent, uint64_t parent_version, node_type * node, uint64_t version);
+
+            bool try_get(const K &key, std::optional<V> &out) const;
+
+            bool try_put(const K &key, const V &val, std::optional<V> &out);
+
+            bool try_del(const K &key, std::optional<V> &out);
+
+        public:
+            ConcurrentBTree();
+
+            ConcurrentBTree(const ConcurrentBTree<K, V, N> &other) = delete;
+
+            ~ConcurrentBTree();
+
+            void operator=(const ConcurrentBTree<K, V, N> &other) = delete;
+
+            std::optional<V> get(const K &key) const;
+
+            /**
+             * Inserts a KV pair into the tree. If the key already exists, returns the previous value and
+             * replaces it.
+             */
+            std::optional<V> put(const K &key, const V val);
+
+            std::optional<V> del(const K &key);
+
+            size_t size() const;
+
+#ifdef TEST
+            /**
+             * Returns the number of levels in the tree. Not safe to call while other threads are writing.
+             */
+            size_t height() const;
+
+            /**
+             * Checks that every leaf is at the same depth and that every key is within the bounds set by
+             * the separators above it. Not safe to call while other threads are writing.
+             */
+            bool is_valid() const;
+
+            bool is_valid(const node_type * node, size_t depth, size_t leaf_depth, const K * lo, const K * hi) const;
+#endif
+    };
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::ConcurrentBTree<K, V, N>::ConcurrentBTree() : root(new leaf_type()), len(0) {}
+
+template <data::Ord K, typename V, const size_t N>
+data::ConcurrentBTree<K, V, N>::~ConcurrentBTree() {
+    destroy(this->root.load());
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::OptimisticLock& data::ConcurrentBTree<K, V, N>::lock_of(node_type * node) {
+    if (node->leaf) {
+        return static_cast<leaf_type *>(node)->lock;
+    }
+
+    return static_cast<internal_type *>(node)->lock;
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::ConcurrentBTree<K, V, N>::child_index(const internal_type * node, const K &key) {
+    const size_t index = node->keys.lower_bound(key);
+
+    if (index < node->keys.size() && node->keys[index] == key) {
+        return index + 1;
+    }
+
+    return index;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::ConcurrentBTree<K, V, N>::destroy(node_type * node) {
+    if (node->leaf) {
+        delete static_cast<leaf_type *>(node);
+        return;
+    }
+
+    internal_type * internal = static_cast<internal_type *>(node);
+
+    for (size_t i = 0; i <= internal->keys.size(); i++) {
+        destroy(internal->children[i]);
+    }
+
+    delete internal;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::ConcurrentBTree<K, V, N>::descend(const K &key, bool stop_at_full, node_type *& node, uint64_t &version, internal_type *& parent, uint64_t &parent_version) const {
+    node = this->root.load(std::memory_order_acquire);
+
+    // If the root was split after it was loaded, it won't be the root anymore
+    if (!lock_of(node).read_lock(version) || node != this->root.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    parent = nullptr;
+    parent_version = 0;
+
+    while (!node->leaf) {
+        internal_type * internal = static_cast<internal_type *>(node);
+
+        if (stop_at_full && internal->keys.size() == N - 1) {
+            return true;
+        }
+
+        // The node's version was read after following the parent's pointer to it. If the parent has
+        // changed since then, the node might have been split and no longer hold the key.
+        if (parent && !parent->lock.validate(parent_version)) {
+            return false;
+        }
+
+        node_type * child = internal->children[child_index(internal, key)];
+
+        // The child pointer can't be followed until it is known to be consistent
+        if (!internal->lock.validate(version)) {
+            return false;
+        }
+
+        parent = internal;
+        parent_version = version;
+        node = child;
+
+        if (!lock_of(node).read_lock(version)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::ConcurrentBTree<K, V, N>::split(internal_type * parent, uint64_t parent_version, node_type * node, uint64_t version) {
+    if (parent && !parent->lock.upgrade(parent_version)) {
+        return;
+    }
+
+    if (!lock_of(node).upgrade(version)) {
+        if (parent) {
+            parent->lock.write_unlock();
+        }
+
+        return;
+    }
+
+    node_type * right;
+    K sep;
+    const size_t mid = node->keys.size() / 2;
+
+    if (node->leaf) {
+        leaf_type * left_leaf = static_cast<leaf_type *>(node);
+        leaf_type * right_leaf = new leaf_type();
+
+        for (size_t i = mid; i < left_leaf->keys.size(); i++) {
+            right_leaf->vals[i - mid] = left_leaf->vals[i];
+        }
+
+        right_leaf->keys = left_leaf->keys.split_off(mid);
+        sep = right_leaf->keys[0];
+        right = right_leaf;
+    } else {
+        internal_type * left_internal = static_cast<internal_type *>(node);
+        internal_type * right_internal = new internal_type();
+
+        right_internal->keys = left_internal->keys.split_off(mid + 1);
+
+        for (size_t i = 0; i <= right_internal->keys.size(); i++) {
+            right_internal->children[i] = left_internal->children[mid + 1 + i];
+            left_internal->children[mid + 1 + i] = nullptr;
+        }
+
+        sep = left_internal->keys.del(mid);
+        right = right_internal;
+    }
+
+    // The new node is only reachable once the parent is unlocked, so it is complete by the time any
+    // reader gets to it
+    if (parent) {
+        parent->put(sep, right);
+        parent->lock.write_unlock();
+    } else {
+        internal_type * new_root = new internal_type();
+        new_root->keys.put(sep);
+        new_root->children[0] = node;
+        new_root->children[1] = right;
+
+        this->root.store(new_root, std::memory_order_release);
+    }
+
+    lock_of(node).write_unlock();
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::ConcurrentBTree<K, V, N>::try_get(const K &key, std::optional<V> &out) const {
+    node_type * node;
+    internal_type * parent;
+    uint64_t version;
+    uint64_t parent_version;
+
+    if (!this->descend(key, false, node, version, parent, parent_version)) {
+        return false;
+    }
+
+    leaf_type * leaf = static_cast<leaf_type *>(node);
+
+    const size_t index = leaf->keys.lower_bound(key);
+    std::optional<V> found = std::nullopt;
+
+    if (index < leaf->keys.size() && leaf->keys[index] == key) {
+        found = leaf->vals[index];
+    }
+
+    if (!leaf->lock.validate(version) || (parent && !parent->lock.validate(parent_version))) {
+        return false;
+    }
+
+    out = found;
+
+    return true;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::ConcurrentBTree<K, V, N>::try_put(const K &key, const V &val, std::optional<V> &out) {
+    node_type * node;
+    internal_type * parent;
+    uint64_t version;
+    uint64_t parent_version;
+
+    if (!this->descend(key, true, node, version, parent, parent_version)) {
+        return false;
+    }
+
+    // Either a full internal node on the way down or a full leaf. The split can fail if another
+    // writer got there first, but the operation starts over either way.
+    if (!node->leaf || node->keys.size() == N - 1) {
+        this->split(parent, parent_version, node, version);
+        return false;
+    }
+
+    leaf_type * leaf = static_cast<leaf_type *>(node);
+
+    if (!leaf->lock.upgrade(version)) {
+        return false;
+    }
+
+    if (parent && !parent->lock.validate(parent_version)) {
+        leaf->lock.write_unlock();
+        return false;
+    }
+
+    const size_t index = leaf->keys.lower_bound(key);
+
+    if (index < leaf->keys.size() && leaf->keys[index] == key) {
+        out = leaf->vals[index];
+        leaf->vals[index] = val;
+    } else {
+        out = std::nullopt;
+        leaf->put(key, val);
+        this->len.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    leaf->lock.write_unlock();
+
+    return true;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::ConcurrentBTree<K, V, N>::try_del(const K &key, std::optional<V> &out) {
+    node_type * node;
+    internal_type * parent;
+    uint64_t version;
+    uint64_t parent_version;
+
+    if (!this->descend(key, false, node, version, parent, parent_version)) {
+        return false;
+    }
+
+    leaf_type * leaf = static_cast<leaf_type *>(node);
+
+    if (!leaf->lock.upgrade(version)) {
+        return false;
+    }
+
+    if (parent && !parent->lock.validate(parent_version)) {
+        leaf->lock.write_unlock();
+        return false;
+    }
+
+    const size_t index = leaf->keys.lower_bound(key);
+
+    if (index < leaf->keys.size() && leaf->keys[index] == key) {
+        out = leaf->del(index);
+        this->len.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        out = std::nullopt;
+    }
+
+    leaf->lock.write_unlock();
+
+    return true;
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::ConcurrentBTree<K, V, N>::get(const K &key) const {
+    std::optional<V> out;
+
+    while (!this->try_get(key, out)) {}
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::ConcurrentBTree<K, V, N>::put(const K &key, const V val) {
+    std::optional<V> out;
+
+    while (!this->try_put(key, val, out)) {}
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::ConcurrentBTree<K, V, N>::del(const K &key) {
+    std::optional<V> out;
+
+    while (!this->try_del(key, out)) {}
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::ConcurrentBTree<K, V, N>::size() const {
+    return this->len.load(std::memory_order_relaxed);
+}
+
+#ifdef TEST
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::ConcurrentBTree<K, V, N>::height() const {
+    size_t out = 1;
+    const node_type * node = this->root.load();
+
+    while (!node->leaf) {
+        node = static_cast<const internal_type *>(node)->children[0];
+        out++;
+    }
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::ConcurrentBTree<K, V, N>::is_valid() const {
+    return this->is_valid(this->root.load(), 1, this->height(), nullptr, nullptr);
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::ConcurrentBTree<K, V, N>::is_valid(const node_type * node, size_t depth, size_t leaf_depth, const K * lo, const K * hi) const {
+    if (node->keys.size() >= N) {
+        return false;
+    }
+
+    for (size_t i = 0; i < node->keys.size(); i++) {
+        if ((lo && node->keys[i] < *lo) || (hi && !(node->keys[i] < *hi))) {
+            return false;
+        }
+
+        if (i > 0 && !(node->keys[i - 1] < node->keys[i])) {
+            return false;
+        }
+    }
+
+    if (node->leaf) {
+        return depth == leaf_depth;
+    }
+
+    const internal_type * internal = static_cast<const internal_type *>(node);
+
+    for (size_t i = 0; i <= internal->keys.size(); i++) {
+        const K * child_lo = i > 0 ? &internal->keys[i - 1] : lo;
+        const K * child_hi = i < internal->keys.size() ? &internal->keys[i] : hi;
+
+        if (!internal->children[i] || !this->is_valid(internal->children[i], depth + 1, leaf_depth, child_lo, child_hi)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif
+#endif
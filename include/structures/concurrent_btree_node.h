@@ -0,0 +1,29 @@
+#ifndef INCLUDE_STRUCTURES_CONCURRENT_BTREE_NODE_H
+#define INCLUDE_STRUCTURES_CONCURRENT_BTREE_NODE_H
+
+#include <stdlib.h>
+
+#include "bplus_tree_node.h"
+#include "optimistic_lock.h"
+#include "../traits.h"
+
+namespace data {
+    /**
+     * A B+ tree leaf with a version lock. The leaf links of BPlusTreeLeaf are not maintained.
+     */
+    template <PartialOrd K, typename V, const size_t N>
+    struct ConcurrentBTreeLeaf : BPlusTreeLeaf<K, V, N> {
+        OptimisticLock lock;
+    };
+
+    /**
+     * A B+ tree internal node with a version lock. Its children are ConcurrentBTreeLeaf or
+     * ConcurrentBTreeInternal nodes, depending on their `leaf` flag.
+     */
+    template <PartialOrd K, typename V, const size_t N>
+    struct ConcurrentBTreeInternal : BPlusTreeInternal<K, V, N> {
+        OptimisticLock lock;
+    };
+}
+
+#endif
@@ -0,0 +1,491 @@
+#ifndef INCLUDE_STRUCTURES_CONCURRENT_RADIX_TRIE_H
+#define INCLUDE_STRUCTURES_CONCURRENT_RADIX_TRIE_H
+
+#include <atomic>
+#include <deque>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "concurrent_radix_trie_node.h"
+#include "epoch.h"
+
+namespace data {
+    /**
+     * A radix trie for workloads with many readers and few writers. Readers don't take locks or write to
+     * shared memory apart from pinning an epoch, so reads scale with the number of cores.
+     *
+     * Nodes are immutable. A writer builds replacements for the nodes on the path to the key it changes,
+     * sharing every subtree that it doesn't touch, and publishes the new version with a single atomic
+     * swap of the root. Readers see either the old version or the new one, never a mix. Replaced nodes
+     * are freed once no reader that could have seen them is still pinned (see EpochManager).
+     *
+     * Writers are serialized with a mutex, so a write costs a lock and a copy of each node on its path.
+     * This is meant for tries that are read far more often than they are written.
+     *
+     * "K" is the type of a symbol in the key. K should implement operator< and operator==.
+     * "V" is the type of the value, and must be copyable.
+     */
+    template <typename K, typename V>
+    class ConcurrentRadixTrie {
+        private:
+            typedef ConcurrentRadixTrieNode<K, V> node_type;
+
+            // The root has an empty key and no value. Its children are the top nodes of the trie.
+            std::atomic<const node_type *> root;
+            std::atomic<size_t> len;
+            mutable EpochManager epochs;
+            std::mutex write_lock;
+            // Nodes that were replaced, along with the epoch they were replaced in. Only used by writers.
+            std::deque<std::pair<uint64_t, std::vector<const node_type *>>> retired;
+
+            static size_t common_prefix_len(std::span<const K> node_key, std::span<const K> key);
+
+            static void destroy_rec(const node_type * node);
+
+            /**
+             * Returns a copy of `node` where the given key (which is relative to `node`) has the given
+             * value. `node` and any other replaced nodes are added to `replaced`.
+             */
+            static const node_type * insert(const node_type * node, std::span<const K> key, const V &value, std::optional<V> &old_val, std::vector<const node_type *> &replaced);
+
+            /**
+             * Returns a copy of `node` without the given key (which is relative to `node`), or `node`
+             * itself if the key is not in its subtree.
+             */
+            static const node_type * remove(const node_type * node, std::span<const K> key, std::optional<V> &old_val, std::vector<const node_type *> &replaced);
+
+            /**
+             * Takes a node that hasn't been published yet and returns what should replace it: nothing if
+             * it has no value and no children, or the merge of it and its child if it has no value and
+             * exactly one child.
+             */
+            static const node_type * compact(const node_type * node, std::vector<const node_type *> &replaced);
+
+            /**
+             * Publishes a new root and retires the replaced nodes. Frees any retired nodes that readers
+             * can no longer reach.
+             */
+            void publish(const node_type * new_root, std::vector<const node_type *> replaced);
+
+        public:
+            ConcurrentRadixTrie();
+
+            ConcurrentRadixTrie(const ConcurrentRadixTrie<K, V> &other) = delete;
+
+            ~ConcurrentRadixTrie();
+
+            void operator=(const ConcurrentRadixTrie<K, V> &other) = delete;
+
+            /**
+             * Inserts or replaces the value for a key and returns the old value, if there was one.
+             * Readers see the new value once this returns.
+             */
+            std::optional<V> put(std::span<const K> key, const V value);
+
+            std::optional<V> put(const std::vector<K> &key, const V value);
+
+            std::optional<V> put(std::initializer_list<K> key, const V value);
+
+            template <typename Traits>
+            std::optional<V> put(std::basic_string_view<K, Traits> key, const V value);
+
+            /**
+             * Returns the value for a key. Can be called from any number of threads at once, including
+             * while another thread is writing, and never blocks.
+             */
+            std::optional<V> get(std::span<const K> key) const;
+
+            std::optional<V> get(const std::vector<K> &key) const;
+
+            std::optional<V> get(std::initializer_list<K> key) const;
+
+            template <typename Traits>
+            std::optional<V> get(std::basic_string_view<K, Traits> key) const;
+
+            std::optional<V> del(std::span<const K> key);
+
+            std::optional<V> del(const std::vector<K> &key);
+
+            std::optional<V> del(std::initializer_list<K> key);
+
+            template <typename Traits>
+            std::optional<V> del(std::basic_string_view<K, Traits> key);
+
+            size_t size() const;
+
+#ifdef TEST
+            /**
+             * Checks that children are sorted and that every node other than the root has a value or at
+             * least two children. Not safe to call while other threads are writing.
+             */
+            bool is_compact() const;
+
+            bool is_compact(const node_type * node) const;
+
+            /**
+             * Returns the number of replaced nodes that haven't been freed yet.
+             */
+            size_t retired_count() const;
+#endif
+    };
+}
+
+template <typename K, typename V>
+data::ConcurrentRadixTrie<K, V>::ConcurrentRadixTrie() : root(node_type::create({}, std::nullopt, {})), len(0), epochs(), write_lock(), retired() {}
+
+template <typename K, typename V>
+data::ConcurrentRadixTrie<K, V>::~ConcurrentRadixTrie() {
+    destroy_rec(this->root.load());
+
+    for (auto &[epoch, nodes] : this->retired) {
+        for (const node_type * node : nodes) {
+            node_type::destroy(node);
+        }
+    }
+}
+
+template <typename K, typename V>
+size_t data::ConcurrentRadixTrie<K, V>::common_prefix_len(std::span<const K> node_key, std::span<const K> key) {
+    size_t i = 0;
+
+    while (i < node_key.size() && i < key.size() && node_key[i] == key[i]) {
+        i++;
+    }
+
+    return i;
+}
+
+template <typename K, typename V>
+void data::ConcurrentRadixTrie<K, V>::destroy_rec(const node_type * node) {
+    for (const node_type * child : node->children()) {
+        destroy_rec(child);
+    }
+
+    node_type::destroy(node);
+}
+
+template <typename K, typename V>
+const typename data::ConcurrentRadixTrie<K, V>::node_type * data::ConcurrentRadixTrie<K, V>::insert(
+    const node_type * node,
+    std::span<const K> key,
+    const V &value,
+    std::optional<V> &old_val,
+    std::vector<const node_type *> &replaced
+) {
+    const size_t index = node->lower_bound(key[0]);
+    std::vector<const node_type *> children(std::begin(node->children()), std::end(node->children()));
+
+    replaced.push_back(node);
+
+    if (index == children.size() || !(node->firsts()[index] == key[0])) {
+        children.insert(std::begin(children) + index, node_type::create(key, value, {}));
+
+        return node_type::create(node->key(), node->val, children);
+    }
+
+    const node_type * child = children[index];
+    const std::span<const K> child_key = child->key();
+    const size_t prefix_len = common_prefix_len(child_key, key);
+
+    if (prefix_len == child_key.size() && prefix_len == key.size()) {
+        old_val = child->val;
+        replaced.push_back(child);
+        children[index] = node_type::create(child_key, value, child->children());
+    } else if (prefix_len == child_key.size()) {
+        children[index] = insert(child, key.subspan(prefix_len), value, old_val, replaced);
+    } else {
+        // The key diverges from (or ends in) the middle of the child; split it
+        const node_type * suffix = node_type::create(child_key.subspan(prefix_len), child->val, child->children());
+
+        replaced.push_back(child);
+
+        if (prefix_len == key.size()) {
+            children[index] = node_type::create(key, value, std::span(&suffix, 1));
+        } else {
+            const node_type * leaf = node_type::create(key.subspan(prefix_len), value, {});
+            const node_type * split_children[2] = { leaf, suffix };
+
+            if (suffix->key()[0] < leaf->key()[0]) {
+                std::swap(split_children[0], split_children[1]);
+            }
+
+            children[index] = node_type::create(key.subspan(0, prefix_len), std::nullopt, split_children);
+        }
+    }
+
+    return node_type::create(node->key(), node->val, children);
+}
+
+template <typename K, typename V>
+const typename data::ConcurrentRadixTrie<K, V>::node_type * data::ConcurrentRadixTrie<K, V>::remove(
+    const node_type * node,
+    std::span<const K> key,
+    std::optional<V> &old_val,
+    std::vector<const node_type *> &replaced
+) {
+    const node_type * child = node->find(key[0]);
+
+    if (!child) {
+        return node;
+    }
+
+    const std::span<const K> child_key = child->key();
+    const size_t prefix_len = common_prefix_len(child_key, key);
+    const node_type * new_child;
+
+    if (prefix_len < child_key.size()) {
+        return node;
+    }
+
+    if (prefix_len == key.size()) {
+        if (!child->val.has_value()) {
+            return node;
+        }
+
+        old_val = child->val;
+        replaced.push_back(child);
+        new_child = node_type::create(child_key, std::nullopt, child->children());
+    } else {
+        new_child = remove(child, key.subspan(prefix_len), old_val, replaced);
+
+        if (new_child == child) {
+            return node;
+        }
+    }
+
+    const size_t index = node->lower_bound(key[0]);
+    std::vector<const node_type *> children(std::begin(node->children()), std::end(node->children()));
+    new_child = compact(new_child, replaced);
+
+    if (new_child) {
+        children[index] = new_child;
+    } else {
+        children.erase(std::begin(children) + index);
+    }
+
+    replaced.push_back(node);
+
+    return node_type::create(node->key(), node->val, children);
+}
+
+template <typename K, typename V>
+const typename data::ConcurrentRadixTrie<K, V>::node_type * data::ConcurrentRadixTrie<K, V>::compact(const node_type * node, std::vector<const node_type *> &replaced) {
+    if (node->val.has_value() || node->children().size() > 1) {
+        return node;
+    }
+
+    if (!node->children().size()) {
+        // Never published, so it can be freed right away
+        node_type::destroy(node);
+
+        return nullptr;
+    }
+
+    const node_type * only_child = node->children()[0];
+    std::vector<K> key(std::begin(node->key()), std::end(node->key()));
+    key.insert(std::end(key), std::begin(only_child->key()), std::end(only_child->key()));
+
+    const node_type * merged = node_type::create(key, only_child->val, only_child->children());
+
+    replaced.push_back(only_child);
+    node_type::destroy(node);
+
+    return merged;
+}
+
+template <typename K, typename V>
+void data::ConcurrentRadixTrie<K, V>::publish(const node_type * new_root, std::vector<const node_type *> replaced) {
+    this->root.store(new_root);
+
+    // Readers pinned in this epoch or earlier might still be looking at the replaced nodes
+    this->retired.push_back({ this->epochs.advance(), std::move(replaced) });
+
+    while (this->retired.size() && this->epochs.is_safe(this->retired.front().first)) {
+        for (const node_type * node : this->retired.front().second) {
+            node_type::destroy(node);
+        }
+
+        this->retired.pop_front();
+    }
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::put(std::span<const K> key, const V value) {
+    if (!key.size()) {
+        throw "Radix trie keys cannot be empty";
+    }
+
+    std::lock_guard<std::mutex> guard(this->write_lock);
+    std::vector<const node_type *> replaced;
+    std::optional<V> out = std::nullopt;
+    const node_type * new_root = insert(this->root.load(), key, value, out, replaced);
+
+    if (!out.has_value()) {
+        this->len++;
+    }
+
+    this->publish(new_root, std::move(replaced));
+
+    return out;
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::put(const std::vector<K> &key, const V value) {
+    return this->put(std::span<const K>(key), value);
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::put(std::initializer_list<K> key, const V value) {
+    return this->put(std::span<const K>(key.begin(), key.size()), value);
+}
+
+template <typename K, typename V>
+template <typename Traits>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::put(std::basic_string_view<K, Traits> key, const V value) {
+    return this->put(std::span<const K>(key.data(), key.size()), value);
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::get(std::span<const K> key) const {
+    EpochManager::Guard guard = this->epochs.pin();
+    const node_type * node = this->root.load();
+    size_t char_count = 0;
+
+    if (!key.size()) {
+        return std::nullopt;
+    }
+
+    while (char_count < key.size()) {
+        node = node->find(key[char_count]);
+
+        if (!node) {
+            return std::nullopt;
+        }
+
+        const std::span<const K> node_key = node->key();
+
+        if (common_prefix_len(node_key, key.subspan(char_count)) < node_key.size()) {
+            return std::nullopt;
+        }
+
+        char_count += node_key.size();
+    }
+
+    return node->val;
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::get(const std::vector<K> &key) const {
+    return this->get(std::span<const K>(key));
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::get(std::initializer_list<K> key) const {
+    return this->get(std::span<const K>(key.begin(), key.size()));
+}
+
+template <typename K, typename V>
+template <typename Traits>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::get(std::basic_string_view<K, Traits> key) const {
+    return this->get(std::span<const K>(key.data(), key.size()));
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::del(std::span<const K> key) {
+    if (!key.size()) {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> guard(this->write_lock);
+    std::vector<const node_type *> replaced;
+    std::optional<V> out = std::nullopt;
+    const node_type * old_root = this->root.load();
+    const node_type * new_root = remove(old_root, key, out, replaced);
+
+    if (new_root == old_root) {
+        return std::nullopt;
+    }
+
+    this->len--;
+    this->publish(new_root, std::move(replaced));
+
+    return out;
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::del(const std::vector<K> &key) {
+    return this->del(std::span<const K>(key));
+}
+
+template <typename K, typename V>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::del(std::initializer_list<K> key) {
+    return this->del(std::span<const K>(key.begin(), key.size()));
+}
+
+template <typename K, typename V>
+template <typename Traits>
+std::optional<V> data::ConcurrentRadixTrie<K, V>::del(std::basic_string_view<K, Traits> key) {
+    return this->del(std::span<const K>(key.data(), key.size()));
+}
+
+template <typename K, typename V>
+size_t data::ConcurrentRadixTrie<K, V>::size() const {
+    return this->len.load();
+}
+
+#ifdef TEST
+
+template <typename K, typename V>
+bool data::ConcurrentRadixTrie<K, V>::is_compact() const {
+    const node_type * root = this->root.load();
+
+    for (const node_type * child : root->children()) {
+        if (!this->is_compact(child)) {
+            return false;
+        }
+    }
+
+    return !root->key().size() && !root->val.has_value();
+}
+
+template <typename K, typename V>
+bool data::ConcurrentRadixTrie<K, V>::is_compact(const node_type * node) const {
+    const std::span<const node_type * const> children = node->children();
+
+    if (!node->key().size() || (!node->val.has_value() && children.size() < 2)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < children.size(); i++) {
+        if (i > 0 && !(children[i - 1]->key()[0] < children[i]->key()[0])) {
+            return false;
+        }
+
+        if (!(node->firsts()[i] == children[i]->key()[0]) || !this->is_compact(children[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename K, typename V>
+size_t data::ConcurrentRadixTrie<K, V>::retired_count() const {
+    size_t out = 0;
+
+    for (const auto &[epoch, nodes] : this->retired) {
+        out += nodes.size();
+    }
+
+    return out;
+}
+
+#endif
+#endif
@@ -0,0 +1,195 @@
+#ifndef INCLUDE_STRUCTURES_CONCURRENT_RADIX_TRIE_NODE_H
+#define INCLUDE_STRUCTURES_CONCURRENT_RADIX_TRIE_NODE_H
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdint.h>
+#include <stdlib.h>
+#include <utility>
+
+namespace data {
+    /**
+     * A node in a ConcurrentRadixTrie. Nodes never change once they are created, so readers can use
+     * them without synchronization. A writer that needs a different node builds a new one, and the old
+     * node stays intact until no reader can be looking at it.
+     *
+     * Since a node's size is fixed when it is created, its key fragment and children are stored in the
+     * same allocation as the node, right after it. Following a key only touches one block per level.
+     * The first symbol of each child's key is stored next to the child pointers, so that finding a child
+     * doesn't visit the other children.
+     *
+     * Unlike RadixTrieNode, a node has no parent pointer. A subtree that a write doesn't touch is
+     * shared by the old and new versions of the trie, so it has no single parent.
+     */
+    template <typename K, typename V>
+    class ConcurrentRadixTrieNode {
+        private:
+            uint32_t key_len;
+            uint32_t child_count;
+
+            static constexpr size_t align_up(size_t offset, size_t alignment);
+
+            static constexpr size_t children_offset();
+
+            static constexpr size_t key_offset(size_t child_count);
+
+            static constexpr size_t alloc_size(size_t key_len, size_t child_count);
+
+            static constexpr size_t alignment();
+
+            ConcurrentRadixTrieNode(std::optional<V> val, uint32_t key_len, uint32_t child_count);
+
+        public:
+            const std::optional<V> val;
+
+            /**
+             * Allocates a node. The children must be sorted by the first symbols of their keys.
+             */
+            static const ConcurrentRadixTrieNode<K, V> * create(std::span<const K> key, std::optional<V> val, std::span<const ConcurrentRadixTrieNode<K, V> * const> children);
+
+            /**
+             * Destroys and frees a node. Does not touch its children.
+             */
+            static void destroy(const ConcurrentRadixTrieNode<K, V> * node);
+
+            std::span<const K> key() const;
+
+            std::span<const ConcurrentRadixTrieNode<K, V> * const> children() const;
+
+            /**
+             * The first symbol of each child's key.
+             */
+            std::span<const K> firsts() const;
+
+            /**
+             * Returns the index of the first child whose key does not start before the given symbol.
+             */
+            size_t lower_bound(const K &first) const;
+
+            /**
+             * Returns the child whose key starts with the given symbol, or null if there is none.
+             */
+            const ConcurrentRadixTrieNode<K, V> * find(const K &first) const;
+    };
+}
+
+template <typename K, typename V>
+constexpr size_t data::ConcurrentRadixTrieNode<K, V>::align_up(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename K, typename V>
+constexpr size_t data::ConcurrentRadixTrieNode<K, V>::children_offset() {
+    return align_up(sizeof(ConcurrentRadixTrieNode<K, V>), alignof(ConcurrentRadixTrieNode<K, V> *));
+}
+
+template <typename K, typename V>
+constexpr size_t data::ConcurrentRadixTrieNode<K, V>::key_offset(size_t child_count) {
+    return align_up(children_offset() + child_count * sizeof(ConcurrentRadixTrieNode<K, V> *), alignof(K));
+}
+
+template <typename K, typename V>
+constexpr size_t data::ConcurrentRadixTrieNode<K, V>::alloc_size(size_t key_len, size_t child_count) {
+    // The key is followed by the first symbols of the children
+    return key_offset(child_count) + (key_len + child_count) * sizeof(K);
+}
+
+template <typename K, typename V>
+constexpr size_t data::ConcurrentRadixTrieNode<K, V>::alignment() {
+    return std::max({ alignof(ConcurrentRadixTrieNode<K, V>), alignof(ConcurrentRadixTrieNode<K, V> *), alignof(K) });
+}
+
+template <typename K, typename V>
+data::ConcurrentRadixTrieNode<K, V>::ConcurrentRadixTrieNode(std::optional<V> val, uint32_t key_len, uint32_t child_count)
+    : key_len(key_len), child_count(child_count), val(std::move(val)) {}
+
+template <typename K, typename V>
+const data::ConcurrentRadixTrieNode<K, V> * data::ConcurrentRadixTrieNode<K, V>::create(
+    std::span<const K> key,
+    std::optional<V> val,
+    std::span<const ConcurrentRadixTrieNode<K, V> * const> children
+) {
+    char * block = static_cast<char *>(::operator new(alloc_size(key.size(), children.size()), std::align_val_t(alignment())));
+    ConcurrentRadixTrieNode<K, V> * node = new (block) ConcurrentRadixTrieNode<K, V>(std::move(val), key.size(), children.size());
+
+    const ConcurrentRadixTrieNode<K, V> ** child_ptrs = reinterpret_cast<const ConcurrentRadixTrieNode<K, V> **>(block + children_offset());
+    K * symbols = reinterpret_cast<K *>(block + key_offset(children.size()));
+
+    std::uninitialized_copy(std::begin(children), std::end(children), child_ptrs);
+    std::uninitialized_copy(std::begin(key), std::end(key), symbols);
+
+    for (size_t i = 0; i < children.size(); i++) {
+        std::construct_at(symbols + key.size() + i, children[i]->key()[0]);
+    }
+
+    return node;
+}
+
+template <typename K, typename V>
+void data::ConcurrentRadixTrieNode<K, V>::destroy(const ConcurrentRadixTrieNode<K, V> * node) {
+    ConcurrentRadixTrieNode<K, V> * mut_node = const_cast<ConcurrentRadixTrieNode<K, V> *>(node);
+    K * symbols = reinterpret_cast<K *>(reinterpret_cast<char *>(mut_node) + key_offset(node->child_count));
+
+    std::destroy(symbols, symbols + node->key_len + node->child_count);
+    std::destroy_at(mut_node);
+
+    ::operator delete(mut_node, std::align_val_t(alignment()));
+}
+
+template <typename K, typename V>
+std::span<const K> data::ConcurrentRadixTrieNode<K, V>::key() const {
+    const K * symbols = reinterpret_cast<const K *>(reinterpret_cast<const char *>(this) + key_offset(this->child_count));
+
+    return std::span<const K>(symbols, this->key_len);
+}
+
+template <typename K, typename V>
+std::span<const data::ConcurrentRadixTrieNode<K, V> * const> data::ConcurrentRadixTrieNode<K, V>::children() const {
+    const ConcurrentRadixTrieNode<K, V> * const * child_ptrs = reinterpret_cast<const ConcurrentRadixTrieNode<K, V> * const *>(
+        reinterpret_cast<const char *>(this) + children_offset()
+    );
+
+    return std::span<const ConcurrentRadixTrieNode<K, V> * const>(child_ptrs, this->child_count);
+}
+
+template <typename K, typename V>
+std::span<const K> data::ConcurrentRadixTrieNode<K, V>::firsts() const {
+    const K * symbols = reinterpret_cast<const K *>(reinterpret_cast<const char *>(this) + key_offset(this->child_count));
+
+    return std::span<const K>(symbols + this->key_len, this->child_count);
+}
+
+template <typename K, typename V>
+size_t data::ConcurrentRadixTrieNode<K, V>::lower_bound(const K &first) const {
+    const std::span<const K> firsts = this->firsts();
+    size_t lo = 0;
+    size_t hi = firsts.size();
+
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+
+        if (firsts[mid] < first) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+template <typename K, typename V>
+const data::ConcurrentRadixTrieNode<K, V> * data::ConcurrentRadixTrieNode<K, V>::find(const K &first) const {
+    const size_t index = this->lower_bound(first);
+
+    if (index < this->child_count && this->firsts()[index] == first) {
+        return this->children()[index];
+    }
+
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,366 @@
+#ifndef INCLUDE_STRUCTURES_DOUBLE_ARRAY_TRIE_H
+#define INCLUDE_STRUCTURES_DOUBLE_ARRAY_TRIE_H
+
+#include <algorithm>
+#include <deque>
+#include <optional>
+#include <span>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace data {
+    /**
+     * A state in a double-array trie. `base` is where the state's transitions start, `check` is the
+     * state that transitions into this one, and `val` is the index of the state's value, or -1 if no key
+     * ends here. A free cell has a `check` of -1.
+     */
+    struct DoubleArrayCell {
+        int32_t base;
+        int32_t check;
+        int32_t val;
+    };
+
+    /**
+     * A read-only trie compiled into a double array (Aoe, 1989). Every state is a cell in one
+     * contiguous array, and the transition from state s on symbol c goes to cell `base[s] + c` if that
+     * cell's `check` is s. Following a key costs two loads per symbol, with no pointers to chase and no
+     * searching within a node.
+     *
+     * A double-array trie can't be changed once it's built. Build one with `Trie::freeze()` or
+     * `RadixTrie::freeze()`, or directly from a list of entries. Symbols must be byte-sized, since they
+     * are used as offsets into the array.
+     *
+     * "K" is the type of a symbol in the key.
+     * "V" is the type of the value.
+     */
+    template <typename K, typename V>
+    class DoubleArrayTrie {
+        static_assert(std::is_integral_v<K> && sizeof(K) == 1, "Double-array tries are only for byte-sized symbols");
+
+        private:
+            typedef std::pair<std::vector<K>, V> entry_type;
+
+            static constexpr int32_t FREE = -1;
+            static constexpr size_t ALPHABET = 256;
+
+            std::vector<DoubleArrayCell> cells;
+            std::vector<V> vals;
+
+            static size_t code(const K &symbol);
+
+            /**
+             * The free cells that are still worth trying as the first transition of a state, in a
+             * doubly linked list ordered by index. A cell that fails too many times is dropped from the
+             * list, but it stays free and can still be taken by a later transition.
+             */
+            struct free_list {
+                static constexpr size_t NONE = SIZE_MAX;
+                static constexpr uint8_t MAX_FAILS = 16;
+
+                size_t head = NONE;
+                size_t tail = NONE;
+                std::vector<size_t> next;
+                std::vector<size_t> prev;
+                std::vector<uint8_t> fails;
+                std::vector<bool> linked;
+
+                void push_back(size_t cell);
+
+                void unlink(size_t cell);
+            };
+
+            /**
+             * Grows the array so that it has at least `size` cells. The new cells are added to the
+             * free list.
+             */
+            void grow(free_list &free, size_t size);
+
+            /**
+             * Returns a base for which every one of the given codes lands on a free cell, trying the
+             * free cells in order as the landing spot for the first code. The array grows as needed.
+             */
+            size_t find_base(free_list &free, const std::vector<size_t> &codes);
+
+            void build(std::vector<entry_type> &entries);
+
+        public:
+            DoubleArrayTrie();
+
+            /**
+             * Builds a trie holding the given entries. If a key appears more than once, the last value
+             * for it wins.
+             */
+            DoubleArrayTrie(std::vector<entry_type> entries);
+
+            std::optional<V> get(std::span<const K> key) const;
+
+            std::optional<V> get(const K * const key, const size_t key_len) const;
+
+            template <typename Traits>
+            std::optional<V> get(std::basic_string_view<K, Traits> key) const;
+
+            /**
+             * Returns the number of keys.
+             */
+            size_t size() const;
+
+            /**
+             * Returns the number of cells in the double array, including free ones.
+             */
+            size_t cell_count() const;
+    };
+}
+
+template <typename K, typename V>
+size_t data::DoubleArrayTrie<K, V>::code(const K &symbol) {
+    return static_cast<uint8_t>(symbol);
+}
+
+template <typename K, typename V>
+data::DoubleArrayTrie<K, V>::DoubleArrayTrie() : cells{ DoubleArrayCell{ 0, 0, -1 } }, vals() {}
+
+template <typename K, typename V>
+data::DoubleArrayTrie<K, V>::DoubleArrayTrie(std::vector<entry_type> entries) : DoubleArrayTrie() {
+    this->build(entries);
+}
+
+template <typename K, typename V>
+void data::DoubleArrayTrie<K, V>::free_list::push_back(size_t cell) {
+    this->prev[cell] = this->tail;
+    this->next[cell] = NONE;
+
+    if (this->tail == NONE) {
+        this->head = cell;
+    } else {
+        this->next[this->tail] = cell;
+    }
+
+    this->tail = cell;
+    this->linked[cell] = true;
+}
+
+template <typename K, typename V>
+void data::DoubleArrayTrie<K, V>::free_list::unlink(size_t cell) {
+    if (!this->linked[cell]) {
+        return;
+    }
+
+    if (this->prev[cell] == NONE) {
+        this->head = this->next[cell];
+    } else {
+        this->next[this->prev[cell]] = this->next[cell];
+    }
+
+    if (this->next[cell] == NONE) {
+        this->tail = this->prev[cell];
+    } else {
+        this->prev[this->next[cell]] = this->prev[cell];
+    }
+
+    this->linked[cell] = false;
+}
+
+template <typename K, typename V>
+void data::DoubleArrayTrie<K, V>::grow(free_list &free, size_t size) {
+    const size_t old_size = this->cells.size();
+
+    if (size <= old_size) {
+        return;
+    }
+
+    this->cells.resize(size, DoubleArrayCell{ 0, FREE, -1 });
+    free.next.resize(size);
+    free.prev.resize(size);
+    free.fails.resize(size, 0);
+    free.linked.resize(size, false);
+
+    for (size_t i = old_size; i < size; i++) {
+        free.push_back(i);
+    }
+}
+
+template <typename K, typename V>
+size_t data::DoubleArrayTrie<K, V>::find_base(free_list &free, const std::vector<size_t> &codes) {
+    size_t cell = free.head;
+
+    while (true) {
+        if (cell == free_list::NONE) {
+            // Every candidate failed, so make room past the end of the array
+            cell = this->cells.size();
+            this->grow(free, cell + ALPHABET);
+        }
+
+        // The root is cell 0, and no transition may lead back into it
+        if (cell > codes[0]) {
+            const size_t base = cell - codes[0];
+            bool fits = true;
+
+            this->grow(free, base + ALPHABET);
+
+            for (size_t c : codes) {
+                if (this->cells[base + c].check != FREE) {
+                    fits = false;
+                    break;
+                }
+            }
+
+            if (fits) {
+                return base;
+            }
+
+            if (++free.fails[cell] >= free_list::MAX_FAILS) {
+                free.unlink(cell);
+            }
+        }
+
+        // Unlinking leaves the cell's own link alone, so this is still the next candidate
+        cell = free.next[cell];
+    }
+}
+
+template <typename K, typename V>
+void data::DoubleArrayTrie<K, V>::build(std::vector<entry_type> &entries) {
+    // Sort by code so that the keys sharing a prefix are contiguous, and keep the last of any duplicates
+    std::stable_sort(std::begin(entries), std::end(entries), [](const entry_type &a, const entry_type &b) {
+        return std::lexicographical_compare(
+            std::begin(a.first), std::end(a.first), std::begin(b.first), std::end(b.first),
+            [](const K &x, const K &y) { return code(x) < code(y); }
+        );
+    });
+
+    std::vector<entry_type> unique;
+
+    for (entry_type &entry : entries) {
+        if (unique.size() && unique.back().first == entry.first) {
+            unique.back().second = std::move(entry.second);
+        } else {
+            unique.push_back(std::move(entry));
+        }
+    }
+
+    struct pending {
+        size_t state;
+        size_t lo;
+        size_t hi;
+        size_t depth;
+    };
+
+    std::deque<pending> queue;
+    std::vector<size_t> codes;
+    std::vector<size_t> starts;
+    free_list free;
+
+    // The root is already in use
+    free.next.resize(1);
+    free.prev.resize(1);
+    free.fails.resize(1, 0);
+    free.linked.resize(1, false);
+
+    if (unique.size()) {
+        queue.push_back({ 0, 0, unique.size(), 0 });
+    }
+
+    // Breadth first, so that each level's states are placed near each other
+    while (queue.size()) {
+        const pending p = queue.front();
+        queue.pop_front();
+
+        size_t lo = p.lo;
+
+        // At most one key ends here, and it sorts before the longer keys that share its prefix
+        if (unique[lo].first.size() == p.depth) {
+            this->cells[p.state].val = (int32_t) this->vals.size();
+            this->vals.push_back(std::move(unique[lo].second));
+            lo++;
+        }
+
+        if (lo == p.hi) {
+            continue;
+        }
+
+        codes.clear();
+        starts.clear();
+
+        for (size_t i = lo; i < p.hi; i++) {
+            const size_t c = code(unique[i].first[p.depth]);
+
+            if (!codes.size() || codes.back() != c) {
+                codes.push_back(c);
+                starts.push_back(i);
+            }
+        }
+
+        starts.push_back(p.hi);
+
+        const size_t base = this->find_base(free, codes);
+
+        if (base + ALPHABET > (size_t) INT32_MAX) {
+            throw "Double-array trie is too big";
+        }
+
+        this->cells[p.state].base = (int32_t) base;
+
+        for (size_t i = 0; i < codes.size(); i++) {
+            this->cells[base + codes[i]].check = (int32_t) p.state;
+            free.unlink(base + codes[i]);
+            queue.push_back({ base + codes[i], starts[i], starts[i + 1], p.depth + 1 });
+        }
+    }
+
+    // Drop the free cells past the last state
+    while (this->cells.size() > 1 && this->cells.back().check == FREE) {
+        this->cells.pop_back();
+    }
+
+    this->cells.shrink_to_fit();
+}
+
+template <typename K, typename V>
+std::optional<V> data::DoubleArrayTrie<K, V>::get(std::span<const K> key) const {
+    const DoubleArrayCell * cells = this->cells.data();
+    const size_t len = this->cells.size();
+    size_t state = 0;
+
+    for (const K &symbol : key) {
+        const size_t next = (size_t) cells[state].base + code(symbol);
+
+        if (next >= len || cells[next].check != (int32_t) state) {
+            return std::nullopt;
+        }
+
+        state = next;
+    }
+
+    if (cells[state].val < 0) {
+        return std::nullopt;
+    }
+
+    return this->vals[cells[state].val];
+}
+
+template <typename K, typename V>
+std::optional<V> data::DoubleArrayTrie<K, V>::get(const K * const key, const size_t key_len) const {
+    return this->get(std::span<const K>(key, key_len));
+}
+
+template <typename K, typename V>
+template <typename Traits>
+std::optional<V> data::DoubleArrayTrie<K, V>::get(std::basic_string_view<K, Traits> key) const {
+    return this->get(std::span<const K>(key.data(), key.size()));
+}
+
+template <typename K, typename V>
+size_t data::DoubleArrayTrie<K, V>::size() const {
+    return this->vals.size();
+}
+
+template <typename K, typename V>
+size_t data::DoubleArrayTrie<K, V>::cell_count() const {
+    return this->cells.size();
+}
+
+#endif
@@ -0,0 +1,364 @@
+#ifndef INCLUDE_STRUCTURES_DURABLE_BTREE_H
+#define INCLUDE_STRUCTURES_DURABLE_BTREE_H
+
+#include <fcntl.h>
+#include <optional>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "../traits.h"
+#include "btree.h"
+#include "write_ahead_log.h"
+
+namespace data {
+    /**
+     * The start of a durable btree's checkpoint file. The entries follow it in key order, each one a key
+     * followed by its value.
+     */
+    struct DurableBTreeCheckpointHeader {
+        // Spells "BTREECKP" when read in the byte order the file was written in
+        static constexpr uint64_t MAGIC = 0x504b434545525442ull;
+        static constexpr uint32_t VERSION = 1;
+
+        uint64_t magic;
+        uint32_t version;
+        uint16_t key_size;
+        uint16_t val_size;
+        // LSN of the last log record that the checkpoint includes
+        uint64_t lsn;
+        uint64_t len;
+        // CRC-32C of this header, with the checksum set to 0, followed by the entries
+        uint32_t checksum;
+        uint32_t padding;
+    };
+
+    /**
+     * A BTree whose changes survive crashes. Every `put` and `del` is appended to a write-ahead log
+     * before it is applied to the tree, and `checkpoint` writes the whole tree to a checkpoint file and
+     * empties the log. Opening the tree loads the last checkpoint and replays the log records after it,
+     * up to the first record that was torn or corrupted by a crash.
+     *
+     * How much can be lost in a crash depends on the log's WalSyncPolicy. With WalSyncPolicy::GROUP,
+     * writes are synced in groups, so that a group of writes shares one sync: a change is durable once
+     * `log().durable_lsn()` reaches its LSN, which happens when its group fills up or `sync` is called.
+     *
+     * The tree lives at `path`, and uses `path` + ".wal" for the log and `path` + ".tmp" while writing a
+     * checkpoint. A checkpoint is written to the temporary file, synced, and then renamed over the last
+     * one, so there is always one complete checkpoint. K and V must be trivially copyable.
+     */
+    template <Ord K, typename V, const size_t N>
+    class DurableBTree {
+        static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>, "Only trivially copyable keys and values can be logged");
+
+        private:
+            enum class Op : uint8_t {
+                PUT = 1,
+                DEL = 2
+            };
+
+            // A log record is an Op followed by a key and, for a put, a value
+            static constexpr size_t PUT_SIZE = 1 + sizeof(K) + sizeof(V);
+            static constexpr size_t DEL_SIZE = 1 + sizeof(K);
+
+            const std::string path;
+            BTree<K, V, N> * tree_;
+            WriteAheadLog log_;
+
+            static uint32_t checksum(const DurableBTreeCheckpointHeader &header, const std::vector<unsigned char> &body);
+
+            /**
+             * Reads the checkpoint at `path` into the tree, and returns the LSN of the last record it
+             * includes. Returns 0 and leaves the tree empty if there is no checkpoint yet.
+             */
+            uint64_t load_checkpoint();
+
+            /**
+             * Applies a record read back from the log to the tree.
+             */
+            void apply(const unsigned char * record, size_t length);
+
+        public:
+            /**
+             * Opens the tree at the given path, recovering it from its checkpoint and log if they exist.
+             * Throws if the checkpoint was not written by a tree with the same K and V, or is corrupt.
+             */
+            DurableBTree(const char * path, WalSyncPolicy policy = WalSyncPolicy::GROUP, size_t group_size = 64);
+
+            DurableBTree(const DurableBTree<K, V, N> &other) = delete;
+
+            DurableBTree(DurableBTree<K, V, N> &&other) = delete;
+
+            /**
+             * Closes the log, which syncs it unless the policy is WalSyncPolicy::NEVER. Does not
+             * checkpoint.
+             */
+            ~DurableBTree();
+
+            void operator=(const DurableBTree<K, V, N> &other) = delete;
+
+            void operator=(DurableBTree<K, V, N> &&other) = delete;
+
+            std::optional<V> get(const K &key) const;
+
+            /**
+             * Logs and applies a put. See BTree::put.
+             */
+            std::optional<V> put(const K key, const V val);
+
+            /**
+             * Logs and applies a delete. Deleting a key that isn't in the tree is not logged.
+             */
+            std::optional<V> del(const K key);
+
+            size_t size() const;
+
+            /**
+             * Makes every change so far durable.
+             */
+            void sync();
+
+            /**
+             * Writes the tree to a new checkpoint and empties the log, so that recovery doesn't have to
+             * replay the changes so far.
+             */
+            void checkpoint();
+
+            /**
+             * The tree that changes are applied to, for reads and iteration.
+             */
+            const BTree<K, V, N>& tree() const;
+
+            const WriteAheadLog& log() const;
+    };
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::DurableBTree<K, V, N>::DurableBTree(const char * path, WalSyncPolicy policy, size_t group_size)
+    : path(path), tree_(nullptr), log_((std::string(path) + ".wal").c_str(), policy, group_size)
+{
+    const uint64_t lsn = this->load_checkpoint();
+
+    try {
+        this->log_.replay(lsn, [&](uint64_t, const void * record, size_t length) {
+            this->apply(static_cast<const unsigned char *>(record), length);
+        });
+    } catch (const char * err) {
+        delete this->tree_;
+        throw;
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::DurableBTree<K, V, N>::~DurableBTree() {
+    delete this->tree_;
+}
+
+template <data::Ord K, typename V, const size_t N>
+uint64_t data::DurableBTree<K, V, N>::load_checkpoint() {
+    FILE * file = fopen(this->path.c_str(), "rb");
+
+    if (!file) {
+        this->tree_ = new BTree<K, V, N>();
+        return 0;
+    }
+
+    DurableBTreeCheckpointHeader header;
+
+    if (fread(&header, sizeof(header), 1, file) != 1) {
+        fclose(file);
+        throw "Durable btree checkpoint is truncated";
+    }
+
+    if (header.magic != DurableBTreeCheckpointHeader::MAGIC || header.version != DurableBTreeCheckpointHeader::VERSION) {
+        fclose(file);
+        throw "Not a durable btree checkpoint";
+    }
+
+    if (header.key_size != sizeof(K) || header.val_size != sizeof(V)) {
+        fclose(file);
+        throw "Durable btree checkpoint has different key or value types";
+    }
+
+    std::vector<unsigned char> body(header.len * (sizeof(K) + sizeof(V)));
+    const size_t read = body.empty() ? 0 : fread(body.data(), 1, body.size(), file);
+
+    fclose(file);
+
+    if (read != body.size()) {
+        throw "Durable btree checkpoint is truncated";
+    }
+
+    if (checksum(header, body) != header.checksum) {
+        throw "Durable btree checkpoint is corrupt";
+    }
+
+    std::vector<std::pair<K, V>> entries(header.len);
+
+    for (size_t i = 0; i < header.len; i++) {
+        const unsigned char * entry = body.data() + i * (sizeof(K) + sizeof(V));
+
+        memcpy(&entries[i].first, entry, sizeof(K));
+        memcpy(&entries[i].second, entry + sizeof(K), sizeof(V));
+    }
+
+    // The entries were written in order, so the tree can be bulk loaded
+    this->tree_ = new BTree<K, V, N>(entries);
+
+    return header.lsn;
+}
+
+template <data::Ord K, typename V, const size_t N>
+uint32_t data::DurableBTree<K, V, N>::checksum(const DurableBTreeCheckpointHeader &header, const std::vector<unsigned char> &body) {
+    DurableBTreeCheckpointHeader unsummed = header;
+
+    unsummed.checksum = 0;
+
+    return crc32c(body.data(), body.size(), crc32c(&unsummed, sizeof(unsummed)));
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::DurableBTree<K, V, N>::apply(const unsigned char * record, size_t length) {
+    K key;
+    V val;
+
+    if (length == PUT_SIZE && record[0] == (uint8_t) Op::PUT) {
+        memcpy(&key, record + 1, sizeof(K));
+        memcpy(&val, record + 1 + sizeof(K), sizeof(V));
+        this->tree_->put(key, val);
+    } else if (length == DEL_SIZE && record[0] == (uint8_t) Op::DEL) {
+        memcpy(&key, record + 1, sizeof(K));
+        this->tree_->del(key);
+    } else {
+        throw "Durable btree log has an unknown record";
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::DurableBTree<K, V, N>::get(const K &key) const {
+    return this->tree_->get(key);
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::DurableBTree<K, V, N>::put(const K key, const V val) {
+    unsigned char record[PUT_SIZE];
+
+    record[0] = (uint8_t) Op::PUT;
+    memcpy(record + 1, &key, sizeof(K));
+    memcpy(record + 1 + sizeof(K), &val, sizeof(V));
+
+    this->log_.append(record, sizeof(record));
+
+    return this->tree_->put(key, val);
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::DurableBTree<K, V, N>::del(const K key) {
+    if (!this->tree_->get(key)) {
+        return std::nullopt;
+    }
+
+    unsigned char record[DEL_SIZE];
+
+    record[0] = (uint8_t) Op::DEL;
+    memcpy(record + 1, &key, sizeof(K));
+
+    this->log_.append(record, sizeof(record));
+
+    return this->tree_->del(key);
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::DurableBTree<K, V, N>::size() const {
+    return this->tree_->size();
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::DurableBTree<K, V, N>::sync() {
+    this->log_.sync();
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::DurableBTree<K, V, N>::checkpoint() {
+    const std::string tmp_path = this->path + ".tmp";
+    std::vector<unsigned char> body;
+
+    body.reserve(this->tree_->size() * (sizeof(K) + sizeof(V)));
+
+    for (const auto &[key, val] : *static_cast<const BTree<K, V, N> *>(this->tree_)) {
+        const unsigned char * key_bytes = reinterpret_cast<const unsigned char *>(&key);
+        const unsigned char * val_bytes = reinterpret_cast<const unsigned char *>(val);
+
+        body.insert(std::end(body), key_bytes, key_bytes + sizeof(K));
+        body.insert(std::end(body), val_bytes, val_bytes + sizeof(V));
+    }
+
+    DurableBTreeCheckpointHeader header{};
+
+    header.magic = DurableBTreeCheckpointHeader::MAGIC;
+    header.version = DurableBTreeCheckpointHeader::VERSION;
+    header.key_size = sizeof(K);
+    header.val_size = sizeof(V);
+    // Every change so far has been appended to the log, even if it hasn't been written yet
+    header.lsn = this->log_.next_lsn() - 1;
+    header.len = this->tree_->size();
+    header.checksum = checksum(header, body);
+
+    FILE * file = fopen(tmp_path.c_str(), "wb");
+
+    if (!file) {
+        throw "Could not open file to write durable btree checkpoint";
+    }
+
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1 && (body.empty() || fwrite(body.data(), 1, body.size(), file) == body.size());
+    const bool synced = written && !fflush(file) && !fsync(fileno(file));
+
+    if (fclose(file) || !synced) {
+        unlink(tmp_path.c_str());
+        throw "Could not write durable btree checkpoint";
+    }
+
+    if (rename(tmp_path.c_str(), this->path.c_str())) {
+        unlink(tmp_path.c_str());
+        throw "Could not replace durable btree checkpoint";
+    }
+
+    // Sync the directory so that the rename is durable before the log is emptied
+    const size_t slash = this->path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : slash ? this->path.substr(0, slash) : "/";
+    const int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+
+    if (dir_fd < 0) {
+        throw "Could not sync durable btree checkpoint";
+    }
+
+    const bool dir_synced = !fsync(dir_fd);
+
+    close(dir_fd);
+
+    if (!dir_synced) {
+        throw "Could not sync durable btree checkpoint";
+    }
+
+    // If this doesn't happen because of a crash, recovery skips the records that the checkpoint
+    // already includes
+    this->log_.reset();
+}
+
+template <data::Ord K, typename V, const size_t N>
+const data::BTree<K, V, N>& data::DurableBTree<K, V, N>::tree() const {
+    return *this->tree_;
+}
+
+template <data::Ord K, typename V, const size_t N>
+const data::WriteAheadLog& data::DurableBTree<K, V, N>::log() const {
+    return this->log_;
+}
+
+#endif
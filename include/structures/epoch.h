@@ -0,0 +1,129 @@
+#ifndef INCLUDE_STRUCTURES_EPOCH_H
+#define INCLUDE_STRUCTURES_EPOCH_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stdlib.h>
+#include <thread>
+
+namespace data {
+    /**
+     * Epoch-based reclamation for structures whose readers don't take locks. A reader pins the current
+     * epoch for as long as it might be holding pointers into the structure. A writer that unlinks memory
+     * advances the epoch and tags the memory with the epoch it was retired in, and frees it once every
+     * pinned reader has moved past that epoch.
+     *
+     * Pinned epochs are announced in a fixed number of slots, each on its own cache line, so readers on
+     * different cores don't write to shared memory. A thread tries the same slot first every time. If
+     * more threads than there are slots pin at once, the extra threads wait for a slot to be free.
+     */
+    class EpochManager {
+        public:
+            static constexpr size_t SLOTS = 128;
+
+            /**
+             * Keeps an epoch pinned until it is destroyed.
+             */
+            class Guard {
+                private:
+                    std::atomic<uint64_t> * slot;
+
+                public:
+                    Guard(std::atomic<uint64_t> * slot);
+
+                    Guard(const Guard &other) = delete;
+
+                    Guard(Guard &&other);
+
+                    ~Guard();
+
+                    void operator=(const Guard &other) = delete;
+            };
+
+        private:
+            struct alignas(64) Slot {
+                // Zero if the slot is free
+                std::atomic<uint64_t> epoch;
+            };
+
+            std::atomic<uint64_t> epoch;
+            Slot slots[SLOTS];
+
+        public:
+            EpochManager();
+
+            EpochManager(const EpochManager &other) = delete;
+
+            void operator=(const EpochManager &other) = delete;
+
+            /**
+             * Pins the current epoch. Memory that was reachable when this is called won't be freed until
+             * the guard is destroyed.
+             */
+            Guard pin();
+
+            /**
+             * Moves to the next epoch and returns the one that ended. Memory that was unlinked before this
+             * is called should be tagged with the returned epoch.
+             */
+            uint64_t advance();
+
+            /**
+             * Returns true if memory tagged with the given epoch can't be reached by any reader.
+             */
+            bool is_safe(uint64_t retired_epoch) const;
+    };
+}
+
+inline data::EpochManager::Guard::Guard(std::atomic<uint64_t> * slot) : slot(slot) {}
+
+inline data::EpochManager::Guard::Guard(Guard &&other) : slot(other.slot) {
+    other.slot = nullptr;
+}
+
+inline data::EpochManager::Guard::~Guard() {
+    if (this->slot) {
+        this->slot->store(0);
+    }
+}
+
+inline data::EpochManager::EpochManager() : epoch(1), slots() {}
+
+inline data::EpochManager::Guard data::EpochManager::pin() {
+    static std::atomic<size_t> next_hint(0);
+    thread_local const size_t hint = next_hint.fetch_add(1) % SLOTS;
+
+    for (size_t i = 0; ; i++) {
+        Slot &slot = this->slots[(hint + i) % SLOTS];
+        uint64_t expected = 0;
+
+        // Everything here is sequentially consistent. A writer that checks the slots before this
+        // announcement lands must have published its changes before this thread reads anything, so
+        // the reader can't see the memory that the writer frees.
+        if (slot.epoch.compare_exchange_strong(expected, this->epoch.load())) {
+            return Guard(&slot.epoch);
+        }
+
+        if (i % SLOTS == SLOTS - 1) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline uint64_t data::EpochManager::advance() {
+    return this->epoch.fetch_add(1);
+}
+
+inline bool data::EpochManager::is_safe(uint64_t retired_epoch) const {
+    for (size_t i = 0; i < SLOTS; i++) {
+        const uint64_t pinned = this->slots[i].epoch.load();
+
+        if (pinned && pinned <= retired_epoch) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif
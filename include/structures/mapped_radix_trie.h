@@ -0,0 +1,307 @@
+#ifndef INCLUDE_STRUCTURES_MAPPED_RADIX_TRIE_H
+#define INCLUDE_STRUCTURES_MAPPED_RADIX_TRIE_H
+
+#include <fcntl.h>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <stdint.h>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "mapped_radix_trie_iterator.h"
+#include "mapped_radix_trie_node.h"
+
+namespace data {
+    /**
+     * A read-only view of a radix trie saved with `RadixTrie::save()`. The file is mapped into memory
+     * and lookups and prefix queries read the mapped pages directly, so opening a trie does not depend
+     * on its size, and processes that open the same file share its pages in the page cache.
+     *
+     * The file is laid out as a header followed by nodes in depth-first order, so the entries under a
+     * prefix are close together. Nodes refer to their children by offsets from the start of the file
+     * instead of by pointers (see MappedRadixTrieNode). The image is in the byte order
+     * of the machine that wrote it, and K and V must be trivially copyable.
+     *
+     * "K" is the type of a symbol in the key. K should implement operator< and operator==.
+     * "V" is the type of the value.
+     */
+    template <typename K, typename V>
+    class MappedRadixTrie {
+        static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>, "Only trivially copyable keys and values can be mapped");
+
+        private:
+            typedef MappedRadixTrieNode<K, V> node_type;
+
+            const unsigned char * base;
+            size_t length;
+
+            const MappedRadixTrieHeader * header() const;
+
+            const node_type * root() const;
+
+            /**
+             * Returns the highest node whose full key starts with the given key, or null if there is
+             * none. `prefix` is set to the key spelled out by the nodes above it.
+             */
+            const node_type * find_prefix_node(std::span<const K> key, std::span<const K> &prefix) const;
+
+            void unmap();
+
+        public:
+            /**
+             * Maps the saved trie at the given path. Throws if the file can't be read or was not saved
+             * with the same K and V.
+             */
+            MappedRadixTrie(const char * path);
+
+            MappedRadixTrie(const MappedRadixTrie<K, V> &other) = delete;
+
+            MappedRadixTrie(MappedRadixTrie<K, V> &&other);
+
+            ~MappedRadixTrie();
+
+            void operator=(const MappedRadixTrie<K, V> &other) = delete;
+
+            void operator=(MappedRadixTrie<K, V> &&other);
+
+            std::optional<V> get(std::span<const K> key) const;
+
+            std::optional<V> get(const std::vector<K> &key) const;
+
+            std::optional<V> get(std::initializer_list<K> key) const;
+
+            template <typename Traits>
+            std::optional<V> get(std::basic_string_view<K, Traits> key) const;
+
+            /**
+             * Returns the number of entries.
+             */
+            size_t size() const;
+
+            MappedRadixTrieIterator<K, V> begin() const;
+
+            MappedRadixTrieIterator<K, V> end() const;
+
+            /**
+             * Returns a lazy range over the entries whose keys start with the given key, in lexicographic
+             * order, stopping after `limit` entries. An empty prefix matches every key.
+             */
+            MappedRadixTrieRange<K, V> entries_with_prefix(std::span<const K> key, size_t limit = SIZE_MAX) const;
+
+            MappedRadixTrieRange<K, V> entries_with_prefix(const std::vector<K> &key, size_t limit = SIZE_MAX) const;
+
+            template <typename Traits>
+            MappedRadixTrieRange<K, V> entries_with_prefix(std::basic_string_view<K, Traits> key, size_t limit = SIZE_MAX) const;
+    };
+}
+
+template <typename K, typename V>
+data::MappedRadixTrie<K, V>::MappedRadixTrie(const char * path) : base(nullptr), length(0) {
+    const int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        throw "Could not open saved radix trie";
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) || (size_t) st.st_size < sizeof(MappedRadixTrieHeader)) {
+        close(fd);
+        throw "Saved radix trie is truncated";
+    }
+
+    void * mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+
+    if (mapped == MAP_FAILED) {
+        throw "Could not map saved radix trie";
+    }
+
+    this->base = static_cast<const unsigned char *>(mapped);
+    this->length = st.st_size;
+
+    const MappedRadixTrieHeader * header = this->header();
+
+    if (header->magic != MappedRadixTrieHeader::MAGIC || header->version != MappedRadixTrieHeader::VERSION) {
+        this->unmap();
+        throw "Not a saved radix trie";
+    }
+
+    if (header->key_size != sizeof(K) || header->val_size != sizeof(V)) {
+        this->unmap();
+        throw "Saved radix trie has different key or value types";
+    }
+
+    if (header->length != this->length || header->root + sizeof(node_type) > this->length) {
+        this->unmap();
+        throw "Saved radix trie is truncated";
+    }
+}
+
+template <typename K, typename V>
+data::MappedRadixTrie<K, V>::MappedRadixTrie(MappedRadixTrie<K, V> &&other) : base(other.base), length(other.length) {
+    other.base = nullptr;
+    other.length = 0;
+}
+
+template <typename K, typename V>
+data::MappedRadixTrie<K, V>::~MappedRadixTrie() {
+    this->unmap();
+}
+
+template <typename K, typename V>
+void data::MappedRadixTrie<K, V>::operator=(MappedRadixTrie<K, V> &&other) {
+    if (this == &other) {
+        return;
+    }
+
+    this->unmap();
+    this->base = other.base;
+    this->length = other.length;
+    other.base = nullptr;
+    other.length = 0;
+}
+
+template <typename K, typename V>
+void data::MappedRadixTrie<K, V>::unmap() {
+    if (this->base) {
+        munmap(const_cast<unsigned char *>(this->base), this->length);
+        this->base = nullptr;
+        this->length = 0;
+    }
+}
+
+template <typename K, typename V>
+const data::MappedRadixTrieHeader * data::MappedRadixTrie<K, V>::header() const {
+    return reinterpret_cast<const MappedRadixTrieHeader *>(this->base);
+}
+
+template <typename K, typename V>
+const data::MappedRadixTrieNode<K, V> * data::MappedRadixTrie<K, V>::root() const {
+    return reinterpret_cast<const node_type *>(this->base + this->header()->root);
+}
+
+template <typename K, typename V>
+std::optional<V> data::MappedRadixTrie<K, V>::get(std::span<const K> key) const {
+    const node_type * node = this->root();
+    size_t char_count = 0;
+
+    // Keys cannot be empty, and the root never has a value
+    while (char_count < key.size()) {
+        node = node->find(this->base, key[char_count]);
+
+        if (!node || node->key_len > key.size() - char_count) {
+            return std::nullopt;
+        }
+
+        const K * fragment = node->key_data();
+
+        for (size_t i = 0; i < node->key_len; i++) {
+            if (!(fragment[i] == key[char_count + i])) {
+                return std::nullopt;
+            }
+        }
+
+        char_count += node->key_len;
+    }
+
+    const V * val = node->value();
+
+    if (!val) {
+        return std::nullopt;
+    }
+
+    return *val;
+}
+
+template <typename K, typename V>
+std::optional<V> data::MappedRadixTrie<K, V>::get(const std::vector<K> &key) const {
+    return this->get(std::span<const K>(key));
+}
+
+template <typename K, typename V>
+std::optional<V> data::MappedRadixTrie<K, V>::get(std::initializer_list<K> key) const {
+    return this->get(std::span<const K>(key.begin(), key.size()));
+}
+
+template <typename K, typename V>
+template <typename Traits>
+std::optional<V> data::MappedRadixTrie<K, V>::get(std::basic_string_view<K, Traits> key) const {
+    return this->get(std::span<const K>(key.data(), key.size()));
+}
+
+template <typename K, typename V>
+size_t data::MappedRadixTrie<K, V>::size() const {
+    return this->header()->size;
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieIterator<K, V> data::MappedRadixTrie<K, V>::begin() const {
+    return MappedRadixTrieIterator<K, V>(this->base, this->root(), std::span<const K>(), SIZE_MAX);
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieIterator<K, V> data::MappedRadixTrie<K, V>::end() const {
+    return MappedRadixTrieIterator<K, V>();
+}
+
+template <typename K, typename V>
+const data::MappedRadixTrieNode<K, V> * data::MappedRadixTrie<K, V>::find_prefix_node(std::span<const K> key, std::span<const K> &prefix) const {
+    const node_type * node = this->root();
+    size_t char_count = 0;
+
+    while (char_count < key.size()) {
+        node = node->find(this->base, key[char_count]);
+
+        if (!node) {
+            return nullptr;
+        }
+
+        const K * fragment = node->key_data();
+        const size_t len = std::min((size_t) node->key_len, key.size() - char_count);
+
+        for (size_t i = 0; i < len; i++) {
+            if (!(fragment[i] == key[char_count + i])) {
+                return nullptr;
+            }
+        }
+
+        // The key ends in or at the end of this node, so every key under it matches
+        prefix = key.subspan(0, char_count);
+        char_count += len;
+    }
+
+    return node;
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieRange<K, V> data::MappedRadixTrie<K, V>::entries_with_prefix(std::span<const K> key, size_t limit) const {
+    std::span<const K> prefix;
+    const node_type * node = this->find_prefix_node(key, prefix);
+
+    if (!node) {
+        return MappedRadixTrieRange<K, V>();
+    }
+
+    return MappedRadixTrieRange<K, V>(MappedRadixTrieIterator<K, V>(this->base, node, prefix, limit));
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieRange<K, V> data::MappedRadixTrie<K, V>::entries_with_prefix(const std::vector<K> &key, size_t limit) const {
+    return this->entries_with_prefix(std::span<const K>(key), limit);
+}
+
+template <typename K, typename V>
+template <typename Traits>
+data::MappedRadixTrieRange<K, V> data::MappedRadixTrie<K, V>::entries_with_prefix(std::basic_string_view<K, Traits> key, size_t limit) const {
+    return this->entries_with_prefix(std::span<const K>(key.data(), key.size()), limit);
+}
+
+#endif
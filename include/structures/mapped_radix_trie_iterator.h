@@ -0,0 +1,245 @@
+#ifndef INCLUDE_STRUCTURES_MAPPED_RADIX_TRIE_ITERATOR_H
+#define INCLUDE_STRUCTURES_MAPPED_RADIX_TRIE_ITERATOR_H
+
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "mapped_radix_trie_node.h"
+
+namespace data {
+    /**
+     * Iterator over the entries of a MappedRadixTrie, in lexicographic order. Like RadixTrieIterator,
+     * it keeps the path from the first node down to the current node along with the key spelled out by
+     * that path, and gives out pairs of a view of the key and a pointer to the value. The value points
+     * into the mapped image, and the key is only valid until the iterator is incremented or destroyed.
+     *
+     * Saved nodes have no parent pointers, so the path also records which child of its parent each
+     * node is.
+     */
+    template <typename K, typename V>
+    class MappedRadixTrieIterator {
+        private:
+            typedef MappedRadixTrieNode<K, V> node_type;
+
+            struct path_entry {
+                const node_type * node;
+                // Index of the node among its parent's children. Unused for the first node.
+                size_t index;
+            };
+
+            const unsigned char * base;
+            // Nodes from the first node down to the current node. Empty at the end.
+            std::vector<path_entry> path;
+            // The full key of the current node
+            std::vector<K> key;
+            // Number of entries left before the iterator stops, including the current one
+            size_t remaining;
+
+            void push(const node_type * node, size_t index);
+
+            void pop();
+
+            /**
+             * Follows the first children from the current node until it reaches a node with a value.
+             */
+            void descend();
+
+            void finish();
+
+            constexpr void check_impl();
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<std::span<const K>, const V *>;
+            using difference_type = int;
+            using pointer = value_type *;
+            using reference = value_type&;
+
+            /**
+             * Creates an end iterator.
+             */
+            MappedRadixTrieIterator();
+
+            /**
+             * Creates an iterator over at most `limit` entries in the subtree rooted at `root`, starting
+             * with `root` itself if it has a value. `prefix` is the key spelled out by the nodes above
+             * `root`.
+             */
+            MappedRadixTrieIterator(const unsigned char * base, const node_type * root, std::span<const K> prefix, size_t limit);
+
+            MappedRadixTrieIterator<K, V>& operator++();
+
+            MappedRadixTrieIterator<K, V> operator++(int);
+
+            bool operator==(const MappedRadixTrieIterator<K, V> &it) const;
+
+            bool operator!=(const MappedRadixTrieIterator<K, V> &it) const;
+
+            value_type operator*() const;
+    };
+
+    /**
+     * A lazy range of entries in a MappedRadixTrie. See RadixTrieRange.
+     */
+    template <typename K, typename V>
+    class MappedRadixTrieRange : public std::ranges::view_interface<MappedRadixTrieRange<K, V>> {
+        private:
+            MappedRadixTrieIterator<K, V> first;
+
+        public:
+            MappedRadixTrieRange();
+
+            MappedRadixTrieRange(MappedRadixTrieIterator<K, V> first);
+
+            MappedRadixTrieIterator<K, V> begin() const;
+
+            MappedRadixTrieIterator<K, V> end() const;
+    };
+}
+
+template <typename K, typename V>
+constexpr void data::MappedRadixTrieIterator<K, V>::check_impl() {
+    // See RadixTrieIterator::check_impl
+    static_assert(std::forward_iterator<MappedRadixTrieIterator<K, V>>);
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieIterator<K, V>::MappedRadixTrieIterator() : base(nullptr), path(), key(), remaining(0) {
+    this->check_impl();
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieIterator<K, V>::MappedRadixTrieIterator(const unsigned char * base, const node_type * root, std::span<const K> prefix, size_t limit)
+    : base(base), path(), key(std::begin(prefix), std::end(prefix)), remaining(limit)
+{
+    this->check_impl();
+
+    // The root of an empty trie has neither a value nor children
+    if (!limit || (!root->has_val && !root->child_count)) {
+        this->key.clear();
+        return;
+    }
+
+    this->push(root, 0);
+    this->descend();
+}
+
+template <typename K, typename V>
+void data::MappedRadixTrieIterator<K, V>::push(const node_type * node, size_t index) {
+    const K * fragment = node->key_data();
+
+    this->path.push_back({ node, index });
+    this->key.insert(std::end(this->key), fragment, fragment + node->key_len);
+}
+
+template <typename K, typename V>
+void data::MappedRadixTrieIterator<K, V>::pop() {
+    this->key.resize(this->key.size() - this->path.back().node->key_len);
+    this->path.pop_back();
+}
+
+template <typename K, typename V>
+void data::MappedRadixTrieIterator<K, V>::descend() {
+    while (!this->path.back().node->has_val) {
+        // As in a RadixTrie, a saved leaf always has a value
+        this->push(this->path.back().node->child(this->base, 0), 0);
+    }
+}
+
+template <typename K, typename V>
+void data::MappedRadixTrieIterator<K, V>::finish() {
+    this->path.clear();
+    this->key.clear();
+    this->remaining = 0;
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieIterator<K, V>& data::MappedRadixTrieIterator<K, V>::operator++() {
+    if (!this->path.size()) {
+        return *this;
+    }
+
+    if (!--this->remaining) {
+        this->finish();
+        return *this;
+    }
+
+    const node_type * node = this->path.back().node;
+
+    if (node->child_count) {
+        this->push(node->child(this->base, 0), 0);
+        this->descend();
+
+        return *this;
+    }
+
+    // Climb until some node on the path has a next sibling. The first node's siblings are outside of
+    // the iterator's subtree.
+    while (this->path.size() > 1) {
+        const size_t next = this->path.back().index + 1;
+        const node_type * parent = this->path[this->path.size() - 2].node;
+
+        this->pop();
+
+        if (next < parent->child_count) {
+            this->push(parent->child(this->base, next), next);
+            this->descend();
+
+            return *this;
+        }
+    }
+
+    this->finish();
+
+    return *this;
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieIterator<K, V> data::MappedRadixTrieIterator<K, V>::operator++(int) {
+    MappedRadixTrieIterator<K, V> it = MappedRadixTrieIterator<K, V>(*this);
+
+    ++(*this);
+
+    return it;
+}
+
+template <typename K, typename V>
+bool data::MappedRadixTrieIterator<K, V>::operator==(const MappedRadixTrieIterator<K, V> &it) const {
+    if (!this->path.size() || !it.path.size()) {
+        return this->path.size() == it.path.size();
+    }
+
+    return this->path.back().node == it.path.back().node;
+}
+
+template <typename K, typename V>
+bool data::MappedRadixTrieIterator<K, V>::operator!=(const MappedRadixTrieIterator<K, V> &it) const {
+    return !(*this == it);
+}
+
+template <typename K, typename V>
+typename data::MappedRadixTrieIterator<K, V>::value_type data::MappedRadixTrieIterator<K, V>::operator*() const {
+    return value_type(std::span<const K>(this->key), this->path.back().node->value());
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieRange<K, V>::MappedRadixTrieRange() : first() {}
+
+template <typename K, typename V>
+data::MappedRadixTrieRange<K, V>::MappedRadixTrieRange(MappedRadixTrieIterator<K, V> first) : first(first) {}
+
+template <typename K, typename V>
+data::MappedRadixTrieIterator<K, V> data::MappedRadixTrieRange<K, V>::begin() const {
+    return this->first;
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieIterator<K, V> data::MappedRadixTrieRange<K, V>::end() const {
+    return MappedRadixTrieIterator<K, V>();
+}
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef INCLUDE_STRUCTURES_MAPPED_RADIX_TRIE_NODE_H
+#define INCLUDE_STRUCTURES_MAPPED_RADIX_TRIE_NODE_H
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "search.h"
+
+namespace data {
+    /**
+     * The first bytes of a saved radix trie. Everything after the header is found through offsets from
+     * the start of the image, so the image can be mapped at any address.
+     */
+    struct MappedRadixTrieHeader {
+        // Spells "RADIXTRI" when read in the byte order the image was written in
+        static constexpr uint64_t MAGIC = 0x4952545849444152ull;
+        static constexpr uint32_t VERSION = 1;
+
+        uint64_t magic;
+        uint32_t version;
+        uint16_t key_size;
+        uint16_t val_size;
+        // Number of entries
+        uint64_t size;
+        // Offset of the root node, which has an empty key and no value
+        uint64_t root;
+        // Length of the whole image in bytes
+        uint64_t length;
+    };
+
+    /**
+     * A node in a saved radix trie. The node is followed directly by its key fragment, then by the first
+     * symbols of its children, then by the offsets of its children, so everything needed to take one
+     * step down the trie is in a few adjacent cache lines. The children are sorted by their first
+     * symbols.
+     */
+    template <typename K, typename V>
+    struct MappedRadixTrieNode {
+        uint32_t key_len;
+        uint32_t child_count;
+        uint32_t has_val;
+        alignas(V) unsigned char val[sizeof(V)];
+
+        /**
+         * Returns where the node's child symbols start, relative to the node.
+         */
+        static size_t symbols_at(size_t key_len);
+
+        /**
+         * Returns where the node's child offsets start, relative to the node.
+         */
+        static size_t children_at(size_t key_len, size_t child_count);
+
+        /**
+         * Returns the number of bytes taken up by a node and its arrays.
+         */
+        static size_t footprint(size_t key_len, size_t child_count);
+
+        const K * key_data() const;
+
+        const V * value() const;
+
+        /**
+         * Returns the child whose key starts with the given symbol, or null if there is none.
+         */
+        const MappedRadixTrieNode<K, V> * find(const unsigned char * base, const K &symbol) const;
+
+        const MappedRadixTrieNode<K, V> * child(const unsigned char * base, size_t i) const;
+    };
+
+    /**
+     * Lays out a radix trie in memory in the format read by MappedRadixTrie, one node at a time, and
+     * writes it to a file. Every node is aligned for K, V and the offsets, so the image can be used in
+     * place once it is mapped at a page boundary.
+     */
+    template <typename K, typename V>
+    class MappedRadixTrieWriter {
+        static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>, "Only trivially copyable keys and values can be saved");
+
+        private:
+            typedef MappedRadixTrieNode<K, V> node_type;
+
+            static constexpr size_t ALIGN = std::max({ alignof(uint64_t), alignof(K), alignof(V) });
+
+            std::vector<unsigned char> image;
+
+            /**
+             * Reserves zeroed, aligned space for `len` bytes at the end of the image and returns its
+             * offset.
+             */
+            size_t reserve(size_t len);
+
+        public:
+            MappedRadixTrieWriter();
+
+            /**
+             * Adds a node with room for `child_count` children and returns its offset. The children are
+             * filled in with `set_child`.
+             */
+            size_t add_node(const K * key, size_t key_len, const V * val, size_t child_count);
+
+            void set_child(size_t node, size_t i, const K &symbol, size_t child);
+
+            /**
+             * Fills in the header and writes the image to the given path, replacing the file if it exists.
+             */
+            void write(const char * path, size_t root, size_t size);
+    };
+}
+
+template <typename K, typename V>
+size_t data::MappedRadixTrieNode<K, V>::symbols_at(size_t key_len) {
+    const size_t end = sizeof(MappedRadixTrieNode<K, V>) + key_len * sizeof(K);
+
+    return (end + alignof(K) - 1) / alignof(K) * alignof(K);
+}
+
+template <typename K, typename V>
+size_t data::MappedRadixTrieNode<K, V>::children_at(size_t key_len, size_t child_count) {
+    const size_t end = symbols_at(key_len) + child_count * sizeof(K);
+
+    return (end + alignof(uint64_t) - 1) / alignof(uint64_t) * alignof(uint64_t);
+}
+
+template <typename K, typename V>
+size_t data::MappedRadixTrieNode<K, V>::footprint(size_t key_len, size_t child_count) {
+    return children_at(key_len, child_count) + child_count * sizeof(uint64_t);
+}
+
+template <typename K, typename V>
+const K * data::MappedRadixTrieNode<K, V>::key_data() const {
+    return reinterpret_cast<const K *>(this + 1);
+}
+
+template <typename K, typename V>
+const V * data::MappedRadixTrieNode<K, V>::value() const {
+    if (!this->has_val) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<const V *>(this->val);
+}
+
+template <typename K, typename V>
+const data::MappedRadixTrieNode<K, V> * data::MappedRadixTrieNode<K, V>::find(const unsigned char * base, const K &symbol) const {
+    const K * symbols = reinterpret_cast<const K *>(reinterpret_cast<const unsigned char *>(this) + symbols_at(this->key_len));
+#ifdef __SSE2__
+    // With at least two children, the symbols are followed by at least 16 bytes of the node, so a 16
+    // byte load stays inside it
+    if constexpr (std::is_integral_v<K> && sizeof(K) == 1) {
+        if (this->child_count >= 2 && this->child_count <= 16) {
+            const __m128i needle = _mm_set1_epi8((char) symbol);
+            const __m128i haystack = _mm_loadu_si128(reinterpret_cast<const __m128i *>(symbols));
+            const unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(needle, haystack)) & ((1u << this->child_count) - 1);
+
+            if (!mask) {
+                return nullptr;
+            }
+
+            return this->child(base, __builtin_ctz(mask));
+        }
+    }
+#endif
+
+    const size_t i = lower_bound(symbols, this->child_count, symbol);
+
+    if (i == this->child_count || !(symbols[i] == symbol)) {
+        return nullptr;
+    }
+
+    return this->child(base, i);
+}
+
+template <typename K, typename V>
+const data::MappedRadixTrieNode<K, V> * data::MappedRadixTrieNode<K, V>::child(const unsigned char * base, size_t i) const {
+    const unsigned char * self = reinterpret_cast<const unsigned char *>(this);
+    const uint64_t * children = reinterpret_cast<const uint64_t *>(self + children_at(this->key_len, this->child_count));
+
+    return reinterpret_cast<const MappedRadixTrieNode<K, V> *>(base + children[i]);
+}
+
+template <typename K, typename V>
+data::MappedRadixTrieWriter<K, V>::MappedRadixTrieWriter() : image() {
+    this->reserve(sizeof(MappedRadixTrieHeader));
+}
+
+template <typename K, typename V>
+size_t data::MappedRadixTrieWriter<K, V>::reserve(size_t len) {
+    const size_t offset = (this->image.size() + ALIGN - 1) / ALIGN * ALIGN;
+
+    this->image.resize(offset + len, 0);
+
+    return offset;
+}
+
+template <typename K, typename V>
+size_t data::MappedRadixTrieWriter<K, V>::add_node(const K * key, size_t key_len, const V * val, size_t child_count) {
+    node_type node{};
+
+    node.key_len = (uint32_t) key_len;
+    node.child_count = (uint32_t) child_count;
+    node.has_val = val != nullptr;
+
+    if (val) {
+        memcpy(node.val, val, sizeof(V));
+    }
+
+    const size_t offset = this->reserve(node_type::footprint(key_len, child_count));
+
+    memcpy(this->image.data() + offset, &node, sizeof(node_type));
+
+    if (key_len) {
+        memcpy(this->image.data() + offset + sizeof(node_type), key, key_len * sizeof(K));
+    }
+
+    return offset;
+}
+
+template <typename K, typename V>
+void data::MappedRadixTrieWriter<K, V>::set_child(size_t node, size_t i, const K &symbol, size_t child) {
+    const node_type * parent = reinterpret_cast<const node_type *>(this->image.data() + node);
+    unsigned char * symbols = this->image.data() + node + node_type::symbols_at(parent->key_len);
+    unsigned char * children = this->image.data() + node + node_type::children_at(parent->key_len, parent->child_count);
+    const uint64_t offset = child;
+
+    memcpy(symbols + i * sizeof(K), &symbol, sizeof(K));
+    memcpy(children + i * sizeof(uint64_t), &offset, sizeof(uint64_t));
+}
+
+template <typename K, typename V>
+void data::MappedRadixTrieWriter<K, V>::write(const char * path, size_t root, size_t size) {
+    MappedRadixTrieHeader header{};
+
+    header.magic = MappedRadixTrieHeader::MAGIC;
+    header.version = MappedRadixTrieHeader::VERSION;
+    header.key_size = sizeof(K);
+    header.val_size = sizeof(V);
+    header.size = size;
+    header.root = root;
+    header.length = this->image.size();
+
+    memcpy(this->image.data(), &header, sizeof(header));
+
+    FILE * file = fopen(path, "wb");
+
+    if (!file) {
+        throw "Could not open file to save radix trie";
+    }
+
+    const size_t written = fwrite(this->image.data(), 1, this->image.size(), file);
+
+    if (fclose(file) || written != this->image.size()) {
+        throw "Could not save radix trie";
+    }
+}
+
+#endif
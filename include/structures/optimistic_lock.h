@@ -0,0 +1,86 @@
+#ifndef INCLUDE_STRUCTURES_OPTIMISTIC_LOCK_H
+#define INCLUDE_STRUCTURES_OPTIMISTIC_LOCK_H
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+namespace data {
+    /**
+     * A version lock for optimistic lock coupling. Readers don't write to the lock at all: they note
+     * the version before reading the data it protects, and check afterward that the version hasn't
+     * changed. Writers take the lock exclusively and bump the version when they release it, which
+     * makes every reader that overlapped with them fail validation and start over.
+     *
+     * The lowest bit of the version is set while the lock is held.
+     */
+    class OptimisticLock {
+        private:
+            static constexpr uint64_t LOCKED = 1;
+
+            std::atomic<uint64_t> version;
+
+        public:
+            OptimisticLock();
+
+            /**
+             * Gets the current version for an optimistic read. Returns false if a writer holds the lock,
+             * in which case the caller should start over.
+             */
+            bool read_lock(uint64_t &version) const;
+
+            /**
+             * Returns true if nothing has written to the protected data since the given version was read.
+             */
+            bool validate(uint64_t version) const;
+
+            /**
+             * Takes the lock exclusively, as long as the version is still the given one.
+             */
+            bool upgrade(uint64_t version);
+
+            void write_unlock();
+    };
+}
+
+inline data::OptimisticLock::OptimisticLock() : version(0) {}
+
+inline bool data::OptimisticLock::read_lock(uint64_t &version) const {
+    const uint64_t current = this->version.load(std::memory_order_acquire);
+
+    if (current & LOCKED) {
+        // Give the writer a chance to finish before the caller retries
+        std::this_thread::yield();
+
+        return false;
+    }
+
+    version = current;
+
+    return true;
+}
+
+inline bool data::OptimisticLock::validate(uint64_t version) const {
+    // The data reads before this point must not be reordered after the version check
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return this->version.load(std::memory_order_relaxed) == version;
+}
+
+inline bool data::OptimisticLock::upgrade(uint64_t version) {
+    if (!this->version.compare_exchange_strong(version, version | LOCKED, std::memory_order_acquire)) {
+        return false;
+    }
+
+    // Keeps the writer's data writes from becoming visible before the lock bit
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return true;
+}
+
+inline void data::OptimisticLock::write_unlock() {
+    // Clears the lock bit and carries into the version
+    this->version.fetch_add(1, std::memory_order_release);
+}
+
+#endif
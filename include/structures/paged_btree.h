@@ -0,0 +1,640 @@
+#ifndef INCLUDE_STRUCTURES_PAGED_BTREE_H
+#define INCLUDE_STRUCTURES_PAGED_BTREE_H
+
+#include <algorithm>
+#include <new>
+#include <optional>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../traits.h"
+#include "buffer_pool.h"
+#include "paged_btree_node.h"
+
+namespace data {
+    /**
+     * A btree whose nodes are pages in a file. Nodes refer to their children by page id, and are
+     * read through a BufferPool with a fixed number of frames, so the tree uses the same amount of memory
+     * no matter how big it gets. The algorithms are the same as BTree's, and the keys of a node are kept
+     * in a SortedArray, so a node is searched the same way.
+     *
+     * Operations remember the path from the root by page id rather than keeping it pinned, and pin a
+     * parent again when they climb back up to it. At most MIN_FRAMES pages are pinned at once, however
+     * deep the tree is, so any pool with that many frames works.
+     *
+     * The first page of the file holds a header with the root, the number of entries and a list of freed
+     * pages. Opening an existing file continues where it left off. Changes reach the file when their
+     * pages are evicted, when `flush` is called, or when the tree is destroyed. A crash can leave the
+     * file in between, so anything that needs to survive one should flush or use a log.
+     *
+     * K and V must be trivially copyable, since nodes are written to disk byte for byte.
+     *
+     * "K" is the type of a key. K should implement operator< and operator==.
+     * "V" is the type of a value.
+     * "N" is the maximum number of keys in a node. A node must fit in a page.
+     */
+    template <Ord K, typename V, const size_t N>
+    class PagedBTree {
+        static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>, "Only trivially copyable keys and values can be paged");
+        static_assert(N >= 3, "A btree node needs room for at least 3 keys");
+
+        private:
+            typedef PagedBTreeNode<K, V, N> node_type;
+            typedef BufferPool::Page page_type;
+
+            static constexpr size_t MIN_KEYS = N / 2 > 1 ? N / 2 - 1 : 1;
+
+            BufferPool pool;
+            // The header stays pinned for as long as the tree is open
+            page_type header_page;
+
+            PagedBTreeHeader * header() const;
+
+            static node_type * node(const page_type &page);
+
+            /**
+             * Takes a page off the free list or from the end of the file, and pins it with an empty
+             * node in it.
+             */
+            page_type new_node();
+
+            void free_node(uint64_t id);
+
+            /**
+             * Splits an overflowed node, and then its parents for as long as they overflow. `parents` holds
+             * the ids of the pages on the path from the root to the node, which are pinned as the split
+             * reaches them.
+             */
+            void split_node(std::vector<uint64_t> &parents, page_type node_page);
+
+            /**
+             * Restores the minimum occupancy of a node after a key was removed from it. See
+             * BTree::rebalance.
+             */
+            void rebalance(std::vector<uint64_t> &parents, std::vector<size_t> &indices, page_type node_page);
+
+            void borrow_left(const page_type &parent_page, size_t index);
+
+            void borrow_right(const page_type &parent_page, size_t index);
+
+            void merge_children(const page_type &parent_page, size_t index);
+
+#ifdef TEST
+            size_t depth(uint64_t id, bool &balanced);
+
+            bool is_full_enough(uint64_t id);
+#endif
+
+        public:
+            /**
+             * The size of a page, which is the size of a node rounded up to a multiple of 4096 bytes.
+             */
+            static constexpr size_t PAGE_SIZE = (std::max(sizeof(node_type), sizeof(PagedBTreeHeader)) + 4095) / 4096 * 4096;
+
+            /**
+             * The fewest frames a tree works with. Besides the header, at most three nodes are pinned at
+             * once, such as a node, its sibling and their parent during a rebalance.
+             */
+            static constexpr size_t MIN_FRAMES = 4;
+
+            /**
+             * Opens the tree in the file at the given path, or creates it if the file is empty or doesn't
+             * exist, with room for `frame_count` pages in memory. Throws if `frame_count` is less than
+             * MIN_FRAMES, or if the file holds something else, or a tree with different types or a
+             * different N.
+             */
+            PagedBTree(const char * path, size_t frame_count = 64);
+
+            PagedBTree(const PagedBTree<K, V, N> &other) = delete;
+
+            PagedBTree(PagedBTree<K, V, N> &&other) = delete;
+
+            void operator=(const PagedBTree<K, V, N> &other) = delete;
+
+            void operator=(PagedBTree<K, V, N> &&other) = delete;
+
+            std::optional<V> get(const K &key);
+
+            /**
+             * Inserts a KV pair into the btree. If the key already exists, returns the previous value and
+             * replaces it.
+             */
+            std::optional<V> put(const K key, const V val);
+
+            std::optional<V> del(const K key);
+
+            size_t size() const;
+
+            /**
+             * Writes every changed page to the file and syncs it.
+             */
+            void flush();
+
+            /**
+             * Returns the number of pages in the file, including the header and free pages.
+             */
+            size_t page_count() const;
+
+            const BufferPool &buffer_pool() const;
+
+#ifdef TEST
+            /**
+             * Checks that every leaf is at the same depth.
+             */
+            bool is_balanced();
+
+            /**
+             * Checks that every node other than the root has at least `MIN_KEYS` keys, and that every
+             * child of an internal node exists.
+             */
+            bool is_full_enough();
+#endif
+    };
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PagedBTree<K, V, N>::PagedBTree(const char * path, size_t frame_count) : pool(path, PAGE_SIZE, frame_count), header_page() {
+    if (frame_count < MIN_FRAMES) {
+        throw "Paged btree needs more buffer pool frames";
+    }
+
+    this->header_page = this->pool.pin(0);
+
+    PagedBTreeHeader * header = this->header();
+
+    if (!header->magic) {
+        // A new file, which reads as zeros
+        header->magic = PagedBTreeHeader::MAGIC;
+        header->version = PagedBTreeHeader::VERSION;
+        header->page_size = PAGE_SIZE;
+        header->key_size = sizeof(K);
+        header->val_size = sizeof(V);
+        header->order = N;
+        header->len = 0;
+        header->page_count = 1;
+        header->free_head = 0;
+        header->root = this->new_node().id();
+        this->header_page.mark_dirty();
+
+        return;
+    }
+
+    if (header->magic != PagedBTreeHeader::MAGIC || header->version != PagedBTreeHeader::VERSION) {
+        throw "Not a paged btree";
+    }
+
+    if (header->page_size != PAGE_SIZE || header->key_size != sizeof(K) || header->val_size != sizeof(V) || header->order != N) {
+        throw "Paged btree has different key or value types, or a different order";
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PagedBTreeHeader * data::PagedBTree<K, V, N>::header() const {
+    return this->header_page.template as<PagedBTreeHeader>();
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PagedBTreeNode<K, V, N> * data::PagedBTree<K, V, N>::node(const page_type &page) {
+    return page.template as<node_type>();
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::PagedBTree<K, V, N>::page_type data::PagedBTree<K, V, N>::new_node() {
+    PagedBTreeHeader * header = this->header();
+    page_type page;
+
+    if (header->free_head) {
+        page = this->pool.pin(header->free_head);
+        memcpy(&header->free_head, page.data(), sizeof(uint64_t));
+    } else {
+        page = this->pool.pin(header->page_count++);
+    }
+
+    this->header_page.mark_dirty();
+    new (page.data()) node_type();
+    page.mark_dirty();
+
+    return page;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PagedBTree<K, V, N>::free_node(uint64_t id) {
+    PagedBTreeHeader * header = this->header();
+    page_type page = this->pool.pin(id);
+
+    memcpy(page.data(), &header->free_head, sizeof(uint64_t));
+    page.mark_dirty();
+    header->free_head = id;
+    this->header_page.mark_dirty();
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::PagedBTree<K, V, N>::get(const K &key) {
+    page_type page = this->pool.pin(this->header()->root);
+
+    while (true) {
+        const node_type * curr_node = node(page);
+        const size_t index = curr_node->keys.lower_bound(key);
+
+        if (index < curr_node->keys.size() && curr_node->keys[index] == key) {
+            return std::optional(curr_node->vals[index]);
+        }
+
+        if (curr_node->is_leaf()) {
+            return std::nullopt;
+        }
+
+        page = this->pool.pin(curr_node->children[index]);
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::PagedBTree<K, V, N>::put(const K key, const V val) {
+    std::vector<uint64_t> parents;
+    page_type page = this->pool.pin(this->header()->root);
+    node_type * curr_node;
+
+    while (true) {
+        curr_node = node(page);
+        const size_t index = curr_node->keys.lower_bound(key);
+
+        if (index < curr_node->keys.size() && curr_node->keys[index] == key) {
+            const V old_val = curr_node->vals[index];
+            curr_node->vals[index] = val;
+            page.mark_dirty();
+
+            return std::optional<V>(old_val);
+        }
+
+        if (curr_node->is_leaf()) {
+            break;
+        }
+
+        parents.push_back(page.id());
+        page = this->pool.pin(curr_node->children[index]);
+    }
+
+    curr_node->put(key, val);
+    page.mark_dirty();
+    this->header()->len++;
+    this->header_page.mark_dirty();
+
+    if (curr_node->is_overflowed()) {
+        this->split_node(parents, std::move(page));
+    }
+
+    return std::nullopt;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PagedBTree<K, V, N>::split_node(std::vector<uint64_t> &parents, page_type left_page) {
+    while (true) {
+        page_type right_page = this->new_node();
+        node_type * left_node = node(left_page);
+        node_type * right_node = node(right_page);
+
+        right_node->keys = left_node->keys.split_off(N / 2 + 1);
+
+        for (size_t i = 0; i < right_node->keys.size(); i++) {
+            right_node->vals[i] = std::move(left_node->vals[N / 2 + 1 + i]);
+        }
+
+        if (!left_node->is_leaf()) {
+            for (size_t i = 0; i <= right_node->keys.size(); i++) {
+                right_node->children[i] = left_node->children[N / 2 + 1 + i];
+                left_node->children[N / 2 + 1 + i] = 0;
+            }
+        }
+
+        // The pivot is now the last key in the left node, and its right child has already moved
+        const K pivot_key = left_node->keys[N / 2];
+        V pivot_val = left_node->del(N / 2);
+
+        left_page.mark_dirty();
+
+        if (!parents.size()) {
+            page_type root_page = this->new_node();
+            node_type * new_root = node(root_page);
+
+            new_root->children[0] = left_page.id();
+            new_root->put(pivot_key, std::move(pivot_val), right_page.id());
+            this->header()->root = root_page.id();
+            this->header_page.mark_dirty();
+
+            return;
+        }
+
+        const uint64_t right_id = right_page.id();
+
+        // Only the parent is changed from here on
+        left_page.reset();
+        right_page.reset();
+
+        page_type parent_page = this->pool.pin(parents.back());
+        parents.pop_back();
+
+        node_type * parent = node(parent_page);
+
+        parent->put(pivot_key, std::move(pivot_val), right_id);
+        parent_page.mark_dirty();
+
+        if (!parent->is_overflowed()) {
+            return;
+        }
+
+        left_page = std::move(parent_page);
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::PagedBTree<K, V, N>::del(const K key) {
+    std::vector<uint64_t> parents;
+    std::vector<size_t> indices;
+    page_type page = this->pool.pin(this->header()->root);
+    node_type * curr_node = node(page);
+    size_t index = curr_node->keys.lower_bound(key);
+
+    while (index == curr_node->keys.size() || !(curr_node->keys[index] == key)) {
+        if (curr_node->is_leaf()) {
+            return std::nullopt;
+        }
+
+        parents.push_back(page.id());
+        indices.push_back(index);
+        page = this->pool.pin(curr_node->children[index]);
+        curr_node = node(page);
+        index = curr_node->keys.lower_bound(key);
+    }
+
+    std::optional<V> out = std::optional<V>(curr_node->vals[index]);
+    this->header()->len--;
+    this->header_page.mark_dirty();
+
+    if (curr_node->is_leaf()) {
+        curr_node->del(index);
+        page.mark_dirty();
+        this->rebalance(parents, indices, std::move(page));
+
+        return out;
+    }
+
+    // Replace an internal key with its predecessor or successor, like BTree::del
+    const uint64_t key_id = page.id();
+    page_type left_page = this->pool.pin(curr_node->children[index]);
+    page_type right_page = this->pool.pin(curr_node->children[index + 1]);
+    const bool from_left = node(left_page)->keys.size() > MIN_KEYS || node(right_page)->keys.size() <= MIN_KEYS;
+
+    parents.push_back(key_id);
+    page.reset();
+
+    if (from_left) {
+        right_page.reset();
+        indices.push_back(index);
+        page = std::move(left_page);
+
+        while (!node(page)->is_leaf()) {
+            const size_t last = node(page)->keys.size();
+
+            parents.push_back(page.id());
+            indices.push_back(last);
+            page = this->pool.pin(node(page)->children[last]);
+        }
+    } else {
+        left_page.reset();
+        indices.push_back(index + 1);
+        page = std::move(right_page);
+
+        while (!node(page)->is_leaf()) {
+            parents.push_back(page.id());
+            indices.push_back(0);
+            page = this->pool.pin(node(page)->children[0]);
+        }
+    }
+
+    {
+        const page_type key_page = this->pool.pin(key_id);
+        node_type * key_node = node(key_page);
+        const size_t pos = from_left ? node(page)->keys.size() - 1 : 0;
+
+        curr_node = node(page);
+        key_node->keys[index] = curr_node->keys[pos];
+        key_node->vals[index] = curr_node->del(pos);
+        key_page.mark_dirty();
+    }
+
+    page.mark_dirty();
+    this->rebalance(parents, indices, std::move(page));
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PagedBTree<K, V, N>::rebalance(std::vector<uint64_t> &parents, std::vector<size_t> &indices, page_type node_page) {
+    while (node_page.id() != this->header()->root && node(node_page)->keys.size() < MIN_KEYS) {
+        page_type parent_page = this->pool.pin(parents.back());
+        const size_t index = indices.back();
+        parents.pop_back();
+        indices.pop_back();
+
+        const node_type * parent = node(parent_page);
+
+        if (index > 0 && node(this->pool.pin(parent->children[index - 1]))->keys.size() > MIN_KEYS) {
+            this->borrow_left(parent_page, index);
+            return;
+        }
+
+        if (index < parent->keys.size() && node(this->pool.pin(parent->children[index + 1]))->keys.size() > MIN_KEYS) {
+            this->borrow_right(parent_page, index);
+            return;
+        }
+
+        // The node may be the one that is merged away, so let go of it first
+        node_page.reset();
+
+        if (index > 0) {
+            this->merge_children(parent_page, index - 1);
+        } else {
+            this->merge_children(parent_page, index);
+        }
+
+        node_page = std::move(parent_page);
+    }
+
+    node_page.reset();
+
+    page_type root_page = this->pool.pin(this->header()->root);
+    node_type * root = node(root_page);
+
+    if (!root->keys.size() && !root->is_leaf()) {
+        // The root lost its last key in a merge, so its only child becomes the new root
+        const uint64_t old_root = root_page.id();
+
+        this->header()->root = root->children[0];
+        this->header_page.mark_dirty();
+        root_page.reset();
+        this->free_node(old_root);
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PagedBTree<K, V, N>::borrow_left(const page_type &parent_page, size_t index) {
+    node_type * parent = node(parent_page);
+    page_type left_page = this->pool.pin(parent->children[index - 1]);
+    page_type node_page = this->pool.pin(parent->children[index]);
+    node_type * left = node(left_page);
+    node_type * curr_node = node(node_page);
+    const size_t last = left->keys.size() - 1;
+    const uint64_t moved_child = left->children[last + 1];
+
+    // The separator goes to the front of the node, and the last child of `left` goes before it
+    curr_node->put(parent->keys[index - 1], parent->vals[index - 1], curr_node->children[0]);
+    curr_node->children[0] = moved_child;
+
+    parent->keys[index - 1] = left->keys[last];
+    parent->vals[index - 1] = left->del(last);
+
+    parent_page.mark_dirty();
+    left_page.mark_dirty();
+    node_page.mark_dirty();
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PagedBTree<K, V, N>::borrow_right(const page_type &parent_page, size_t index) {
+    node_type * parent = node(parent_page);
+    page_type node_page = this->pool.pin(parent->children[index]);
+    page_type right_page = this->pool.pin(parent->children[index + 1]);
+    node_type * curr_node = node(node_page);
+    node_type * right = node(right_page);
+
+    curr_node->put(parent->keys[index], parent->vals[index], right->children[0]);
+
+    // Removing the first key of `right` drops the child after it, so shift that child into first place
+    right->children[0] = right->children[1];
+    parent->keys[index] = right->keys[0];
+    parent->vals[index] = right->del(0);
+
+    parent_page.mark_dirty();
+    node_page.mark_dirty();
+    right_page.mark_dirty();
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PagedBTree<K, V, N>::merge_children(const page_type &parent_page, size_t index) {
+    node_type * parent = node(parent_page);
+    page_type left_page = this->pool.pin(parent->children[index]);
+    page_type right_page = this->pool.pin(parent->children[index + 1]);
+    node_type * left = node(left_page);
+    node_type * right = node(right_page);
+    const K sep_key = parent->keys[index];
+
+    // Removing the separator also unlinks `right`, which was the child after it
+    left->put(sep_key, parent->del(index), right->children[0]);
+
+    for (size_t i = 0; i < right->keys.size(); i++) {
+        left->put(right->keys[i], right->vals[i], right->children[i + 1]);
+    }
+
+    parent_page.mark_dirty();
+    left_page.mark_dirty();
+
+    const uint64_t right_id = right_page.id();
+    right_page.reset();
+    this->free_node(right_id);
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::PagedBTree<K, V, N>::size() const {
+    return this->header()->len;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PagedBTree<K, V, N>::flush() {
+    this->pool.flush();
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::PagedBTree<K, V, N>::page_count() const {
+    return this->header()->page_count;
+}
+
+template <data::Ord K, typename V, const size_t N>
+const data::BufferPool &data::PagedBTree<K, V, N>::buffer_pool() const {
+    return this->pool;
+}
+
+#ifdef TEST
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::PagedBTree<K, V, N>::depth(uint64_t id, bool &balanced) {
+    // Only one page on the path is pinned at a time, so this works with any number of frames
+    std::vector<uint64_t> children;
+
+    {
+        const page_type page = this->pool.pin(id);
+        const node_type * curr_node = node(page);
+
+        if (curr_node->is_leaf()) {
+            return 1;
+        }
+
+        children.assign(curr_node->children, curr_node->children + curr_node->keys.size() + 1);
+    }
+
+    const size_t first = this->depth(children[0], balanced);
+
+    for (size_t i = 1; i < children.size(); i++) {
+        balanced = balanced && this->depth(children[i], balanced) == first;
+    }
+
+    return first + 1;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::PagedBTree<K, V, N>::is_balanced() {
+    bool balanced = true;
+
+    this->depth(this->header()->root, balanced);
+
+    return balanced;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::PagedBTree<K, V, N>::is_full_enough(uint64_t id) {
+    std::vector<uint64_t> children;
+
+    {
+        const page_type page = this->pool.pin(id);
+        const node_type * curr_node = node(page);
+        const bool is_root = id == this->header()->root;
+
+        if (!is_root && curr_node->keys.size() < MIN_KEYS) {
+            return false;
+        }
+
+        if (curr_node->is_leaf()) {
+            return true;
+        }
+
+        children.assign(curr_node->children, curr_node->children + curr_node->keys.size() + 1);
+    }
+
+    for (uint64_t child : children) {
+        if (!child || !this->is_full_enough(child)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::PagedBTree<K, V, N>::is_full_enough() {
+    return this->is_full_enough(this->header()->root);
+}
+
+#endif
+#endif
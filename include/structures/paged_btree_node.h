@@ -0,0 +1,113 @@
+#ifndef INCLUDE_STRUCTURES_PAGED_BTREE_NODE_H
+#define INCLUDE_STRUCTURES_PAGED_BTREE_NODE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <utility>
+
+#include "sorted_array.h"
+#include "../traits.h"
+
+namespace data {
+    /**
+     * The first page of a paged btree's file.
+     */
+    struct PagedBTreeHeader {
+        // Spells "PAGEDBTR" when read in the byte order the file was written in
+        static constexpr uint64_t MAGIC = 0x5254424445474150ull;
+        static constexpr uint32_t VERSION = 1;
+
+        uint64_t magic;
+        uint32_t version;
+        uint32_t page_size;
+        uint16_t key_size;
+        uint16_t val_size;
+        uint32_t order;
+        uint64_t root;
+        uint64_t len;
+        // Number of pages in the file, including the header and free pages
+        uint64_t page_count;
+        // First page in the list of freed pages, or 0 if there is none. Each free page starts with the
+        // id of the next one.
+        uint64_t free_head;
+    };
+
+    /**
+     * A btree node that lives in a page of a file. It has the same layout as a BTreeNode, with keys in
+     * a SortedArray, but its children are page ids instead of pointers, so a node can be written to
+     * disk and read back as it is. Page 0 holds the header, so a child id of 0 means there is no child.
+     *
+     * A node doesn't own its children. The tree frees their pages.
+     */
+    template <PartialOrd K, typename V, const size_t N>
+    struct PagedBTreeNode {
+        static constexpr size_t CACHE_LINE = 64;
+
+        alignas(CACHE_LINE) SortedArray<K, N> keys;
+        alignas(CACHE_LINE) uint64_t children[N + 1];
+        alignas(CACHE_LINE) V vals[N];
+
+        PagedBTreeNode();
+
+        bool is_leaf() const;
+
+        bool is_overflowed() const;
+
+        /**
+         * Inserts a key that is not in the node along with the child to its right, and returns the
+         * key's index.
+         */
+        size_t put(const K &key, V val, uint64_t right = 0);
+
+        /**
+         * Removes the key at the given index and returns its value. The child to the right of the key
+         * is dropped from the node, so the caller must take it first.
+         */
+        V del(size_t index);
+    };
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+data::PagedBTreeNode<K, V, N>::PagedBTreeNode() : keys(), children{} {}
+
+template <data::PartialOrd K, typename V, const size_t N>
+bool data::PagedBTreeNode<K, V, N>::is_leaf() const {
+    return !this->children[0];
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+bool data::PagedBTreeNode<K, V, N>::is_overflowed() const {
+    return this->keys.size() == N;
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+size_t data::PagedBTreeNode<K, V, N>::put(const K &key, V val, uint64_t right) {
+    const size_t index = this->keys.put(key);
+
+    for (size_t i = this->keys.size() - 1; i > index; i--) {
+        this->vals[i] = std::move(this->vals[i - 1]);
+        this->children[i + 1] = this->children[i];
+    }
+
+    this->vals[index] = std::move(val);
+    this->children[index + 1] = right;
+
+    return index;
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+V data::PagedBTreeNode<K, V, N>::del(size_t index) {
+    V out = std::move(this->vals[index]);
+
+    for (size_t i = index; i + 1 < this->keys.size(); i++) {
+        this->vals[i] = std::move(this->vals[i + 1]);
+        this->children[i + 1] = this->children[i + 2];
+    }
+
+    this->children[this->keys.size()] = 0;
+    this->keys.del(index);
+
+    return out;
+}
+
+#endif
@@ -0,0 +1,604 @@
+#ifndef INCLUDE_STRUCTURES_PERSISTENT_BTREE_H
+#define INCLUDE_STRUCTURES_PERSISTENT_BTREE_H
+
+#include <optional>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+#include "persistent_btree_iterator.h"
+#include "persistent_btree_node.h"
+#include "../traits.h"
+
+#ifdef TEST
+#include <unordered_set>
+#endif
+
+namespace data {
+    /**
+     * A btree whose snapshots are O(1). Copying the tree doesn't copy any nodes: the copy shares the
+     * original's root, and each node counts how many parents and trees point to it. A write copies the
+     * shared nodes on the path it changes before changing them, so neither tree sees the other's writes,
+     * and everything off that path stays shared. A node that only one tree can reach is changed in place,
+     * so a tree without snapshots does no more copying than a BTree.
+     *
+     * The shape of the tree and the way it splits, borrows and merges are the same as BTree. Since
+     * shared nodes and values are copied, V must be copyable.
+     *
+     * One tree must not be used by two threads at once, but trees that share nodes can be used on
+     * different threads. A snapshot can be handed to another thread and read there while the original
+     * tree keeps changing.
+     */
+    template <Ord K, typename V, const size_t N>
+    class PersistentBTree {
+        private:
+            typedef PersistentBTreeNode<K, V, N> node_type;
+
+            /**
+             * The minimum number of keys in any node other than the root. See BTree::MIN_KEYS.
+             */
+            static constexpr size_t MIN_KEYS = N / 2 > 1 ? N / 2 - 1 : 1;
+
+            static_assert(N >= 3, "A btree node needs room for at least 3 keys");
+
+            node_type * root;
+            size_t len;
+
+            /**
+             * Makes sure that this tree is the only thing pointing to the node in `slot`, copying it into
+             * `slot` if it was shared. The caller must already own the node that `slot` is in.
+             */
+            static node_type * unshare(node_type *& slot);
+
+            /**
+             * Returns an empty root that moved-from trees share, so that moving a tree doesn't allocate.
+             * It holds a reference of its own, so it is never freed, and a write always copies it.
+             */
+            static node_type * empty_root();
+
+            void split_node(std::vector<node_type *> &parents, node_type * node);
+
+            /**
+             * Restores the minimum occupancy of `node` after a key was removed from it. `parents` and
+             * `indices` are the path from the root to `node`, and every node on it is owned by this tree.
+             */
+            void rebalance(std::vector<node_type *> &parents, std::vector<size_t> &indices, node_type * node);
+
+            void borrow_left(node_type * parent, size_t index);
+
+            void borrow_right(node_type * parent, size_t index);
+
+            void merge_children(node_type * parent, size_t index);
+
+        public:
+            typedef PersistentBTreeIterator<K, V, N> iterator;
+
+            PersistentBTree();
+
+            /**
+             * Takes a snapshot of another tree without copying any nodes.
+             */
+            PersistentBTree(const PersistentBTree<K, V, N> &other);
+
+            PersistentBTree(PersistentBTree<K, V, N> &&other) noexcept;
+
+            PersistentBTree<K, V, N>& operator=(const PersistentBTree<K, V, N> &other);
+
+            PersistentBTree<K, V, N>& operator=(PersistentBTree<K, V, N> &&other) noexcept;
+
+            ~PersistentBTree();
+
+            /**
+             * Returns a snapshot of the tree in O(1) time. Later writes to either tree are not seen by
+             * the other.
+             */
+            PersistentBTree<K, V, N> snapshot() const;
+
+            std::optional<V> get(const K &key) const;
+
+            /**
+             * Inserts a KV pair into the btree. If the key already exists, returns the previous value and
+             * replaces it.
+             */
+            std::optional<V> put(const K key, const V val);
+
+            std::optional<V> del(const K key);
+
+            size_t size() const;
+
+            iterator begin() const;
+
+            iterator end() const;
+
+            /**
+             * Returns an iterator at the first entry whose key is not less than the given key.
+             */
+            iterator lower_bound(const K &key) const;
+
+#ifdef TEST
+            /**
+             * Checks that the keys are in order, that every leaf is at the same depth, that every node
+             * other than the root has at least `MIN_KEYS` keys, and that the size is right.
+             */
+            bool is_valid() const;
+
+            /**
+             * Returns the number of levels in the btree. A btree whose root is a leaf has height 1.
+             */
+            size_t height() const;
+
+            /**
+             * Returns the number of nodes in this tree that are not shared with another tree.
+             */
+            size_t unshared_nodes(const PersistentBTree<K, V, N> &other) const;
+#endif
+    };
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTree<K, V, N>::PersistentBTree() : root(new node_type()), len(0) {}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTree<K, V, N>::PersistentBTree(const PersistentBTree<K, V, N> &other) : root(other.root), len(other.len) {
+    node_type::retain(this->root);
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTree<K, V, N>::PersistentBTree(PersistentBTree<K, V, N> &&other) noexcept : root(other.root), len(other.len) {
+    other.root = empty_root();
+    other.len = 0;
+    node_type::retain(other.root);
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTree<K, V, N>& data::PersistentBTree<K, V, N>::operator=(const PersistentBTree<K, V, N> &other) {
+    // Retain first in case both trees already share the root
+    node_type::retain(other.root);
+    node_type::release(this->root);
+
+    this->root = other.root;
+    this->len = other.len;
+
+    return *this;
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTree<K, V, N>& data::PersistentBTree<K, V, N>::operator=(PersistentBTree<K, V, N> &&other) noexcept {
+    std::swap(this->root, other.root);
+    std::swap(this->len, other.len);
+
+    return *this;
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTree<K, V, N>::~PersistentBTree() {
+    node_type::release(this->root);
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTree<K, V, N> data::PersistentBTree<K, V, N>::snapshot() const {
+    return PersistentBTree<K, V, N>(*this);
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::PersistentBTree<K, V, N>::node_type * data::PersistentBTree<K, V, N>::unshare(node_type *& slot) {
+    // Another tree could drop its reference at any time, but if the count is 1 then no other tree can
+    // reach the node to add one
+    if (slot->refs.load(std::memory_order_acquire) == 1) {
+        return slot;
+    }
+
+    node_type * copy = new node_type(*slot);
+    node_type::release(slot);
+    slot = copy;
+
+    return copy;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::PersistentBTree<K, V, N>::node_type * data::PersistentBTree<K, V, N>::empty_root() {
+    static node_type * const root = new node_type();
+
+    return root;
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::PersistentBTree<K, V, N>::get(const K &key) const {
+    const node_type * node = this->root;
+
+    while (true) {
+        const size_t index = node->keys.lower_bound(key);
+
+        if (index < node->keys.size() && node->keys[index] == key) {
+            return std::optional<V>(node->vals[index]);
+        }
+
+        if (node->is_leaf()) {
+            return std::nullopt;
+        }
+
+        node = node->children[index];
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::PersistentBTree<K, V, N>::put(const K key, const V val) {
+    std::vector<node_type *> parents;
+    node_type * node = unshare(this->root);
+
+    // Every write changes the path to the key, so the path can be copied on the way down
+    while (true) {
+        const size_t index = node->keys.lower_bound(key);
+
+        if (index < node->keys.size() && node->keys[index] == key) {
+            std::optional<V> old_val = std::optional<V>(std::move(node->vals[index]));
+            node->vals[index] = val;
+
+            return old_val;
+        }
+
+        if (node->is_leaf()) {
+            break;
+        }
+
+        parents.push_back(node);
+        node = unshare(node->children[index]);
+    }
+
+    node->put(key, val);
+    this->len++;
+
+    if (node->is_overflowed()) {
+        this->split_node(parents, node);
+    }
+
+    return std::nullopt;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PersistentBTree<K, V, N>::split_node(std::vector<node_type *> &parents, node_type * node) {
+    while (node->is_overflowed()) {
+        const size_t mid = N / 2;
+        node_type * right = new node_type();
+
+        right->keys = node->keys.split_off(mid + 1);
+
+        for (size_t i = 0; i < right->keys.size(); i++) {
+            right->vals[i] = std::move(node->vals[mid + 1 + i]);
+        }
+
+        if (!node->is_leaf()) {
+            // The children move without changing their counts, since each still has one parent
+            for (size_t i = 0; i <= right->keys.size(); i++) {
+                right->children[i] = node->children[mid + 1 + i];
+                node->children[mid + 1 + i] = nullptr;
+            }
+        }
+
+        const K pivot_key = node->keys[mid];
+        V pivot_val = node->del(mid);
+
+        // `del` dropped the child to the right of the pivot, but it already moved to `right`
+        if (!parents.size()) {
+            node_type * new_root = new node_type();
+            new_root->children[0] = node;
+            new_root->put(pivot_key, std::move(pivot_val), right);
+            this->root = new_root;
+
+            return;
+        }
+
+        node_type * parent = parents.back();
+        parents.pop_back();
+        parent->put(pivot_key, std::move(pivot_val), right);
+        node = parent;
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+std::optional<V> data::PersistentBTree<K, V, N>::del(const K key) {
+    std::vector<size_t> indices;
+    const node_type * curr_node = this->root;
+    size_t index = curr_node->keys.lower_bound(key);
+
+    // Find the key without copying anything, so that deleting a missing key leaves every node shared
+    while (index == curr_node->keys.size() || !(curr_node->keys[index] == key)) {
+        if (curr_node->is_leaf()) {
+            return std::nullopt;
+        }
+
+        indices.push_back(index);
+        curr_node = curr_node->children[index];
+        index = curr_node->keys.lower_bound(key);
+    }
+
+    // Now copy the path to the key
+    std::vector<node_type *> parents;
+    node_type * key_node = unshare(this->root);
+
+    for (size_t i : indices) {
+        parents.push_back(key_node);
+        key_node = unshare(key_node->children[i]);
+    }
+
+    std::optional<V> out = std::optional<V>(key_node->vals[index]);
+    this->len--;
+
+    if (key_node->is_leaf()) {
+        key_node->del(index);
+        this->rebalance(parents, indices, key_node);
+
+        return out;
+    }
+
+    // Replace an internal key with its predecessor or successor, as BTree does, copying the path to
+    // the leaf that it comes from
+    node_type * node = key_node;
+    parents.push_back(key_node);
+
+    if (key_node->children[index]->keys.size() > MIN_KEYS || key_node->children[index + 1]->keys.size() <= MIN_KEYS) {
+        indices.push_back(index);
+        node = unshare(key_node->children[index]);
+
+        while (!node->is_leaf()) {
+            parents.push_back(node);
+            indices.push_back(node->keys.size());
+            node = unshare(node->children[node->keys.size()]);
+        }
+
+        const size_t last = node->keys.size() - 1;
+        key_node->keys[index] = node->keys[last];
+        key_node->vals[index] = node->del(last);
+    } else {
+        indices.push_back(index + 1);
+        node = unshare(key_node->children[index + 1]);
+
+        while (!node->is_leaf()) {
+            parents.push_back(node);
+            indices.push_back(0);
+            node = unshare(node->children[0]);
+        }
+
+        key_node->keys[index] = node->keys[0];
+        key_node->vals[index] = node->del(0);
+    }
+
+    this->rebalance(parents, indices, node);
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PersistentBTree<K, V, N>::rebalance(std::vector<node_type *> &parents, std::vector<size_t> &indices, node_type * node) {
+    while (node != this->root && node->keys.size() < MIN_KEYS) {
+        node_type * parent = parents.back();
+        const size_t index = indices.back();
+        parents.pop_back();
+        indices.pop_back();
+
+        if (index > 0 && parent->children[index - 1]->keys.size() > MIN_KEYS) {
+            this->borrow_left(parent, index);
+            return;
+        }
+
+        if (index < parent->keys.size() && parent->children[index + 1]->keys.size() > MIN_KEYS) {
+            this->borrow_right(parent, index);
+            return;
+        }
+
+        if (index > 0) {
+            this->merge_children(parent, index - 1);
+        } else {
+            this->merge_children(parent, index);
+        }
+
+        node = parent;
+    }
+
+    if (!this->root->keys.size() && !this->root->is_leaf()) {
+        // The root lost its last key in a merge, so its only child becomes the new root. The child's
+        // reference moves from the old root to the tree.
+        node_type * old_root = this->root;
+        this->root = old_root->children[0];
+        old_root->children[0] = nullptr;
+
+        node_type::release(old_root);
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PersistentBTree<K, V, N>::borrow_left(node_type * parent, size_t index) {
+    node_type * left = unshare(parent->children[index - 1]);
+    node_type * node = parent->children[index];
+    const size_t last = left->keys.size() - 1;
+    node_type * moved_child = left->children[last + 1];
+
+    // The separator goes to the front of `node`, and the last child of `left` goes before it
+    node->put(parent->keys[index - 1], std::move(parent->vals[index - 1]), node->children[0]);
+    node->children[0] = moved_child;
+
+    parent->keys[index - 1] = left->keys[last];
+    parent->vals[index - 1] = left->del(last);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PersistentBTree<K, V, N>::borrow_right(node_type * parent, size_t index) {
+    node_type * node = parent->children[index];
+    node_type * right = unshare(parent->children[index + 1]);
+    node_type * moved_child = right->children[0];
+
+    node->put(parent->keys[index], std::move(parent->vals[index]), moved_child);
+
+    // Removing the first key of `right` drops the child after it, so shift that child into first place
+    right->children[0] = right->children[1];
+    parent->keys[index] = right->keys[0];
+    parent->vals[index] = right->del(0);
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PersistentBTree<K, V, N>::merge_children(node_type * parent, size_t index) {
+    node_type * left = unshare(parent->children[index]);
+    node_type * right = parent->children[index + 1];
+    const K sep_key = parent->keys[index];
+    V sep_val = parent->del(index);
+
+    // `right` may still be shared, so its entries are copied and its children gain a parent. Releasing
+    // it afterwards takes those references back if nothing else was using it.
+    left->put(sep_key, std::move(sep_val), right->children[0]);
+
+    for (size_t i = 0; i < right->keys.size(); i++) {
+        left->put(right->keys[i], right->vals[i], right->children[i + 1]);
+    }
+
+    if (!right->is_leaf()) {
+        for (size_t i = 0; i <= right->keys.size(); i++) {
+            node_type::retain(right->children[i]);
+        }
+    }
+
+    node_type::release(right);
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::PersistentBTree<K, V, N>::size() const {
+    return this->len;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::PersistentBTree<K, V, N>::iterator data::PersistentBTree<K, V, N>::begin() const {
+    iterator it;
+    it.push_first(this->root);
+
+    return it;
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::PersistentBTree<K, V, N>::iterator data::PersistentBTree<K, V, N>::end() const {
+    return iterator();
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::PersistentBTree<K, V, N>::iterator data::PersistentBTree<K, V, N>::lower_bound(const K &key) const {
+    iterator it;
+    it.seek(this->root, key);
+
+    return it;
+}
+
+#ifdef TEST
+template <data::Ord K, typename V, const size_t N>
+bool data::PersistentBTree<K, V, N>::is_valid() const {
+    struct Frame {
+        const node_type * node;
+        size_t depth;
+        const K * lo;
+        const K * hi;
+    };
+
+    std::vector<Frame> stack = { { this->root, 1, nullptr, nullptr } };
+    size_t leaf_depth = 0;
+    size_t count = 0;
+
+    while (stack.size()) {
+        const Frame frame = stack.back();
+        const node_type * node = frame.node;
+        stack.pop_back();
+
+        if (node != this->root && node->keys.size() < MIN_KEYS) {
+            return false;
+        }
+
+        if (node->refs.load() == 0) {
+            return false;
+        }
+
+        for (size_t i = 0; i < node->keys.size(); i++) {
+            if ((frame.lo && !(*frame.lo < node->keys[i])) || (frame.hi && !(node->keys[i] < *frame.hi))) {
+                return false;
+            }
+
+            if (i > 0 && !(node->keys[i - 1] < node->keys[i])) {
+                return false;
+            }
+        }
+
+        count += node->keys.size();
+
+        if (node->is_leaf()) {
+            if (leaf_depth && leaf_depth != frame.depth) {
+                return false;
+            }
+
+            leaf_depth = frame.depth;
+            continue;
+        }
+
+        for (size_t i = 0; i <= node->keys.size(); i++) {
+            if (!node->children[i]) {
+                return false;
+            }
+
+            const K * lo = i > 0 ? &node->keys[i - 1] : frame.lo;
+            const K * hi = i < node->keys.size() ? &node->keys[i] : frame.hi;
+
+            stack.push_back({ node->children[i], frame.depth + 1, lo, hi });
+        }
+    }
+
+    return count == this->len;
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::PersistentBTree<K, V, N>::height() const {
+    size_t out = 1;
+
+    for (const node_type * node = this->root; !node->is_leaf(); node = node->children[0]) {
+        out++;
+    }
+
+    return out;
+}
+
+template <data::Ord K, typename V, const size_t N>
+size_t data::PersistentBTree<K, V, N>::unshared_nodes(const PersistentBTree<K, V, N> &other) const {
+    std::unordered_set<const node_type *> others;
+    std::vector<const node_type *> stack = { other.root };
+
+    while (stack.size()) {
+        const node_type * node = stack.back();
+        stack.pop_back();
+        others.insert(node);
+
+        if (!node->is_leaf()) {
+            for (size_t i = 0; i <= node->keys.size(); i++) {
+                stack.push_back(node->children[i]);
+            }
+        }
+    }
+
+    // A shared node's whole subtree is shared, so there's no need to look below it
+    size_t out = 0;
+    stack = { this->root };
+
+    while (stack.size()) {
+        const node_type * node = stack.back();
+        stack.pop_back();
+
+        if (others.count(node)) {
+            continue;
+        }
+
+        out++;
+
+        if (!node->is_leaf()) {
+            for (size_t i = 0; i <= node->keys.size(); i++) {
+                stack.push_back(node->children[i]);
+            }
+        }
+    }
+
+    return out;
+}
+#endif
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef INCLUDE_STRUCTURES_PERSISTENT_BTREE_ITERATOR_H
+#define INCLUDE_STRUCTURES_PERSISTENT_BTREE_ITERATOR_H
+
+#include <iterator>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+#include "persistent_btree_node.h"
+#include "../traits.h"
+
+namespace data {
+    template <Ord K, typename V, const size_t N>
+    class PersistentBTree;
+
+    /**
+     * Forward iterator over the entries of a PersistentBTree in key order. The "value type" is a pair
+     * where the first item is a reference to the key and the second item is a const pointer to the value.
+     * Values can't be changed through the iterator because the nodes it visits may be shared with other
+     * versions of the tree.
+     *
+     * Like BTreeIterator, it keeps the path from the root to the current entry. Any change to the tree
+     * invalidates its iterators, but an iterator over a snapshot stays valid while the snapshot is alive,
+     * no matter what happens to the tree the snapshot was taken from.
+     */
+    template <Ord K, typename V, const size_t N>
+    class PersistentBTreeIterator {
+        private:
+            struct Frame {
+                const PersistentBTreeNode<K, V, N> * node;
+                size_t index;
+
+                bool operator==(const Frame &other) const = default;
+            };
+
+            // Empty at the end
+            std::vector<Frame> path;
+
+            /**
+             * Follows the first children down from `node` and stops at its first entry.
+             */
+            void push_first(const PersistentBTreeNode<K, V, N> * node);
+
+            /**
+             * Pops the current frame and any frames whose subtrees have been fully visited, stopping at
+             * the next entry in an ancestor.
+             */
+            void climb();
+
+            /**
+             * Moves to the first entry whose key is not less than `key`.
+             */
+            void seek(const PersistentBTreeNode<K, V, N> * root, const K &key);
+
+            constexpr void check_impl();
+
+            friend class PersistentBTree<K, V, N>;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<const K &, const V *>;
+            using difference_type = ptrdiff_t;
+            using pointer = value_type *;
+            using reference = value_type&;
+
+            /**
+             * Creates an end iterator.
+             */
+            PersistentBTreeIterator();
+
+            PersistentBTreeIterator<K, V, N>& operator++();
+
+            PersistentBTreeIterator<K, V, N> operator++(int);
+
+            bool operator==(const PersistentBTreeIterator<K, V, N> &it) const;
+
+            bool operator!=(const PersistentBTreeIterator<K, V, N> &it) const;
+
+            value_type operator*() const;
+    };
+}
+
+template <data::Ord K, typename V, const size_t N>
+constexpr void data::PersistentBTreeIterator<K, V, N>::check_impl() {
+    // See RadixTrieIterator::check_impl
+    static_assert(std::forward_iterator<PersistentBTreeIterator<K, V, N>>);
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTreeIterator<K, V, N>::PersistentBTreeIterator() : path() {
+    this->check_impl();
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PersistentBTreeIterator<K, V, N>::push_first(const PersistentBTreeNode<K, V, N> * node) {
+    while (!node->is_leaf()) {
+        this->path.push_back({ node, 0 });
+        node = node->children[0];
+    }
+
+    if (node->keys.size()) {
+        this->path.push_back({ node, 0 });
+    } else {
+        // Only an empty root can be an empty leaf
+        this->path.clear();
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PersistentBTreeIterator<K, V, N>::climb() {
+    this->path.pop_back();
+
+    while (this->path.size() && this->path.back().index == this->path.back().node->keys.size()) {
+        this->path.pop_back();
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+void data::PersistentBTreeIterator<K, V, N>::seek(const PersistentBTreeNode<K, V, N> * root, const K &key) {
+    const PersistentBTreeNode<K, V, N> * node = root;
+
+    while (true) {
+        const size_t index = node->keys.lower_bound(key);
+        this->path.push_back({ node, index });
+
+        if ((index < node->keys.size() && node->keys[index] == key) || node->is_leaf()) {
+            break;
+        }
+
+        node = node->children[index];
+    }
+
+    if (this->path.back().index == this->path.back().node->keys.size()) {
+        // Every key in the leaf is smaller, so the next entry is in an ancestor
+        this->climb();
+    }
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTreeIterator<K, V, N>& data::PersistentBTreeIterator<K, V, N>::operator++() {
+    if (!this->path.size()) {
+        return *this;
+    }
+
+    Frame &frame = this->path.back();
+
+    if (!frame.node->is_leaf()) {
+        // The next entry is the first one in the subtree after the current entry
+        frame.index++;
+        this->push_first(frame.node->children[frame.index]);
+
+        return *this;
+    }
+
+    if (frame.index + 1 < frame.node->keys.size()) {
+        frame.index++;
+
+        return *this;
+    }
+
+    this->climb();
+
+    return *this;
+}
+
+template <data::Ord K, typename V, const size_t N>
+data::PersistentBTreeIterator<K, V, N> data::PersistentBTreeIterator<K, V, N>::operator++(int) {
+    PersistentBTreeIterator<K, V, N> it = PersistentBTreeIterator<K, V, N>(*this);
+
+    ++(*this);
+
+    return it;
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::PersistentBTreeIterator<K, V, N>::operator==(const PersistentBTreeIterator<K, V, N> &it) const {
+    if (!this->path.size() || !it.path.size()) {
+        return this->path.size() == it.path.size();
+    }
+
+    return this->path.back() == it.path.back();
+}
+
+template <data::Ord K, typename V, const size_t N>
+bool data::PersistentBTreeIterator<K, V, N>::operator!=(const PersistentBTreeIterator<K, V, N> &it) const {
+    return !(*this == it);
+}
+
+template <data::Ord K, typename V, const size_t N>
+typename data::PersistentBTreeIterator<K, V, N>::value_type data::PersistentBTreeIterator<K, V, N>::operator*() const {
+    const Frame &frame = this->path.back();
+
+    return value_type(frame.node->keys[frame.index], &frame.node->vals[frame.index]);
+}
+
+#endif
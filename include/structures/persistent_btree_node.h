@@ -0,0 +1,152 @@
+#ifndef INCLUDE_STRUCTURES_PERSISTENT_BTREE_NODE_H
+#define INCLUDE_STRUCTURES_PERSISTENT_BTREE_NODE_H
+
+#include <atomic>
+#include <stdlib.h>
+#include <utility>
+
+#include "sorted_array.h"
+#include "../traits.h"
+
+namespace data {
+    /**
+     * A node in a PersistentBTree. Nodes are shared by every version of the tree that hasn't changed
+     * them, so a node counts the parents and trees that point to it and is only freed when the last one
+     * lets go. A node that is shared is never modified: a writer copies it first, and the copy shares
+     * the original's children.
+     *
+     * `vals[i]` is the value for `keys[i]`. `children[i]` holds the keys less than `keys[i]`, and
+     * `children[keys.size()]` holds the keys greater than the last key. Every child is null in a leaf.
+     *
+     * The count is atomic because snapshots can be released on other threads than the one writing.
+     */
+    template <PartialOrd K, typename V, const size_t N>
+    struct PersistentBTreeNode {
+        std::atomic<size_t> refs;
+        SortedArray<K, N> keys;
+        V vals[N];
+        PersistentBTreeNode<K, V, N> * children[N + 1];
+
+        PersistentBTreeNode();
+
+        /**
+         * Copies the keys and values of a node. The children are shared with `other`, not copied.
+         */
+        PersistentBTreeNode(const PersistentBTreeNode<K, V, N> &other);
+
+        PersistentBTreeNode(PersistentBTreeNode<K, V, N> &&other) = delete;
+
+        void operator=(const PersistentBTreeNode<K, V, N> &other) = delete;
+
+        /**
+         * Releases the children.
+         */
+        ~PersistentBTreeNode();
+
+        bool is_leaf() const;
+
+        bool is_overflowed() const;
+
+        /**
+         * Inserts a key that is not in the node along with the child to its right, and returns the
+         * key's index.
+         */
+        size_t put(const K &key, V val, PersistentBTreeNode<K, V, N> * right = nullptr);
+
+        /**
+         * Removes the key at the given index and returns its value. The child to the right of the key
+         * is dropped from the node without being released, so the caller must take it first.
+         */
+        V del(size_t index);
+
+        static void retain(PersistentBTreeNode<K, V, N> * node);
+
+        /**
+         * Drops a reference to the node, and frees it if that was the last one.
+         */
+        static void release(PersistentBTreeNode<K, V, N> * node);
+    };
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+data::PersistentBTreeNode<K, V, N>::PersistentBTreeNode() : refs(1), keys(), children{} {}
+
+template <data::PartialOrd K, typename V, const size_t N>
+data::PersistentBTreeNode<K, V, N>::PersistentBTreeNode(const PersistentBTreeNode<K, V, N> &other) : refs(1), keys(other.keys), children{} {
+    for (size_t i = 0; i < other.keys.size(); i++) {
+        this->vals[i] = other.vals[i];
+    }
+
+    if (!other.is_leaf()) {
+        for (size_t i = 0; i <= other.keys.size(); i++) {
+            this->children[i] = other.children[i];
+            retain(this->children[i]);
+        }
+    }
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+data::PersistentBTreeNode<K, V, N>::~PersistentBTreeNode() {
+    if (!this->is_leaf()) {
+        for (size_t i = 0; i <= this->keys.size(); i++) {
+            release(this->children[i]);
+        }
+    }
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+bool data::PersistentBTreeNode<K, V, N>::is_leaf() const {
+    return !this->children[0];
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+bool data::PersistentBTreeNode<K, V, N>::is_overflowed() const {
+    return this->keys.size() == N;
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+size_t data::PersistentBTreeNode<K, V, N>::put(const K &key, V val, PersistentBTreeNode<K, V, N> * right) {
+    const size_t index = this->keys.put(key);
+
+    for (size_t i = this->keys.size() - 1; i > index; i--) {
+        this->vals[i] = std::move(this->vals[i - 1]);
+        this->children[i + 1] = this->children[i];
+    }
+
+    this->vals[index] = std::move(val);
+    this->children[index + 1] = right;
+
+    return index;
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+V data::PersistentBTreeNode<K, V, N>::del(size_t index) {
+    V out = std::move(this->vals[index]);
+
+    for (size_t i = index; i + 1 < this->keys.size(); i++) {
+        this->vals[i] = std::move(this->vals[i + 1]);
+        this->children[i + 1] = this->children[i + 2];
+    }
+
+    this->children[this->keys.size()] = nullptr;
+    this->keys.del(index);
+
+    return out;
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+void data::PersistentBTreeNode<K, V, N>::retain(PersistentBTreeNode<K, V, N> * node) {
+    // A new reference is always made from an existing one, so there's nothing to synchronize with
+    node->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <data::PartialOrd K, typename V, const size_t N>
+void data::PersistentBTreeNode<K, V, N>::release(PersistentBTreeNode<K, V, N> * node) {
+    // Releasing makes this thread's reads of the node happen before a writer that sees the count drop
+    // modifies or frees it
+    if (node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete node;
+    }
+}
+
+#endif
@@ -2,59 +2,174 @@
 #define INCLUDE_STRUCTURES_RADIX_TRIE_H
 
 #include <queue>
+#include <initializer_list>
 #include <optional>
+#include <span>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "arena.h"
+#include "double_array_trie.h"
+#include "mapped_radix_trie_node.h"
+#include "radix_trie_children.h"
 #include "radix_trie_iterator.h"
 #include "radix_trie_node.h"
-#include "sorted_vec.h"
 
 namespace data {
+    /**
+     * Radix trie (compressed trie) implementation. Each node holds a fragment of a key, and the children
+     * of a node are indexed by the first symbol of their fragments, so following a key takes one binary
+     * search per level. Iterating over the trie visits keys in lexicographic order. Keys cannot be empty.
+     *
+     * Nodes, key fragments and child blocks are allocated from an arena owned by the trie. If K and V are
+     * trivially destructible, destroying the trie only releases the arena's chunks and never visits a node.
+     *
+     * "K" is the type of a symbol in the key. K should implement operator< and operator==.
+     * "V" is the type of the value.
+     */
     template <typename K, typename V>
     class RadixTrie {
         private:
             typedef std::pair<std::vector<K>, const V *> entry_type;
 
-            SortedVec<RadixTrieNode<K, V> *> nodes;
+            Arena arena;
+            RadixTrieChildren<K, V> nodes;
 
-            void split_and_insert(RadixTrieNode<K, V> * node, std::vector<K> key, const V value, const size_t prefix_len, const size_t char_count);
+            RadixTrieNode<K, V> * new_node(const K * key, size_t key_len, std::optional<V> val, RadixTrieNode<K, V> * parent);
+
+            /**
+             * Releases a node's fragment and child block and returns the node to the arena. Does not
+             * touch the node's children.
+             */
+            void free_node(RadixTrieNode<K, V> * node);
+
+            /**
+             * Runs the destructors of a node and all of its descendants, including the symbols in their
+             * keys and child blocks. The arena is about to be dropped, so the nodes themselves are not
+             * returned to it.
+             */
+            void destroy_rec(RadixTrieNode<K, V> * node);
+
+            void split_and_insert(RadixTrieNode<K, V> * node, std::span<const K> key, const V value, const size_t prefix_len, const size_t char_count);
 
             void delete_node(RadixTrieNode<K, V> * node);
 
             void try_delete_node(RadixTrieNode<K, V> * node);
 
-            size_t depth_rec(const SortedVec<RadixTrieNode<K, V> *> * nodes) const;
+            void delete_all();
+
+            /**
+             * Returns the node whose full key is exactly the given key, or null if there is none. The
+             * node does not necessarily have a value.
+             */
+            RadixTrieNode<K, V> * find_node(std::span<const K> key) const;
+
+            size_t depth_rec(const RadixTrieChildren<K, V> * nodes) const;
+
+            /**
+             * Returns the highest node whose full key starts with the given key, or null if there is
+             * none. The given key can end in the middle of the node's fragment.
+             */
+            RadixTrieNode<K, V> * find_prefix_node(std::span<const K> key) const;
 
-            std::vector<entry_type> entries_rec(const std::vector<K> &key, const SortedVec<RadixTrieNode<K, V> *> &nodes) const;
+            /**
+             * Adds a node and its descendants to a saved image and returns the node's offset.
+             */
+            size_t save_rec(MappedRadixTrieWriter<K, V> &writer, const RadixTrieNode<K, V> * node, size_t &size) const;
 
         public:
             RadixTrie();
 
+            RadixTrie(const RadixTrie<K, V> &other) = delete;
+
+            RadixTrie(RadixTrie<K, V> &&other);
+
             ~RadixTrie();
 
-            std::optional<V> put(const std::vector<K> key, const V value);
+            void operator=(const RadixTrie<K, V> &other) = delete;
+
+            void operator=(RadixTrie<K, V> &&other);
+
+            /**
+             * Inserts or replaces the value for a key and returns the old value, if there was one. The
+             * key is only read, and only the symbols that are not already in the trie are copied.
+             */
+            std::optional<V> put(std::span<const K> key, const V value);
+
+            std::optional<V> put(const std::vector<K> &key, const V value);
+
+            std::optional<V> put(std::initializer_list<K> key, const V value);
 
-            std::optional<V> get(const std::vector<K> key);
+            template <typename Traits>
+            std::optional<V> put(std::basic_string_view<K, Traits> key, const V value);
 
-            std::optional<V> del(const std::vector<K> key);
+            /**
+             * Returns the value for a key. Lookups do not allocate.
+             */
+            std::optional<V> get(std::span<const K> key) const;
+
+            std::optional<V> get(const std::vector<K> &key) const;
+
+            std::optional<V> get(std::initializer_list<K> key) const;
+
+            template <typename Traits>
+            std::optional<V> get(std::basic_string_view<K, Traits> key) const;
+
+            std::optional<V> del(std::span<const K> key);
+
+            std::optional<V> del(const std::vector<K> &key);
+
+            std::optional<V> del(std::initializer_list<K> key);
+
+            template <typename Traits>
+            std::optional<V> del(std::basic_string_view<K, Traits> key);
 
             size_t depth() const;
 
             std::vector<entry_type> entries() const;
 
+            /**
+             * Compiles the trie into a read-only DoubleArrayTrie with the same keys and values. The
+             * trie is left as it is.
+             */
+            DoubleArrayTrie<K, V> freeze() const requires (std::is_integral_v<K> && sizeof(K) == 1);
+
+            /**
+             * Writes the trie to a file that can be opened with MappedRadixTrie. The file only holds
+             * offsets, not pointers, so it can be mapped at any address.
+             */
+            void save(const char * path) const requires (std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>);
+
             RadixTrieIterator<K, V> begin();
 
             RadixTrieIterator<K, V> end();
 
-            std::vector<entry_type> entries_with_prefix(const std::vector<K> &key) const;
+            RadixTrieIterator<K, V, true> begin() const;
+
+            RadixTrieIterator<K, V, true> end() const;
+
+            /**
+             * Returns a lazy range over the entries whose keys start with the given key, in lexicographic
+             * order, stopping after `limit` entries. The range starts at the node for the prefix and does
+             * not materialize the entries, so a query costs the same no matter how many keys match.
+             * An empty prefix matches every key.
+             */
+            RadixTrieRange<K, V, true> entries_with_prefix(std::span<const K> key, size_t limit = SIZE_MAX) const;
+
+            RadixTrieRange<K, V, true> entries_with_prefix(const std::vector<K> &key, size_t limit = SIZE_MAX) const;
+
+            template <typename Traits>
+            RadixTrieRange<K, V, true> entries_with_prefix(std::basic_string_view<K, Traits> key, size_t limit = SIZE_MAX) const;
 
 #ifdef TEST
             void print();
 
-            SortedVec<RadixTrieNode<K, V> *>& get_nodes();
+            RadixTrieChildren<K, V>& get_nodes();
 
             RadixTrieNode<K, V> * get_node(const std::vector<K> key);
 #endif
@@ -63,219 +178,249 @@ namespace data {
 
 
 template <typename K, typename V>
-data::RadixTrie<K, V>::RadixTrie() : nodes(SortedVec<RadixTrieNode<K, V> *>()) {}
+data::RadixTrie<K, V>::RadixTrie() : arena(Arena()), nodes(RadixTrieChildren<K, V>()) {}
+
+template <typename K, typename V>
+data::RadixTrie<K, V>::RadixTrie(RadixTrie<K, V> &&other) : arena(std::move(other.arena)), nodes(std::move(other.nodes)) {}
 
 template <typename K, typename V>
 data::RadixTrie<K, V>::~RadixTrie() {
-    for (size_t i = 0; i < this->nodes.size(); i++) {
-        delete this->nodes[i];
+    this->delete_all();
+}
+
+template <typename K, typename V>
+void data::RadixTrie<K, V>::operator=(RadixTrie<K, V> &&other) {
+    if (this == &other) {
+        return;
+    }
+
+    this->delete_all();
+    this->arena = std::move(other.arena);
+    this->nodes = std::move(other.nodes);
+}
+
+template <typename K, typename V>
+void data::RadixTrie<K, V>::delete_all() {
+    if constexpr (!std::is_trivially_destructible_v<K> || !std::is_trivially_destructible_v<V>) {
+        RadixTrieNode<K, V> * node = this->nodes.first();
+
+        while (node) {
+            RadixTrieNode<K, V> * next = this->nodes.next(node->key[0]);
+            this->destroy_rec(node);
+            node = next;
+        }
     }
+
+    // Everything else lives in the arena
+    this->nodes = RadixTrieChildren<K, V>();
+    this->arena = Arena();
+}
+
+template <typename K, typename V>
+void data::RadixTrie<K, V>::destroy_rec(RadixTrieNode<K, V> * node) {
+    RadixTrieNode<K, V> * child = node->children.first();
+
+    while (child) {
+        RadixTrieNode<K, V> * next = node->children.next(child->key[0]);
+        this->destroy_rec(child);
+        child = next;
+    }
+
+    node->key.release(this->arena);
+    node->children.release(this->arena);
+    node->~RadixTrieNode<K, V>();
+}
+
+template <typename K, typename V>
+data::RadixTrieNode<K, V> * data::RadixTrie<K, V>::new_node(const K * key, size_t key_len, std::optional<V> val, RadixTrieNode<K, V> * parent) {
+    return this->arena.template create<RadixTrieNode<K, V>>(RadixTrieFragment<K>(this->arena, key, key_len), val, parent);
+}
+
+template <typename K, typename V>
+void data::RadixTrie<K, V>::free_node(RadixTrieNode<K, V> * node) {
+    node->key.release(this->arena);
+    node->children.release(this->arena);
+    this->arena.destroy(node);
 }
 
 template <typename T>
-static void print_vec(const std::vector<T> &vec) {
+static void print_vec(const T &vec) {
     for (size_t i = 0; i < vec.size(); i++) {
         printf("%c", vec[i]);
     }
 }
 
 template <typename K, typename V>
-void data::RadixTrie<K, V>::split_and_insert(RadixTrieNode<K, V> * node, std::vector<K> key, const V value, const size_t prefix_len, const size_t char_count)  {
-    std::vector<K> other_key_prev = std::vector<K>(node->key.begin(), node->key.begin() + prefix_len);
-    RadixTrieNode<K, V> * other_node_prev = new RadixTrieNode<K, V>(other_key_prev, std::nullopt, node->parent);
-    other_node_prev->children.put(node);
-
-    SortedVec<RadixTrieNode<K, V> *> * siblings;
+void data::RadixTrie<K, V>::split_and_insert(RadixTrieNode<K, V> * node, std::span<const K> key, const V value, const size_t prefix_len, const size_t char_count) {
+    RadixTrieNode<K, V> * other_node_prev = this->new_node(node->key.data(), prefix_len, std::nullopt, node->parent);
 
+    // The new node starts with the same symbol as the node it replaces
     if (other_node_prev->parent) {
-        siblings = &other_node_prev->parent->children;
+        other_node_prev->parent->children.replace(other_node_prev);
     } else {
-        siblings = &this->nodes;
-    }
-        
-    for (size_t j = 0; j < siblings->size(); j++) {
-        if ((*siblings)[j] == node) {
-            (*siblings)[j] = other_node_prev;
-            break;
-        }
+        this->nodes.replace(other_node_prev);
     }
 
+    node->key.remove_prefix(this->arena, prefix_len);
     node->parent = other_node_prev;
-    node->key = std::vector<K>(node->key.begin() + prefix_len, node->key.end());
+    other_node_prev->children.put(node, this->arena);
 
     if (char_count == key.size()) {
         other_node_prev->val = std::optional(value);
     } else {
-        RadixTrieNode<K, V> * key_node = new RadixTrieNode<K, V>(std::vector<K>(key.begin() + char_count, key.end()), std::optional(value), other_node_prev);
-        other_node_prev->children.put(key_node);
+        RadixTrieNode<K, V> * key_node = this->new_node(key.data() + char_count, key.size() - char_count, std::optional(value), other_node_prev);
+        other_node_prev->children.put(key_node, this->arena);
     }
 }
 
 template <typename K, typename V>
-std::optional<V> data::RadixTrie<K, V>::put(const std::vector<K> key, const V value) {
+std::optional<V> data::RadixTrie<K, V>::put(std::span<const K> key, const V value) {
+    if (!key.size()) {
+        throw "Radix trie keys cannot be empty";
+    }
+
     size_t char_count = 0;
 
     RadixTrieNode<K, V> * curr_node = nullptr;
-    SortedVec<RadixTrieNode<K, V> *> * curr_nodes = &this->nodes;
-    bool found_node = true;
+    RadixTrieChildren<K, V> * curr_nodes = &this->nodes;
+    RadixTrieNode<K, V> * node;
 
-    while (found_node) {
-        found_node = false;
-
-        for (size_t i = 0; i < curr_nodes->size(); i++) {
-            RadixTrieNode<K, V> * node = (*curr_nodes)[i];
-            const size_t prefix_len = node->common_prefix_len(key, char_count);
-
-            if (!prefix_len) {
-                continue;
-            }
+    while ((node = curr_nodes->find(key[char_count]))) {
+        const size_t prefix_len = node->common_prefix_len(key, char_count);
+        char_count += prefix_len;
 
-            // The key is not exhausted yet
-            if ((prefix_len + char_count) < key.size()) {
-                char_count += prefix_len;
-
-                // The prefix is the entire node key; search node's children
-                if (prefix_len == node->key.size()) {
-                    curr_node = node;
-                    curr_nodes = &node->children;
-                    found_node = true;
-                    break;
-                }
-
-                // make split branch, add node, and return
-                if (prefix_len == node->key.size()) {
-                    // add new node as child
-                    RadixTrieNode<K, V> * new_node = new RadixTrieNode<K, V>(std::vector<K>(key.begin() + char_count, key.end()), std::optional(value), node);
-                    node->children.put(new_node);
-                    return std::nullopt;
-                } else {
-                    // split node, make branch
-                    this->split_and_insert(node, key, value, prefix_len, char_count);
-                }
-                return std::nullopt;
-            }
+        if (prefix_len < node->key.size()) {
+            // The key diverges from (or ends in) the middle of this node; split node, make branch
+            this->split_and_insert(node, key, value, prefix_len, char_count);
+            return std::nullopt;
+        }
 
-            // The entire key has been exhausted - we have to do something now
-            if ((prefix_len + char_count) == key.size()) {
-                char_count += prefix_len;
-
-                // make split branch and return
-                if (prefix_len == node->key.size()) {
-                    // write over existing node's value
-                    const std::optional<V> out = node->val;
-                    node->val = std::optional(value);
-
-                    return out;
-                } else {
-                    // split node, make branch
-                    this->split_and_insert(node, key, value, prefix_len, char_count);
-                }
-                return std::nullopt;
-            }
+        if (char_count == key.size()) {
+            // The entire key has been exhausted; write over existing node's value
+            const std::optional<V> out = node->val;
+            node->val = std::optional(value);
 
-            __builtin_unreachable();
+            return out;
         }
-    }
 
-    RadixTrieNode<K, V> * key_node = new RadixTrieNode<K, V>(std::vector<K>(key.begin() + char_count, key.end()), std::optional(value), curr_node);
-    if (curr_node) {
-        curr_node->children.put(key_node);
-    } else {
-        this->nodes.put(key_node);
+        // The prefix is the entire node key; search node's children
+        curr_node = node;
+        curr_nodes = &node->children;
     }
 
+    RadixTrieNode<K, V> * key_node = this->new_node(key.data() + char_count, key.size() - char_count, std::optional(value), curr_node);
+    curr_nodes->put(key_node, this->arena);
+
     return std::nullopt;
 }
 
 template <typename K, typename V>
-std::optional<V> data::RadixTrie<K, V>::get(const std::vector<K> key) {
-    size_t char_count = 0;
+std::optional<V> data::RadixTrie<K, V>::put(const std::vector<K> &key, const V value) {
+    return this->put(std::span<const K>(key), value);
+}
 
-    RadixTrieNode<K, V> * curr_node = nullptr;
-    SortedVec<RadixTrieNode<K, V> *> * curr_nodes = &this->nodes;
-    bool found_node = true;
-
-    while (found_node) {
-        found_node = false;
-
-        for (size_t i = 0; i < curr_nodes->size(); i++) {
-            RadixTrieNode<K, V> * node = (*curr_nodes)[i];
-            const size_t prefix_len = node->common_prefix_len(key, char_count);
-
-            if (!prefix_len) {
-                continue;
-            } else if (prefix_len < node->key.size()) {
-                return std::nullopt;
-            } else if ((prefix_len + char_count) == key.size()) {
-                return node->val;
-            } else {
-                curr_node = node;
-                curr_nodes = &curr_node->children;
-                char_count += prefix_len;
-                found_node = true;
-                break;
-            }
-        }
+template <typename K, typename V>
+std::optional<V> data::RadixTrie<K, V>::put(std::initializer_list<K> key, const V value) {
+    return this->put(std::span<const K>(key.begin(), key.size()), value);
+}
+
+template <typename K, typename V>
+template <typename Traits>
+std::optional<V> data::RadixTrie<K, V>::put(std::basic_string_view<K, Traits> key, const V value) {
+    return this->put(std::span<const K>(key.data(), key.size()), value);
+}
+
+template <typename K, typename V>
+std::optional<V> data::RadixTrie<K, V>::get(std::span<const K> key) const {
+    const RadixTrieNode<K, V> * node = this->find_node(key);
+
+    if (!node) {
+        return std::nullopt;
     }
 
-    return std::nullopt;
+    return node->val;
+}
+
+template <typename K, typename V>
+std::optional<V> data::RadixTrie<K, V>::get(const std::vector<K> &key) const {
+    return this->get(std::span<const K>(key));
+}
+
+template <typename K, typename V>
+std::optional<V> data::RadixTrie<K, V>::get(std::initializer_list<K> key) const {
+    return this->get(std::span<const K>(key.begin(), key.size()));
 }
 
 template <typename K, typename V>
-std::optional<V> data::RadixTrie<K, V>::del(const std::vector<K> key) {
+template <typename Traits>
+std::optional<V> data::RadixTrie<K, V>::get(std::basic_string_view<K, Traits> key) const {
+    return this->get(std::span<const K>(key.data(), key.size()));
+}
+
+template <typename K, typename V>
+std::optional<V> data::RadixTrie<K, V>::del(std::span<const K> key) {
+    RadixTrieNode<K, V> * node = this->find_node(key);
+
+    if (!node) {
+        return std::nullopt;
+    }
+
+    const std::optional<V> out = node->val;
+
+    node->val = std::nullopt;
+    this->try_delete_node(node);
+
+    return out;
+}
+
+template <typename K, typename V>
+std::optional<V> data::RadixTrie<K, V>::del(const std::vector<K> &key) {
+    return this->del(std::span<const K>(key));
+}
+
+template <typename K, typename V>
+std::optional<V> data::RadixTrie<K, V>::del(std::initializer_list<K> key) {
+    return this->del(std::span<const K>(key.begin(), key.size()));
+}
+
+template <typename K, typename V>
+template <typename Traits>
+std::optional<V> data::RadixTrie<K, V>::del(std::basic_string_view<K, Traits> key) {
+    return this->del(std::span<const K>(key.data(), key.size()));
+}
+
+template <typename K, typename V>
+data::RadixTrieNode<K, V> * data::RadixTrie<K, V>::find_node(std::span<const K> key) const {
     size_t char_count = 0;
 
-    RadixTrieNode<K, V> * curr_node = nullptr;
-    SortedVec<RadixTrieNode<K, V> *> * curr_nodes = &this->nodes;
-    bool found_node = true;
-
-    while (found_node) {
-        found_node = false;
-
-        for (size_t i = 0; i < curr_nodes->size(); i++) {
-            RadixTrieNode<K, V> * node = (*curr_nodes)[i];
-            const size_t prefix_len = node->common_prefix_len(key, char_count);
-
-            if (!prefix_len) {
-                continue;
-            } else if (prefix_len < node->key.size()) {
-                return std::nullopt;
-            } else if ((prefix_len + char_count) == key.size()) {
-                const std::optional<V> out = node->val;
-
-                node->val = std::nullopt;
-                this->try_delete_node(node);
-                return out;
-            } else {
-                curr_node = node;
-                curr_nodes = &curr_node->children;
-                char_count += prefix_len;
-                found_node = true;
-                break;
-            }
+    const RadixTrieChildren<K, V> * curr_nodes = &this->nodes;
+    RadixTrieNode<K, V> * node;
+
+    while (char_count < key.size() && (node = curr_nodes->find(key[char_count]))) {
+        const size_t prefix_len = node->common_prefix_len(key, char_count);
+
+        if (prefix_len < node->key.size()) {
+            return nullptr;
+        }
+
+        char_count += prefix_len;
+
+        if (char_count == key.size()) {
+            return node;
         }
+
+        curr_nodes = &node->children;
     }
 
-    return std::nullopt;
+    return nullptr;
 }
 
 template <typename K, typename V>
 void data::RadixTrie<K, V>::delete_node(RadixTrieNode<K, V> * node) {
-    SortedVec<RadixTrieNode<K, V> *> * siblings;
-
     if (node->parent) {
-        siblings = &node->parent->children;
+        node->parent->children.del(node->key[0], this->arena);
     } else {
-        siblings = &this->nodes;
-    }
-
-    for (size_t i = 0; i < siblings->size(); i++) {
-        RadixTrieNode<K, V> * sibling = (*siblings)[i];
-
-        if (sibling == node) {
-            siblings->del(i);
-            break;
-        }
+        this->nodes.del(node->key[0], this->arena);
     }
 
     RadixTrieNode<K, V> * parent = node->parent;
@@ -284,7 +429,7 @@ void data::RadixTrie<K, V>::delete_node(RadixTrieNode<K, V> * node) {
         this->try_delete_node(parent);
     }
 
-    delete node;
+    this->free_node(node);
 }
 
 template <typename K, typename V>
@@ -292,21 +437,32 @@ void data::RadixTrie<K, V>::try_delete_node(RadixTrieNode<K, V> * node) {
     if (!node->children.size()) {
         this->delete_node(node);
     } else if (node->children.size() == 1) {
-        RadixTrieNode<K, V> * child = node->children[0];
+        // Merge the only child into this node. The merged node keeps this node's first symbol, so
+        // it stays where it is in the parent's children.
+        RadixTrieNode<K, V> * child = node->children.first();
 
-        node->key.insert(std::end(node->key), std::begin(child->key), std::end(child->key));
+        node->key.append(this->arena, child->key.data(), child->key.size());
         node->val = child->val;
-        node->children = child->children;
-        this->delete_node(child);
+        node->children.release(this->arena);
+        node->children = std::move(child->children);
+
+        RadixTrieNode<K, V> * grandchild = node->children.first();
+
+        while (grandchild) {
+            grandchild->parent = node;
+            grandchild = node->children.next(grandchild->key[0]);
+        }
+
+        this->free_node(child);
     } 
 }
 
 template <typename K, typename V>
-size_t data::RadixTrie<K, V>::depth_rec(const SortedVec<RadixTrieNode<K, V> *> * nodes) const {
+size_t data::RadixTrie<K, V>::depth_rec(const RadixTrieChildren<K, V> * nodes) const {
     size_t max = 0;
 
-    for (size_t i = 0; i < nodes->size(); i++) {
-        const size_t node_max = 1 + this->depth_rec(&(*nodes)[i]->children);
+    for (const RadixTrieNode<K, V> * node = nodes->first(); node; node = nodes->next(node->key[0])) {
+        const size_t node_max = 1 + this->depth_rec(&node->children);
 
         if (node_max > max) {
             max = node_max;
@@ -322,115 +478,136 @@ size_t data::RadixTrie<K, V>::depth() const {
 }
 
 template <typename K, typename V>
-std::vector<typename data::RadixTrie<K, V>::entry_type> data::RadixTrie<K, V>::entries_rec(const std::vector<K> &key, const SortedVec<RadixTrieNode<K, V> *> &nodes) const {
+std::vector<typename data::RadixTrie<K, V>::entry_type> data::RadixTrie<K, V>::entries() const {
     std::vector<entry_type> out;
 
-    for (size_t i = 0; i < nodes.size(); i++) {
-        const RadixTrieNode<K, V> * node = nodes[i];
-        std::vector<K> full_key;
-
-        full_key.insert(std::end(full_key), std::begin(key), std::end(key));
-        full_key.insert(std::end(full_key), std::begin(node->key), std::end(node->key));
-
-        if (node->val.has_value()) {
-            out.push_back(entry_type(full_key, &node->val.value()));
-        }
-
-        std::vector<entry_type> node_entries = this->entries_rec(full_key, node->children);
- 
-        for (size_t j = 0; j < node_entries.size(); j++) {
-            entry_type entry = node_entries[j];
-            out.push_back(entry);
-        }
+    for (auto entry : *this) {
+        out.push_back(entry_type(std::vector<K>(std::begin(entry.first), std::end(entry.first)), entry.second));
     }
 
     return out;
 }
 
 template <typename K, typename V>
-std::vector<typename data::RadixTrie<K, V>::entry_type> data::RadixTrie<K, V>::entries() const {
-    const std::vector<K> key;
+data::DoubleArrayTrie<K, V> data::RadixTrie<K, V>::freeze() const requires (std::is_integral_v<K> && sizeof(K) == 1) {
+    std::vector<std::pair<std::vector<K>, V>> entries;
 
-    return this->entries_rec(key, this->nodes);
+    for (auto entry : *this) {
+        entries.push_back({ std::vector<K>(std::begin(entry.first), std::end(entry.first)), *entry.second });
+    }
+
+    return DoubleArrayTrie<K, V>(std::move(entries));
 }
 
 template <typename K, typename V>
-data::RadixTrieIterator<K, V> data::RadixTrie<K, V>::begin() {
-    if (!this->nodes.size()) {
-        return this->end();
-    }
+size_t data::RadixTrie<K, V>::save_rec(MappedRadixTrieWriter<K, V> &writer, const RadixTrieNode<K, V> * node, size_t &size) const {
+    const V * val = node->val.has_value() ? &node->val.value() : nullptr;
+    const size_t offset = writer.add_node(node->key.data(), node->key.size(), val, node->children.size());
+    size_t i = 0;
 
-    RadixTrieNode<K, V> * node = this->nodes[0];
+    size += val != nullptr;
 
-    while (!node->val.has_value() && node->children.size()) {
-        node = node->children[0];
+    for (const RadixTrieNode<K, V> * child = node->children.first(); child; child = node->children.next(child->key[0])) {
+        writer.set_child(offset, i++, child->key[0], this->save_rec(writer, child, size));
     }
 
-    return RadixTrieIterator<K, V>(&this->nodes, node, false);
+    return offset;
 }
 
 template <typename K, typename V>
-data::RadixTrieIterator<K, V> data::RadixTrie<K, V>::end() {
-    if (!this->nodes.size()) {
-        return RadixTrieIterator<K, V>(&this->nodes, nullptr, true);
+void data::RadixTrie<K, V>::save(const char * path) const requires (std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>) {
+    MappedRadixTrieWriter<K, V> writer;
+    // The top-level nodes have no parent, so they hang off an empty root
+    const size_t root = writer.add_node(nullptr, 0, nullptr, this->nodes.size());
+    size_t size = 0;
+    size_t i = 0;
+
+    for (const RadixTrieNode<K, V> * node = this->nodes.first(); node; node = this->nodes.next(node->key[0])) {
+        writer.set_child(root, i++, node->key[0], this->save_rec(writer, node, size));
     }
 
-    RadixTrieNode<K, V> * node = this->nodes[this->nodes.size() - 1];
+    writer.write(path, root, size);
+}
 
-    while (node->children.size()) {
-        node = node->children[node->children.size() - 1];
-    }
+template <typename K, typename V>
+data::RadixTrieIterator<K, V> data::RadixTrie<K, V>::begin() {
+    return RadixTrieIterator<K, V>(&this->nodes);
+}
 
-    return RadixTrieIterator<K, V>(&this->nodes, node, true);
+template <typename K, typename V>
+data::RadixTrieIterator<K, V> data::RadixTrie<K, V>::end() {
+    return RadixTrieIterator<K, V>();
 }
 
 template <typename K, typename V>
-std::vector<typename data::RadixTrie<K, V>::entry_type> data::RadixTrie<K, V>::entries_with_prefix(const std::vector<K> &key) const {
-    size_t char_count = 0;
+data::RadixTrieIterator<K, V, true> data::RadixTrie<K, V>::begin() const {
+    return RadixTrieIterator<K, V, true>(&this->nodes);
+}
 
-    RadixTrieNode<K, V> * curr_node = nullptr;
-    const SortedVec<RadixTrieNode<K, V> *> * curr_nodes = &this->nodes;
-    bool found_node = true;
+template <typename K, typename V>
+data::RadixTrieIterator<K, V, true> data::RadixTrie<K, V>::end() const {
+    return RadixTrieIterator<K, V, true>();
+}
 
-    while (found_node) {
-        found_node = false;
+template <typename K, typename V>
+data::RadixTrieNode<K, V> * data::RadixTrie<K, V>::find_prefix_node(std::span<const K> key) const {
+    size_t char_count = 0;
 
-        for (size_t i = 0; i < curr_nodes->size(); i++) {
-            RadixTrieNode<K, V> * node = (*curr_nodes)[i];
-            const size_t prefix_len = node->common_prefix_len(key, char_count);
+    const RadixTrieChildren<K, V> * curr_nodes = &this->nodes;
+    RadixTrieNode<K, V> * node;
 
-            if (!prefix_len) {
-                continue;
-            } else if (prefix_len < node->key.size()) {
-                return {};
-            } else if ((prefix_len + char_count) == key.size()) {
-                std::vector<entry_type> out = this->entries_rec(key, node->children);
+    while ((node = curr_nodes->find(key[char_count]))) {
+        const size_t prefix_len = node->common_prefix_len(key, char_count);
+        char_count += prefix_len;
 
-                if (node->val.has_value()) {
-                    out.push_back({ key, &node->val.value() });
-                }
+        if (char_count == key.size()) {
+            // The key ends in or at the end of this node, so every key under it matches
+            return node;
+        }
 
-                return out;
-            } else {
-                curr_node = node;
-                curr_nodes = &curr_node->children;
-                char_count += prefix_len;
-                found_node = true;
-                break;
-            }
+        if (prefix_len < node->key.size()) {
+            return nullptr;
         }
+
+        curr_nodes = &node->children;
+    }
+
+    return nullptr;
+}
+
+template <typename K, typename V>
+data::RadixTrieRange<K, V, true> data::RadixTrie<K, V>::entries_with_prefix(std::span<const K> key, size_t limit) const {
+    if (!key.size()) {
+        return RadixTrieRange<K, V, true>(RadixTrieIterator<K, V, true>(&this->nodes, limit));
     }
 
-    return {};
+    const RadixTrieNode<K, V> * node = this->find_prefix_node(key);
+
+    if (!node) {
+        return RadixTrieRange<K, V, true>();
+    }
+
+    return RadixTrieRange<K, V, true>(RadixTrieIterator<K, V, true>(node, limit));
+}
+
+template <typename K, typename V>
+data::RadixTrieRange<K, V, true> data::RadixTrie<K, V>::entries_with_prefix(const std::vector<K> &key, size_t limit) const {
+    return this->entries_with_prefix(std::span<const K>(key), limit);
+}
+
+template <typename K, typename V>
+template <typename Traits>
+data::RadixTrieRange<K, V, true> data::RadixTrie<K, V>::entries_with_prefix(std::basic_string_view<K, Traits> key, size_t limit) const {
+    return this->entries_with_prefix(std::span<const K>(key.data(), key.size()), limit);
 }
 
 #ifdef TEST
 template <>
-void data::RadixTrie<char, int>::print() {
+inline void data::RadixTrie<char, int>::print() {
     size_t level = 0;
     std::queue<RadixTrieNode<char, int> *> buf;
-    for (size_t i = 0; i < this->nodes.size(); i++) {
-        buf.push(this->nodes[i]);
+    for (RadixTrieNode<char, int> * node = this->nodes.first(); node; node = this->nodes.next(node->key[0])) {
+        buf.push(node);
     }
 
     printf("Starting radix trie printout. Parent nodes: %ld\n", this->nodes.size());
@@ -459,8 +636,8 @@ void data::RadixTrie<char, int>::print() {
             }
             printf(") ");
 
-            for (size_t j = 0; j < node->children.size(); j++) {
-                buf.push(node->children[i]);
+            for (RadixTrieNode<char, int> * child = node->children.first(); child; child = node->children.next(child->key[0])) {
+                buf.push(child);
             }
         }
         printf("\n");
@@ -477,42 +654,13 @@ void data::RadixTrie<K, V>::print() {
 }
 
 template <typename K, typename V>
-data::SortedVec<data::RadixTrieNode<K, V> *>& data::RadixTrie<K, V>::get_nodes() {
+data::RadixTrieChildren<K, V>& data::RadixTrie<K, V>::get_nodes() {
     return this->nodes;
 }
 
 template <typename K, typename V>
 data::RadixTrieNode<K, V> * data::RadixTrie<K, V>::get_node(std::vector<K> key) {
-    size_t char_count = 0;
-
-    RadixTrieNode<K, V> * curr_node = nullptr;
-    SortedVec<RadixTrieNode<K, V> *> * curr_nodes = &this->nodes;
-    bool found_node = true;
-
-    while (found_node) {
-        found_node = false;
-
-        for (size_t i = 0; i < curr_nodes->size(); i++) {
-            RadixTrieNode<K, V> * node = (*curr_nodes)[i];
-            const size_t prefix_len = node->common_prefix_len(key, char_count);
-
-            if (!prefix_len) {
-                continue;
-            } else if (prefix_len < node->key.size()) {
-                return nullptr;
-            } else if ((prefix_len + char_count) == key.size()) {
-                return node;
-            } else {
-                curr_node = node;
-                curr_nodes = &curr_node->children;
-                char_count += prefix_len;
-                found_node = true;
-                break;
-            }
-        }
-    }
-
-    return nullptr;
+    return this->find_node(key);
 }
 
 #endif
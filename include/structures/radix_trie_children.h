@@ -0,0 +1,838 @@
+#ifndef INCLUDE_STRUCTURES_RADIX_TRIE_CHILDREN_H
+#define INCLUDE_STRUCTURES_RADIX_TRIE_CHILDREN_H
+
+#include <algorithm>
+#include <memory>
+#include <stdint.h>
+#include <stdlib.h>
+#include <type_traits>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "arena.h"
+
+namespace data {
+    template <typename K, typename V>
+    struct RadixTrieNode;
+
+    /**
+     * An edge to a child in a radix trie. The first symbol of the child's key is stored in the edge
+     * so that edges can be searched without dereferencing the children. No two children of the
+     * same node can start with the same symbol, so edges are ordered by symbol alone.
+     */
+    template <typename K, typename V>
+    struct RadixTrieEdge {
+        K symbol;
+        RadixTrieNode<K, V> * node;
+
+        RadixTrieEdge();
+
+        RadixTrieEdge(const K &symbol, RadixTrieNode<K, V> * node = nullptr);
+
+        bool operator<(const RadixTrieEdge<K, V> &other) const;
+    };
+
+    /**
+     * The representations a set of children can have. They follow the node types of the Adaptive
+     * Radix Tree (Leis et al.): NODE4 and NODE16 are sorted arrays of symbols and children, NODE48
+     * maps every possible byte to a slot in an array of 48 children, and NODE256 is an array of
+     * children indexed directly by byte. NODE48 and NODE256 are only used for byte-sized symbols.
+     * Other symbols use EDGES, a sorted array of edges that doubles when it fills up, once they
+     * outgrow NODE16.
+     */
+    enum class RadixTrieChildrenKind : uint8_t {
+        EMPTY,
+        NODE4,
+        NODE16,
+        NODE48,
+        NODE256,
+        EDGES
+    };
+
+    template <typename K, typename V, const size_t M>
+    struct RadixTrieSortedBlock {
+        K symbols[M];
+        RadixTrieNode<K, V> * children[M];
+    };
+
+    template <typename K, typename V>
+    struct RadixTrieIndexedBlock {
+        // Slot of the child for each byte, plus one. Zero means there is no child.
+        uint8_t index[256];
+        RadixTrieNode<K, V> * children[48];
+    };
+
+    template <typename K, typename V>
+    struct RadixTrieDirectBlock {
+        RadixTrieNode<K, V> * children[256];
+    };
+
+    /**
+     * The children of a radix trie node, indexed by the first symbol of their keys. The representation
+     * grows and shrinks with the number of children (see RadixTrieChildrenKind), so a node without
+     * children allocates nothing, and a node with a few children allocates a block that fits in a
+     * cache line or two. Iterating over the children visits them in lexicographic order. The children
+     * are not owned by this container.
+     *
+     * Blocks are allocated from the arena passed to the methods that add and remove children, and are
+     * not freed on destruction. The owner either calls `release` or lets the arena go away.
+     */
+    template <typename K, typename V>
+    class RadixTrieChildren {
+        private:
+            /**
+             * Byte-sized symbols can be used as array indices, which enables NODE48 and NODE256.
+             */
+            static constexpr bool BYTE_SYMBOLS = std::is_integral_v<K> && sizeof(K) == 1 && !std::is_same_v<K, bool>;
+
+            static constexpr uint8_t EDGES_INITIAL_CAPACITY_LOG = 5;
+
+            typedef RadixTrieSortedBlock<K, V, 4> Node4;
+            typedef RadixTrieSortedBlock<K, V, 16> Node16;
+            typedef RadixTrieIndexedBlock<K, V> Node48;
+            typedef RadixTrieDirectBlock<K, V> Node256;
+
+            union {
+                Node4 * node4;
+                Node16 * node16;
+                Node48 * node48;
+                Node256 * node256;
+                RadixTrieEdge<K, V> * edges;
+            };
+            uint32_t count;
+            RadixTrieChildrenKind kind_;
+            // Base 2 log of the number of edges allocated for EDGES. Unused by the other kinds.
+            uint8_t capacity_log;
+
+            size_t capacity() const;
+
+            /**
+             * Maps a byte-sized symbol to an index such that the order of the indices matches the order
+             * of the symbols.
+             */
+            static size_t code(const K &symbol);
+
+            static K decode(size_t code);
+
+            template <const size_t M>
+            static RadixTrieNode<K, V> * find_sorted(const RadixTrieSortedBlock<K, V, M> * block, size_t count, const K &symbol);
+
+            template <const size_t M>
+            static void put_sorted(RadixTrieSortedBlock<K, V, M> * block, size_t count, const K &symbol, RadixTrieNode<K, V> * child);
+
+            template <const size_t M>
+            static void del_sorted(RadixTrieSortedBlock<K, V, M> * block, size_t count, size_t index);
+
+            /**
+             * Returns all children in order. Used when changing representations.
+             */
+            std::vector<RadixTrieEdge<K, V>> collect() const;
+
+            /**
+             * Frees the current representation and rebuilds the children in the given one.
+             */
+            void convert(RadixTrieChildrenKind new_kind, Arena &arena);
+
+            void free_block(Arena &arena);
+
+            static RadixTrieEdge<K, V> * alloc_edges(size_t capacity, Arena &arena);
+
+            static void free_edges(RadixTrieEdge<K, V> * edges, size_t capacity, Arena &arena);
+
+            /**
+             * Returns the index of the first edge whose symbol is not less than the given symbol.
+             */
+            size_t edges_lower_bound(const K &symbol) const;
+
+            /**
+             * Returns the slot of the child starting with the given symbol, or -1 if there is none. For
+             * NODE4, NODE16 and EDGES this is the child's position. For NODE48 and NODE256 it is the
+             * code of the symbol.
+             */
+            ptrdiff_t slot_of(const K &symbol) const;
+
+            RadixTrieNode<K, V> *& at_slot(ptrdiff_t slot);
+
+        public:
+            RadixTrieChildren();
+
+            RadixTrieChildren(const RadixTrieChildren<K, V> &other) = delete;
+
+            RadixTrieChildren(RadixTrieChildren<K, V> &&other);
+
+            void operator=(const RadixTrieChildren<K, V> &other) = delete;
+
+            /**
+             * Takes over the other container's children. Any block held by this container is not
+             * released, so this container should be empty or released first.
+             */
+            void operator=(RadixTrieChildren<K, V> &&other);
+
+            /**
+             * Forgets every child and returns the block to the arena.
+             */
+            void release(Arena &arena);
+
+            size_t size() const;
+
+            RadixTrieChildrenKind kind() const;
+
+            /**
+             * Returns the child whose key starts with the given symbol, or null if there is none.
+             */
+            RadixTrieNode<K, V> * find(const K &symbol) const;
+
+            /**
+             * Adds a child. The child's key must not be empty, and there must not already be a child
+             * whose key starts with the same symbol.
+             */
+            void put(RadixTrieNode<K, V> * child, Arena &arena);
+
+            /**
+             * Replaces the child whose key starts with the same symbol as the given child's key.
+             */
+            void replace(RadixTrieNode<K, V> * child);
+
+            /**
+             * Removes and returns the child whose key starts with the given symbol, or returns null if
+             * there is none.
+             */
+            RadixTrieNode<K, V> * del(const K &symbol, Arena &arena);
+
+            /**
+             * Returns the lexicographically smallest child, or null if there are no children.
+             */
+            RadixTrieNode<K, V> * first() const;
+
+            /**
+             * Returns the lexicographically greatest child, or null if there are no children.
+             */
+            RadixTrieNode<K, V> * last() const;
+
+            /**
+             * Returns the first child whose key starts with a symbol greater than the given symbol, or
+             * null if there is none.
+             */
+            RadixTrieNode<K, V> * next(const K &symbol) const;
+    };
+}
+
+template <typename K, typename V>
+data::RadixTrieEdge<K, V>::RadixTrieEdge() : symbol(K()), node(nullptr) {}
+
+template <typename K, typename V>
+data::RadixTrieEdge<K, V>::RadixTrieEdge(const K &symbol, RadixTrieNode<K, V> * node) : symbol(symbol), node(node) {}
+
+template <typename K, typename V>
+bool data::RadixTrieEdge<K, V>::operator<(const RadixTrieEdge<K, V> &other) const {
+    return this->symbol < other.symbol;
+}
+
+template <typename K, typename V>
+data::RadixTrieChildren<K, V>::RadixTrieChildren() : node4(nullptr), count(0), kind_(RadixTrieChildrenKind::EMPTY), capacity_log(0) {}
+
+template <typename K, typename V>
+data::RadixTrieChildren<K, V>::RadixTrieChildren(RadixTrieChildren<K, V> &&other)
+    : node4(other.node4), count(other.count), kind_(other.kind_), capacity_log(other.capacity_log)
+{
+    other.node4 = nullptr;
+    other.count = 0;
+    other.kind_ = RadixTrieChildrenKind::EMPTY;
+    other.capacity_log = 0;
+}
+
+template <typename K, typename V>
+void data::RadixTrieChildren<K, V>::operator=(RadixTrieChildren<K, V> &&other) {
+    if (this == &other) {
+        return;
+    }
+
+    this->node4 = other.node4;
+    this->count = other.count;
+    this->kind_ = other.kind_;
+    this->capacity_log = other.capacity_log;
+
+    other.node4 = nullptr;
+    other.count = 0;
+    other.kind_ = RadixTrieChildrenKind::EMPTY;
+    other.capacity_log = 0;
+}
+
+template <typename K, typename V>
+void data::RadixTrieChildren<K, V>::release(Arena &arena) {
+    this->free_block(arena);
+    this->count = 0;
+    this->kind_ = RadixTrieChildrenKind::EMPTY;
+}
+
+template <typename K, typename V>
+void data::RadixTrieChildren<K, V>::free_block(Arena &arena) {
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::EMPTY:
+            break;
+        case RadixTrieChildrenKind::NODE4:
+            arena.destroy(this->node4);
+            break;
+        case RadixTrieChildrenKind::NODE16:
+            arena.destroy(this->node16);
+            break;
+        case RadixTrieChildrenKind::NODE48:
+            arena.destroy(this->node48);
+            break;
+        case RadixTrieChildrenKind::NODE256:
+            arena.destroy(this->node256);
+            break;
+        case RadixTrieChildrenKind::EDGES:
+            free_edges(this->edges, this->capacity(), arena);
+            break;
+    }
+
+    this->node4 = nullptr;
+    this->capacity_log = 0;
+}
+
+template <typename K, typename V>
+size_t data::RadixTrieChildren<K, V>::capacity() const {
+    return ((size_t) 1) << this->capacity_log;
+}
+
+template <typename K, typename V>
+data::RadixTrieEdge<K, V> * data::RadixTrieChildren<K, V>::alloc_edges(size_t capacity, Arena &arena) {
+    static_assert(alignof(RadixTrieEdge<K, V>) <= Arena::ALIGNMENT, "Arena blocks are not aligned enough for this type");
+
+    RadixTrieEdge<K, V> * out = static_cast<RadixTrieEdge<K, V> *>(arena.allocate(capacity * sizeof(RadixTrieEdge<K, V>)));
+    std::uninitialized_default_construct(out, out + capacity);
+
+    return out;
+}
+
+template <typename K, typename V>
+void data::RadixTrieChildren<K, V>::free_edges(RadixTrieEdge<K, V> * edges, size_t capacity, Arena &arena) {
+    std::destroy(edges, edges + capacity);
+    arena.deallocate(edges, capacity * sizeof(RadixTrieEdge<K, V>));
+}
+
+template <typename K, typename V>
+size_t data::RadixTrieChildren<K, V>::edges_lower_bound(const K &symbol) const {
+    size_t lo = 0;
+    size_t hi = this->count;
+
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+
+        if (this->edges[mid].symbol < symbol) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+template <typename K, typename V>
+size_t data::RadixTrieChildren<K, V>::code(const K &symbol) {
+    if constexpr (!BYTE_SYMBOLS) {
+        // Only NODE48 and NODE256 use codes
+        __builtin_unreachable();
+    } else if constexpr (std::is_signed_v<K>) {
+        return ((uint8_t) symbol) ^ 0x80;
+    } else {
+        return (uint8_t) symbol;
+    }
+}
+
+template <typename K, typename V>
+K data::RadixTrieChildren<K, V>::decode(size_t code) {
+    if constexpr (!BYTE_SYMBOLS) {
+        __builtin_unreachable();
+    } else if constexpr (std::is_signed_v<K>) {
+        return (K) (uint8_t) (code ^ 0x80);
+    } else {
+        return (K) code;
+    }
+}
+
+template <typename K, typename V>
+size_t data::RadixTrieChildren<K, V>::size() const {
+    return this->count;
+}
+
+template <typename K, typename V>
+data::RadixTrieChildrenKind data::RadixTrieChildren<K, V>::kind() const {
+    return this->kind_;
+}
+
+template <typename K, typename V>
+template <const size_t M>
+data::RadixTrieNode<K, V> * data::RadixTrieChildren<K, V>::find_sorted(const RadixTrieSortedBlock<K, V, M> * block, size_t count, const K &symbol) {
+#ifdef __SSE2__
+    if constexpr (BYTE_SYMBOLS && M == 16) {
+        // Compare all 16 symbols at once and mask out the unused ones
+        const __m128i needle = _mm_set1_epi8((char) symbol);
+        const __m128i haystack = _mm_loadu_si128((const __m128i *) block->symbols);
+        const unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(needle, haystack)) & ((1u << count) - 1);
+
+        if (mask) {
+            return block->children[__builtin_ctz(mask)];
+        }
+
+        return nullptr;
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++) {
+        if (!(block->symbols[i] < symbol)) {
+            if (symbol < block->symbols[i]) {
+                return nullptr;
+            }
+
+            return block->children[i];
+        }
+    }
+
+    return nullptr;
+}
+
+template <typename K, typename V>
+template <const size_t M>
+void data::RadixTrieChildren<K, V>::put_sorted(RadixTrieSortedBlock<K, V, M> * block, size_t count, const K &symbol, RadixTrieNode<K, V> * child) {
+    size_t index = count;
+
+    while (index > 0 && symbol < block->symbols[index - 1]) {
+        block->symbols[index] = block->symbols[index - 1];
+        block->children[index] = block->children[index - 1];
+        index--;
+    }
+
+    block->symbols[index] = symbol;
+    block->children[index] = child;
+}
+
+template <typename K, typename V>
+template <const size_t M>
+void data::RadixTrieChildren<K, V>::del_sorted(RadixTrieSortedBlock<K, V, M> * block, size_t count, size_t index) {
+    for (size_t i = index; i < count - 1; i++) {
+        block->symbols[i] = block->symbols[i + 1];
+        block->children[i] = block->children[i + 1];
+    }
+}
+
+template <typename K, typename V>
+std::vector<data::RadixTrieEdge<K, V>> data::RadixTrieChildren<K, V>::collect() const {
+    std::vector<RadixTrieEdge<K, V>> out;
+    out.reserve(this->count);
+
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::EMPTY:
+            break;
+        case RadixTrieChildrenKind::NODE4:
+            for (size_t i = 0; i < this->count; i++) {
+                out.push_back(RadixTrieEdge<K, V>(this->node4->symbols[i], this->node4->children[i]));
+            }
+            break;
+        case RadixTrieChildrenKind::NODE16:
+            for (size_t i = 0; i < this->count; i++) {
+                out.push_back(RadixTrieEdge<K, V>(this->node16->symbols[i], this->node16->children[i]));
+            }
+            break;
+        case RadixTrieChildrenKind::NODE48:
+            for (size_t i = 0; i < 256; i++) {
+                if (this->node48->index[i]) {
+                    out.push_back(RadixTrieEdge<K, V>(decode(i), this->node48->children[this->node48->index[i] - 1]));
+                }
+            }
+            break;
+        case RadixTrieChildrenKind::NODE256:
+            for (size_t i = 0; i < 256; i++) {
+                if (this->node256->children[i]) {
+                    out.push_back(RadixTrieEdge<K, V>(decode(i), this->node256->children[i]));
+                }
+            }
+            break;
+        case RadixTrieChildrenKind::EDGES:
+            for (size_t i = 0; i < this->count; i++) {
+                out.push_back(this->edges[i]);
+            }
+            break;
+    }
+
+    return out;
+}
+
+template <typename K, typename V>
+void data::RadixTrieChildren<K, V>::convert(RadixTrieChildrenKind new_kind, Arena &arena) {
+    const std::vector<RadixTrieEdge<K, V>> children = this->collect();
+
+    this->free_block(arena);
+    this->kind_ = new_kind;
+
+    switch (new_kind) {
+        case RadixTrieChildrenKind::EMPTY:
+            break;
+        case RadixTrieChildrenKind::NODE4:
+            this->node4 = arena.create<Node4>();
+
+            for (size_t i = 0; i < children.size(); i++) {
+                this->node4->symbols[i] = children[i].symbol;
+                this->node4->children[i] = children[i].node;
+            }
+            break;
+        case RadixTrieChildrenKind::NODE16:
+            this->node16 = arena.create<Node16>();
+
+            for (size_t i = 0; i < children.size(); i++) {
+                this->node16->symbols[i] = children[i].symbol;
+                this->node16->children[i] = children[i].node;
+            }
+            break;
+        case RadixTrieChildrenKind::NODE48:
+            this->node48 = arena.create<Node48>();
+
+            for (size_t i = 0; i < children.size(); i++) {
+                this->node48->index[code(children[i].symbol)] = i + 1;
+                this->node48->children[i] = children[i].node;
+            }
+            break;
+        case RadixTrieChildrenKind::NODE256:
+            this->node256 = arena.create<Node256>();
+
+            for (size_t i = 0; i < children.size(); i++) {
+                this->node256->children[code(children[i].symbol)] = children[i].node;
+            }
+            break;
+        case RadixTrieChildrenKind::EDGES:
+            this->capacity_log = EDGES_INITIAL_CAPACITY_LOG;
+            this->edges = alloc_edges(this->capacity(), arena);
+
+            for (size_t i = 0; i < children.size(); i++) {
+                this->edges[i] = children[i];
+            }
+            break;
+    }
+}
+
+template <typename K, typename V>
+ptrdiff_t data::RadixTrieChildren<K, V>::slot_of(const K &symbol) const {
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::EMPTY:
+            return -1;
+        case RadixTrieChildrenKind::NODE4:
+            for (size_t i = 0; i < this->count; i++) {
+                if (!(this->node4->symbols[i] < symbol) && !(symbol < this->node4->symbols[i])) {
+                    return i;
+                }
+            }
+            return -1;
+        case RadixTrieChildrenKind::NODE16:
+            for (size_t i = 0; i < this->count; i++) {
+                if (!(this->node16->symbols[i] < symbol) && !(symbol < this->node16->symbols[i])) {
+                    return i;
+                }
+            }
+            return -1;
+        case RadixTrieChildrenKind::NODE48:
+            return this->node48->index[code(symbol)] ? code(symbol) : -1;
+        case RadixTrieChildrenKind::NODE256:
+            return this->node256->children[code(symbol)] ? code(symbol) : -1;
+        case RadixTrieChildrenKind::EDGES: {
+            const size_t index = this->edges_lower_bound(symbol);
+
+            if (index < this->count && !(symbol < this->edges[index].symbol)) {
+                return index;
+            }
+
+            return -1;
+        }
+    }
+
+    __builtin_unreachable();
+}
+
+template <typename K, typename V>
+data::RadixTrieNode<K, V> *& data::RadixTrieChildren<K, V>::at_slot(ptrdiff_t slot) {
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::NODE4:
+            return this->node4->children[slot];
+        case RadixTrieChildrenKind::NODE16:
+            return this->node16->children[slot];
+        case RadixTrieChildrenKind::NODE48:
+            return this->node48->children[this->node48->index[slot] - 1];
+        case RadixTrieChildrenKind::NODE256:
+            return this->node256->children[slot];
+        case RadixTrieChildrenKind::EDGES:
+            return this->edges[slot].node;
+        default:
+            __builtin_unreachable();
+    }
+}
+
+template <typename K, typename V>
+data::RadixTrieNode<K, V> * data::RadixTrieChildren<K, V>::find(const K &symbol) const {
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::EMPTY:
+            return nullptr;
+        case RadixTrieChildrenKind::NODE4:
+            return find_sorted(this->node4, this->count, symbol);
+        case RadixTrieChildrenKind::NODE16:
+            return find_sorted(this->node16, this->count, symbol);
+        case RadixTrieChildrenKind::NODE48: {
+            const uint8_t index = this->node48->index[code(symbol)];
+
+            if (!index) {
+                return nullptr;
+            }
+
+            return this->node48->children[index - 1];
+        }
+        case RadixTrieChildrenKind::NODE256:
+            return this->node256->children[code(symbol)];
+        case RadixTrieChildrenKind::EDGES: {
+            const ptrdiff_t slot = this->slot_of(symbol);
+
+            if (slot < 0) {
+                return nullptr;
+            }
+
+            return this->edges[slot].node;
+        }
+    }
+
+    __builtin_unreachable();
+}
+
+template <typename K, typename V>
+void data::RadixTrieChildren<K, V>::put(RadixTrieNode<K, V> * child, Arena &arena) {
+    const K &symbol = child->key[0];
+
+    // Grow into the next representation first if the current one is full
+    if (this->kind_ == RadixTrieChildrenKind::EMPTY) {
+        this->convert(RadixTrieChildrenKind::NODE4, arena);
+    } else if (this->kind_ == RadixTrieChildrenKind::NODE4 && this->count == 4) {
+        this->convert(RadixTrieChildrenKind::NODE16, arena);
+    } else if (this->kind_ == RadixTrieChildrenKind::NODE16 && this->count == 16) {
+        this->convert(BYTE_SYMBOLS ? RadixTrieChildrenKind::NODE48 : RadixTrieChildrenKind::EDGES, arena);
+    } else if (this->kind_ == RadixTrieChildrenKind::NODE48 && this->count == 48) {
+        this->convert(RadixTrieChildrenKind::NODE256, arena);
+    }
+
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::NODE4:
+            put_sorted(this->node4, this->count, symbol, child);
+            break;
+        case RadixTrieChildrenKind::NODE16:
+            put_sorted(this->node16, this->count, symbol, child);
+            break;
+        case RadixTrieChildrenKind::NODE48:
+            // Children are kept packed into the first `count` slots
+            this->node48->index[code(symbol)] = this->count + 1;
+            this->node48->children[this->count] = child;
+            break;
+        case RadixTrieChildrenKind::NODE256:
+            this->node256->children[code(symbol)] = child;
+            break;
+        case RadixTrieChildrenKind::EDGES: {
+            if (this->count == this->capacity()) {
+                RadixTrieEdge<K, V> * grown = alloc_edges(this->capacity() * 2, arena);
+                std::move(this->edges, this->edges + this->count, grown);
+                free_edges(this->edges, this->capacity(), arena);
+
+                this->edges = grown;
+                this->capacity_log++;
+            }
+
+            const size_t index = this->edges_lower_bound(symbol);
+            std::move_backward(this->edges + index, this->edges + this->count, this->edges + this->count + 1);
+            this->edges[index] = RadixTrieEdge<K, V>(symbol, child);
+            break;
+        }
+        default:
+            __builtin_unreachable();
+    }
+
+    this->count++;
+}
+
+template <typename K, typename V>
+void data::RadixTrieChildren<K, V>::replace(RadixTrieNode<K, V> * child) {
+    const ptrdiff_t slot = this->slot_of(child->key[0]);
+
+    if (slot >= 0) {
+        this->at_slot(slot) = child;
+    }
+}
+
+template <typename K, typename V>
+data::RadixTrieNode<K, V> * data::RadixTrieChildren<K, V>::del(const K &symbol, Arena &arena) {
+    const ptrdiff_t slot = this->slot_of(symbol);
+
+    if (slot < 0) {
+        return nullptr;
+    }
+
+    RadixTrieNode<K, V> * out = this->at_slot(slot);
+
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::NODE4:
+            del_sorted(this->node4, this->count, slot);
+            break;
+        case RadixTrieChildrenKind::NODE16:
+            del_sorted(this->node16, this->count, slot);
+            break;
+        case RadixTrieChildrenKind::NODE48: {
+            // Move the child in the last slot into the hole to keep the children packed
+            const size_t hole = this->node48->index[slot] - 1;
+            const size_t last = this->count - 1;
+            this->node48->index[slot] = 0;
+
+            if (hole != last) {
+                RadixTrieNode<K, V> * moved = this->node48->children[last];
+                this->node48->children[hole] = moved;
+                this->node48->index[code(moved->key[0])] = hole + 1;
+            }
+
+            this->node48->children[last] = nullptr;
+            break;
+        }
+        case RadixTrieChildrenKind::NODE256:
+            this->node256->children[slot] = nullptr;
+            break;
+        case RadixTrieChildrenKind::EDGES:
+            std::move(this->edges + slot + 1, this->edges + this->count, this->edges + slot);
+            break;
+        default:
+            __builtin_unreachable();
+    }
+
+    this->count--;
+
+    // Shrink with some slack below each capacity, so that alternating puts and deletes at a
+    // boundary don't convert back and forth
+    if (!this->count) {
+        this->convert(RadixTrieChildrenKind::EMPTY, arena);
+    } else if (this->kind_ == RadixTrieChildrenKind::NODE16 && this->count <= 3) {
+        this->convert(RadixTrieChildrenKind::NODE4, arena);
+    } else if ((this->kind_ == RadixTrieChildrenKind::NODE48 || this->kind_ == RadixTrieChildrenKind::EDGES) && this->count <= 12) {
+        this->convert(RadixTrieChildrenKind::NODE16, arena);
+    } else if (this->kind_ == RadixTrieChildrenKind::NODE256 && this->count <= 37) {
+        this->convert(RadixTrieChildrenKind::NODE48, arena);
+    }
+
+    return out;
+}
+
+template <typename K, typename V>
+data::RadixTrieNode<K, V> * data::RadixTrieChildren<K, V>::first() const {
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::EMPTY:
+            return nullptr;
+        case RadixTrieChildrenKind::NODE4:
+            return this->node4->children[0];
+        case RadixTrieChildrenKind::NODE16:
+            return this->node16->children[0];
+        case RadixTrieChildrenKind::NODE48:
+            for (size_t i = 0; i < 256; i++) {
+                if (this->node48->index[i]) {
+                    return this->node48->children[this->node48->index[i] - 1];
+                }
+            }
+            return nullptr;
+        case RadixTrieChildrenKind::NODE256:
+            for (size_t i = 0; i < 256; i++) {
+                if (this->node256->children[i]) {
+                    return this->node256->children[i];
+                }
+            }
+            return nullptr;
+        case RadixTrieChildrenKind::EDGES:
+            return this->edges[0].node;
+    }
+
+    __builtin_unreachable();
+}
+
+template <typename K, typename V>
+data::RadixTrieNode<K, V> * data::RadixTrieChildren<K, V>::last() const {
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::EMPTY:
+            return nullptr;
+        case RadixTrieChildrenKind::NODE4:
+            return this->node4->children[this->count - 1];
+        case RadixTrieChildrenKind::NODE16:
+            return this->node16->children[this->count - 1];
+        case RadixTrieChildrenKind::NODE48:
+            for (size_t i = 256; i > 0; i--) {
+                if (this->node48->index[i - 1]) {
+                    return this->node48->children[this->node48->index[i - 1] - 1];
+                }
+            }
+            return nullptr;
+        case RadixTrieChildrenKind::NODE256:
+            for (size_t i = 256; i > 0; i--) {
+                if (this->node256->children[i - 1]) {
+                    return this->node256->children[i - 1];
+                }
+            }
+            return nullptr;
+        case RadixTrieChildrenKind::EDGES:
+            return this->edges[this->count - 1].node;
+    }
+
+    __builtin_unreachable();
+}
+
+template <typename K, typename V>
+data::RadixTrieNode<K, V> * data::RadixTrieChildren<K, V>::next(const K &symbol) const {
+    switch (this->kind_) {
+        case RadixTrieChildrenKind::EMPTY:
+            return nullptr;
+        case RadixTrieChildrenKind::NODE4:
+            for (size_t i = 0; i < this->count; i++) {
+                if (symbol < this->node4->symbols[i]) {
+                    return this->node4->children[i];
+                }
+            }
+            return nullptr;
+        case RadixTrieChildrenKind::NODE16:
+            for (size_t i = 0; i < this->count; i++) {
+                if (symbol < this->node16->symbols[i]) {
+                    return this->node16->children[i];
+                }
+            }
+            return nullptr;
+        case RadixTrieChildrenKind::NODE48:
+            for (size_t i = code(symbol) + 1; i < 256; i++) {
+                if (this->node48->index[i]) {
+                    return this->node48->children[this->node48->index[i] - 1];
+                }
+            }
+            return nullptr;
+        case RadixTrieChildrenKind::NODE256:
+            for (size_t i = code(symbol) + 1; i < 256; i++) {
+                if (this->node256->children[i]) {
+                    return this->node256->children[i];
+                }
+            }
+            return nullptr;
+        case RadixTrieChildrenKind::EDGES: {
+            size_t index = this->edges_lower_bound(symbol);
+
+            if (index < this->count && !(symbol < this->edges[index].symbol)) {
+                index++;
+            }
+
+            if (index == this->count) {
+                return nullptr;
+            }
+
+            return this->edges[index].node;
+        }
+    }
+
+    __builtin_unreachable();
+}
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef INCLUDE_STRUCTURES_RADIX_TRIE_FRAGMENT_H
+#define INCLUDE_STRUCTURES_RADIX_TRIE_FRAGMENT_H
+
+#include <algorithm>
+#include <memory>
+#include <stdint.h>
+#include <stdlib.h>
+#include <type_traits>
+#include <vector>
+
+#include "arena.h"
+
+namespace data {
+    /**
+     * The fragment of a key held by a radix trie node. Most edge labels are short, so fragments of up
+     * to `INLINE_BYTES` bytes of trivially copyable symbols are stored in the fragment itself. Longer
+     * fragments are allocated from the trie's arena. A fragment is only a handle: copying it does not
+     * copy symbols that live in the arena, and the trie is responsible for releasing it.
+     *
+     * Symbols past the end of a fragment's arena block are uninitialized, so a fragment can be shortened
+     * or extended in place as long as it fits in its block.
+     */
+    template <typename K>
+    class RadixTrieFragment {
+        public:
+            static constexpr size_t INLINE_BYTES = 16;
+
+            /**
+             * The number of symbols that can be stored inline. Symbols that are not trivially copyable
+             * are always stored in the arena.
+             */
+            static constexpr size_t INLINE_CAPACITY = std::is_trivially_copyable_v<K> ? INLINE_BYTES / sizeof(K) : 0;
+
+        private:
+            union {
+                K * heap;
+                alignas(K) unsigned char buf[INLINE_BYTES];
+            };
+            uint32_t len;
+            // Number of symbols in the arena block, or zero if the symbols are inline
+            uint32_t cap;
+
+            K * items();
+
+            /**
+             * Allocates an arena block that can hold at least `min_cap` symbols. The block is rounded
+             * up to the arena's alignment, since that memory would be wasted otherwise.
+             */
+            static K * alloc(Arena &arena, size_t min_cap, uint32_t &cap);
+
+            /**
+             * Makes room for `new_len` symbols, moving the existing symbols to a larger arena block if
+             * needed. Does not change the length.
+             */
+            void reserve(Arena &arena, size_t new_len);
+
+        public:
+            RadixTrieFragment();
+
+            /**
+             * Copies `len` symbols into a new fragment.
+             */
+            RadixTrieFragment(Arena &arena, const K * items, size_t len);
+
+            /**
+             * Destroys the symbols and returns their memory to the arena. The fragment is empty afterward.
+             */
+            void release(Arena &arena);
+
+            /**
+             * Drops the first `n` symbols. The remaining symbols are moved inline if they fit, and are
+             * otherwise shifted within the same block.
+             */
+            void remove_prefix(Arena &arena, size_t n);
+
+            /**
+             * Appends `n` symbols, reusing the fragment's block if they fit.
+             */
+            void append(Arena &arena, const K * items, size_t n);
+
+            /**
+             * True if the symbols are stored in the fragment instead of the arena.
+             */
+            bool is_inline() const;
+
+            size_t size() const;
+
+            const K * data() const;
+
+            const K * begin() const;
+
+            const K * end() const;
+
+            const K& operator[](size_t i) const;
+
+            bool operator==(const std::vector<K> &other) const;
+    };
+}
+
+template <typename K>
+data::RadixTrieFragment<K>::RadixTrieFragment() : heap(nullptr), len(0), cap(0) {}
+
+template <typename K>
+data::RadixTrieFragment<K>::RadixTrieFragment(Arena &arena, const K * items, size_t len) : heap(nullptr), len(len), cap(0) {
+    if (len > INLINE_CAPACITY) {
+        this->heap = alloc(arena, len, this->cap);
+    }
+
+    std::uninitialized_copy(items, items + len, this->items());
+}
+
+template <typename K>
+K * data::RadixTrieFragment<K>::alloc(Arena &arena, size_t min_cap, uint32_t &cap) {
+    static_assert(alignof(K) <= Arena::ALIGNMENT, "Arena blocks are not aligned enough for this type");
+
+    const size_t bytes = (min_cap * sizeof(K) + Arena::ALIGNMENT - 1) & ~(Arena::ALIGNMENT - 1);
+    cap = bytes / sizeof(K);
+
+    return static_cast<K *>(arena.allocate(cap * sizeof(K)));
+}
+
+template <typename K>
+K * data::RadixTrieFragment<K>::items() {
+    if (this->cap) {
+        return this->heap;
+    }
+
+    return reinterpret_cast<K *>(this->buf);
+}
+
+template <typename K>
+void data::RadixTrieFragment<K>::release(Arena &arena) {
+    std::destroy(this->items(), this->items() + this->len);
+
+    if (this->cap) {
+        arena.deallocate(this->heap, this->cap * sizeof(K));
+    }
+
+    this->heap = nullptr;
+    this->len = 0;
+    this->cap = 0;
+}
+
+template <typename K>
+void data::RadixTrieFragment<K>::reserve(Arena &arena, size_t new_len) {
+    if (new_len <= INLINE_CAPACITY && !this->cap) {
+        return;
+    }
+
+    if (new_len <= this->cap) {
+        return;
+    }
+
+    K * old_items = this->items();
+    uint32_t new_cap;
+    K * new_items = alloc(arena, new_len, new_cap);
+
+    std::uninitialized_move(old_items, old_items + this->len, new_items);
+    std::destroy(old_items, old_items + this->len);
+
+    if (this->cap) {
+        arena.deallocate(this->heap, this->cap * sizeof(K));
+    }
+
+    this->heap = new_items;
+    this->cap = new_cap;
+}
+
+template <typename K>
+void data::RadixTrieFragment<K>::remove_prefix(Arena &arena, size_t n) {
+    K * old_items = this->items();
+    const size_t new_len = this->len - n;
+
+    // Only trivially copyable symbols are ever inline. Others stay in the block even when none are
+    // left, so that they are destroyed below.
+    if (std::is_trivially_copyable_v<K> && this->cap && new_len <= INLINE_CAPACITY) {
+        // Trivially copyable, so the symbols can be copied out before the block is freed
+        K * block = this->heap;
+        const uint32_t block_cap = this->cap;
+
+        std::copy(block + n, block + this->len, reinterpret_cast<K *>(this->buf));
+        arena.deallocate(block, block_cap * sizeof(K));
+
+        this->cap = 0;
+        this->len = new_len;
+
+        return;
+    }
+
+    std::move(old_items + n, old_items + this->len, old_items);
+    std::destroy(old_items + new_len, old_items + this->len);
+
+    this->len = new_len;
+}
+
+template <typename K>
+void data::RadixTrieFragment<K>::append(Arena &arena, const K * items, size_t n) {
+    this->reserve(arena, this->len + n);
+
+    std::uninitialized_copy(items, items + n, this->items() + this->len);
+
+    this->len += n;
+}
+
+template <typename K>
+bool data::RadixTrieFragment<K>::is_inline() const {
+    return !this->cap;
+}
+
+template <typename K>
+size_t data::RadixTrieFragment<K>::size() const {
+    return this->len;
+}
+
+template <typename K>
+const K * data::RadixTrieFragment<K>::data() const {
+    if (this->cap) {
+        return this->heap;
+    }
+
+    return reinterpret_cast<const K *>(this->buf);
+}
+
+template <typename K>
+const K * data::RadixTrieFragment<K>::begin() const {
+    return this->data();
+}
+
+template <typename K>
+const K * data::RadixTrieFragment<K>::end() const {
+    return this->data() + this->len;
+}
+
+template <typename K>
+const K& data::RadixTrieFragment<K>::operator[](size_t i) const {
+    return this->data()[i];
+}
+
+template <typename K>
+bool data::RadixTrieFragment<K>::operator==(const std::vector<K> &other) const {
+    if (this->len != other.size()) {
+        return false;
+    }
+
+    const K * items = this->data();
+
+    for (size_t i = 0; i < this->len; i++) {
+        if (!(items[i] == other[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif
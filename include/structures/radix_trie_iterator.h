@@ -2,166 +2,283 @@
 #define INCLUDE_STRUCTURES_RADIX_TRIE_ITERATOR_H
 
 #include <iterator>
+#include <ranges>
+#include <span>
+#include <stdint.h>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "radix_trie_children.h"
 #include "radix_trie_node.h"
-#include "sorted_vec.h"
 
 namespace data {
     /**
      * Custom iterator for RadixTrie. The "value type" of the iterator is a pair where
      * the first item is the full key to an entry, and the second item is a pointer to the
-     * corresponding value. Null nodes are skipped.
+     * corresponding value. Null nodes are skipped, and entries are visited in lexicographic order.
+     *
+     * The iterator keeps the path from the top of the trie to the current node, along with the key
+     * spelled out by that path. Moving to the next entry only pushes and pops the fragments that change,
+     * so a full scan is linear in the size of the trie and does not allocate once the key buffer has
+     * grown to the longest key.
+     *
+     * An iterator can also be confined to the subtree under one node, and can stop after a given number
+     * of entries. RadixTrie uses this for prefix queries.
      *
      * Because the value type is constructed by the iterator (and is not actually present in the
      * radix trie), the iterator can only be used to get full pairs (instead of references or pointers
-     * to pairs).
+     * to pairs). The key is a view into the iterator's buffer, so it is only valid until the iterator
+     * is incremented or destroyed. Copy it to keep it.
+     *
+     * If IS_CONST is true, the iterator only gives out const pointers to values.
      */
-    template <typename K, typename V>
+    template <typename K, typename V, const bool IS_CONST = false>
     class RadixTrieIterator {
         private:
-            SortedVec<RadixTrieNode<K, V> *> * top_nodes;
-            RadixTrieNode<K, V> * curr_node;
-            bool end;
+            typedef std::conditional_t<IS_CONST, const RadixTrieNode<K, V>, RadixTrieNode<K, V>> node_type;
+            typedef std::conditional_t<IS_CONST, const RadixTrieChildren<K, V>, RadixTrieChildren<K, V>> children_type;
+
+            // Siblings of the first node in the path, or null if the iterator is confined to that node's subtree
+            children_type * top_nodes;
+            // Nodes from the first node down to the current node. Empty at the end.
+            std::vector<node_type *> path;
+            // The full key of the current node
+            std::vector<K> key;
+            // Number of entries left before the iterator stops, including the current one
+            size_t remaining;
 
-            RadixTrieNode<K, V> * next_node_up(RadixTrieNode<K, V> * node);
+            void push(node_type * node);
+
+            void pop();
+
+            /**
+             * Follows the first children from the current node until it reaches a node with a value.
+             */
+            void descend();
+
+            void finish();
 
             constexpr void check_impl();
 
         public:
             using iterator_category = std::forward_iterator_tag;
-            using value_type = std::pair<std::vector<K>, V *>;
+            using value_type = std::pair<std::span<const K>, std::conditional_t<IS_CONST, const V, V> *>;
             using difference_type = int;
             using pointer = value_type *;
             using reference = value_type&;
 
+            /**
+             * Creates an end iterator.
+             */
             RadixTrieIterator();
- 
-            RadixTrieIterator(SortedVec<RadixTrieNode<K, V> *> * top_nodes, RadixTrieNode<K, V> * node, bool end);
 
-            RadixTrieIterator<K, V>& operator++();
+            /**
+             * Creates an iterator over at most `limit` entries under `top_nodes`.
+             */
+            RadixTrieIterator(children_type * top_nodes, size_t limit = SIZE_MAX);
+
+            /**
+             * Creates an iterator over at most `limit` entries in the subtree rooted at `root`, starting
+             * with `root` itself if it has a value.
+             */
+            RadixTrieIterator(node_type * root, size_t limit);
 
-            RadixTrieIterator<K, V> operator++(int);
+            RadixTrieIterator<K, V, IS_CONST>& operator++();
 
-            bool operator==(const RadixTrieIterator<K, V> &it) const;
+            RadixTrieIterator<K, V, IS_CONST> operator++(int);
 
-            bool operator!=(const RadixTrieIterator<K, V> &it) const;
+            bool operator==(const RadixTrieIterator<K, V, IS_CONST> &it) const;
+
+            bool operator!=(const RadixTrieIterator<K, V, IS_CONST> &it) const;
 
             value_type operator*() const;
     };
+
+    /**
+     * A lazy range of radix trie entries, starting at a given iterator and ending when the iterator
+     * does. Entries are produced as the range is iterated, so the range uses constant memory (apart from
+     * the iterator's key buffer) no matter how many entries it covers, and can be passed to std::ranges
+     * algorithms and views.
+     */
+    template <typename K, typename V, const bool IS_CONST = false>
+    class RadixTrieRange : public std::ranges::view_interface<RadixTrieRange<K, V, IS_CONST>> {
+        private:
+            RadixTrieIterator<K, V, IS_CONST> first;
+
+        public:
+            RadixTrieRange();
+
+            RadixTrieRange(RadixTrieIterator<K, V, IS_CONST> first);
+
+            RadixTrieIterator<K, V, IS_CONST> begin() const;
+
+            RadixTrieIterator<K, V, IS_CONST> end() const;
+    };
 }
 
-template <typename K, typename V>
-constexpr void data::RadixTrieIterator<K, V>::check_impl() {
+template <typename K, typename V, const bool IS_CONST>
+constexpr void data::RadixTrieIterator<K, V, IS_CONST>::check_impl() {
     // Require that this class satisfies the forward iterator concept at compile time.
     // The assertion is checked when the template is instantiated, so it cannot be
     // outside of RadixTrieIterator with generic template arguments. It can be in the
     // template class declaration, but it won't be valid because the class
     // does not exist at this point. The assertion has to be checked when the class exists
     // and is instantiated with type arguments.
-    static_assert(std::forward_iterator<RadixTrieIterator<K, V>>);
+    static_assert(std::forward_iterator<RadixTrieIterator<K, V, IS_CONST>>);
 }
 
-template <typename K, typename V>
-data::RadixTrieIterator<K, V>::RadixTrieIterator() : top_nodes(nullptr), curr_node(nullptr), end(true) {
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieIterator<K, V, IS_CONST>::RadixTrieIterator() : top_nodes(nullptr), path(), key(), remaining(0) {
     this->check_impl();
 }
 
-template <typename K, typename V>
-data::RadixTrieIterator<K, V>::RadixTrieIterator(SortedVec<RadixTrieNode<K, V> *> * top_nodes, RadixTrieNode<K, V> * node, bool end)
-    : top_nodes(top_nodes), curr_node(node), end(end) 
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieIterator<K, V, IS_CONST>::RadixTrieIterator(children_type * top_nodes, size_t limit)
+    : top_nodes(top_nodes), path(), key(), remaining(limit)
 {
     this->check_impl();
-}
 
-template <typename K, typename V>
-data::RadixTrieIterator<K, V>& data::RadixTrieIterator<K, V>::operator++() {
-    if (this->end) {
-        return *this;
+    if (top_nodes->size() && limit) {
+        this->push(top_nodes->first());
+        this->descend();
     }
+}
 
-    if (curr_node->children.size()) {
-        curr_node = curr_node->children[0];
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieIterator<K, V, IS_CONST>::RadixTrieIterator(node_type * root, size_t limit)
+    : top_nodes(nullptr), path(), key(), remaining(limit)
+{
+    this->check_impl();
 
-        while (!curr_node->val.has_value()) {
-            // A leaf node cannot have a null value; at some point we will reach
-            // a non-null node
-            curr_node = curr_node->children[0];
-        }
-    } else {
-        RadixTrieNode<K, V> * node = this->next_node_up(curr_node);
+    if (!limit) {
+        return;
+    }
 
-        if (node) {
-            this->curr_node = node;
-        } else {
-            this->end = true;
-        }
+    // The key above the root is only needed once, so it is fine to build it from the root's ancestors
+    if (root->parent) {
+        this->key = root->parent->full_key();
     }
 
-    return *this;
+    this->push(root);
+    this->descend();
 }
 
-template <typename K, typename V>
-data::RadixTrieIterator<K, V> data::RadixTrieIterator<K, V>::operator++(int) {
-    RadixTrieIterator<K, V> it = RadixTrieIterator<K, V>(*this);
+template <typename K, typename V, const bool IS_CONST>
+void data::RadixTrieIterator<K, V, IS_CONST>::push(node_type * node) {
+    this->path.push_back(node);
+    this->key.insert(std::end(this->key), std::begin(node->key), std::end(node->key));
+}
 
-    ++(*this);
+template <typename K, typename V, const bool IS_CONST>
+void data::RadixTrieIterator<K, V, IS_CONST>::pop() {
+    this->key.erase(std::end(this->key) - this->path.back()->key.size(), std::end(this->key));
+    this->path.pop_back();
+}
 
-    return it;
+template <typename K, typename V, const bool IS_CONST>
+void data::RadixTrieIterator<K, V, IS_CONST>::descend() {
+    while (!this->path.back()->val.has_value()) {
+        // A leaf node cannot have a null value; at some point we will reach
+        // a non-null node
+        this->push(this->path.back()->children.first());
+    }
 }
 
-template <typename K, typename V>
-data::RadixTrieNode<K, V> * data::RadixTrieIterator<K, V>::next_node_up(RadixTrieNode<K, V> * node) {
-    SortedVec<RadixTrieNode<K, V> *> * siblings;
+template <typename K, typename V, const bool IS_CONST>
+void data::RadixTrieIterator<K, V, IS_CONST>::finish() {
+    this->path.clear();
+    this->key.clear();
+    this->remaining = 0;
+}
 
-    if (node->parent) {
-        siblings = &node->parent->children;
-    } else {
-        siblings = this->top_nodes;
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieIterator<K, V, IS_CONST>& data::RadixTrieIterator<K, V, IS_CONST>::operator++() {
+    if (!this->path.size()) {
+        return *this;
     }
 
-    for (size_t i = 0; i < siblings->size(); i++) {
-        if ((*siblings)[i] != node) {
-            continue;
-        }
+    if (!--this->remaining) {
+        this->finish();
+        return *this;
+    }
 
-        if (i < (siblings->size() - 1)) {
-            RadixTrieNode<K, V> * out = (*siblings)[i + 1];
+    node_type * node = this->path.back();
 
-            while (!out->val.has_value()) {
-                // A leaf node cannot have a null value; at some point we will reach
-                // a non-null node
-                out = out->children[0];
-            }
+    if (node->children.size()) {
+        this->push(node->children.first());
+        this->descend();
 
-            return out;
-        }
+        return *this;
+    }
 
-        if (node->parent) {
-            return this->next_node_up(node->parent);
-        }
+    // Climb until some node on the path has a next sibling. The first node only has siblings if the
+    // iterator is not confined to its subtree.
+    while (this->path.size()) {
+        node = this->path.back();
+
+        children_type * siblings = this->path.size() > 1 ? &this->path[this->path.size() - 2]->children : this->top_nodes;
+        node_type * next = siblings ? siblings->next(node->key[0]) : nullptr;
 
-        return nullptr;
+        this->pop();
+
+        if (next) {
+            this->push(next);
+            this->descend();
+
+            return *this;
+        }
     }
 
-    return nullptr;
+    this->finish();
+
+    return *this;
+}
+
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieIterator<K, V, IS_CONST> data::RadixTrieIterator<K, V, IS_CONST>::operator++(int) {
+    RadixTrieIterator<K, V, IS_CONST> it = RadixTrieIterator<K, V, IS_CONST>(*this);
+
+    ++(*this);
+
+    return it;
 }
 
-template <typename K, typename V>
-bool data::RadixTrieIterator<K, V>::operator==(const RadixTrieIterator<K, V> &it) const {
+template <typename K, typename V, const bool IS_CONST>
+bool data::RadixTrieIterator<K, V, IS_CONST>::operator==(const RadixTrieIterator<K, V, IS_CONST> &it) const {
     // There is no need to check if "top_nodes" is equal. Unless you're doing
     // something weird, a single node can't be shared by more than one radix trie
-    return this->curr_node == it.curr_node && this->end == it.end;
+    if (!this->path.size() || !it.path.size()) {
+        return this->path.size() == it.path.size();
+    }
+
+    return this->path.back() == it.path.back();
 }
 
-template <typename K, typename V>
-bool data::RadixTrieIterator<K, V>::operator!=(const RadixTrieIterator<K, V> &it) const {
+template <typename K, typename V, const bool IS_CONST>
+bool data::RadixTrieIterator<K, V, IS_CONST>::operator!=(const RadixTrieIterator<K, V, IS_CONST> &it) const {
     return !(*this == it);
 }
 
-template <typename K, typename V>
-typename data::RadixTrieIterator<K, V>::value_type data::RadixTrieIterator<K, V>::operator*() const {
-    return std::pair(this->curr_node->full_key(), &this->curr_node->val.value());
+template <typename K, typename V, const bool IS_CONST>
+typename data::RadixTrieIterator<K, V, IS_CONST>::value_type data::RadixTrieIterator<K, V, IS_CONST>::operator*() const {
+    return value_type(std::span<const K>(this->key), &this->path.back()->val.value());
+}
+
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieRange<K, V, IS_CONST>::RadixTrieRange() : first() {}
+
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieRange<K, V, IS_CONST>::RadixTrieRange(RadixTrieIterator<K, V, IS_CONST> first) : first(first) {}
+
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieIterator<K, V, IS_CONST> data::RadixTrieRange<K, V, IS_CONST>::begin() const {
+    return this->first;
+}
+
+template <typename K, typename V, const bool IS_CONST>
+data::RadixTrieIterator<K, V, IS_CONST> data::RadixTrieRange<K, V, IS_CONST>::end() const {
+    return RadixTrieIterator<K, V, IS_CONST>();
 }
 
 #endif
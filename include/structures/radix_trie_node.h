@@ -2,49 +2,46 @@
 #define INCLUDE_STRUCTURES_RADIX_TRIE_NODE_H
 
 #include <optional>
+#include <span>
 #include <vector>
 
-#include "sorted_vec.h"
+#include "radix_trie_children.h"
+#include "radix_trie_fragment.h"
 
 namespace data {
+    /**
+     * A node in a radix trie. Nodes, their key fragments, and their children's blocks are all allocated
+     * from the trie's arena and are owned by the trie, not by their parents.
+     */
     template <typename K, typename V>
     struct RadixTrieNode {
-        std::vector<K> key;
+        RadixTrieFragment<K> key;
         std::optional<V> val;
-        // The parent is not owned by the node
         struct RadixTrieNode<K, V> * parent;
-        SortedVec<struct RadixTrieNode<K, V> *> children;
+        RadixTrieChildren<K, V> children;
 
-        RadixTrieNode(std::vector<K> key, std::optional<V> val, struct RadixTrieNode<K, V> * parent);
-
-        ~RadixTrieNode();
+        RadixTrieNode(RadixTrieFragment<K> key, std::optional<V> val, struct RadixTrieNode<K, V> * parent);
 
         /**
          * Returns the length of the longest common prefix shared by this key and the other key.
          */
-        size_t common_prefix_len(const std::vector<K> &key, size_t offset) const;
+        size_t common_prefix_len(std::span<const K> key, size_t offset) const;
 
         std::vector<K> full_key() const;
     };
 }
 
 template <typename K, typename V>
-data::RadixTrieNode<K, V>::RadixTrieNode(std::vector<K> key, std::optional<V> val, RadixTrieNode<K, V> * parent)
-    : key(key), val(val), parent(parent), children(SortedVec<RadixTrieNode<K, V> *>()) {}
-
-template <typename K, typename V>
-data::RadixTrieNode<K, V>::~RadixTrieNode() {
-    for (size_t i = 0; i < this->children.size(); i++) {
-        delete this->children[i];
-    }
-}
+data::RadixTrieNode<K, V>::RadixTrieNode(RadixTrieFragment<K> key, std::optional<V> val, RadixTrieNode<K, V> * parent)
+    : key(key), val(val), parent(parent), children(RadixTrieChildren<K, V>()) {}
 
 template <typename K, typename V>
-size_t data::RadixTrieNode<K, V>::common_prefix_len(const std::vector<K> &other_key, size_t offset) const {
+size_t data::RadixTrieNode<K, V>::common_prefix_len(std::span<const K> other_key, size_t offset) const {
     const size_t min_len = std::min(this->key.size(), other_key.size() - offset);
+    const K * key = this->key.data();
 
     for (size_t i = 0; i < min_len; i++) {
-        if (this->key[i] != other_key[i + offset]) {
+        if (key[i] != other_key[i + offset]) {
             return i;
         }
     }
@@ -54,7 +51,7 @@ size_t data::RadixTrieNode<K, V>::common_prefix_len(const std::vector<K> &other_
 
 template <typename K, typename V>
 std::vector<K> data::RadixTrieNode<K, V>::full_key() const {
-    std::vector<const std::vector<K> *> keys;
+    std::vector<const RadixTrieFragment<K> *> keys;
     const RadixTrieNode<K, V> * node = this;
 
     while (node) {
@@ -65,7 +62,7 @@ std::vector<K> data::RadixTrieNode<K, V>::full_key() const {
     std::vector<K> out;
 
     while (keys.size()) {
-        const std::vector<K> * key = keys.back();
+        const RadixTrieFragment<K> * key = keys.back();
         keys.pop_back();
 
         out.insert(std::end(out), std::begin(*key), std::end(*key));
@@ -0,0 +1,150 @@
+#ifndef INCLUDE_STRUCTURES_SEARCH_H
+#define INCLUDE_STRUCTURES_SEARCH_H
+
+#include <stdlib.h>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "../traits.h"
+
+namespace data {
+    /**
+     * Returns the position of the first of `len` sorted items that is not less than `item`. This is the
+     * search used by SortedArray and SortedVec.
+     *
+     * For most types this is an ordinary binary search. For arithmetic types, the search is branchless:
+     * each step picks the next half with a conditional move instead of a jump, so there is nothing to
+     * mispredict. Once the remaining window fits in a cache line, the items in it that are less than
+     * `item` are counted, which finds the position without any more branches on the data.
+     */
+    template <PartialOrd T>
+    size_t lower_bound(T * items, size_t len, const std::remove_const_t<T> &item);
+
+    /**
+     * Returns how many of `len` items are less than `item`. Signed 32 and 64 bit integers, floats and
+     * doubles are compared several at a time with AVX2 or SSE, depending on which one the compiler is
+     * allowed to use. Anything else, and any items left over, are compared one at a time.
+     */
+    template <PartialOrd T>
+    size_t count_less(T * items, size_t len, const std::remove_const_t<T> &item);
+}
+
+namespace {
+    template <typename T, const size_t SIZE>
+    constexpr bool is_signed_int = std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == SIZE;
+}
+
+template <data::PartialOrd T>
+size_t data::lower_bound(T * items, size_t len, const std::remove_const_t<T> &item) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        constexpr size_t LINEAR_WINDOW = 64 / sizeof(T);
+
+        T * base = items;
+        size_t n = len;
+
+        // The answer is always in [base, base + n]
+        while (n > LINEAR_WINDOW) {
+            const size_t half = n / 2;
+
+            base = base[half] < item ? base + half : base;
+            n -= half;
+        }
+
+        return (base - items) + count_less(base, n, item);
+    } else {
+        size_t l = 0;
+        size_t r = len;
+
+        while (l < r) {
+            size_t m = (l + r) >> 1;
+
+            if (items[m] < item) {
+                l = m + 1;
+            } else {
+                r = m;
+            }
+        }
+
+        return l;
+    }
+}
+
+template <data::PartialOrd T>
+size_t data::count_less(T * items, size_t len, const std::remove_const_t<T> &item) {
+    typedef std::remove_const_t<T> item_type;
+
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    if constexpr (is_signed_int<item_type, 4>) {
+        const __m256i needle = _mm256_set1_epi32(item);
+
+        for (; i + 8 <= len; i += 8) {
+            const __m256i vals = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(items + i));
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, vals))));
+        }
+    } else if constexpr (is_signed_int<item_type, 8>) {
+        const __m256i needle = _mm256_set1_epi64x(item);
+
+        for (; i + 4 <= len; i += 4) {
+            const __m256i vals = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(items + i));
+            count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, vals))));
+        }
+    } else if constexpr (std::is_same_v<item_type, float>) {
+        const __m256 needle = _mm256_set1_ps(item);
+
+        for (; i + 8 <= len; i += 8) {
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(items + i), needle, _CMP_LT_OQ)));
+        }
+    } else if constexpr (std::is_same_v<item_type, double>) {
+        const __m256d needle = _mm256_set1_pd(item);
+
+        for (; i + 4 <= len; i += 4) {
+            count += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(items + i), needle, _CMP_LT_OQ)));
+        }
+    }
+#elif defined(__SSE2__)
+    if constexpr (is_signed_int<item_type, 4>) {
+        const __m128i needle = _mm_set1_epi32(item);
+
+        for (; i + 4 <= len; i += 4) {
+            const __m128i vals = _mm_loadu_si128(reinterpret_cast<const __m128i *>(items + i));
+            count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(needle, vals))));
+        }
+    } else if constexpr (std::is_same_v<item_type, float>) {
+        const __m128 needle = _mm_set1_ps(item);
+
+        for (; i + 4 <= len; i += 4) {
+            count += __builtin_popcount(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(items + i), needle)));
+        }
+    } else if constexpr (std::is_same_v<item_type, double>) {
+        const __m128d needle = _mm_set1_pd(item);
+
+        for (; i + 2 <= len; i += 2) {
+            count += __builtin_popcount(_mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(items + i), needle)));
+        }
+    }
+#if defined(__SSE4_2__)
+    else if constexpr (is_signed_int<item_type, 8>) {
+        const __m128i needle = _mm_set1_epi64x(item);
+
+        for (; i + 2 <= len; i += 2) {
+            const __m128i vals = _mm_loadu_si128(reinterpret_cast<const __m128i *>(items + i));
+            count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(needle, vals))));
+        }
+    }
+#endif
+#endif
+
+    for (; i < len; i++) {
+        count += items[i] < item;
+    }
+
+    return count;
+}
+
+#endif
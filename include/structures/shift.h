@@ -0,0 +1,52 @@
+#ifndef INCLUDE_STRUCTURES_SHIFT_H
+#define INCLUDE_STRUCTURES_SHIFT_H
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+namespace data {
+    /**
+     * Moves `items[from]` to `items[len - 1]` up by one position, leaving a moved-from item at `from`.
+     * `items[len]` must already hold an object, which is overwritten. Trivially copyable items are
+     * moved with one memmove, and anything else is moved one at a time with move assignment.
+     */
+    template <typename T>
+    void shift_right(T * items, size_t from, size_t len);
+
+    /**
+     * Moves `items[from + 1]` to `items[len - 1]` down by one position, overwriting `items[from]`. The
+     * last item is left moved-from.
+     */
+    template <typename T>
+    void shift_left(T * items, size_t from, size_t len);
+}
+
+template <typename T>
+void data::shift_right(T * items, size_t from, size_t len) {
+    if (from >= len) {
+        return;
+    }
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        memmove(static_cast<void *>(items + from + 1), static_cast<const void *>(items + from), (len - from) * sizeof(T));
+    } else {
+        std::move_backward(items + from, items + len, items + len + 1);
+    }
+}
+
+template <typename T>
+void data::shift_left(T * items, size_t from, size_t len) {
+    if (from + 1 >= len) {
+        return;
+    }
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        memmove(static_cast<void *>(items + from), static_cast<const void *>(items + from + 1), (len - from - 1) * sizeof(T));
+    } else {
+        std::move(items + from + 1, items + len, items + from);
+    }
+}
+
+#endif
@@ -2,10 +2,13 @@
 #define INCLUDE_STRUCTURES_SORTED_ARRAY_H
 
 #include <stdlib.h>
+#include <utility>
 #ifdef TEST
 #include <vector>
 #endif
 
+#include "search.h"
+#include "shift.h"
 #include "../traits.h"
 
 namespace data {
@@ -46,7 +49,16 @@ namespace data {
             /**
              * Puts an item into the array and returns the index it was inserted at.
              */
-            size_t put(const T item);
+            size_t put(const T &item);
+
+            size_t put(T &&item);
+
+            /**
+             * Constructs an item from the given arguments, puts it into the array, and returns the index
+             * it was inserted at.
+             */
+            template <typename... Args>
+            size_t emplace(Args&&... args);
 
             const T& operator[](size_t i) const;
 
@@ -54,6 +66,9 @@ namespace data {
 
             T get(size_t i) const;
 
+            /**
+             * Removes the item at the given index and returns it. The item is moved out, not copied.
+             */
             T del(size_t i);
 
             template <const size_t M>
@@ -71,6 +86,13 @@ namespace data {
              */
             SortedArray<T, N> substr(size_t from) const;
 
+            /**
+             * Moves everything from the given `from` index (inclusive) to the end of the array into
+             * a new array of the same type and parameterization, and truncates this array to `from`.
+             * Unlike `substr`, no elements are copied.
+             */
+            SortedArray<T, N> split_off(size_t from);
+
             void truncate(size_t new_len);
 
 #ifdef TEST
@@ -123,40 +145,35 @@ size_t data::SortedArray<T, N>::size() const {
 
 template <data::PartialOrd T, const size_t N>
 size_t data::SortedArray<T, N>::lower_bound(const T &item) const {
-    size_t l = 0;
-    size_t r = this->len;
-
-    while (l < r) {
-        size_t m = (l + r) >> 1;
-
-        if (this->items[m] < item) {
-            l = m + 1;
-        } else {
-            r = m;
-        }
-    }
+    return data::lower_bound(this->items, this->len, item);
+}
 
-    return l;
+template <data::PartialOrd T, const size_t N>
+size_t data::SortedArray<T, N>::put(const T &item) {
+    return this->put(T(item));
 }
 
 template <data::PartialOrd T, const size_t N>
-size_t data::SortedArray<T, N>::put(const T item) {
+size_t data::SortedArray<T, N>::put(T &&item) {
     if (this->len == N) {
         throw "Out of memory";
     }
 
     size_t index = this->lower_bound(item);
 
-    for (size_t i = this->len; i > index; i--) {
-        this->items[i] = this->items[i - 1];
-    }
-
-    this->items[index] = item;
+    shift_right(this->items, index, this->len);
+    this->items[index] = std::move(item);
     this->len++;
 
     return index;
 }
 
+template <data::PartialOrd T, const size_t N>
+template <typename... Args>
+size_t data::SortedArray<T, N>::emplace(Args&&... args) {
+    return this->put(T(std::forward<Args>(args)...));
+}
+
 template <data::PartialOrd T, const size_t N>
 const T& data::SortedArray<T, N>::operator[](size_t i) const {
     return this->items[i];
@@ -174,14 +191,9 @@ T data::SortedArray<T, N>::get(size_t i) const {
 
 template <data::PartialOrd T, const size_t N>
 T data::SortedArray<T, N>::del(size_t i) {
-    T out = this->items[i];
-
-    if (this->len > 1) {
-        for (size_t j = i; j < this->len - 1; j++) {
-            this->items[j] = this->items[j + 1];
-        }
-    }
+    T out = std::move(this->items[i]);
 
+    shift_left(this->items, i, this->len);
     this->len--;
 
     return out;
@@ -194,7 +206,7 @@ bool data::SortedArray<T, N>::operator==(const SortedArray<T, M> &other) const r
         return false;
     }
 
-    if (this->items == other.items) {
+    if (static_cast<const void *>(this) == static_cast<const void *>(&other)) {
         return true;
     }
 
@@ -224,6 +236,20 @@ data::SortedArray<T, N> data::SortedArray<T, N>::substr(size_t from) const {
     return this->substr(from, this->len);
 }
 
+template <data::PartialOrd T, const size_t N>
+data::SortedArray<T, N> data::SortedArray<T, N>::split_off(size_t from) {
+    data::SortedArray<T, N> out;
+    out.len = this->len - from;
+
+    for (size_t i = 0; i < out.len; i++) {
+        out.items[i] = std::move(this->items[from + i]);
+    }
+
+    this->len = from;
+
+    return out;
+}
+
 template <data::PartialOrd T, const size_t N>
 void data::SortedArray<T, N>::truncate(size_t new_len) {
     this->len = new_len;
@@ -2,62 +2,136 @@
 #define INCLUDE_STRUCTURES_SORTED_VEC_H
 
 #include <algorithm>
-
-#ifdef TEST
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#endif
 
+#include "search.h"
+#include "shift.h"
 #include "../traits.h"
 
 namespace data {
     /**
-     * A sorted vector with variable capacity. The vector grows when the number of elements reaches
-     * 2/3 of its capacity. NB: The vector does not shrink on its own - you have to call `shrink()`.
-     * 
+     * Growth policy for SortedVec that multiplies the capacity by NUM / DEN whenever the vector is full,
+     * starting from MIN. A vector never holds more than NUM / DEN times the memory its items need, until
+     * items are deleted.
+     */
+    template <const size_t NUM, const size_t DEN, const size_t MIN = 4>
+    struct GeometricGrowth {
+        static_assert(NUM > DEN, "The growth factor must be greater than 1");
+
+        /**
+         * Returns the capacity to grow to from `capacity` so that at least `needed` items fit.
+         */
+        static size_t next_capacity(size_t capacity, size_t needed);
+    };
+
+    typedef GeometricGrowth<2, 1> DoublingGrowth;
+
+    /**
+     * A sorted vector with variable capacity. The vector grows when it is full, by however much the
+     * growth policy G says. NB: The vector does not shrink on its own - you have to call
+     * `shrink_to_fit()`.
+     *
+     * Storage is allocated without constructing anything, and items are only constructed in the slots
+     * they occupy. T doesn't need a default constructor, and unused capacity costs nothing but memory.
+     * An empty vector doesn't allocate at all.
+     *
      * See SortedArray for an implementation of a sorted array with a fixed size.
      */
-    template <PartialOrd T>
+    template <PartialOrd T, typename G = GeometricGrowth<3, 2>>
     class SortedVec {
         private:
-            static constexpr size_t INITIAL_CAPACITY = 64;
             T * items;
             size_t len;
             size_t capacity;
 
             /**
-             * Moving a sorted vec consists of freeing the target's items and copying the
-             * items pointer to the target. To prevent double freeing, `items` is set to null in
-             * the source object. Moving a vector does not invalidate it, so the vector needs
-             * to be able to recreate its items array if necessary.
+             * Moves the items into new storage with exactly the given capacity, which must be at least
+             * `len`.
+             */
+            void reallocate(size_t new_capacity);
+
+            /**
+             * Makes sure that the vector can hold `new_len` items, reallocating at most once.
+             */
+            void grow_for(size_t new_len);
+
+            /**
+             * Merges `k` sorted items into the vector, filling it from the back so that every item
+             * moves at most once. `batch` is read with `batch[j]`, so passing a move iterator moves the
+             * items in.
              */
-            void resurrect_array(size_t capacity = INITIAL_CAPACITY);
-            
+            template <typename It>
+            void merge_sorted(It batch, size_t k);
+
         public:
             SortedVec();
 
+            /**
+             * Creates an empty vector with room for `capacity` items.
+             */
             SortedVec(size_t capacity);
 
-            SortedVec(const SortedVec<T> &other);
+            /**
+             * The copy only has as much capacity as the items need.
+             */
+            SortedVec(const SortedVec<T, G> &other);
 
-            SortedVec(SortedVec<T> &&other);
+            SortedVec(SortedVec<T, G> &&other);
 
             ~SortedVec();
 
-            void operator=(const SortedVec<T> &other);
+            void operator=(const SortedVec<T, G> &other);
 
-            void operator=(SortedVec<T> &&other);
+            void operator=(SortedVec<T, G> &&other);
 
             size_t size() const;
 
             size_t cap() const;
 
+            /**
+             * Makes room for at least `capacity` items. Does nothing if there is already enough room.
+             */
+            void reserve(size_t capacity);
+
+            /**
+             * Reduces the capacity to the number of items, freeing the storage entirely if the vector
+             * is empty.
+             */
+            void shrink_to_fit();
+
             /**
              * Returns the position of the first element in the vector that is not less than `item`
              * (i.e., the first element that is greater than or equal to `item`).
              */
             size_t lower_bound(const T &item) const;
 
-            void put(const T item);
+            void put(const T &item);
+
+            void put(T &&item);
+
+            /**
+             * Puts every item in a range into the vector. The batch is sorted and merged in with one pass,
+             * so adding k items to a vector of n items takes O(n + k log k) time and grows the vector at
+             * most once, instead of the O(kn) of calling `put` k times.
+             */
+            template <std::ranges::input_range R>
+            void put_batch(R &&range);
+
+            /**
+             * Puts every item in another sorted vector into this one in O(n + k) time.
+             */
+            void merge(const SortedVec<T, G> &other);
+
+            /**
+             * Constructs an item from the given arguments and puts it into the vector.
+             */
+            template <typename... Args>
+            void emplace(Args&&... args);
 
             T& operator[](size_t i);
 
@@ -66,15 +140,13 @@ namespace data {
             T get(size_t i) const;
 
             /**
-             * Deletes the element at the given position. Note that this does NOT resize the underlying
-             * array. If you are bulk deleting elements, you might want to call shrink() afterward to 
-             * reduce the vector's capacity and free up unused memory.
+             * Deletes the element at the given position and returns it. The element is moved out, not
+             * copied. Note that this does NOT resize the underlying array. If you are bulk deleting
+             * elements, you might want to call shrink_to_fit() afterward to free up unused memory.
              */
             T del(size_t i);
 
-            void shrink();
-
-            bool operator==(const SortedVec<T> &other) const requires Eq<T>;
+            bool operator==(const SortedVec<T, G> &other) const requires Eq<T>;
 
 #ifdef TEST
             void append_unsorted(const T item);
@@ -84,189 +156,248 @@ namespace data {
     };
 }
 
-template <data::PartialOrd T>
-data::SortedVec<T>::SortedVec() 
-    : items(new T[SortedVec<T>::INITIAL_CAPACITY]), len(0), capacity(SortedVec<T>::INITIAL_CAPACITY) {}
+template <const size_t NUM, const size_t DEN, const size_t MIN>
+size_t data::GeometricGrowth<NUM, DEN, MIN>::next_capacity(size_t capacity, size_t needed) {
+    // Round up, so that small capacities still grow
+    return std::max({ needed, MIN, (capacity * NUM + DEN - 1) / DEN });
+}
 
-template <data::PartialOrd T>
-data::SortedVec<T>::SortedVec(size_t capacity) : items(new T[capacity]), len(0), capacity(capacity) {}
+template <data::PartialOrd T, typename G>
+data::SortedVec<T, G>::SortedVec() : items(nullptr), len(0), capacity(0) {}
 
-template <data::PartialOrd T>
-data::SortedVec<T>::SortedVec(const SortedVec<T> &other) : items(new T[other.capacity]), len(other.len), capacity(other.capacity) {
-    std::copy(other.items, other.items + other.len, this->items);
+template <data::PartialOrd T, typename G>
+data::SortedVec<T, G>::SortedVec(size_t capacity) : items(nullptr), len(0), capacity(0) {
+    this->reserve(capacity);
 }
 
-template <data::PartialOrd T>
-data::SortedVec<T>::SortedVec(SortedVec<T> &&other) : items(other.items), len(other.len), capacity(other.capacity) {
+template <data::PartialOrd T, typename G>
+data::SortedVec<T, G>::SortedVec(const SortedVec<T, G> &other) : items(nullptr), len(0), capacity(0) {
+    this->reserve(other.len);
+
+    std::uninitialized_copy(other.items, other.items + other.len, this->items);
+    this->len = other.len;
+}
+
+template <data::PartialOrd T, typename G>
+data::SortedVec<T, G>::SortedVec(SortedVec<T, G> &&other) : items(other.items), len(other.len), capacity(other.capacity) {
     other.items = nullptr;
     other.capacity = 0;
     other.len = 0;
 }
 
-template <data::PartialOrd T>
-data::SortedVec<T>::~SortedVec() {
+template <data::PartialOrd T, typename G>
+data::SortedVec<T, G>::~SortedVec() {
+    std::destroy(this->items, this->items + this->len);
+
     if (this->items) {
-        delete[] this->items;
+        std::allocator<T>().deallocate(this->items, this->capacity);
     }
 }
 
-template <data::PartialOrd T>
-void data::SortedVec<T>::operator=(const SortedVec<T> &other) {
-    if (this->capacity != other.capacity) {
-        T * new_items = new T[other.capacity];
-
-        if (this->items) {
-            delete[] this->items;
-        }
-
-        this->items = new_items;
-        this->capacity = other.capacity;
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::operator=(const SortedVec<T, G> &other) {
+    if (this == &other) {
+        return;
     }
 
-    if (!this->items) {
-        this->resurrect_array(other.capacity);
-    }
+    // Existing storage is reused if it's big enough
+    std::destroy(this->items, this->items + this->len);
+    this->len = 0;
+    this->reserve(other.len);
 
+    std::uninitialized_copy(other.items, other.items + other.len, this->items);
     this->len = other.len;
-    std::copy(other.items, other.items + other.len, this->items);
 }
 
-template <data::PartialOrd T>
-void data::SortedVec<T>::operator=(SortedVec<T> &&other) {
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::operator=(SortedVec<T, G> &&other) {
+    std::swap(this->items, other.items);
+    std::swap(this->len, other.len);
+    std::swap(this->capacity, other.capacity);
+}
+
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::reallocate(size_t new_capacity) {
+    T * new_items = new_capacity ? std::allocator<T>().allocate(new_capacity) : nullptr;
+
+    std::uninitialized_move(this->items, this->items + this->len, new_items);
+    std::destroy(this->items, this->items + this->len);
+
     if (this->items) {
-        delete[] this->items;
+        std::allocator<T>().deallocate(this->items, this->capacity);
     }
 
-    this->items = other.items;
-    this->capacity = other.capacity;
-    this->len = other.len;
-
-    other.items = nullptr;
-    other.capacity = 0;
-    other.len = 0;
+    this->items = new_items;
+    this->capacity = new_capacity;
 }
 
-template <data::PartialOrd T>
-void data::SortedVec<T>::resurrect_array(size_t capacity) {
-    this->items = new T[capacity];
-    this->capacity = capacity;
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::grow_for(size_t new_len) {
+    if (new_len > this->capacity) {
+        this->reallocate(G::next_capacity(this->capacity, new_len));
+    }
 }
 
-template <data::PartialOrd T>
-size_t data::SortedVec<T>::size() const {
+template <data::PartialOrd T, typename G>
+size_t data::SortedVec<T, G>::size() const {
     return this->len;
 }
 
-template <data::PartialOrd T>
-size_t data::SortedVec<T>::cap() const {
+template <data::PartialOrd T, typename G>
+size_t data::SortedVec<T, G>::cap() const {
     return this->capacity;
 }
 
-template <data::PartialOrd T>
-size_t data::SortedVec<T>::lower_bound(const T &item) const {
-    size_t l = 0;
-    size_t r = this->len;
-
-    while (l < r) {
-        size_t m = (l + r) >> 1;
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::reserve(size_t capacity) {
+    if (capacity > this->capacity) {
+        this->reallocate(capacity);
+    }
+}
 
-        if (this->items[m] < item) {
-            l = m + 1;
-        } else {
-            r = m;
-        }
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::shrink_to_fit() {
+    if (this->len < this->capacity) {
+        this->reallocate(this->len);
     }
+}
 
-    return l;
+template <data::PartialOrd T, typename G>
+size_t data::SortedVec<T, G>::lower_bound(const T &item) const {
+    return data::lower_bound(this->items, this->len, item);
 }
 
-template <data::PartialOrd T>
-void data::SortedVec<T>::put(const T item) {
-    if (!this->items) {
-        this->resurrect_array();
-    }
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::put(const T &item) {
+    this->put(T(item));
+}
 
-    size_t index = this->lower_bound(item);
- 
-    for (size_t i = this->len; i > index; i--) {
-        this->items[i] = this->items[i - 1];
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::put(T &&item) {
+    this->grow_for(this->len + 1);
+
+    const size_t index = this->lower_bound(item);
+
+    if (index == this->len) {
+        std::construct_at(this->items + this->len, std::move(item));
+    } else {
+        // The last item moves into the first unused slot, which has to be constructed. Everything
+        // else shifts into slots that already hold items.
+        std::construct_at(this->items + this->len, std::move(this->items[this->len - 1]));
+        shift_right(this->items, index, this->len - 1);
+        this->items[index] = std::move(item);
     }
 
-    this->items[index] = item;
     this->len++;
+}
 
-    if (this->len * 1.5 > this->capacity) {
-        this->capacity *= 2;
-        T * new_items = new T[this->capacity];
+template <data::PartialOrd T, typename G>
+template <typename It>
+void data::SortedVec<T, G>::merge_sorted(It batch, size_t k) {
+    if (!k) {
+        return;
+    }
 
-        std::move(this->items, this->items + this->len, new_items);
-        delete[] this->items;
+    this->grow_for(this->len + k);
 
-        this->items = new_items;
-    }
-}
+    const size_t old_len = this->len;
+    size_t i = this->len;
+    size_t j = k;
+    size_t w = this->len + k;
 
-template <data::PartialOrd T>
-T& data::SortedVec<T>::operator[](size_t i) {
-    return this->items[i];
-}
+    // Slots past the old end are unused until an item is constructed in them
+    const auto place = [&](size_t pos, auto &&item) {
+        if (pos >= old_len) {
+            std::construct_at(this->items + pos, std::forward<decltype(item)>(item));
+        } else {
+            this->items[pos] = std::forward<decltype(item)>(item);
+        }
+    };
 
-template <data::PartialOrd T>
-const T& data::SortedVec<T>::operator[](size_t i) const {
-    return this->items[i];
-}
+    // Equal items already in the vector end up after the new ones, as with `put`
+    while (j > 0) {
+        if (i > 0 && !(this->items[i - 1] < batch[j - 1])) {
+            place(--w, std::move(this->items[--i]));
+        } else {
+            place(--w, batch[--j]);
+        }
+    }
 
-template <data::PartialOrd T>
-T data::SortedVec<T>::get(size_t i) const {
-    return this->items[i];
+    this->len += k;
 }
 
-template <data::PartialOrd T>
-T data::SortedVec<T>::del(size_t i) {
-    T out = this->items[i];
+template <data::PartialOrd T, typename G>
+template <std::ranges::input_range R>
+void data::SortedVec<T, G>::put_batch(R &&range) {
+    std::vector<T> batch;
+
+    if constexpr (std::ranges::sized_range<R>) {
+        batch.reserve(std::ranges::size(range));
+    }
 
-    if (this->len > 1) {
-        for (size_t j = i; j < this->len - 1; j++) {
-            this->items[j] = this->items[j + 1];
+    // Items are moved out of a container that was passed as an rvalue, but not out of a view, since the
+    // view may be looking at someone else's container
+    if constexpr (!std::is_lvalue_reference_v<R> && !std::ranges::view<std::remove_cvref_t<R>>) {
+        for (auto &&item : range) {
+            batch.push_back(std::move(item));
+        }
+    } else {
+        for (auto &&item : range) {
+            batch.push_back(item);
         }
     }
 
-    this->len--;
+    std::sort(std::begin(batch), std::end(batch));
 
-    return out;
+    this->merge_sorted(std::make_move_iterator(std::begin(batch)), batch.size());
 }
 
-template <data::PartialOrd T>
-void data::SortedVec<T>::shrink() {
-    if (this->len * 3 >= this->capacity) {
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::merge(const SortedVec<T, G> &other) {
+    if (&other == this) {
+        const SortedVec<T, G> copy(other);
+        this->merge_sorted(static_cast<const T *>(copy.items), copy.len);
+
         return;
     }
 
-    // Divide capacity by 2 and make it a power of 2
+    this->merge_sorted(static_cast<const T *>(other.items), other.len);
+}
 
-    this->capacity >>= 1;
+template <data::PartialOrd T, typename G>
+template <typename... Args>
+void data::SortedVec<T, G>::emplace(Args&&... args) {
+    this->put(T(std::forward<Args>(args)...));
+}
 
-    size_t c = this->capacity;
-    size_t pos = 0;
+template <data::PartialOrd T, typename G>
+T& data::SortedVec<T, G>::operator[](size_t i) {
+    return this->items[i];
+}
 
-    while (c >>= 1) {
-        pos++;
-    }
+template <data::PartialOrd T, typename G>
+const T& data::SortedVec<T, G>::operator[](size_t i) const {
+    return this->items[i];
+}
 
-    this->capacity &= (1 << pos);
+template <data::PartialOrd T, typename G>
+T data::SortedVec<T, G>::get(size_t i) const {
+    return this->items[i];
+}
 
-    T * new_items = new T[this->capacity];
-    
-    if (this->items) {
-        std::move(this->items, this->items + this->len, new_items);
-        delete[] this->items;
-    }
+template <data::PartialOrd T, typename G>
+T data::SortedVec<T, G>::del(size_t i) {
+    T out = std::move(this->items[i]);
 
-    this->items = new_items;
+    shift_left(this->items, i, this->len);
+    this->len--;
+    std::destroy_at(this->items + this->len);
+
+    return out;
 }
 
-template <data::PartialOrd T>
-bool data::SortedVec<T>::operator==(const SortedVec<T> &other) const requires data::Eq<T> {
+template <data::PartialOrd T, typename G>
+bool data::SortedVec<T, G>::operator==(const SortedVec<T, G> &other) const requires data::Eq<T> {
     if (this->len != other.len) {
         return false;
     }
@@ -285,24 +416,16 @@ bool data::SortedVec<T>::operator==(const SortedVec<T> &other) const requires da
 }
 
 #ifdef TEST
-template <data::PartialOrd T>
-void data::SortedVec<T>::append_unsorted(const T item) {
-    this->items[this->len] = item;
-    this->len++;
-
-    if (this->len * 1.5 > this->capacity) {
-        this->capacity *= 2;
-        T * new_items = new T[this->capacity];
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::append_unsorted(const T item) {
+    this->grow_for(this->len + 1);
 
-        std::move(this->items, this->items + this->len, new_items);
-        delete[] this->items;
-
-        this->items = new_items;
-    }
+    std::construct_at(this->items + this->len, item);
+    this->len++;
 }
 
-template <data::PartialOrd T>
-void data::SortedVec<T>::append_unsorted(const std::vector<T> &items) {
+template <data::PartialOrd T, typename G>
+void data::SortedVec<T, G>::append_unsorted(const std::vector<T> &items) {
     for (const T &item : items) {
         this->append_unsorted(item);
     }
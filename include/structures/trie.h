@@ -2,41 +2,73 @@
 #define INCLUDE_STRUCTURES_TRIE_H
 
 #include <stdlib.h>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <optional>
 
+#include "arena.h"
+#include "double_array_trie.h"
+#include "trie_children.h"
+
 namespace data {
-    template <typename K, typename V>
+    template <typename K, typename V, typename C>
     struct TrieNode {
+        typedef typename C::template index<K, TrieNode<K, V, C>> children_type;
+
         const K key;
         std::optional<V> val;
-        struct TrieNode<K, V> * parent;
-        std::vector<struct TrieNode<K, V> *> children;
+        struct TrieNode<K, V, C> * parent;
+        children_type children;
 
-        TrieNode(K key, std::optional<V> val, struct TrieNode<K, V> * parent);
+        TrieNode(K key, std::optional<V> val, struct TrieNode<K, V, C> * parent);
     };
 
     /**
-     * Trie implementation. Each node can have any number of children, which are
-     * stored in an std::vector in no particular order. Worst case lookup time is O(ka)
-     * where k is the length of the longest string, and a is the size of the alphabet.
-     * The factor of a is incurred because of the use of a compact std::vector instead of
-     * a sparse array for each element of the alphabet. The latter would enable constant-time
-     * lookup at each level of the trie, but it would also use an enormous amount of space.
+     * Trie implementation. How each node finds its children is chosen at compile time with C (see
+     * trie_children.h):
+     *
+     *  - ListChildren keeps the children in an unordered array. Worst case lookup time is O(ka) where
+     *    k is the length of the longest string, and a is the size of the alphabet, but any K with
+     *    operator== works.
+     *  - BitmapChildren is for byte-sized symbols. It finds a child in O(1) with a 256 bit bitmap and a
+     *    popcount, and only stores as many child pointers as there are children, so lookup is O(k).
+     *    This is the default for char, uint8_t and the like.
+     *  - DenseChildren<A> is for alphabets that are the integers 0 to A - 1. Every node has a slot for
+     *    each symbol, which is the fastest option and only a good one when A is very small.
+     *
+     * Nodes and their child arrays are allocated from an arena owned by the trie. If K and V are
+     * trivially destructible, destroying the trie only releases the arena's chunks and never visits a node.
      *
      * "K" is the type of a character in the key. K should implement operator==.
      * "V" is the type of the value.
      */
-    template <typename K, typename V>
+    template <typename K, typename V, typename C = DefaultTrieChildren<K>>
     class Trie {
         private:
-            std::vector<TrieNode<K, V> *> nodes;
+            typedef TrieNode<K, V, C> node_type;
+            typedef typename node_type::children_type children_type;
+
+            Arena arena;
+            children_type nodes;
+
+            void delete_parents(node_type * node);
 
-            void delete_parents(TrieNode<K, V> * node);
+            void destroy_rec(node_type * node);
+
+            void collect_rec(const node_type * node, std::vector<K> &key, std::vector<std::pair<std::vector<K>, V>> &out) const;
 
         public:
             Trie();
 
+            Trie(const Trie<K, V, C> &other) = delete;
+
+            Trie(Trie<K, V, C> &&other);
+
+            ~Trie();
+
+            void operator=(const Trie<K, V, C> &other) = delete;
+
             void put(const K * const key, const size_t key_len, const V value);
 
             std::optional<V> get(const K * const key, const size_t key_len) const;
@@ -44,39 +76,64 @@ namespace data {
             std::optional<V> del(const K * const key, const size_t key_len);
 
             size_t node_count();
+
+            /**
+             * Compiles the trie into a read-only DoubleArrayTrie with the same keys and values. The
+             * trie is left as it is.
+             */
+            DoubleArrayTrie<K, V> freeze() const requires (std::is_integral_v<K> && sizeof(K) == 1);
     };
 }
 
-template <typename K, typename V>
-data::TrieNode<K, V>::TrieNode(K key, std::optional<V> val, TrieNode<K, V> * parent) 
-    : key(key), val(val), parent(parent), children(std::vector<TrieNode<K, V> *>()) {}
+template <typename K, typename V, typename C>
+data::TrieNode<K, V, C>::TrieNode(K key, std::optional<V> val, TrieNode<K, V, C> * parent)
+    : key(key), val(val), parent(parent), children() {}
+
+template <typename K, typename V, typename C>
+data::Trie<K, V, C>::Trie() : arena(Arena()), nodes() {}
+
+template <typename K, typename V, typename C>
+data::Trie<K, V, C>::Trie(Trie<K, V, C> &&other) : arena(std::move(other.arena)), nodes(std::move(other.nodes)) {
+    // Some indices keep their children when they are moved, and the other trie must not destroy them
+    other.nodes = children_type();
+}
 
-template <typename K, typename V>
-data::Trie<K, V>::Trie() : nodes(std::vector<TrieNode<K, V> *>()) {}
+template <typename K, typename V, typename C>
+data::Trie<K, V, C>::~Trie() {
+    if constexpr (!std::is_trivially_destructible_v<K> || !std::is_trivially_destructible_v<V>) {
+        this->nodes.for_each([&](node_type * node) {
+            this->destroy_rec(node);
+        });
+    }
 
-template <typename K, typename V>
-void data::Trie<K, V>::put(const K * const key, const size_t key_len, const V value) {
-    TrieNode<K, V> * prev_node = nullptr;
-    TrieNode<K, V> * curr_node = nullptr;
-    std::vector<TrieNode<K, V> *> * curr_nodes = &this->nodes;
+    // Everything else, including the child arrays, lives in the arena
+}
+
+template <typename K, typename V, typename C>
+void data::Trie<K, V, C>::destroy_rec(node_type * node) {
+    node->children.for_each([&](node_type * child) {
+        this->destroy_rec(child);
+    });
+
+    node->~node_type();
+}
+
+template <typename K, typename V, typename C>
+void data::Trie<K, V, C>::put(const K * const key, const size_t key_len, const V value) {
+    node_type * prev_node = nullptr;
+    node_type * curr_node = nullptr;
+    children_type * curr_nodes = &this->nodes;
 
     for (size_t i = 0; i < key_len; i++) {
         prev_node = curr_node;
-        curr_node = nullptr;
-
-        for (size_t j = 0; j < curr_nodes->size(); j++) {
-            if ((*curr_nodes)[j]->key == key[i]) {
-                curr_node = (*curr_nodes)[j];
-                curr_nodes = &curr_node->children;
-                break;
-            }
-        }
- 
+        curr_node = curr_nodes->find(key[i]);
+
         if (!curr_node) {
-            curr_node = new TrieNode<K, V>(key[i], std::nullopt, prev_node);
-            curr_nodes->push_back(curr_node);
-            curr_nodes = &curr_node->children;
+            curr_node = this->arena.template create<node_type>(key[i], std::nullopt, prev_node);
+            curr_nodes->put(key[i], curr_node, this->arena);
         }
+
+        curr_nodes = &curr_node->children;
     }
 
     if (curr_node) {
@@ -84,19 +141,19 @@ void data::Trie<K, V>::put(const K * const key, const size_t key_len, const V va
     }
 }
 
-template <typename K, typename V>
-std::optional<V> data::Trie<K, V>::get(const K * const key, const size_t key_len) const {
-    TrieNode<K, V> * curr_node = nullptr;
-    const std::vector<TrieNode<K, V> *> * curr_nodes = &this->nodes;
+template <typename K, typename V, typename C>
+std::optional<V> data::Trie<K, V, C>::get(const K * const key, const size_t key_len) const {
+    node_type * curr_node = nullptr;
+    const children_type * curr_nodes = &this->nodes;
 
     for (size_t i = 0; i < key_len; i++) {
-        for (size_t j = 0; j < curr_nodes->size(); j++) {
-            if ((*curr_nodes)[j]->key == key[i]) {
-                curr_node = (*curr_nodes)[j];
-                curr_nodes = &curr_node->children;
-                break;
-            }
+        curr_node = curr_nodes->find(key[i]);
+
+        if (!curr_node) {
+            return std::nullopt;
         }
+
+        curr_nodes = &curr_node->children;
     }
 
     if (!curr_node) {
@@ -106,19 +163,19 @@ std::optional<V> data::Trie<K, V>::get(const K * const key, const size_t key_len
     return curr_node->val;
 }
 
-template <typename K, typename V>
-std::optional<V> data::Trie<K, V>::del(const K * const key, const size_t key_len) {
-    TrieNode<K, V> * curr_node = nullptr;
-    std::vector<TrieNode<K, V> *> * curr_nodes = &this->nodes;
+template <typename K, typename V, typename C>
+std::optional<V> data::Trie<K, V, C>::del(const K * const key, const size_t key_len) {
+    node_type * curr_node = nullptr;
+    children_type * curr_nodes = &this->nodes;
 
     for (size_t i = 0; i < key_len; i++) {
-        for (size_t j = 0; j < curr_nodes->size(); j++) {
-            if ((*curr_nodes)[j]->key == key[i]) {
-                curr_node = (*curr_nodes)[j];
-                curr_nodes = &curr_node->children;
-                break;
-            }
+        curr_node = curr_nodes->find(key[i]);
+
+        if (!curr_node) {
+            return std::nullopt;
         }
+
+        curr_nodes = &curr_node->children;
     }
 
     if (!curr_node) {
@@ -133,33 +190,64 @@ std::optional<V> data::Trie<K, V>::del(const K * const key, const size_t key_len
     return out;
 }
 
-template <typename K, typename V>
-size_t data::Trie<K, V>::node_count() {
-    std::vector<TrieNode<K, V> *> buf;
-    buf.insert(std::end(buf), std::begin(this->nodes), std::end(this->nodes));
+template <typename K, typename V, typename C>
+size_t data::Trie<K, V, C>::node_count() {
+    std::vector<node_type *> buf;
+    const auto push = [&](node_type * node) {
+        buf.push_back(node);
+    };
+
+    this->nodes.for_each(push);
 
     size_t out = 0;
 
     while (buf.size()) {
-        TrieNode<K, V> * node = buf.back();
+        node_type * node = buf.back();
         buf.pop_back();
         out++;
 
-        buf.insert(std::end(buf), std::begin(node->children), std::end(node->children));
+        node->children.for_each(push);
     }
 
     return out;
 }
 
-template <typename K, typename V>
-void data::Trie<K, V>::delete_parents(TrieNode<K, V> * node) {
+template <typename K, typename V, typename C>
+void data::Trie<K, V, C>::collect_rec(const node_type * node, std::vector<K> &key, std::vector<std::pair<std::vector<K>, V>> &out) const {
+    key.push_back(node->key);
+
+    if (node->val.has_value()) {
+        out.push_back({ key, node->val.value() });
+    }
+
+    node->children.for_each([&](const node_type * child) {
+        this->collect_rec(child, key, out);
+    });
+
+    key.pop_back();
+}
+
+template <typename K, typename V, typename C>
+data::DoubleArrayTrie<K, V> data::Trie<K, V, C>::freeze() const requires (std::is_integral_v<K> && sizeof(K) == 1) {
+    std::vector<std::pair<std::vector<K>, V>> entries;
+    std::vector<K> key;
+
+    this->nodes.for_each([&](const node_type * node) {
+        this->collect_rec(node, key, entries);
+    });
+
+    return DoubleArrayTrie<K, V>(std::move(entries));
+}
+
+template <typename K, typename V, typename C>
+void data::Trie<K, V, C>::delete_parents(node_type * node) {
     if (!node) {
         return;
     }
 
     if (!node->children.size() && !node->val.has_value()) {
         // Remove node from parent's children
-        std::vector<TrieNode<K, V> *> * siblings; 
+        children_type * siblings;
 
         if (node->parent) {
             siblings = &node->parent->children;
@@ -167,17 +255,10 @@ void data::Trie<K, V>::delete_parents(TrieNode<K, V> * node) {
             siblings = &this->nodes;
         }
 
-        for (size_t i = 0; i < siblings->size(); i++) {
-            TrieNode<K, V> * sibling = (*siblings)[i];
-
-            if (sibling == node) {
-                siblings->erase(siblings->begin() + i);
-                break;
-            }
-        }
+        siblings->del(node->key, this->arena);
 
         delete_parents(node->parent);
-        delete node;
+        this->arena.destroy(node);
     }
 }
 
@@ -0,0 +1,418 @@
+#ifndef INCLUDE_STRUCTURES_TRIE_CHILDREN_H
+#define INCLUDE_STRUCTURES_TRIE_CHILDREN_H
+
+#include <bit>
+#include <stdint.h>
+#include <stdlib.h>
+#include <type_traits>
+
+#include "arena.h"
+#include "shift.h"
+
+namespace data {
+    /**
+     * A packed array of child pointers, allocated from an arena. The capacity is always the number of
+     * children rounded up to a power of two, so it doesn't need to be stored, and an empty array holds
+     * no memory. The children are not owned by the array.
+     */
+    template <typename N>
+    class TrieChildArray {
+        private:
+            N ** items;
+            uint32_t count;
+
+            static size_t capacity_for(size_t count);
+
+            void reallocate(size_t new_capacity, Arena &arena);
+
+        public:
+            TrieChildArray();
+
+            TrieChildArray(const TrieChildArray<N> &other) = delete;
+
+            TrieChildArray(TrieChildArray<N> &&other);
+
+            void operator=(const TrieChildArray<N> &other) = delete;
+
+            /**
+             * Takes the other array's children. This array's old block is not returned to its arena.
+             */
+            void operator=(TrieChildArray<N> &&other);
+
+            size_t size() const;
+
+            N * operator[](size_t i) const;
+
+            void insert(size_t i, N * child, Arena &arena);
+
+            void erase(size_t i, Arena &arena);
+    };
+
+    /**
+     * Children in an unordered array, found by comparing every child's key with the symbol. Works for
+     * any K with operator==, but finding a child takes time proportional to the number of children.
+     * N must have a `key` member holding its symbol.
+     */
+    template <typename K, typename N>
+    class TrieListIndex {
+        private:
+            TrieChildArray<N> children;
+
+        public:
+            /**
+             * Returns the child for the given symbol, or null if there is none.
+             */
+            N * find(const K &symbol) const;
+
+            /**
+             * Adds a child for a symbol that doesn't have one yet.
+             */
+            void put(const K &symbol, N * child, Arena &arena);
+
+            /**
+             * Removes the child for the given symbol, if there is one.
+             */
+            void del(const K &symbol, Arena &arena);
+
+            size_t size() const;
+
+            template <typename F>
+            void for_each(F &&f) const;
+    };
+
+    /**
+     * Children of a node whose symbols are bytes. A 256 bit bitmap says which symbols have a child, and
+     * the children are packed in symbol order in an array that is only as big as the node's fanout. The
+     * position of a child is the number of bits set before its symbol's bit, which takes a few popcounts
+     * to find, so finding a child takes constant time no matter how many children there are.
+     */
+    template <typename K, typename N>
+    class TrieBitmapIndex {
+        static_assert(std::is_integral_v<K> && sizeof(K) == 1, "Bitmap indices are only for byte-sized symbols");
+
+        private:
+            uint64_t bitmap[4];
+            TrieChildArray<N> children;
+
+            static size_t code(const K &symbol);
+
+            bool has(size_t code) const;
+
+            /**
+             * Returns the number of children whose symbols have codes less than the given code.
+             */
+            size_t rank(size_t code) const;
+
+        public:
+            TrieBitmapIndex();
+
+            N * find(const K &symbol) const;
+
+            void put(const K &symbol, N * child, Arena &arena);
+
+            void del(const K &symbol, Arena &arena);
+
+            size_t size() const;
+
+            template <typename F>
+            void for_each(F &&f) const;
+    };
+
+    /**
+     * An array with a slot for every symbol in an alphabet of A symbols, which must be the integers
+     * 0 to A - 1. Finding a child is a single load. The array is part of the node, so this is best for
+     * very small alphabets, like the four bases of DNA.
+     */
+    template <typename K, typename N, const size_t A>
+    class TrieDenseIndex {
+        static_assert(std::is_integral_v<K>, "Dense indices are only for integral symbols");
+
+        private:
+            N * children[A];
+            uint32_t count;
+
+        public:
+            TrieDenseIndex();
+
+            N * find(const K &symbol) const;
+
+            /**
+             * Throws if the symbol is outside of the alphabet.
+             */
+            void put(const K &symbol, N * child, Arena &arena);
+
+            void del(const K &symbol, Arena &arena);
+
+            size_t size() const;
+
+            template <typename F>
+            void for_each(F &&f) const;
+    };
+
+    /**
+     * The kinds of child index that a Trie can be given. Each one names the index type for a symbol
+     * type K and a node type N.
+     */
+    struct ListChildren {
+        template <typename K, typename N>
+        using index = TrieListIndex<K, N>;
+    };
+
+    struct BitmapChildren {
+        template <typename K, typename N>
+        using index = TrieBitmapIndex<K, N>;
+    };
+
+    template <const size_t A>
+    struct DenseChildren {
+        template <typename K, typename N>
+        using index = TrieDenseIndex<K, N, A>;
+    };
+
+    /**
+     * Byte-sized symbols get a bitmap index, and everything else gets a list.
+     */
+    template <typename K>
+    using DefaultTrieChildren = std::conditional_t<
+        std::is_integral_v<K> && sizeof(K) == 1 && !std::is_same_v<K, bool>,
+        BitmapChildren,
+        ListChildren
+    >;
+}
+
+template <typename N>
+data::TrieChildArray<N>::TrieChildArray() : items(nullptr), count(0) {}
+
+template <typename N>
+data::TrieChildArray<N>::TrieChildArray(TrieChildArray<N> &&other) : items(other.items), count(other.count) {
+    other.items = nullptr;
+    other.count = 0;
+}
+
+template <typename N>
+void data::TrieChildArray<N>::operator=(TrieChildArray<N> &&other) {
+    if (this == &other) {
+        return;
+    }
+
+    this->items = other.items;
+    this->count = other.count;
+    other.items = nullptr;
+    other.count = 0;
+}
+
+template <typename N>
+size_t data::TrieChildArray<N>::capacity_for(size_t count) {
+    return count ? std::bit_ceil(count) : 0;
+}
+
+template <typename N>
+void data::TrieChildArray<N>::reallocate(size_t new_capacity, Arena &arena) {
+    N ** new_items = new_capacity ? static_cast<N **>(arena.allocate(new_capacity * sizeof(N *))) : nullptr;
+    const size_t kept = std::min((size_t) this->count, new_capacity);
+
+    for (size_t i = 0; i < kept; i++) {
+        new_items[i] = this->items[i];
+    }
+
+    if (this->items) {
+        arena.deallocate(this->items, capacity_for(this->count) * sizeof(N *));
+    }
+
+    this->items = new_items;
+}
+
+template <typename N>
+size_t data::TrieChildArray<N>::size() const {
+    return this->count;
+}
+
+template <typename N>
+N * data::TrieChildArray<N>::operator[](size_t i) const {
+    return this->items[i];
+}
+
+template <typename N>
+void data::TrieChildArray<N>::insert(size_t i, N * child, Arena &arena) {
+    if (this->count == capacity_for(this->count)) {
+        this->reallocate(capacity_for(this->count + 1), arena);
+    }
+
+    shift_right(this->items, i, this->count);
+    this->items[i] = child;
+    this->count++;
+}
+
+template <typename N>
+void data::TrieChildArray<N>::erase(size_t i, Arena &arena) {
+    shift_left(this->items, i, this->count);
+
+    const size_t new_capacity = capacity_for(this->count - 1);
+
+    if (new_capacity < capacity_for(this->count)) {
+        // `count` is still the old count here, so the old block's size is known
+        this->reallocate(new_capacity, arena);
+    }
+
+    this->count--;
+}
+
+template <typename K, typename N>
+N * data::TrieListIndex<K, N>::find(const K &symbol) const {
+    for (size_t i = 0; i < this->children.size(); i++) {
+        if (this->children[i]->key == symbol) {
+            return this->children[i];
+        }
+    }
+
+    return nullptr;
+}
+
+template <typename K, typename N>
+void data::TrieListIndex<K, N>::put(const K &symbol, N * child, Arena &arena) {
+    (void) symbol;
+    this->children.insert(this->children.size(), child, arena);
+}
+
+template <typename K, typename N>
+void data::TrieListIndex<K, N>::del(const K &symbol, Arena &arena) {
+    for (size_t i = 0; i < this->children.size(); i++) {
+        if (this->children[i]->key == symbol) {
+            this->children.erase(i, arena);
+            return;
+        }
+    }
+}
+
+template <typename K, typename N>
+size_t data::TrieListIndex<K, N>::size() const {
+    return this->children.size();
+}
+
+template <typename K, typename N>
+template <typename F>
+void data::TrieListIndex<K, N>::for_each(F &&f) const {
+    for (size_t i = 0; i < this->children.size(); i++) {
+        f(this->children[i]);
+    }
+}
+
+template <typename K, typename N>
+data::TrieBitmapIndex<K, N>::TrieBitmapIndex() : bitmap{}, children() {}
+
+template <typename K, typename N>
+size_t data::TrieBitmapIndex<K, N>::code(const K &symbol) {
+    return static_cast<uint8_t>(symbol);
+}
+
+template <typename K, typename N>
+bool data::TrieBitmapIndex<K, N>::has(size_t code) const {
+    return (this->bitmap[code >> 6] >> (code & 63)) & 1;
+}
+
+template <typename K, typename N>
+size_t data::TrieBitmapIndex<K, N>::rank(size_t code) const {
+    const size_t word = code >> 6;
+    size_t out = std::popcount(this->bitmap[word] & ((uint64_t(1) << (code & 63)) - 1));
+
+    for (size_t i = 0; i < word; i++) {
+        out += std::popcount(this->bitmap[i]);
+    }
+
+    return out;
+}
+
+template <typename K, typename N>
+N * data::TrieBitmapIndex<K, N>::find(const K &symbol) const {
+    const size_t c = code(symbol);
+
+    if (!this->has(c)) {
+        return nullptr;
+    }
+
+    return this->children[this->rank(c)];
+}
+
+template <typename K, typename N>
+void data::TrieBitmapIndex<K, N>::put(const K &symbol, N * child, Arena &arena) {
+    const size_t c = code(symbol);
+
+    this->children.insert(this->rank(c), child, arena);
+    this->bitmap[c >> 6] |= uint64_t(1) << (c & 63);
+}
+
+template <typename K, typename N>
+void data::TrieBitmapIndex<K, N>::del(const K &symbol, Arena &arena) {
+    const size_t c = code(symbol);
+
+    if (!this->has(c)) {
+        return;
+    }
+
+    this->children.erase(this->rank(c), arena);
+    this->bitmap[c >> 6] &= ~(uint64_t(1) << (c & 63));
+}
+
+template <typename K, typename N>
+size_t data::TrieBitmapIndex<K, N>::size() const {
+    return this->children.size();
+}
+
+template <typename K, typename N>
+template <typename F>
+void data::TrieBitmapIndex<K, N>::for_each(F &&f) const {
+    for (size_t i = 0; i < this->children.size(); i++) {
+        f(this->children[i]);
+    }
+}
+
+template <typename K, typename N, const size_t A>
+data::TrieDenseIndex<K, N, A>::TrieDenseIndex() : children{}, count(0) {}
+
+template <typename K, typename N, const size_t A>
+N * data::TrieDenseIndex<K, N, A>::find(const K &symbol) const {
+    const size_t i = static_cast<size_t>(symbol);
+
+    return i < A ? this->children[i] : nullptr;
+}
+
+template <typename K, typename N, const size_t A>
+void data::TrieDenseIndex<K, N, A>::put(const K &symbol, N * child, Arena &arena) {
+    (void) arena;
+    const size_t i = static_cast<size_t>(symbol);
+
+    if (i >= A) {
+        throw "Symbol is outside of the trie's alphabet";
+    }
+
+    this->children[i] = child;
+    this->count++;
+}
+
+template <typename K, typename N, const size_t A>
+void data::TrieDenseIndex<K, N, A>::del(const K &symbol, Arena &arena) {
+    (void) arena;
+    const size_t i = static_cast<size_t>(symbol);
+
+    if (i < A && this->children[i]) {
+        this->children[i] = nullptr;
+        this->count--;
+    }
+}
+
+template <typename K, typename N, const size_t A>
+size_t data::TrieDenseIndex<K, N, A>::size() const {
+    return this->count;
+}
+
+template <typename K, typename N, const size_t A>
+template <typename F>
+void data::TrieDenseIndex<K, N, A>::for_each(F &&f) const {
+    for (size_t i = 0; i < A; i++) {
+        if (this->children[i]) {
+            f(this->children[i]);
+        }
+    }
+}
+
+#endif
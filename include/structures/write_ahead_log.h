@@ -0,0 +1,423 @@
+#ifndef INCLUDE_STRUCTURES_WRITE_AHEAD_LOG_H
+#define INCLUDE_STRUCTURES_WRITE_AHEAD_LOG_H
+
+#include <array>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace data {
+    /**
+     * When a write-ahead log makes its records durable.
+     *
+     * ALWAYS syncs the log after every record, so a record is durable as soon as it is appended.
+     * GROUP collects records and syncs them together once the group is full, so that many writes share
+     * one sync. A record is only durable once its group is synced or `sync` is called.
+     * NEVER writes records to the file when the buffer fills up but leaves syncing to the OS, except in
+     * `sync`.
+     */
+    enum class WalSyncPolicy : uint8_t {
+        ALWAYS,
+        GROUP,
+        NEVER
+    };
+
+    /**
+     * Returns the CRC-32C of the given bytes, continuing from `crc` if it is the checksum of the bytes
+     * before them.
+     */
+    uint32_t crc32c(const void * data, size_t len, uint32_t crc = 0);
+
+    /**
+     * An append-only log of opaque records. Every record is given the next log sequence number (LSN),
+     * starting from 1, and is framed with its length and a CRC-32C of the frame and the record, so that
+     * a record that was only partly written before a crash is detected when the log is read back.
+     *
+     * A log is opened in two steps: the constructor opens the file, and `replay` reads the records that
+     * are in it and cuts off anything after the last valid record. Records can only be appended after
+     * the log has been replayed, so new records never follow a torn one.
+     *
+     * Records are appended to a buffer in memory and written to the file with one write per group. See
+     * WalSyncPolicy for when they are synced.
+     */
+    class WriteAheadLog {
+        private:
+            struct RecordHeader {
+                uint32_t length;
+                // CRC-32C of this header, with the checksum set to 0, followed by the record
+                uint32_t checksum;
+                uint64_t lsn;
+            };
+
+            // Records are written once this many bytes are buffered, even if the group is not full
+            static constexpr size_t MAX_PENDING = 1 << 20;
+
+            int fd;
+            WalSyncPolicy policy;
+            size_t group_size;
+            bool replayed;
+            // Records that have been appended but not written to the file
+            std::vector<unsigned char> pending;
+            size_t pending_records;
+            // Offset of the end of the last record in the file
+            uint64_t end;
+            uint64_t next_lsn_;
+            uint64_t durable_lsn_;
+            size_t syncs_;
+
+            static uint32_t checksum(const RecordHeader &header, const unsigned char * record);
+
+            /**
+             * Writes the pending records to the file, and syncs it if `sync` is true.
+             */
+            void write_pending(bool sync);
+
+            void release();
+
+        public:
+            /**
+             * Opens or creates the log at the given path. With WalSyncPolicy::GROUP, records are synced
+             * in groups of `group_size`.
+             */
+            WriteAheadLog(const char * path, WalSyncPolicy policy = WalSyncPolicy::GROUP, size_t group_size = 64);
+
+            // There is one log per file
+            WriteAheadLog(const WriteAheadLog &other) = delete;
+
+            WriteAheadLog(WriteAheadLog &&other) = delete;
+
+            /**
+             * Writes the pending records and syncs them unless the policy is WalSyncPolicy::NEVER. Errors
+             * are ignored, so call `sync` first to find out about them.
+             */
+            ~WriteAheadLog();
+
+            void operator=(const WriteAheadLog &other) = delete;
+
+            void operator=(WriteAheadLog &&other) = delete;
+
+            /**
+             * Reads the log from the start and calls `f(lsn, record, length)` on every record with an LSN
+             * greater than `after`, in order. Reading stops at the first record that is torn, corrupted,
+             * or out of sequence, and the file is truncated there. If the log ends before `after`, the
+             * whole log is dropped. Later records get LSNs after the last valid record and after
+             * `after`.
+             *
+             * Must be called exactly once, before anything is appended.
+             */
+            template <typename F>
+            void replay(uint64_t after, F f);
+
+            /**
+             * Appends a record and returns its LSN. The record might not be durable yet when this
+             * returns: see WalSyncPolicy.
+             */
+            uint64_t append(const void * record, size_t length);
+
+            /**
+             * Writes and syncs every appended record, whatever the policy.
+             */
+            void sync();
+
+            /**
+             * Removes every record from the log, including pending ones, and syncs the empty log. LSNs
+             * keep counting up from where they were. Used once every record has been checkpointed
+             * somewhere else.
+             */
+            void reset();
+
+            /**
+             * Returns the LSN that the next record will get.
+             */
+            uint64_t next_lsn() const;
+
+            /**
+             * Returns the LSN of the last record that is known to be synced, or 0 if there is none.
+             */
+            uint64_t durable_lsn() const;
+
+            /**
+             * Returns the size of the log in bytes, including records that haven't been written yet.
+             */
+            uint64_t size() const;
+
+            /**
+             * Returns the number of times the file has been synced.
+             */
+            size_t syncs() const;
+    };
+}
+
+namespace {
+    constexpr std::array<uint32_t, 256> make_crc32c_table() {
+        std::array<uint32_t, 256> table{};
+
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+
+            for (int bit = 0; bit < 8; bit++) {
+                // Castagnoli polynomial, reflected
+                crc = crc & 1 ? (crc >> 1) ^ 0x82f63b78u : crc >> 1;
+            }
+
+            table[i] = crc;
+        }
+
+        return table;
+    }
+
+    constexpr std::array<uint32_t, 256> CRC32C_TABLE = make_crc32c_table();
+}
+
+inline uint32_t data::crc32c(const void * data, size_t len, uint32_t crc) {
+    const unsigned char * bytes = static_cast<const unsigned char *>(data);
+
+    crc = ~crc;
+
+    for (size_t i = 0; i < len; i++) {
+        crc = CRC32C_TABLE[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+inline data::WriteAheadLog::WriteAheadLog(const char * path, WalSyncPolicy policy, size_t group_size)
+    : fd(-1), policy(policy), group_size(group_size), replayed(false), pending(), pending_records(0), end(0), next_lsn_(1), durable_lsn_(0), syncs_(0)
+{
+    if (!group_size) {
+        throw "Write-ahead log groups must hold at least one record";
+    }
+
+    this->fd = open(path, O_RDWR | O_CREAT, 0644);
+
+    if (this->fd < 0) {
+        throw "Could not open write-ahead log";
+    }
+}
+
+inline data::WriteAheadLog::~WriteAheadLog() {
+    this->release();
+}
+
+inline void data::WriteAheadLog::release() {
+    if (this->fd < 0) {
+        return;
+    }
+
+    if (this->replayed) {
+        try {
+            this->write_pending(this->policy != WalSyncPolicy::NEVER);
+        } catch (const char * err) {
+            // Nothing can be done about it here
+        }
+    }
+
+    close(this->fd);
+    this->fd = -1;
+}
+
+inline uint32_t data::WriteAheadLog::checksum(const RecordHeader &header, const unsigned char * record) {
+    RecordHeader unsummed = header;
+
+    unsummed.checksum = 0;
+
+    return crc32c(record, header.length, crc32c(&unsummed, sizeof(unsummed)));
+}
+
+template <typename F>
+void data::WriteAheadLog::replay(uint64_t after, F f) {
+    if (this->replayed) {
+        throw "Write-ahead log has already been replayed";
+    }
+
+    struct stat st;
+
+    if (fstat(this->fd, &st)) {
+        throw "Could not read write-ahead log";
+    }
+
+    std::vector<unsigned char> log(st.st_size);
+    size_t done = 0;
+
+    while (done < log.size()) {
+        const ssize_t n = pread(this->fd, log.data() + done, log.size() - done, done);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw "Could not read write-ahead log";
+        }
+
+        if (!n) {
+            break;
+        }
+
+        done += n;
+    }
+
+    log.resize(done);
+
+    uint64_t offset = 0;
+    uint64_t last_lsn = 0;
+
+    while (offset + sizeof(RecordHeader) <= log.size()) {
+        RecordHeader header;
+
+        memcpy(&header, log.data() + offset, sizeof(header));
+
+        const unsigned char * record = log.data() + offset + sizeof(header);
+
+        if (header.length > log.size() - offset - sizeof(header)) {
+            break;
+        }
+
+        if (!header.lsn || header.checksum != checksum(header, record) || (last_lsn && header.lsn != last_lsn + 1)) {
+            break;
+        }
+
+        if (header.lsn > after) {
+            f(header.lsn, static_cast<const void *>(record), (size_t) header.length);
+        }
+
+        last_lsn = header.lsn;
+        offset += sizeof(header) + header.length;
+    }
+
+    // The log ends before `after`, so every record in it is covered by whatever `after` came from. New
+    // records would leave a gap in the LSNs after the old ones, so the old ones are dropped.
+    if (last_lsn < after) {
+        offset = 0;
+    }
+
+    if (offset != log.size()) {
+        if (ftruncate(this->fd, offset) || fsync(this->fd)) {
+            throw "Could not truncate write-ahead log";
+        }
+    }
+
+    this->end = offset;
+    this->next_lsn_ = (last_lsn > after ? last_lsn : after) + 1;
+    this->durable_lsn_ = this->next_lsn_ - 1;
+    this->replayed = true;
+}
+
+inline void data::WriteAheadLog::write_pending(bool sync) {
+    size_t done = 0;
+
+    while (done < this->pending.size()) {
+        const ssize_t n = pwrite(this->fd, this->pending.data() + done, this->pending.size() - done, this->end + done);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw "Could not write to write-ahead log";
+        }
+
+        done += n;
+    }
+
+    this->end += this->pending.size();
+    this->pending.clear();
+    this->pending_records = 0;
+
+    if (sync) {
+        if (fdatasync(this->fd)) {
+            throw "Could not sync write-ahead log";
+        }
+
+        this->durable_lsn_ = this->next_lsn_ - 1;
+        this->syncs_++;
+    }
+}
+
+inline uint64_t data::WriteAheadLog::append(const void * record, size_t length) {
+    if (!this->replayed) {
+        throw "Write-ahead log must be replayed before appending";
+    }
+
+    if (length > UINT32_MAX) {
+        throw "Write-ahead log record is too long";
+    }
+
+    RecordHeader header{ (uint32_t) length, 0, this->next_lsn_ };
+    const unsigned char * bytes = static_cast<const unsigned char *>(record);
+
+    header.checksum = checksum(header, bytes);
+
+    const unsigned char * header_bytes = reinterpret_cast<const unsigned char *>(&header);
+
+    this->pending.insert(std::end(this->pending), header_bytes, header_bytes + sizeof(header));
+    this->pending.insert(std::end(this->pending), bytes, bytes + length);
+    this->pending_records++;
+    this->next_lsn_++;
+
+    switch (this->policy) {
+        case WalSyncPolicy::ALWAYS:
+            this->write_pending(true);
+            break;
+        case WalSyncPolicy::GROUP:
+            if (this->pending_records >= this->group_size || this->pending.size() >= MAX_PENDING) {
+                this->write_pending(true);
+            }
+            break;
+        case WalSyncPolicy::NEVER:
+            if (this->pending.size() >= MAX_PENDING) {
+                this->write_pending(false);
+            }
+            break;
+    }
+
+    return header.lsn;
+}
+
+inline void data::WriteAheadLog::sync() {
+    if (!this->replayed) {
+        throw "Write-ahead log must be replayed before syncing";
+    }
+
+    this->write_pending(true);
+}
+
+inline void data::WriteAheadLog::reset() {
+    if (!this->replayed) {
+        throw "Write-ahead log must be replayed before resetting";
+    }
+
+    this->pending.clear();
+    this->pending_records = 0;
+
+    if (ftruncate(this->fd, 0) || fsync(this->fd)) {
+        throw "Could not reset write-ahead log";
+    }
+
+    this->end = 0;
+    this->durable_lsn_ = this->next_lsn_ - 1;
+    this->syncs_++;
+}
+
+inline uint64_t data::WriteAheadLog::next_lsn() const {
+    return this->next_lsn_;
+}
+
+inline uint64_t data::WriteAheadLog::durable_lsn() const {
+    return this->durable_lsn_;
+}
+
+inline uint64_t data::WriteAheadLog::size() const {
+    return this->end + this->pending.size();
+}
+
+inline size_t data::WriteAheadLog::syncs() const {
+    return this->syncs_;
+}
+
+#endif
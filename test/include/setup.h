@@ -9,6 +9,15 @@ extern void radix_trie_tests();
 extern void sorted_vec_tests();
 extern void sorted_array_tests();
 extern void btree_tests();
+extern void bplus_tree_tests();
+extern void concurrent_btree_tests();
+extern void concurrent_radix_trie_tests();
+extern void persistent_btree_tests();
+extern void arena_tests();
+extern void double_array_trie_tests();
+extern void mapped_radix_trie_tests();
+extern void paged_btree_tests();
+extern void durable_btree_tests();
 
 void setup_tests() {
     srand(time(NULL));
@@ -18,6 +27,15 @@ void setup_tests() {
     sorted_vec_tests();
     sorted_array_tests();
     btree_tests();
+    bplus_tree_tests();
+    concurrent_btree_tests();
+    concurrent_radix_trie_tests();
+    persistent_btree_tests();
+    arena_tests();
+    double_array_trie_tests();
+    mapped_radix_trie_tests();
+    paged_btree_tests();
+    durable_btree_tests();
 }
 
 #endif
@@ -0,0 +1,129 @@
+#include <string>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/arena.h"
+
+namespace {
+    struct tracked_type {
+        static size_t live;
+
+        std::string name;
+
+        tracked_type(const std::string &name) : name(name) {
+            live++;
+        }
+
+        ~tracked_type() {
+            live--;
+        }
+    };
+
+    size_t tracked_type::live = 0;
+}
+
+void arena_tests() {
+    data::test::tests["arena"]["freed blocks are reused"] = []() {
+        data::Arena arena;
+
+        void * a = arena.allocate(24);
+        void * b = arena.allocate(24);
+
+        expect(a != b);
+        expect((size_t) a % data::Arena::ALIGNMENT == 0);
+        expect((size_t) b % data::Arena::ALIGNMENT == 0);
+
+        arena.deallocate(a, 24);
+
+        // Same size class
+        expect(arena.allocate(20) == a);
+        expect(arena.allocate(24) != a);
+    };
+
+    data::test::tests["arena"]["small blocks are carved out of chunks"] = []() {
+        data::Arena arena;
+
+        expect(arena.chunk_count() == 0);
+
+        for (size_t i = 0; i < 1000; i++) {
+            arena.allocate(32);
+        }
+
+        expect(arena.chunk_count() == 1);
+
+        for (size_t i = 0; i < 10000; i++) {
+            arena.allocate(32);
+        }
+
+        expect(arena.chunk_count() > 1);
+    };
+
+    data::test::tests["arena"]["large blocks"] = []() {
+        data::Arena arena;
+
+        char * a = static_cast<char *>(arena.allocate(100000));
+        char * b = static_cast<char *>(arena.allocate(5000));
+        char * c = static_cast<char *>(arena.allocate(3000));
+
+        a[99999] = 'a';
+        b[4999] = 'b';
+        c[2999] = 'c';
+
+        expect(arena.chunk_count() == 0);
+
+        arena.deallocate(b, 5000);
+
+        expect(a[99999] == 'a');
+        expect(c[2999] == 'c');
+
+        // `a` and `c` are freed with the arena
+    };
+
+    data::test::tests["arena"]["create and destroy"] = []() {
+        data::Arena arena;
+
+        tracked_type * a = arena.create<tracked_type>("a");
+        tracked_type * b = arena.create<tracked_type>("b");
+
+        expect(tracked_type::live == 2);
+        expect(a->name == "a");
+        expect(b->name == "b");
+
+        arena.destroy(a);
+
+        expect(tracked_type::live == 1);
+
+        arena.destroy(b);
+
+        expect(tracked_type::live == 0);
+    };
+
+    data::test::tests["arena"]["moving an arena"] = []() {
+        data::Arena arena;
+        int * a = arena.create<int>(5);
+
+        data::Arena moved(std::move(arena));
+
+        expect(arena.chunk_count() == 0);
+        expect(moved.chunk_count() == 1);
+        expect(*a == 5);
+
+        moved.destroy(a);
+        expect(moved.create<int>(6) == a);
+    };
+
+    data::test::tests["arena"]["allocator for standard containers"] = []() {
+        data::Arena arena;
+        std::vector<int, data::ArenaAllocator<int>> vec((data::ArenaAllocator<int>(&arena)));
+
+        for (int i = 0; i < 10000; i++) {
+            vec.push_back(i);
+        }
+
+        for (int i = 0; i < 10000; i++) {
+            expect(vec[i] == i);
+        }
+
+        expect(data::ArenaAllocator<int>(&arena) == data::ArenaAllocator<char>(&arena));
+    };
+}
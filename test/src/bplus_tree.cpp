@@ -0,0 +1,169 @@
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/bplus_tree.h"
+
+namespace {
+    /**
+     * Randomly inserts and deletes keys, checking the tree against an std::map and checking the
+     * B+ tree invariants after every deletion.
+     */
+    template <const size_t N>
+    void churn_tree(size_t ops, int key_range) {
+        data::BPlusTree<int, std::string, N> tree;
+        std::map<int, std::string> exp_map;
+
+        for (size_t i = 0; i < ops; i++) {
+            const int key = rand() % key_range;
+
+            if (rand() % 2) {
+                const std::string val = std::to_string(rand());
+                std::optional<std::string> old_val = tree.put(key, val);
+                auto it = exp_map.find(key);
+
+                expect(old_val.has_value() == (it != std::end(exp_map)));
+
+                if (it != std::end(exp_map)) {
+                    expect(old_val == it->second);
+                }
+
+                exp_map[key] = val;
+            } else {
+                std::optional<std::string> old_val = tree.del(key);
+                auto it = exp_map.find(key);
+
+                if (it == std::end(exp_map)) {
+                    expect(!old_val.has_value());
+                } else {
+                    expect(old_val == it->second);
+                    exp_map.erase(it);
+                }
+
+                expect(!tree.get(key).has_value());
+                expect(tree.is_valid());
+                expect(tree.leaves_are_linked());
+            }
+
+            expect(tree.size() == exp_map.size());
+        }
+
+        auto exp_it = std::begin(exp_map);
+
+        for (const auto [key, val] : tree) {
+            expect(exp_it != std::end(exp_map));
+            expect(key == exp_it->first);
+            expect(*val == exp_it->second);
+            exp_it++;
+        }
+
+        expect(exp_it == std::end(exp_map));
+    }
+
+    template <typename Range>
+    std::vector<std::pair<int, int>> to_items(const Range &range) {
+        std::vector<std::pair<int, int>> out;
+
+        for (const auto [key, val] : range) {
+            out.push_back({ key, *val });
+        }
+
+        return out;
+    }
+}
+
+void bplus_tree_tests() {
+    data::test::tests["bplus tree"]["inserting and deleting keys keeps the tree valid"] = []() {
+        churn_tree<3>(4000, 500);
+        churn_tree<4>(4000, 500);
+        churn_tree<5>(4000, 500);
+        churn_tree<32>(10000, 2000);
+    };
+
+    data::test::tests["bplus tree"]["deleting every key collapses the tree"] = []() {
+        data::BPlusTree<int, int, 6> tree;
+        const int count = 5000;
+
+        for (int i = 0; i < count; i++) {
+            expect(!tree.put(i, i * 2).has_value());
+        }
+
+        expect(tree.height() > 1);
+        expect(tree.is_valid());
+        expect(tree.leaves_are_linked());
+
+        for (int i = count - 1; i >= 0; i--) {
+            expect(tree.del(i) == i * 2);
+        }
+
+        expect(tree.size() == 0);
+        expect(tree.height() == 1);
+        expect(std::begin(tree) == std::end(tree));
+
+        for (int i = 0; i < 100; i++) {
+            tree.put(i, i);
+        }
+
+        expect(tree.size() == 100);
+        expect(tree.is_valid());
+        expect(tree.leaves_are_linked());
+    };
+
+    data::test::tests["bplus tree"]["range scans follow the leaf links"] = []() {
+        data::BPlusTree<int, int, 5> tree;
+
+        for (int i = 0; i < 1000; i++) {
+            tree.put(i * 2, i);
+        }
+
+        const std::vector<std::pair<int, int>> exp_items = { { 100, 50 }, { 102, 51 }, { 104, 52 } };
+
+        expect(to_items(tree.range(100, 106)) == exp_items);
+        expect(to_items(tree.range(99, 105)) == exp_items);
+        expect(to_items(tree.range(100, 100)).empty());
+        expect(to_items(tree.range(106, 100)).empty());
+        expect(to_items(tree.range(5000, 6000)).empty());
+        expect(to_items(tree.range(-100, 4)) == (std::vector<std::pair<int, int>>{ { 0, 0 }, { 2, 1 } }));
+        expect(to_items(tree.range(1996, 5000)) == (std::vector<std::pair<int, int>>{ { 1996, 998 }, { 1998, 999 } }));
+        expect(std::ranges::distance(tree.range(0, 2000)) == 1000);
+
+        expect((*tree.lower_bound(7)).first == 8);
+        expect((*tree.lower_bound(8)).first == 8);
+        expect((*tree.upper_bound(8)).first == 10);
+        expect(tree.upper_bound(1998) == std::end(tree));
+
+        // Values can be changed through a non-const range, but keys can't
+        for (auto [key, val] : tree.range(0, 10)) {
+            *val = -key;
+        }
+
+        const data::BPlusTree<int, int, 5> &const_tree = tree;
+
+        expect(to_items(const_tree.range(6, 12)) == (std::vector<std::pair<int, int>>{ { 6, -6 }, { 8, -8 }, { 10, 5 } }));
+    };
+
+    data::test::tests["bplus tree"]["does not leak memory for complex types"] = []() {
+        data::BPlusTree<std::string, std::vector<int>, 8> tree;
+
+        for (int i = 0; i < 5000; i++) {
+            const int key = rand() % 1000;
+
+            if (rand() % 3) {
+                tree.put(std::to_string(key), std::vector<int>(key % 10, key));
+            } else {
+                tree.del(std::to_string(key));
+            }
+        }
+
+        expect(tree.is_valid());
+        expect(tree.leaves_are_linked());
+
+        data::BPlusTree<std::string, std::vector<int>, 8> moved(std::move(tree));
+
+        expect(tree.size() == 0);
+        expect(std::begin(tree) == std::end(tree));
+        expect(moved.is_valid());
+    };
+}
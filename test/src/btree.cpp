@@ -1,6 +1,168 @@
+#include <iterator>
+#include <map>
+#include <ranges>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "../include/utils.h"
 #include "../../include/structures/btree.h"
 
+namespace {
+    /**
+     * Counts how many times any instance has been copied. Moves are free.
+     */
+    struct counted_type {
+        static inline size_t copies = 0;
+        int val;
+
+        counted_type() : val(0) {}
+
+        counted_type(int val) : val(val) {}
+
+        counted_type(const counted_type &other) : val(other.val) {
+            copies++;
+        }
+
+        counted_type(counted_type &&other) : val(other.val) {}
+
+        void operator=(const counted_type &other) {
+            this->val = other.val;
+            copies++;
+        }
+
+        void operator=(counted_type &&other) {
+            this->val = other.val;
+        }
+
+        bool operator<(const counted_type &other) const {
+            return this->val < other.val;
+        }
+    };
+
+    /**
+     * Randomly inserts and deletes keys, checking the tree against an std::map and checking the
+     * btree invariants after every deletion.
+     */
+    template <const size_t N>
+    void churn_tree(size_t ops, int key_range) {
+        data::BTree<int, std::string, N> tree;
+        std::map<int, std::string> exp_map;
+
+        for (size_t i = 0; i < ops; i++) {
+            const int key = rand() % key_range;
+
+            if (rand() % 2) {
+                const std::string val = std::to_string(rand());
+                std::optional<std::string> old_val = tree.put(key, val);
+                auto it = exp_map.find(key);
+
+                expect(old_val.has_value() == (it != std::end(exp_map)));
+                exp_map[key] = val;
+            } else {
+                std::optional<std::string> old_val = tree.del(key);
+                auto it = exp_map.find(key);
+
+                if (it == std::end(exp_map)) {
+                    expect(!old_val.has_value());
+                } else {
+                    expect(old_val == it->second);
+                    exp_map.erase(it);
+                }
+
+                expect(!tree.get(key).has_value());
+                expect(tree.is_balanced());
+                expect(tree.is_full_enough());
+            }
+
+            expect(tree.size() == exp_map.size());
+        }
+
+        for (auto &pair : exp_map) {
+            expect(tree.get(pair.first) == pair.second);
+        }
+    }
+
+    /**
+     * Bulk loads every size up to `max_count` at the given fill factor and checks the btree invariants,
+     * then checks that the tree still works with regular inserts and deletes.
+     */
+    template <const size_t N>
+    void bulk_load_tree(size_t max_count, double fill) {
+        for (size_t count = 0; count <= max_count; count += 1 + count / 8) {
+            std::vector<std::pair<int, std::string>> pairs;
+
+            for (size_t i = 0; i < count; i++) {
+                pairs.push_back({ (int) i * 2, std::to_string(i) });
+            }
+
+            data::BTree<int, std::string, N> tree(pairs, fill);
+
+            expect(tree.size() == count);
+            expect(tree.is_balanced());
+            expect(tree.is_full_enough());
+
+            for (size_t i = 0; i < count; i++) {
+                expect(tree.get(i * 2) == std::to_string(i));
+                expect(!tree.get(i * 2 + 1).has_value());
+            }
+
+            for (size_t i = 0; i < count; i += 3) {
+                expect(!tree.put(i * 2 + 1, "odd").has_value());
+                expect(tree.del(i * 2) == std::to_string(i));
+            }
+
+            expect(tree.is_balanced());
+            expect(tree.is_full_enough());
+        }
+    }
+
+    /**
+     * Builds a random tree and an std::map with the same entries, then checks that iterating the tree
+     * in both directions visits the same entries as the map.
+     */
+    template <const size_t N>
+    void iterate_tree(size_t ops, int key_range) {
+        data::BTree<int, int, N> tree;
+        std::map<int, int> exp_map;
+
+        for (size_t i = 0; i < ops; i++) {
+            const int key = rand() % key_range;
+
+            if (rand() % 3) {
+                tree.put(key, key * 3);
+                exp_map[key] = key * 3;
+            } else {
+                tree.del(key);
+                exp_map.erase(key);
+            }
+        }
+
+        auto exp_it = std::begin(exp_map);
+
+        for (const auto [key, val] : tree) {
+            expect(exp_it != std::end(exp_map));
+            expect(key == exp_it->first);
+            expect(*val == exp_it->second);
+            exp_it++;
+        }
+
+        expect(exp_it == std::end(exp_map));
+
+        auto exp_rit = std::rbegin(exp_map);
+        auto it = std::end(tree);
+
+        while (it != std::begin(tree)) {
+            --it;
+            expect(exp_rit != std::rend(exp_map));
+            expect((*it).first == exp_rit->first);
+            exp_rit++;
+        }
+
+        expect(exp_rit == std::rend(exp_map));
+    }
+}
+
 void btree_tests() {
     data::test::tests["btree"]["does not leak memory for simple types"] = []() {
         data::BTree<int, int, 20> tree;
@@ -108,4 +270,243 @@ void btree_tests() {
         expect(tree.is_balanced());
         expect(tree.is_full_enough());
     };
+
+    data::test::tests["btree"]["splitting nodes does not copy subtrees"] = []() {
+        data::BTree<int, counted_type, 8> tree;
+        const size_t count = 20000;
+
+        for (size_t i = 0; i < count; i++) {
+            counted_type::copies = 0;
+            tree.put(i, counted_type(i));
+
+            // Inserting a key copies its value a constant number of times, no matter how many
+            // nodes are split or how big the split subtrees are
+            expect(counted_type::copies < 16);
+        }
+
+        expect(tree.size() == count);
+        expect(tree.is_balanced());
+        expect(tree.is_full_enough());
+
+        for (size_t i = 0; i < count; i++) {
+            expect(tree.get(i).value().val == (int) i);
+        }
+    };
+
+    data::test::tests["btree"]["deleting keys keeps the tree balanced"] = []() {
+        churn_tree<3>(4000, 500);
+        churn_tree<4>(4000, 500);
+        churn_tree<5>(4000, 500);
+        churn_tree<20>(10000, 2000);
+    };
+
+    data::test::tests["btree"]["deleting every key collapses the tree"] = []() {
+        data::BTree<int, int, 6> tree;
+        const int count = 5000;
+
+        for (int i = 0; i < count; i++) {
+            tree.put(i, i * 2);
+        }
+
+        for (int i = 0; i < count; i += 2) {
+            expect(tree.del(i) == i * 2);
+        }
+
+        expect(tree.size() == count / 2);
+        expect(tree.is_balanced());
+        expect(tree.is_full_enough());
+
+        for (int i = count - 1; i >= 0; i--) {
+            if (i % 2) {
+                expect(tree.del(i) == i * 2);
+            } else {
+                expect(!tree.del(i).has_value());
+            }
+        }
+
+        expect(tree.size() == 0);
+        expect(tree.height() == 1);
+
+        for (int i = 0; i < count; i++) {
+            expect(!tree.get(i).has_value());
+        }
+
+        for (int i = 0; i < 100; i++) {
+            tree.put(i, i);
+        }
+
+        expect(tree.size() == 100);
+        expect(tree.is_balanced());
+        expect(tree.is_full_enough());
+    };
+
+    data::test::tests["btree"]["bulk loading sorted pairs"] = []() {
+        bulk_load_tree<3>(2000, 1.0);
+        bulk_load_tree<4>(2000, 1.0);
+        bulk_load_tree<5>(2000, 0.5);
+        bulk_load_tree<20>(5000, 1.0);
+        bulk_load_tree<20>(5000, 0.7);
+        bulk_load_tree<20>(5000, 0.01);
+    };
+
+    data::test::tests["btree"]["bulk loading packs nodes"] = []() {
+        std::vector<std::pair<int, int>> pairs;
+
+        for (int i = 0; i < 100000; i++) {
+            pairs.push_back({ i, i });
+        }
+
+        data::BTree<int, int, 11> full(std::begin(pairs), std::end(pairs));
+        data::BTree<int, int, 11> half(std::begin(pairs), std::end(pairs), 0.5);
+
+        // 10 keys per full node: 10^5 keys need 5 levels, while half full nodes need 7
+        expect(full.height() == 5);
+        expect(half.height() == 7);
+    };
+
+    data::test::tests["btree"]["bulk loading rejects unsorted input"] = []() {
+        const std::vector<std::vector<std::pair<int, int>>> inputs = {
+            { { 1, 1 }, { 3, 3 }, { 2, 2 } },
+            { { 1, 1 }, { 1, 2 } },
+            { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 3, 3 }, { 4, 4 }, { 5, 5 }, { 6, 6 }, { 6, 6 } }
+        };
+
+        for (const auto &input : inputs) {
+            try {
+                data::BTree<int, int, 3> tree(input);
+                fail_test();
+            } catch (const char * const err) {}
+        }
+
+        try {
+            data::BTree<int, int, 3> tree(inputs[0], 1.5);
+            fail_test();
+        } catch (const char * const err) {}
+    };
+
+    data::test::tests["btree"]["moving a node does not copy its keys"] = []() {
+        data::BTreeNode<counted_type, counted_type, 7> node;
+
+        for (int i = 0; i < 5; i++) {
+            node.put(counted_type(i), counted_type(i * 10));
+        }
+
+        counted_type::copies = 0;
+
+        data::BTreeNode<counted_type, counted_type, 7> moved(std::move(node));
+        data::BTreeNode<counted_type, counted_type, 7> assigned;
+
+        assigned = std::move(moved);
+
+        expect(counted_type::copies == 0);
+        expect(assigned.keys.size() == 5);
+
+        for (int i = 0; i < 5; i++) {
+            expect(assigned.keys[i].val == i);
+            expect(assigned.vals[i].val == i * 10);
+        }
+    };
+
+    data::test::tests["btree"]["iterators visit keys in order"] = []() {
+        iterate_tree<3>(3000, 1000);
+        iterate_tree<4>(3000, 1000);
+        iterate_tree<20>(10000, 5000);
+        iterate_tree<5>(0, 1);
+
+        data::BTree<int, int, 4> tree;
+
+        for (int i = 0; i < 100; i++) {
+            tree.put(i, i);
+        }
+
+        // Values can be changed through a non-const iterator
+        for (auto [key, val] : tree) {
+            *val = key * 2;
+        }
+
+        const data::BTree<int, int, 4> &const_tree = tree;
+        int exp_key = 99;
+
+        for (const auto [key, val] : const_tree | std::views::reverse) {
+            expect(key == exp_key);
+            expect(*val == exp_key * 2);
+            exp_key--;
+        }
+
+        expect(exp_key == -1);
+    };
+
+    data::test::tests["btree"]["seeking to keys"] = []() {
+        data::BTree<int, int, 5> tree;
+
+        for (int i = 0; i < 1000; i++) {
+            tree.put(i * 2, i);
+        }
+
+        for (int key = -1; key < 2001; key++) {
+            const int exp_lower = key < 0 ? 0 : key + key % 2;
+            const int exp_upper = key < 0 ? 0 : key + 1 + (key + 1) % 2;
+
+            auto lower = tree.lower_bound(key);
+            auto upper = tree.upper_bound(key);
+            auto [first, last] = tree.equal_range(key);
+
+            if (exp_lower >= 2000) {
+                expect(lower == std::end(tree));
+            } else {
+                expect((*lower).first == exp_lower);
+            }
+
+            if (exp_upper >= 2000) {
+                expect(upper == std::end(tree));
+            } else {
+                expect((*upper).first == exp_upper);
+            }
+
+            expect(first == lower);
+            expect(std::distance(first, last) == (key >= 0 && key < 2000 && key % 2 == 0));
+        }
+
+        // Seeking and then stepping backward
+        auto it = tree.lower_bound(501);
+        expect((*--it).first == 500);
+        expect((*--it).first == 498);
+        expect((*--std::end(tree)).first == 1998);
+    };
+
+    data::test::tests["btree"]["range queries"] = []() {
+        data::BTree<int, int, 4> tree;
+
+        for (int i = 0; i < 500; i++) {
+            tree.put(i * 2, i);
+        }
+
+        const auto items = [](const auto &range) {
+            std::vector<std::pair<int, int>> out;
+
+            for (const auto [key, val] : range) {
+                out.push_back({ key, *val });
+            }
+
+            return out;
+        };
+
+        const std::vector<std::pair<int, int>> exp_items = { { 100, 50 }, { 102, 51 }, { 104, 52 } };
+
+        expect(items(tree.range(100, 106)) == exp_items);
+        expect(items(tree.range(99, 105)) == exp_items);
+        expect(items(tree.range(100, 100)).empty());
+        expect(items(tree.range(106, 100)).empty());
+        expect(items(tree.range(1000, 2000)).empty());
+        expect(items(tree.range(996, 2000)) == (std::vector<std::pair<int, int>>{ { 996, 498 }, { 998, 499 } }));
+        expect(std::ranges::distance(tree.range(-10, 1000)) == 500);
+
+        std::vector<int> reversed;
+
+        for (const auto [key, val] : tree.range(100, 106) | std::views::reverse) {
+            reversed.push_back(key);
+        }
+
+        expect(reversed == (std::vector<int>{ 104, 102, 100 }));
+    };
 }
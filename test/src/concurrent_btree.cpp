@@ -0,0 +1,169 @@
+#include <atomic>
+#include <map>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/concurrent_btree.h"
+
+namespace {
+    /**
+     * A value that can tell if it was read while half written.
+     */
+    struct checked_val {
+        uint64_t key;
+        uint64_t check;
+
+        checked_val() : key(0), check(0) {}
+
+        checked_val(uint64_t key, uint64_t version) : key(key), check(key * 31 + version) {}
+
+        bool is_for(uint64_t key) const {
+            return this->key == key && this->check - key * 31 <= 1;
+        }
+    };
+
+    template <const size_t N>
+    void churn_tree(size_t ops, int key_range) {
+        data::ConcurrentBTree<int, int, N> tree;
+        std::map<int, int> exp_map;
+
+        for (size_t i = 0; i < ops; i++) {
+            const int key = rand() % key_range;
+
+            if (rand() % 3) {
+                const int val = rand();
+                std::optional<int> old_val = tree.put(key, val);
+                auto it = exp_map.find(key);
+
+                if (it == std::end(exp_map)) {
+                    expect(!old_val.has_value());
+                } else {
+                    expect(old_val == it->second);
+                }
+
+                exp_map[key] = val;
+            } else {
+                std::optional<int> old_val = tree.del(key);
+                auto it = exp_map.find(key);
+
+                if (it == std::end(exp_map)) {
+                    expect(!old_val.has_value());
+                } else {
+                    expect(old_val == it->second);
+                    exp_map.erase(it);
+                }
+            }
+
+            expect(tree.size() == exp_map.size());
+        }
+
+        expect(tree.is_valid());
+
+        for (int key = 0; key < key_range; key++) {
+            auto it = exp_map.find(key);
+
+            if (it == std::end(exp_map)) {
+                expect(!tree.get(key).has_value());
+            } else {
+                expect(tree.get(key) == it->second);
+            }
+        }
+    }
+}
+
+void concurrent_btree_tests() {
+    data::test::tests["concurrent btree"]["matches a sorted map on one thread"] = []() {
+        churn_tree<4>(5000, 500);
+        churn_tree<5>(5000, 500);
+        churn_tree<64>(20000, 5000);
+    };
+
+    data::test::tests["concurrent btree"]["concurrent writers and readers"] = []() {
+        data::ConcurrentBTree<uint64_t, checked_val, 8> tree;
+        const size_t writers = 4;
+        const size_t readers = 2;
+        const uint64_t keys_per_writer = 20000;
+        std::atomic<bool> done(false);
+        std::atomic<size_t> bad_reads(0);
+        std::atomic<size_t> bad_writes(0);
+        std::vector<std::thread> threads;
+
+        // Each writer owns the keys congruent to its index, inserts them in a scrambled order, then
+        // rewrites and deletes some of them. Readers check that any value they see is whole and
+        // belongs to the key they looked up.
+        for (size_t w = 0; w < writers; w++) {
+            threads.emplace_back([&, w]() {
+                for (uint64_t i = 0; i < keys_per_writer; i++) {
+                    const uint64_t key = ((i * 2654435761u) % keys_per_writer) * writers + w;
+
+                    if (tree.put(key, checked_val(key, 0)).has_value()) {
+                        bad_writes++;
+                    }
+                }
+
+                for (uint64_t i = 0; i < keys_per_writer; i++) {
+                    const uint64_t key = i * writers + w;
+
+                    if (i % 3 == 0) {
+                        if (!tree.del(key).has_value()) {
+                            bad_writes++;
+                        }
+                    } else {
+                        std::optional<checked_val> old_val = tree.put(key, checked_val(key, 1));
+
+                        if (!old_val.has_value() || !old_val->is_for(key)) {
+                            bad_writes++;
+                        }
+                    }
+                }
+            });
+        }
+
+        for (size_t r = 0; r < readers; r++) {
+            threads.emplace_back([&, r]() {
+                uint64_t key = r;
+
+                while (!done.load()) {
+                    key = (key * 6364136223846793005u + 1442695040888963407u);
+                    const uint64_t lookup = (key >> 33) % (keys_per_writer * writers);
+                    std::optional<checked_val> val = tree.get(lookup);
+
+                    if (val.has_value() && !val->is_for(lookup)) {
+                        bad_reads++;
+                    }
+                }
+            });
+        }
+
+        for (size_t w = 0; w < writers; w++) {
+            threads[w].join();
+        }
+
+        done.store(true);
+
+        for (size_t r = 0; r < readers; r++) {
+            threads[writers + r].join();
+        }
+
+        expect(bad_reads == 0);
+        expect(bad_writes == 0);
+        expect(tree.is_valid());
+
+        size_t exp_size = 0;
+
+        for (uint64_t key = 0; key < keys_per_writer * writers; key++) {
+            std::optional<checked_val> val = tree.get(key);
+
+            if ((key / writers) % 3 == 0) {
+                expect(!val.has_value());
+            } else {
+                expect(val.has_value() && val->key == key && val->check == key * 31 + 1);
+                exp_size++;
+            }
+        }
+
+        expect(tree.size() == exp_size);
+    };
+}
@@ -0,0 +1,155 @@
+#include <atomic>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/concurrent_radix_trie.h"
+
+namespace {
+    std::string random_key(size_t max_len) {
+        std::string out;
+        const size_t len = 1 + rand() % max_len;
+
+        for (size_t i = 0; i < len; i++) {
+            out.push_back('a' + rand() % 3);
+        }
+
+        return out;
+    }
+
+    /**
+     * The value stored for a key in the concurrent test, so that readers can tell if they got a value
+     * for the wrong key.
+     */
+    size_t value_for(std::string_view key) {
+        return std::hash<std::string_view>()(key);
+    }
+}
+
+void concurrent_radix_trie_tests() {
+    data::test::tests["concurrent radix trie"]["matches a map on one thread"] = []() {
+        data::ConcurrentRadixTrie<char, int> trie;
+        std::map<std::string, int> exp_map;
+
+        for (size_t i = 0; i < 5000; i++) {
+            const std::string key = random_key(8);
+
+            if (rand() % 3) {
+                const int val = rand();
+                std::optional<int> old_val = trie.put(std::string_view(key), val);
+                auto it = exp_map.find(key);
+
+                if (it == std::end(exp_map)) {
+                    expect(!old_val.has_value());
+                } else {
+                    expect(old_val == it->second);
+                }
+
+                exp_map[key] = val;
+            } else {
+                std::optional<int> old_val = trie.del(std::string_view(key));
+                auto it = exp_map.find(key);
+
+                if (it == std::end(exp_map)) {
+                    expect(!old_val.has_value());
+                } else {
+                    expect(old_val == it->second);
+                    exp_map.erase(it);
+                }
+
+                expect(trie.is_compact());
+            }
+
+            expect(trie.size() == exp_map.size());
+        }
+
+        for (auto &[key, val] : exp_map) {
+            expect(trie.get(std::string_view(key)) == val);
+        }
+
+        for (auto &[key, val] : exp_map) {
+            expect(trie.del(std::string_view(key)) == val);
+        }
+
+        expect(trie.size() == 0);
+        expect(trie.is_compact());
+        expect(!trie.get({ 'a' }).has_value());
+
+        try {
+            trie.put({}, 0);
+            fail_test();
+        } catch (const char * const err) {}
+
+        // Nothing is pinned, so every replaced node has been freed
+        expect(trie.retired_count() == 0);
+    };
+
+    data::test::tests["concurrent radix trie"]["readers during writes"] = []() {
+        data::ConcurrentRadixTrie<char, size_t> trie;
+        std::vector<std::string> stable_keys;
+        std::vector<std::string> churn_keys;
+
+        // Stable keys are always in the trie. Churn keys are inserted and deleted by the writer, and
+        // share prefixes with the stable keys, so nodes on the readers' paths keep getting split and
+        // merged.
+        for (size_t i = 0; i < 200; i++) {
+            stable_keys.push_back("key" + std::to_string(i * 7));
+            churn_keys.push_back("key" + std::to_string(i * 7) + "x" + std::to_string(i));
+            churn_keys.push_back("key" + std::to_string(i * 7 + 3));
+        }
+
+        for (const std::string &key : stable_keys) {
+            trie.put(std::string_view(key), value_for(key));
+        }
+
+        std::atomic<bool> done(false);
+        std::atomic<size_t> bad_reads(0);
+        std::vector<std::thread> readers;
+
+        for (size_t r = 0; r < 3; r++) {
+            readers.emplace_back([&, r]() {
+                size_t i = r;
+
+                while (!done.load()) {
+                    const std::string &stable = stable_keys[i % stable_keys.size()];
+                    const std::string &churn = churn_keys[i % churn_keys.size()];
+                    std::optional<size_t> stable_val = trie.get(std::string_view(stable));
+                    std::optional<size_t> churn_val = trie.get(std::string_view(churn));
+
+                    if (stable_val != value_for(stable) || (churn_val.has_value() && churn_val != value_for(churn))) {
+                        bad_reads++;
+                    }
+
+                    i += 7;
+                }
+            });
+        }
+
+        for (size_t round = 0; round < 20; round++) {
+            for (const std::string &key : churn_keys) {
+                trie.put(std::string_view(key), value_for(key));
+            }
+
+            for (const std::string &key : churn_keys) {
+                trie.del(std::string_view(key));
+            }
+        }
+
+        done.store(true);
+
+        for (std::thread &reader : readers) {
+            reader.join();
+        }
+
+        expect(bad_reads == 0);
+        expect(trie.size() == stable_keys.size());
+        expect(trie.is_compact());
+
+        // The readers are gone, so the next write frees everything that was retired before it
+        trie.put({ 'z' }, 0);
+        expect(trie.retired_count() == 0);
+    };
+}
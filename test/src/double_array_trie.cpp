@@ -0,0 +1,131 @@
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/double_array_trie.h"
+#include "../../include/structures/radix_trie.h"
+#include "../../include/structures/trie.h"
+
+namespace {
+    std::string random_key(size_t max_len, const std::string &alphabet) {
+        std::string out;
+        const size_t len = 1 + rand() % max_len;
+
+        for (size_t i = 0; i < len; i++) {
+            out.push_back(alphabet[rand() % alphabet.size()]);
+        }
+
+        return out;
+    }
+
+    /**
+     * Checks that a frozen trie holds exactly the keys in a map, by looking up every key in the map
+     * along with random keys that may or may not be in it.
+     */
+    void expect_matches(const data::DoubleArrayTrie<char, int> &frozen, const std::map<std::string, int> &exp_map, const std::string &alphabet) {
+        expect(frozen.size() == exp_map.size());
+
+        for (const auto &[key, val] : exp_map) {
+            expect(frozen.get(std::string_view(key)) == val);
+
+            // Every proper prefix is either another key or not in the trie
+            for (size_t len = 0; len < key.size(); len++) {
+                const std::string prefix = key.substr(0, len);
+                auto it = exp_map.find(prefix);
+                const std::optional<int> exp_val = it == std::end(exp_map) ? std::nullopt : std::optional<int>(it->second);
+
+                expect(frozen.get(std::string_view(prefix)) == exp_val);
+            }
+        }
+
+        for (size_t i = 0; i < 2000; i++) {
+            const std::string key = random_key(10, alphabet);
+            auto it = exp_map.find(key);
+            const std::optional<int> exp_val = it == std::end(exp_map) ? std::nullopt : std::optional<int>(it->second);
+
+            expect(frozen.get(key.data(), key.size()) == exp_val);
+        }
+    }
+}
+
+void double_array_trie_tests() {
+    data::test::tests["double array trie"]["building from entries"] = []() {
+        data::DoubleArrayTrie<char, int> empty;
+
+        expect(empty.size() == 0);
+        expect(!empty.get("", 0).has_value());
+        expect(!empty.get("a", 1).has_value());
+
+        data::DoubleArrayTrie<char, int> frozen({
+            { { 'b', 'c' }, 1 },
+            { { 'a' }, 2 },
+            { { 'a', 'b', 'c' }, 3 },
+            { {}, 4 },
+            { { 'b', 'c' }, 5 }
+        });
+
+        // The duplicate key keeps the last value
+        expect(frozen.size() == 4);
+        expect(frozen.get("bc", 2) == 5);
+        expect(frozen.get("a", 1) == 2);
+        expect(frozen.get("abc", 3) == 3);
+        expect(frozen.get("", 0) == 4);
+        expect(!frozen.get("ab", 2).has_value());
+        expect(!frozen.get("b", 1).has_value());
+        expect(!frozen.get("abcd", 4).has_value());
+        expect(!frozen.get("c", 1).has_value());
+    };
+
+    data::test::tests["double array trie"]["freezing a trie"] = []() {
+        const std::string alphabet = "acgt\x01\xff";
+        data::Trie<char, int> trie;
+        std::map<std::string, int> exp_map;
+
+        for (size_t i = 0; i < 5000; i++) {
+            const std::string key = random_key(8, alphabet);
+            const int val = rand();
+
+            trie.put(key.data(), key.size(), val);
+            exp_map[key] = val;
+        }
+
+        // Deleted keys must not come back
+        for (size_t i = 0; i < 1000; i++) {
+            const std::string key = random_key(8, alphabet);
+
+            trie.del(key.data(), key.size());
+            exp_map.erase(key);
+        }
+
+        expect_matches(trie.freeze(), exp_map, alphabet);
+    };
+
+    data::test::tests["double array trie"]["freezing a radix trie"] = []() {
+        std::string alphabet;
+
+        for (int i = -128; i < 128; i++) {
+            alphabet.push_back((char) i);
+        }
+
+        data::RadixTrie<char, int> trie;
+        std::map<std::string, int> exp_map;
+
+        for (size_t i = 0; i < 5000; i++) {
+            const std::string key = random_key(6, i % 2 ? alphabet : "xyz");
+            const int val = rand();
+
+            trie.put(std::string_view(key), val);
+            exp_map[key] = val;
+        }
+
+        const data::DoubleArrayTrie<char, int> frozen = trie.freeze();
+
+        expect_matches(frozen, exp_map, "xyz");
+        expect_matches(frozen, exp_map, alphabet);
+
+        // Bases are packed into the lowest free cells, so most of the array is in use
+        expect(frozen.cell_count() < 4 * (frozen.size() * 6 + 256));
+    };
+}
@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/durable_btree.h"
+
+namespace {
+    typedef data::DurableBTree<int, int64_t, 7> test_tree;
+
+    struct Op {
+        bool is_put;
+        int key;
+        int64_t val;
+        // Size of the log after the op was appended
+        uint64_t log_end;
+    };
+
+    /**
+     * A new temporary directory for a tree's files. The directory and the files are removed when the
+     * guard goes out of scope, even if the test fails. Declare it before the trees that use it so that
+     * they are closed first.
+     */
+    struct temp_dir {
+        std::string dir;
+        std::string path;
+
+        temp_dir() {
+            char name[] = "/tmp/durable_btree_XXXXXX";
+
+            expect(mkdtemp(name) != nullptr);
+
+            this->dir = name;
+            this->path = this->dir + "/tree";
+        }
+
+        temp_dir(const temp_dir &other) = delete;
+
+        ~temp_dir() {
+            unlink(this->path.c_str());
+            unlink((this->path + ".wal").c_str());
+            unlink((this->path + ".tmp").c_str());
+            rmdir(this->dir.c_str());
+        }
+
+        void operator=(const temp_dir &other) = delete;
+    };
+
+    std::vector<unsigned char> read_file(const std::string &path) {
+        FILE * file = fopen(path.c_str(), "rb");
+        std::vector<unsigned char> out;
+        int c;
+
+        expect(file != nullptr);
+
+        while ((c = fgetc(file)) != EOF) {
+            out.push_back((unsigned char) c);
+        }
+
+        fclose(file);
+
+        return out;
+    }
+
+    void write_file(const std::string &path, const std::vector<unsigned char> &bytes, size_t len) {
+        expect(len <= bytes.size());
+
+        FILE * file = fopen(path.c_str(), "wb");
+
+        expect(file != nullptr);
+        expect(fwrite(bytes.data(), 1, len, file) == len);
+        fclose(file);
+    }
+
+    /**
+     * Applies random puts and deletes to the tree and to `exp_map`, and records them.
+     */
+    void random_ops(test_tree &tree, std::map<int, int64_t> &exp_map, std::vector<Op> &ops, size_t count, int key_range) {
+        for (size_t i = 0; i < count; i++) {
+            const int key = rand() % key_range;
+            auto it = exp_map.find(key);
+            const std::optional<int64_t> exp_old = it == std::end(exp_map) ? std::nullopt : std::optional<int64_t>(it->second);
+
+            if (rand() % 3) {
+                const int64_t val = rand();
+
+                expect(tree.put(key, val) == exp_old);
+                exp_map[key] = val;
+                ops.push_back({ true, key, val, tree.log().size() });
+            } else {
+                expect(tree.del(key) == exp_old);
+                exp_map.erase(key);
+                ops.push_back({ false, key, 0, tree.log().size() });
+            }
+        }
+    }
+
+    /**
+     * Returns `base` with every op whose record ends at or before `cut` applied to it.
+     */
+    std::map<int, int64_t> apply_ops(std::map<int, int64_t> base, const std::vector<Op> &ops, uint64_t cut) {
+        for (const Op &op : ops) {
+            if (op.log_end > cut) {
+                break;
+            }
+
+            if (op.is_put) {
+                base[op.key] = op.val;
+            } else {
+                base.erase(op.key);
+            }
+        }
+
+        return base;
+    }
+
+    void expect_matches(const test_tree &tree, const std::map<int, int64_t> &exp_map, int key_range) {
+        expect(tree.size() == exp_map.size());
+        expect(tree.tree().is_balanced());
+        expect(tree.tree().is_full_enough());
+
+        for (int key = 0; key < key_range; key++) {
+            auto it = exp_map.find(key);
+            const std::optional<int64_t> exp_val = it == std::end(exp_map) ? std::nullopt : std::optional<int64_t>(it->second);
+
+            expect(tree.get(key) == exp_val);
+        }
+    }
+}
+
+void durable_btree_tests() {
+    data::test::tests["durable btree"]["recovers after closing"] = []() {
+        const temp_dir dir;
+        const std::string &path = dir.path;
+        std::map<int, int64_t> exp_map;
+        std::vector<Op> ops;
+
+        {
+            test_tree tree(path.c_str());
+            random_ops(tree, exp_map, ops, 5000, 1000);
+        }
+
+        {
+            test_tree tree(path.c_str());
+            expect_matches(tree, exp_map, 1000);
+
+            tree.checkpoint();
+            expect(tree.log().size() == 0);
+
+            random_ops(tree, exp_map, ops, 5000, 1000);
+        }
+
+        {
+            test_tree tree(path.c_str());
+            expect_matches(tree, exp_map, 1000);
+
+            // A checkpoint of an empty tree
+            for (const auto &[key, val] : std::map<int, int64_t>(exp_map)) {
+                tree.del(key);
+                exp_map.erase(key);
+            }
+
+            tree.checkpoint();
+        }
+
+        test_tree tree(path.c_str());
+        expect_matches(tree, exp_map, 1000);
+    };
+
+    data::test::tests["durable btree"]["recovers from a log truncated anywhere"] = []() {
+        const temp_dir dir;
+        const std::string &path = dir.path;
+        const std::string wal_path = path + ".wal";
+        std::map<int, int64_t> before_checkpoint;
+        std::map<int, int64_t> exp_map;
+        std::vector<Op> ops;
+
+        {
+            // Writes aren't synced, but the log is still written out when the tree is closed
+            test_tree tree(path.c_str(), data::WalSyncPolicy::NEVER);
+
+            random_ops(tree, exp_map, ops, 1000, 300);
+            tree.checkpoint();
+            before_checkpoint = exp_map;
+            ops.clear();
+            random_ops(tree, exp_map, ops, 2000, 300);
+        }
+
+        const std::vector<unsigned char> log = read_file(wal_path);
+
+        expect(log.size() == ops.back().log_end);
+
+        std::vector<uint64_t> cuts = { 0, 1, log.size() - 1, log.size() };
+
+        // Every record boundary and the bytes around a few of them
+        for (size_t i = 0; i < ops.size(); i++) {
+            cuts.push_back(ops[i].log_end);
+
+            if (i % 50 == 0) {
+                // A delete of a missing key logs nothing, so the first ops can end at 0
+                if (ops[i].log_end > 0) {
+                    cuts.push_back(ops[i].log_end - 1);
+                }
+
+                cuts.push_back(ops[i].log_end + 1);
+            }
+        }
+
+        for (int i = 0; i < 300; i++) {
+            cuts.push_back(rand() % (log.size() + 1));
+        }
+
+        for (uint64_t cut : cuts) {
+            cut = std::min<uint64_t>(cut, log.size());
+
+            write_file(wal_path, log, cut);
+
+            test_tree tree(path.c_str());
+            expect_matches(tree, apply_ops(before_checkpoint, ops, cut), 300);
+        }
+    };
+
+    data::test::tests["durable btree"]["stops at a corrupted record"] = []() {
+        const temp_dir dir;
+        const std::string &path = dir.path;
+        const std::string wal_path = path + ".wal";
+        std::map<int, int64_t> exp_map;
+        std::vector<Op> ops;
+
+        {
+            test_tree tree(path.c_str(), data::WalSyncPolicy::NEVER);
+            random_ops(tree, exp_map, ops, 2000, 300);
+        }
+
+        const std::vector<unsigned char> log = read_file(wal_path);
+
+        for (int i = 0; i < 100; i++) {
+            std::vector<unsigned char> corrupt = log;
+            const size_t pos = rand() % corrupt.size();
+            uint64_t record_start = 0;
+
+            corrupt[pos] ^= 1 << (rand() % 8);
+
+            for (const Op &op : ops) {
+                if (op.log_end > pos) {
+                    break;
+                }
+
+                record_start = op.log_end;
+            }
+
+            write_file(wal_path, corrupt, corrupt.size());
+
+            // Everything from the corrupted record on is lost
+            test_tree tree(path.c_str());
+            expect_matches(tree, apply_ops(std::map<int, int64_t>(), ops, record_start), 300);
+        }
+    };
+
+    data::test::tests["durable btree"]["appends after a torn record"] = []() {
+        const temp_dir dir;
+        const std::string &path = dir.path;
+        const std::string wal_path = path + ".wal";
+        std::map<int, int64_t> exp_map;
+        std::vector<Op> ops;
+
+        {
+            test_tree tree(path.c_str());
+            random_ops(tree, exp_map, ops, 1000, 300);
+        }
+
+        // Tear the last record in half
+        const std::vector<unsigned char> log = read_file(wal_path);
+        const uint64_t cut = (ops[ops.size() - 2].log_end + log.size()) / 2;
+
+        write_file(wal_path, log, cut);
+        exp_map = apply_ops(std::map<int, int64_t>(), ops, cut);
+        ops.clear();
+
+        {
+            test_tree tree(path.c_str());
+            random_ops(tree, exp_map, ops, 1000, 300);
+        }
+
+        test_tree tree(path.c_str());
+        expect_matches(tree, exp_map, 300);
+    };
+
+    data::test::tests["durable btree"]["a crash during a checkpoint"] = []() {
+        const temp_dir dir;
+        const std::string &path = dir.path;
+        const std::string wal_path = path + ".wal";
+        std::map<int, int64_t> exp_map;
+        std::vector<Op> ops;
+
+        {
+            test_tree tree(path.c_str(), data::WalSyncPolicy::GROUP, 16);
+
+            random_ops(tree, exp_map, ops, 1000, 300);
+            tree.sync();
+
+            const std::vector<unsigned char> log = read_file(wal_path);
+
+            // Some changes are still waiting for their group when the checkpoint is taken
+            random_ops(tree, exp_map, ops, 10, 300);
+            tree.checkpoint();
+
+            // Crash after the new checkpoint was renamed, but before the log was emptied. The log only
+            // has records from before the checkpoint.
+            write_file(wal_path, log, log.size());
+        }
+
+        {
+            test_tree tree(path.c_str());
+            expect_matches(tree, exp_map, 300);
+
+            random_ops(tree, exp_map, ops, 1000, 300);
+        }
+
+        test_tree tree(path.c_str());
+        expect_matches(tree, exp_map, 300);
+    };
+
+    data::test::tests["durable btree"]["groups share a sync"] = []() {
+        {
+            const temp_dir dir;
+            const std::string &path = dir.path;
+            test_tree tree(path.c_str(), data::WalSyncPolicy::GROUP, 16);
+
+            for (int i = 0; i < 1600; i++) {
+                tree.put(i, i);
+            }
+
+            expect(tree.log().syncs() == 100);
+            expect(tree.log().durable_lsn() == 1600);
+
+            tree.put(1600, 1600);
+
+            expect(tree.log().durable_lsn() == 1600);
+
+            tree.sync();
+
+            expect(tree.log().durable_lsn() == 1601);
+            expect(tree.log().syncs() == 101);
+
+            // Deleting a key that isn't there doesn't log anything
+            expect(!tree.del(5000).has_value());
+            expect(tree.log().next_lsn() == 1602);
+        }
+
+        {
+            const temp_dir dir;
+            const std::string &path = dir.path;
+            test_tree tree(path.c_str(), data::WalSyncPolicy::ALWAYS);
+
+            for (int i = 0; i < 100; i++) {
+                tree.put(i, i);
+                expect(tree.log().durable_lsn() == (uint64_t) i + 1);
+            }
+
+            expect(tree.log().syncs() == 100);
+        }
+
+        {
+            const temp_dir dir;
+            const std::string &path = dir.path;
+            test_tree tree(path.c_str(), data::WalSyncPolicy::NEVER);
+
+            for (int i = 0; i < 100; i++) {
+                tree.put(i, i);
+            }
+
+            expect(tree.log().syncs() == 0);
+            expect(tree.log().durable_lsn() == 0);
+        }
+    };
+
+    data::test::tests["durable btree"]["rejects other files"] = []() {
+        const temp_dir dir;
+        const std::string &path = dir.path;
+
+        {
+            data::DurableBTree<int, int, 7> tree(path.c_str());
+            tree.put(1, 1);
+            tree.checkpoint();
+        }
+
+        bool threw = false;
+
+        try {
+            test_tree tree(path.c_str());
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+
+        FILE * file = fopen(path.c_str(), "wb");
+        fputs("not a checkpoint, but long enough to have a header", file);
+        fclose(file);
+
+        threw = false;
+
+        try {
+            data::DurableBTree<int, int, 7> tree(path.c_str());
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+
+        // A checkpoint whose header claims to include more of the log than it does
+        unlink(path.c_str());
+
+        {
+            data::DurableBTree<int, int, 7> tree(path.c_str());
+            tree.put(2, 2);
+            tree.checkpoint();
+        }
+
+        std::vector<unsigned char> checkpoint = read_file(path);
+
+        checkpoint[offsetof(data::DurableBTreeCheckpointHeader, lsn)] ^= 1;
+        write_file(path, checkpoint, checkpoint.size());
+
+        threw = false;
+
+        try {
+            data::DurableBTree<int, int, 7> tree(path.c_str());
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+    };
+}
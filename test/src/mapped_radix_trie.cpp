@@ -0,0 +1,222 @@
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/mapped_radix_trie.h"
+#include "../../include/structures/radix_trie.h"
+
+namespace {
+    /**
+     * A new, empty temporary file, which is removed when the guard goes out of scope, even if the test
+     * fails.
+     */
+    struct temp_file {
+        std::string path;
+
+        temp_file() {
+            char name[] = "/tmp/mapped_radix_trie_XXXXXX";
+            const int fd = mkstemp(name);
+
+            expect(fd >= 0);
+            close(fd);
+
+            this->path = name;
+        }
+
+        temp_file(const temp_file &other) = delete;
+
+        ~temp_file() {
+            unlink(this->path.c_str());
+        }
+
+        void operator=(const temp_file &other) = delete;
+    };
+
+    std::string random_key(size_t max_len, const std::string &alphabet) {
+        std::string out;
+        const size_t len = 1 + rand() % max_len;
+
+        for (size_t i = 0; i < len; i++) {
+            out.push_back(alphabet[rand() % alphabet.size()]);
+        }
+
+        return out;
+    }
+
+    template <typename R>
+    std::vector<std::pair<std::string, int>> to_items(const R &range) {
+        std::vector<std::pair<std::string, int>> out;
+
+        for (auto entry : range) {
+            out.push_back({ std::string(std::begin(entry.first), std::end(entry.first)), *entry.second });
+        }
+
+        return out;
+    }
+
+    bool throws(const char * path) {
+        try {
+            data::MappedRadixTrie<char, int> mapped(path);
+        } catch (const char * err) {
+            return true;
+        }
+
+        return false;
+    }
+}
+
+void mapped_radix_trie_tests() {
+    data::test::tests["mapped radix trie"]["saving and opening"] = []() {
+        const std::string alphabet = "abcd";
+        const temp_file temp;
+        const std::string &path = temp.path;
+        data::RadixTrie<char, int> trie;
+        std::map<std::string, int> exp_map;
+
+        for (size_t i = 0; i < 5000; i++) {
+            const std::string key = random_key(10, alphabet);
+            const int val = rand();
+
+            trie.put(std::string_view(key), val);
+            exp_map[key] = val;
+        }
+
+        for (size_t i = 0; i < 1000; i++) {
+            const std::string key = random_key(10, alphabet);
+
+            trie.del(std::string_view(key));
+            exp_map.erase(key);
+        }
+
+        trie.save(path.c_str());
+
+        data::MappedRadixTrie<char, int> opened(path.c_str());
+        // The view keeps working after it is moved, and after the file is unlinked
+        const data::MappedRadixTrie<char, int> mapped(std::move(opened));
+
+        unlink(path.c_str());
+
+        expect(mapped.size() == exp_map.size());
+        expect(to_items(mapped) == to_items(trie));
+
+        for (const auto &[key, val] : exp_map) {
+            expect(mapped.get(std::string_view(key)) == val);
+        }
+
+        for (size_t i = 0; i < 2000; i++) {
+            const std::string key = random_key(12, alphabet);
+            auto it = exp_map.find(key);
+            const std::optional<int> exp_val = it == std::end(exp_map) ? std::nullopt : std::optional<int>(it->second);
+
+            expect(mapped.get(std::string_view(key)) == exp_val);
+        }
+
+        expect(!mapped.get(std::string_view("")).has_value());
+    };
+
+    data::test::tests["mapped radix trie"]["entries_with_prefix"] = []() {
+        const temp_file temp;
+        const std::string &path = temp.path;
+        data::RadixTrie<char, int> trie;
+
+        trie.put(std::string_view("tester"), 1);
+        trie.put(std::string_view("slow"), 2);
+        trie.put(std::string_view("water"), 3);
+        trie.put(std::string_view("slower"), 4);
+        trie.put(std::string_view("test"), 5);
+        trie.put(std::string_view("team"), 6);
+        trie.put(std::string_view("toast"), 7);
+
+        trie.save(path.c_str());
+
+        const data::MappedRadixTrie<char, int> mapped(path.c_str());
+
+        unlink(path.c_str());
+
+        // Prefixes that end between nodes, in the middle of a fragment, at a leaf, and nowhere
+        const std::vector<std::string> prefixes = { "", "t", "te", "tes", "slo", "slowe", "water", "waters", "x", "tea" };
+
+        for (const std::string &prefix : prefixes) {
+            expect(to_items(mapped.entries_with_prefix(std::string_view(prefix))) == to_items(trie.entries_with_prefix(std::string_view(prefix))));
+
+            for (size_t limit = 0; limit < 4; limit++) {
+                expect(to_items(mapped.entries_with_prefix(std::string_view(prefix), limit)) == to_items(trie.entries_with_prefix(std::string_view(prefix), limit)));
+            }
+        }
+
+        const std::vector<std::pair<std::string, int>> exp_items = { { "team", 6 }, { "test", 5 }, { "tester", 1 } };
+
+        expect(to_items(mapped.entries_with_prefix(std::string_view("te"))) == exp_items);
+        expect(!to_items(mapped.entries_with_prefix(std::string_view("tx"))).size());
+    };
+
+    data::test::tests["mapped radix trie"]["empty tries"] = []() {
+        const temp_file temp;
+        const std::string &path = temp.path;
+        data::RadixTrie<char, int> trie;
+
+        trie.save(path.c_str());
+
+        const data::MappedRadixTrie<char, int> mapped(path.c_str());
+
+        unlink(path.c_str());
+
+        expect(mapped.size() == 0);
+        expect(mapped.begin() == mapped.end());
+        expect(!mapped.get(std::string_view("a")).has_value());
+        expect(!to_items(mapped.entries_with_prefix(std::string_view(""))).size());
+    };
+
+    data::test::tests["mapped radix trie"]["rejects bad files"] = []() {
+        const temp_file temp;
+        const std::string &path = temp.path;
+
+        // Empty file
+        expect(throws(path.c_str()));
+
+        data::RadixTrie<char, int> trie;
+
+        trie.put(std::string_view("key"), 1);
+        trie.save(path.c_str());
+
+        expect(!throws(path.c_str()));
+
+        // Different value type
+        bool threw = false;
+
+        try {
+            data::MappedRadixTrie<char, int64_t> mapped(path.c_str());
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+
+        // Truncated image
+        expect(!truncate(path.c_str(), 64));
+        expect(throws(path.c_str()));
+
+        // Not a trie at all
+        FILE * file = fopen(path.c_str(), "wb");
+
+        for (size_t i = 0; i < 256; i++) {
+            fputc('x', file);
+        }
+
+        fclose(file);
+
+        expect(throws(path.c_str()));
+
+        unlink(path.c_str());
+
+        // Missing file
+        expect(throws(path.c_str()));
+    };
+}
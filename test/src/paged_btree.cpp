@@ -0,0 +1,316 @@
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+#include "../include/utils.h"
+#include "../../include/structures/buffer_pool.h"
+#include "../../include/structures/paged_btree.h"
+
+namespace {
+    /**
+     * A new, empty temporary file, which is removed when the guard goes out of scope, even if the test
+     * fails. Declare it before the trees that use it so that they are closed first.
+     */
+    struct temp_file {
+        std::string path;
+
+        temp_file() {
+            char name[] = "/tmp/paged_btree_XXXXXX";
+            const int fd = mkstemp(name);
+
+            expect(fd >= 0);
+            close(fd);
+
+            this->path = name;
+        }
+
+        temp_file(const temp_file &other) = delete;
+
+        ~temp_file() {
+            unlink(this->path.c_str());
+        }
+
+        void operator=(const temp_file &other) = delete;
+    };
+
+    /**
+     * Randomly inserts and deletes keys with only a few frames, so that pages are constantly evicted
+     * and read back, and checks the tree against an std::map.
+     */
+    template <const size_t N>
+    void churn_tree(size_t ops, int key_range, size_t frames) {
+        const temp_file temp;
+        const std::string &path = temp.path;
+        data::PagedBTree<int, int64_t, N> tree(path.c_str(), frames);
+        std::map<int, int64_t> exp_map;
+
+        for (size_t i = 0; i < ops; i++) {
+            const int key = rand() % key_range;
+
+            if (rand() % 3) {
+                const int64_t val = rand();
+                auto it = exp_map.find(key);
+                const std::optional<int64_t> exp_old = it == std::end(exp_map) ? std::nullopt : std::optional<int64_t>(it->second);
+
+                expect(tree.put(key, val) == exp_old);
+                exp_map[key] = val;
+            } else {
+                auto it = exp_map.find(key);
+                const std::optional<int64_t> exp_old = it == std::end(exp_map) ? std::nullopt : std::optional<int64_t>(it->second);
+
+                expect(tree.del(key) == exp_old);
+                exp_map.erase(key);
+            }
+        }
+
+        expect(tree.size() == exp_map.size());
+        expect(tree.is_balanced());
+        expect(tree.is_full_enough());
+
+        for (int key = 0; key < key_range; key++) {
+            auto it = exp_map.find(key);
+            const std::optional<int64_t> exp_val = it == std::end(exp_map) ? std::nullopt : std::optional<int64_t>(it->second);
+
+            expect(tree.get(key) == exp_val);
+        }
+
+        // Only the frames are kept in memory, so most lookups had to go to the file
+        expect(tree.buffer_pool().frame_count() == frames);
+        expect(tree.buffer_pool().misses() > 0);
+    }
+}
+
+void paged_btree_tests() {
+    data::test::tests["paged btree"]["matches a map with few frames"] = []() {
+        churn_tree<3>(20000, 2000, 32);
+        churn_tree<4>(20000, 2000, 32);
+        churn_tree<31>(50000, 20000, 8);
+        churn_tree<255>(50000, 100000, 8);
+    };
+
+    data::test::tests["paged btree"]["deep trees need only a few frames"] = []() {
+        typedef data::PagedBTree<int, int, 3> tree_type;
+
+        const temp_file temp;
+        const std::string &path = temp.path;
+        // With one key per node at worst, this is a dozen levels deep
+        tree_type tree(path.c_str(), tree_type::MIN_FRAMES);
+
+        for (int i = 0; i < 5000; i++) {
+            expect(!tree.put(i, i).has_value());
+        }
+
+        expect(tree.size() == 5000);
+        expect(tree.is_balanced());
+        expect(tree.is_full_enough());
+
+        for (int i = 0; i < 5000; i++) {
+            expect(tree.get(i) == i);
+        }
+
+        // Deleting from the middle of the key range replaces internal keys and merges all the way up
+        for (int i = 1000; i < 4000; i++) {
+            expect(tree.del(i) == i);
+        }
+
+        for (int i = 4999; i >= 4000; i--) {
+            expect(tree.del(i) == i);
+        }
+
+        expect(tree.size() == 1000);
+        expect(tree.is_balanced());
+        expect(tree.is_full_enough());
+
+        for (int i = 0; i < 5000; i++) {
+            expect(tree.get(i) == (i < 1000 ? std::optional<int>(i) : std::nullopt));
+        }
+    };
+
+    data::test::tests["paged btree"]["reopening a file"] = []() {
+        const temp_file temp;
+        const std::string &path = temp.path;
+        std::map<int, int64_t> exp_map;
+
+        {
+            data::PagedBTree<int, int64_t, 15> tree(path.c_str(), 8);
+
+            for (int i = 0; i < 5000; i++) {
+                const int key = rand() % 10000;
+
+                tree.put(key, i);
+                exp_map[key] = i;
+            }
+
+            tree.flush();
+        }
+
+        {
+            // Changes that were never flushed are written back when the tree is closed
+            data::PagedBTree<int, int64_t, 15> tree(path.c_str(), 8);
+
+            expect(tree.size() == exp_map.size());
+
+            for (const auto &[key, val] : exp_map) {
+                expect(tree.get(key) == val);
+            }
+
+            for (int key = 0; key < 10000; key += 2) {
+                tree.del(key);
+                exp_map.erase(key);
+            }
+        }
+
+        data::PagedBTree<int, int64_t, 15> tree(path.c_str(), 8);
+
+        expect(tree.size() == exp_map.size());
+        expect(tree.is_balanced());
+        expect(tree.is_full_enough());
+
+        for (int key = 0; key < 10000; key++) {
+            auto it = exp_map.find(key);
+            const std::optional<int64_t> exp_val = it == std::end(exp_map) ? std::nullopt : std::optional<int64_t>(it->second);
+
+            expect(tree.get(key) == exp_val);
+        }
+    };
+
+    data::test::tests["paged btree"]["reuses freed pages"] = []() {
+        const temp_file temp;
+        const std::string &path = temp.path;
+        data::PagedBTree<int, int, 7> tree(path.c_str(), 16);
+
+        for (int i = 0; i < 10000; i++) {
+            tree.put(i, i);
+        }
+
+        const size_t pages = tree.page_count();
+
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < 10000; i++) {
+                expect(tree.del(i) == i);
+            }
+
+            expect(tree.size() == 0);
+
+            for (int i = 0; i < 10000; i++) {
+                expect(!tree.put(i, i).has_value());
+            }
+        }
+
+        expect(tree.page_count() == pages);
+    };
+
+    data::test::tests["paged btree"]["rejects other files"] = []() {
+        const temp_file temp;
+        const std::string &path = temp.path;
+
+        {
+            data::PagedBTree<int, int, 7> tree(path.c_str(), 4);
+            tree.put(1, 1);
+        }
+
+        bool threw = false;
+
+        try {
+            data::PagedBTree<int, int64_t, 7> tree(path.c_str(), 4);
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+
+        threw = false;
+
+        try {
+            data::PagedBTree<int, int, 9> tree(path.c_str(), 4);
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+
+        FILE * file = fopen(path.c_str(), "wb");
+        fputs("not a btree", file);
+        fclose(file);
+
+        threw = false;
+
+        try {
+            data::PagedBTree<int, int, 7> tree(path.c_str(), 4);
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+
+        threw = false;
+
+        try {
+            data::PagedBTree<int, int, 7> tree(path.c_str(), data::PagedBTree<int, int, 7>::MIN_FRAMES - 1);
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+    };
+
+    data::test::tests["buffer pool"]["evicts with the clock policy"] = []() {
+        const temp_file temp;
+        const std::string &path = temp.path;
+        data::BufferPool pool(path.c_str(), 4096, 3);
+
+        for (uint64_t id = 0; id < 3; id++) {
+            data::BufferPool::Page page = pool.pin(id);
+
+            // New pages read as zeros
+            expect(page.data()[0] == 0);
+            page.data()[0] = (unsigned char) (id + 1);
+            page.mark_dirty();
+        }
+
+        expect(pool.misses() == 3);
+
+        // Every frame has been used since the hand last passed, so the first sweep only clears the
+        // reference bits and the second one takes page 0. Page 0 is written back on the way out.
+        {
+            data::BufferPool::Page page = pool.pin(3);
+        }
+
+        expect(pool.misses() == 4);
+
+        {
+            data::BufferPool::Page page = pool.pin(1);
+            expect(page.data()[0] == 2);
+        }
+
+        expect(pool.hits() == 1);
+
+        {
+            data::BufferPool::Page page = pool.pin(0);
+            expect(page.data()[0] == 1);
+        }
+
+        expect(pool.misses() == 5);
+
+        // Pinned pages can't be evicted
+        data::BufferPool::Page a = pool.pin(0);
+        data::BufferPool::Page b = pool.pin(1);
+        data::BufferPool::Page c = pool.pin(2);
+        bool threw = false;
+
+        try {
+            pool.pin(4);
+        } catch (const char * err) {
+            threw = true;
+        }
+
+        expect(threw);
+
+        c.reset();
+
+        expect(pool.pin(4).id() == 4);
+    };
+}
@@ -0,0 +1,243 @@
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../include/utils.h"
+#include "../../include/structures/persistent_btree.h"
+
+namespace {
+    template <const size_t N>
+    bool matches_map(const data::PersistentBTree<int, std::string, N> &tree, const std::map<int, std::string> &exp_map) {
+        auto exp_it = std::begin(exp_map);
+
+        for (const auto [key, val] : tree) {
+            if (exp_it == std::end(exp_map) || key != exp_it->first || *val != exp_it->second) {
+                return false;
+            }
+
+            exp_it++;
+        }
+
+        return exp_it == std::end(exp_map) && tree.size() == exp_map.size();
+    }
+
+    /**
+     * Randomly inserts and deletes keys while taking snapshots along the way, and checks at the end
+     * that every snapshot still holds exactly what the tree held when it was taken.
+     */
+    template <const size_t N>
+    void churn_with_snapshots(size_t ops, int key_range) {
+        data::PersistentBTree<int, std::string, N> tree;
+        std::map<int, std::string> exp_map;
+        std::vector<std::pair<data::PersistentBTree<int, std::string, N>, std::map<int, std::string>>> snapshots;
+
+        for (size_t i = 0; i < ops; i++) {
+            const int key = rand() % key_range;
+
+            if (rand() % 2) {
+                const std::string val = std::to_string(rand());
+                std::optional<std::string> old_val = tree.put(key, val);
+                auto it = exp_map.find(key);
+
+                expect(old_val.has_value() == (it != std::end(exp_map)));
+
+                if (it != std::end(exp_map)) {
+                    expect(old_val == it->second);
+                }
+
+                exp_map[key] = val;
+            } else {
+                std::optional<std::string> old_val = tree.del(key);
+                auto it = exp_map.find(key);
+
+                if (it == std::end(exp_map)) {
+                    expect(!old_val.has_value());
+                } else {
+                    expect(old_val == it->second);
+                    exp_map.erase(it);
+                }
+
+                expect(!tree.get(key).has_value());
+                expect(tree.is_valid());
+            }
+
+            expect(tree.size() == exp_map.size());
+
+            if (i % 200 == 0) {
+                snapshots.push_back({ tree.snapshot(), exp_map });
+            }
+        }
+
+        expect(matches_map(tree, exp_map));
+
+        for (auto &[snapshot, snapshot_map] : snapshots) {
+            expect(snapshot.is_valid());
+            expect(matches_map(snapshot, snapshot_map));
+        }
+
+        // Writing to a snapshot doesn't change the tree either
+        auto &[snapshot, snapshot_map] = snapshots.back();
+
+        for (int key = 0; key < key_range; key += 3) {
+            snapshot.del(key);
+        }
+
+        expect(snapshot.is_valid());
+        expect(matches_map(tree, exp_map));
+    }
+}
+
+void persistent_btree_tests() {
+    data::test::tests["persistent btree"]["snapshots keep their contents"] = []() {
+        churn_with_snapshots<3>(4000, 500);
+        churn_with_snapshots<4>(4000, 500);
+        churn_with_snapshots<5>(4000, 500);
+        churn_with_snapshots<16>(6000, 2000);
+    };
+
+    data::test::tests["persistent btree"]["writes only copy the nodes they change"] = []() {
+        data::PersistentBTree<int, int, 8> tree;
+
+        for (int i = 0; i < 10000; i++) {
+            tree.put(i, i);
+        }
+
+        data::PersistentBTree<int, int, 8> snapshot = tree.snapshot();
+        expect(tree.unshared_nodes(snapshot) == 0);
+
+        // Replacing a value in a leaf copies the path from the root to that leaf
+        tree.put(5000, -1);
+        expect(tree.unshared_nodes(snapshot) == tree.height());
+        expect(snapshot.unshared_nodes(tree) == snapshot.height());
+        expect(snapshot.get(5000) == 5000);
+
+        // Nodes that were already copied are owned by the tree, so they aren't copied again
+        tree.put(5000, -2);
+        expect(tree.unshared_nodes(snapshot) == tree.height());
+
+        // Deleting a missing key doesn't copy anything
+        expect(!tree.del(20000).has_value());
+        expect(tree.unshared_nodes(snapshot) == tree.height());
+
+        for (int i = 0; i < 10000; i += 2) {
+            tree.del(i);
+        }
+
+        expect(tree.is_valid());
+        expect(snapshot.is_valid());
+        expect(snapshot.size() == 10000);
+
+        for (int i = 0; i < 10000; i++) {
+            expect(snapshot.get(i) == (i == 5000 ? 5000 : i));
+            expect(tree.get(i) == (i % 2 ? std::optional<int>(i) : std::nullopt));
+        }
+    };
+
+    data::test::tests["persistent btree"]["moved-from trees are empty and usable"] = []() {
+        data::PersistentBTree<int, int, 4> tree;
+        data::PersistentBTree<int, int, 4> other;
+
+        for (int i = 0; i < 100; i++) {
+            tree.put(i, i);
+        }
+
+        data::PersistentBTree<int, int, 4> moved(std::move(tree));
+        data::PersistentBTree<int, int, 4> also_moved(std::move(other));
+
+        expect(moved.size() == 100);
+        expect(moved.is_valid());
+        expect(tree.size() == 0);
+        expect(!tree.get(5).has_value());
+        expect(!tree.del(5).has_value());
+        expect(tree.begin() == tree.end());
+
+        // Moved-from trees share an empty root, which a write copies instead of changing
+        tree.put(1, 10);
+        other.put(2, 20);
+
+        expect(tree.get(1) == 10);
+        expect(!tree.get(2).has_value());
+        expect(other.get(2) == 20);
+        expect(!other.get(1).has_value());
+        expect(tree.is_valid());
+        expect(other.is_valid());
+
+        tree = std::move(moved);
+
+        expect(tree.size() == 100);
+        expect(tree.get(99) == 99);
+    };
+
+    data::test::tests["persistent btree"]["seeking to keys"] = []() {
+        data::PersistentBTree<int, int, 4> tree;
+
+        expect(tree.begin() == tree.end());
+        expect(tree.lower_bound(0) == tree.end());
+
+        for (int i = 0; i < 1000; i += 2) {
+            tree.put(i, i * 10);
+        }
+
+        for (int i = -1; i < 1000; i++) {
+            auto it = tree.lower_bound(i);
+            const int exp_key = i < 0 ? 0 : (i + 1) / 2 * 2;
+
+            if (exp_key >= 1000) {
+                expect(it == tree.end());
+                continue;
+            }
+
+            expect(it != tree.end());
+            expect((*it).first == exp_key);
+            expect(*(*it).second == exp_key * 10);
+        }
+    };
+
+    data::test::tests["persistent btree"]["reading snapshots on other threads"] = []() {
+        data::PersistentBTree<int, int, 8> tree;
+        std::atomic<size_t> bad_reads(0);
+        std::vector<std::thread> readers;
+
+        for (int i = 0; i < 2000; i++) {
+            tree.put(i, 0);
+        }
+
+        // Each snapshot is taken after a whole round of writes, so every value in it is the same
+        for (size_t round = 0; round < 40; round++) {
+            readers.emplace_back([&, snapshot = tree.snapshot()]() {
+                const int exp_val = *(*snapshot.begin()).second;
+                size_t count = 0;
+
+                for (const auto [key, val] : snapshot) {
+                    bad_reads += *val != exp_val;
+                    count++;
+                }
+
+                bad_reads += count != 2000;
+            });
+
+            for (int i = 0; i < 2000; i++) {
+                tree.put(i, round + 1);
+            }
+
+            // Churn the shape of the tree too, so that readers' nodes get split and merged in the tree
+            for (int i = 2000; i < 2500; i++) {
+                tree.put(i, 0);
+            }
+
+            for (int i = 2000; i < 2500; i++) {
+                tree.del(i);
+            }
+        }
+
+        for (std::thread &reader : readers) {
+            reader.join();
+        }
+
+        expect(bad_reads == 0);
+        expect(tree.is_valid());
+    };
+}
@@ -1,10 +1,16 @@
 #include <algorithm>
+#include <map>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "../include/utils.h"
 #include "../../include/structures/radix_trie.h"
 #include "../../include/structures/radix_trie_iterator.h"
-#include "../../include/structures/sorted_vec.h"
+#include "../../include/structures/radix_trie_children.h"
+#include "../../include/structures/radix_trie_fragment.h"
 
 namespace {
     typedef std::pair<std::vector<char>, const int *> ro_value_type;
@@ -33,6 +39,17 @@ namespace {
         { c_str_to_vec("toast"), 7 }
     };
 
+    template <typename R>
+    std::vector<ro_value_type> to_items(R range) {
+        std::vector<ro_value_type> out;
+
+        for (auto entry : range) {
+            out.push_back({ std::vector<char>(std::begin(entry.first), std::end(entry.first)), entry.second });
+        }
+
+        return out;
+    }
+
     data::RadixTrie<char, int> setup_r_trie() {
         data::RadixTrie<char, int> r_trie;
 
@@ -147,11 +164,11 @@ void radix_trie_tests() {
         expect(r_trie.del(c_str_to_vec("fastest")) == 2);
         expect(r_trie.del(c_str_to_vec("faster")) == 1);
  
-        data::SortedVec<data::RadixTrieNode<char, int> *> &nodes = r_trie.get_nodes();
+        data::RadixTrieChildren<char, int> &nodes = r_trie.get_nodes();
         expect(nodes.size() == 1);
-        expect(nodes[0]->key == c_str_to_vec("fastestest"));
-        expect(nodes[0]->val == 4);
-        expect(nodes[0]->children.size() == 0);
+        expect(nodes.first()->key == c_str_to_vec("fastestest"));
+        expect(nodes.first()->val == 4);
+        expect(nodes.first()->children.size() == 0);
     };
 
     data::test::tests["radix trie"]["iterator"] = []() {
@@ -159,7 +176,7 @@ void radix_trie_tests() {
         std::vector<ro_value_type> items;
 
         for (auto node : r_trie) {
-            items.push_back(node);
+            items.push_back({ std::vector<char>(std::begin(node.first), std::end(node.first)), node.second });
         }
 
         std::sort(std::begin(items), std::end(items), [](const ro_value_type &a, const ro_value_type &b) {
@@ -173,8 +190,11 @@ void radix_trie_tests() {
         data::RadixTrieIterator<char, int> end = std::end(r_trie);
 
         for (; (it != end); ++it, it2++) {
-            expect(*it == *it2);
+            expect(std::ranges::equal((*it).first, (*it2).first));
+            expect((*it).second == (*it2).second);
         }
+
+        expect(it2 == end);
     };
 
     data::test::tests["radix trie"]["entries"] = []() {
@@ -204,7 +224,7 @@ void radix_trie_tests() {
 
         data::RadixTrie<char, int> r_trie = setup_r_trie();
 
-        std::vector<ro_value_type> items = r_trie.entries_with_prefix(c_str_to_vec("test"));
+        std::vector<ro_value_type> items = to_items(r_trie.entries_with_prefix(c_str_to_vec("test")));
 
         std::sort(std::begin(items), std::end(items), [](const ro_value_type &a, const ro_value_type &b) {
             return *a.second < *b.second;
@@ -212,7 +232,7 @@ void radix_trie_tests() {
 
         test_item_equality(items, exp_items_test);
 
-        items = r_trie.entries_with_prefix(c_str_to_vec("t"));
+        items = to_items(r_trie.entries_with_prefix(c_str_to_vec("t")));
 
         std::sort(std::begin(items), std::end(items), [](const ro_value_type &a, const ro_value_type &b) {
             return *a.second < *b.second;
@@ -220,4 +240,374 @@ void radix_trie_tests() {
 
         test_item_equality(items, exp_items_t);
     };
+
+    data::test::tests["radix trie"]["merging a node keeps its grandchildren"] = []() {
+        data::RadixTrie<char, int> r_trie;
+
+        r_trie.put(c_str_to_vec("ab"), 1);
+        r_trie.put(c_str_to_vec("abcd"), 2);
+        r_trie.put(c_str_to_vec("abcdef"), 3);
+        r_trie.put(c_str_to_vec("abcdxy"), 4);
+
+        // "abcd" is merged into "ab", so "ef" and "xy" get a new parent
+        expect(r_trie.del(c_str_to_vec("abcd")) == 2);
+        expect(r_trie.del(c_str_to_vec("ab")) == 1);
+
+        data::RadixTrieNode<char, int> * node = r_trie.get_node(c_str_to_vec("abcdxy"));
+        expect(!!node);
+        expect(node->parent->key == c_str_to_vec("abcd"));
+        expect(node->parent == r_trie.get_nodes().first());
+        expect(r_trie.get(c_str_to_vec("abcdef")) == 3);
+        expect(r_trie.get(c_str_to_vec("abcdxy")) == 4);
+
+        expect(r_trie.del(c_str_to_vec("abcdef")) == 3);
+        expect(r_trie.get_nodes().first()->key == c_str_to_vec("abcdxy"));
+        expect(r_trie.depth() == 1);
+    };
+
+    data::test::tests["radix trie"]["iterates in lexicographic order"] = []() {
+        data::RadixTrie<char, int> r_trie = setup_r_trie();
+        std::vector<std::vector<char>> keys;
+
+        for (auto entry : r_trie) {
+            keys.push_back(std::vector<char>(std::begin(entry.first), std::end(entry.first)));
+        }
+
+        const std::vector<std::vector<char>> exp_keys = {
+            c_str_to_vec("slow"),
+            c_str_to_vec("slower"),
+            c_str_to_vec("team"),
+            c_str_to_vec("test"),
+            c_str_to_vec("tester"),
+            c_str_to_vec("toast"),
+            c_str_to_vec("water")
+        };
+
+        expect(keys == exp_keys);
+    };
+
+    data::test::tests["radix trie"]["many siblings"] = []() {
+        data::RadixTrie<int, int> r_trie;
+        std::vector<std::vector<int>> keys;
+
+        for (int i = 0; i < 500; i++) {
+            keys.push_back({ (i * 7919) % 500, i % 3, i });
+        }
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            expect(!r_trie.put(keys[i], i).has_value());
+        }
+
+        expect(r_trie.get_nodes().size() == 500);
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            expect(r_trie.get(keys[i]) == (int) i);
+        }
+
+        std::vector<int> first_symbols;
+
+        for (auto entry : r_trie) {
+            first_symbols.push_back(entry.first[0]);
+        }
+
+        expect(first_symbols.size() == 500);
+        expect(std::is_sorted(std::begin(first_symbols), std::end(first_symbols)));
+
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            expect(r_trie.del(keys[i]) == (int) i);
+        }
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (i % 2) {
+                expect(r_trie.get(keys[i]) == (int) i);
+            } else {
+                expect(!r_trie.get(keys[i]).has_value());
+            }
+        }
+    };
+
+    data::test::tests["radix trie"]["rejects empty keys"] = []() {
+        data::RadixTrie<char, int> r_trie;
+
+        try {
+            r_trie.put({}, 1);
+            fail_test();
+        } catch (const char * const err) {
+            expect(!r_trie.get({}).has_value());
+        }
+    };
+
+    data::test::tests["radix trie"]["children grow and shrink through node kinds"] = []() {
+        data::RadixTrie<char, int> r_trie;
+        std::vector<std::vector<char>> keys;
+
+        // Every byte value, including negative chars, as a child of "x"
+        for (int i = 0; i < 256; i++) {
+            keys.push_back({ 'x', (char) i, 'y' });
+        }
+
+        r_trie.put({ 'x' }, -1);
+
+        data::RadixTrieNode<char, int> * parent = r_trie.get_node({ 'x' });
+        expect(parent->children.kind() == data::RadixTrieChildrenKind::EMPTY);
+
+        const std::vector<std::pair<size_t, data::RadixTrieChildrenKind>> growth = {
+            { 1, data::RadixTrieChildrenKind::NODE4 },
+            { 4, data::RadixTrieChildrenKind::NODE4 },
+            { 5, data::RadixTrieChildrenKind::NODE16 },
+            { 16, data::RadixTrieChildrenKind::NODE16 },
+            { 17, data::RadixTrieChildrenKind::NODE48 },
+            { 48, data::RadixTrieChildrenKind::NODE48 },
+            { 49, data::RadixTrieChildrenKind::NODE256 },
+            { 256, data::RadixTrieChildrenKind::NODE256 }
+        };
+        size_t next_check = 0;
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            r_trie.put(keys[(i * 37) % 256], (i * 37) % 256);
+
+            if (next_check < growth.size() && growth[next_check].first == i + 1) {
+                expect(parent->children.size() == i + 1);
+                expect(parent->children.kind() == growth[next_check].second);
+                next_check++;
+            }
+        }
+
+        std::vector<std::vector<char>> sorted_keys = keys;
+        std::sort(std::begin(sorted_keys), std::end(sorted_keys));
+
+        std::vector<std::vector<char>> iter_keys;
+
+        for (auto entry : r_trie) {
+            if (entry.first.size() > 1) {
+                iter_keys.push_back(std::vector<char>(std::begin(entry.first), std::end(entry.first)));
+            }
+        }
+
+        expect(iter_keys == sorted_keys);
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            expect(r_trie.get(keys[i]) == (int) i);
+        }
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            const size_t remaining = keys.size() - i;
+
+            if (remaining == 37) {
+                expect(parent->children.kind() == data::RadixTrieChildrenKind::NODE48);
+            } else if (remaining == 12) {
+                expect(parent->children.kind() == data::RadixTrieChildrenKind::NODE16);
+            } else if (remaining == 3) {
+                expect(parent->children.kind() == data::RadixTrieChildrenKind::NODE4);
+            }
+
+            expect(r_trie.del(keys[i]) == (int) i);
+
+            for (size_t j = i + 1; j < keys.size(); j += 17) {
+                expect(r_trie.get(keys[j]) == (int) j);
+            }
+        }
+
+        expect(parent->children.kind() == data::RadixTrieChildrenKind::EMPTY);
+        expect(r_trie.get({ 'x' }) == -1);
+    };
+
+    data::test::tests["radix trie"]["short key fragments are stored inline"] = []() {
+        data::Arena arena;
+        const std::vector<char> text = c_str_to_vec("abcdefghijklmnopqrstuvwxyz");
+
+        data::RadixTrieFragment<char> frag(arena, text.data(), 16);
+
+        expect(frag.is_inline());
+        expect(arena.chunk_count() == 0);
+
+        frag.append(arena, text.data() + 16, 10);
+
+        expect(!frag.is_inline());
+        expect(frag == text);
+
+        frag.remove_prefix(arena, 4);
+
+        expect(!frag.is_inline());
+        expect(frag == std::vector<char>(std::begin(text) + 4, std::end(text)));
+
+        frag.remove_prefix(arena, 10);
+
+        expect(frag.is_inline());
+        expect(frag == std::vector<char>(std::begin(text) + 14, std::end(text)));
+
+        frag.release(arena);
+
+        expect(frag.size() == 0);
+    };
+
+    data::test::tests["radix trie"]["removing every symbol of a fragment that is not trivially copyable"] = []() {
+        data::Arena arena;
+        const std::vector<std::string> text = { "long enough not to fit in a small string buffer", "and another one just like it" };
+
+        data::RadixTrieFragment<std::string> frag(arena, text.data(), text.size());
+
+        expect(!frag.is_inline());
+
+        // The strings stay in the block and are destroyed there
+        frag.remove_prefix(arena, text.size());
+
+        expect(frag.size() == 0);
+        expect(!frag.is_inline());
+
+        frag.append(arena, text.data(), 1);
+
+        expect(frag == std::vector<std::string>(std::begin(text), std::begin(text) + 1));
+
+        frag.release(arena);
+    };
+
+    data::test::tests["radix trie"]["splits and merges long keys"] = []() {
+        data::RadixTrie<char, int> r_trie;
+        const std::vector<char> long_key = c_str_to_vec("a fairly long key that does not fit inline");
+        const std::vector<char> branch = c_str_to_vec("a fairly long key with a branch");
+        const std::vector<char> prefix = c_str_to_vec("a fairly long key");
+
+        r_trie.put(long_key, 1);
+        r_trie.put(branch, 2);
+        r_trie.put(prefix, 3);
+
+        expect(r_trie.get(long_key) == 1);
+        expect(r_trie.get(branch) == 2);
+        expect(r_trie.get(prefix) == 3);
+        expect(r_trie.get_node(prefix)->key.size() == prefix.size());
+
+        expect(r_trie.del(branch) == 2);
+        expect(r_trie.del(prefix) == 3);
+
+        expect(r_trie.get(long_key) == 1);
+        expect(r_trie.depth() == 1);
+        expect(r_trie.get_node(long_key)->key == long_key);
+    };
+
+    data::test::tests["radix trie"]["symbols that are not trivially copyable"] = []() {
+        data::RadixTrie<std::string, int> r_trie;
+        const std::vector<std::string> prefix = { "alpha", "beta", "gamma", "delta" };
+        const std::vector<std::string> branch = { "alpha", "beta", "x" };
+
+        for (int i = 0; i < 100; i++) {
+            std::vector<std::string> key = prefix;
+            key.push_back(std::to_string(i));
+
+            r_trie.put(key, i);
+        }
+
+        r_trie.put(branch, 100);
+        r_trie.put({ "alpha" }, 101);
+
+        for (int i = 0; i < 100; i += 2) {
+            std::vector<std::string> key = prefix;
+            key.push_back(std::to_string(i));
+
+            expect(r_trie.get(key) == i);
+            expect(r_trie.del(key) == i);
+        }
+
+        expect(r_trie.del({ "alpha" }) == 101);
+        expect(r_trie.get(branch) == 100);
+        expect(r_trie.get({ "alpha", "beta", "gamma", "delta", "99" }) == 99);
+    };
+
+    data::test::tests["radix trie"]["span and string_view keys"] = []() {
+        data::RadixTrie<char, int> r_trie;
+        const std::string_view text = "testing spans";
+
+        expect(!r_trie.put(text.substr(0, 4), 1).has_value());
+        expect(!r_trie.put(std::span<const char>(text.data(), 7), 2).has_value());
+        expect(!r_trie.put(text, 3).has_value());
+        expect(r_trie.put(std::string_view("test"), 4) == 1);
+
+        const data::RadixTrie<char, int> &ro_trie = r_trie;
+
+        expect(ro_trie.get(std::string_view("test")) == 4);
+        expect(ro_trie.get(std::span<const char>(text.data(), 7)) == 2);
+        expect(ro_trie.get(text) == 3);
+        expect(ro_trie.get(c_str_to_vec("testing")) == 2);
+        expect(!ro_trie.get(text.substr(0, 5)).has_value());
+        expect(!ro_trie.get(std::string_view()).has_value());
+
+        expect(r_trie.del(std::string_view("testing")) == 2);
+        expect(!ro_trie.get(std::string_view("testing")).has_value());
+        expect(ro_trie.get(text) == 3);
+    };
+
+    data::test::tests["radix trie"]["iterator matches a sorted map"] = []() {
+        data::RadixTrie<char, int> r_trie;
+        std::map<std::vector<char>, int> exp;
+
+        expect(std::begin(r_trie) == std::end(r_trie));
+
+        // Short keys over a small alphabet share lots of prefixes, so the iterator has to climb
+        // several levels at a time
+        for (int i = 0; i < 2000; i++) {
+            std::vector<char> key;
+            const int len = 1 + rand() % 6;
+
+            for (int j = 0; j < len; j++) {
+                key.push_back('a' + rand() % 3);
+            }
+
+            r_trie.put(key, i);
+            exp[key] = i;
+        }
+
+        auto exp_it = std::begin(exp);
+
+        for (auto entry : r_trie) {
+            expect(exp_it != std::end(exp));
+            expect(std::ranges::equal(entry.first, exp_it->first));
+            expect(*entry.second == exp_it->second);
+            exp_it++;
+        }
+
+        expect(exp_it == std::end(exp));
+    };
+
+    data::test::tests["radix trie"]["lazy prefix queries"] = []() {
+        data::RadixTrie<char, int> r_trie = setup_r_trie();
+
+        // "te" ends in the middle of the "te" -> "st"/"am" split, and "tes" in the middle of "st"
+        const std::vector<std::vector<char>> exp_te = { c_str_to_vec("team"), c_str_to_vec("test"), c_str_to_vec("tester") };
+        std::vector<std::vector<char>> keys;
+
+        for (auto entry : r_trie.entries_with_prefix(std::string_view("te"))) {
+            keys.push_back(std::vector<char>(std::begin(entry.first), std::end(entry.first)));
+        }
+
+        expect(keys == exp_te);
+
+        keys.clear();
+
+        for (auto entry : r_trie.entries_with_prefix(std::string_view("tes"))) {
+            keys.push_back(std::vector<char>(std::begin(entry.first), std::end(entry.first)));
+        }
+
+        expect(keys == std::vector<std::vector<char>>(std::begin(exp_te) + 1, std::end(exp_te)));
+
+        std::vector<ro_value_type> items = to_items(r_trie.entries_with_prefix(std::string_view("t"), 2));
+
+        expect(items.size() == 2);
+        expect(items[0].first == c_str_to_vec("team"));
+        expect(items[1].first == c_str_to_vec("test"));
+
+        expect(r_trie.entries_with_prefix(std::string_view("sl"), 0).empty());
+        expect(r_trie.entries_with_prefix(std::string_view("x")).empty());
+        expect(r_trie.entries_with_prefix(std::string_view("toasty")).empty());
+        expect(r_trie.entries_with_prefix(std::string_view("slowest")).empty());
+        expect(std::ranges::distance(r_trie.entries_with_prefix(std::string_view("slow"))) == 2);
+        expect(std::ranges::distance(r_trie.entries_with_prefix(std::string_view(""))) == 7);
+        expect(std::ranges::distance(r_trie.entries_with_prefix(std::string_view(""), 3)) == 3);
+
+        // Composes with standard views
+        auto values = r_trie.entries_with_prefix(std::string_view("t"))
+            | std::views::transform([](auto entry) { return *entry.second; })
+            | std::views::filter([](int val) { return val > 5; });
+
+        expect(std::ranges::equal(values, std::vector<int>{ 6, 7 }));
+    };
 }
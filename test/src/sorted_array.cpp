@@ -1,7 +1,44 @@
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
 #include "../include/utils.h"
 #include "../../include/structures/sorted_array.h"
+#include "../../include/structures/sorted_vec.h"
 
 namespace {
+    size_t copies = 0;
+
+    /**
+     * Counts how many times it is copied, so that tests can check that items are moved.
+     */
+    struct counted {
+        int val;
+
+        counted() : val(0) {}
+
+        counted(int val) : val(val) {}
+
+        counted(const counted &other) : val(other.val) {
+            copies++;
+        }
+
+        counted(counted &&other) = default;
+
+        counted& operator=(const counted &other) {
+            copies++;
+            this->val = other.val;
+
+            return *this;
+        }
+
+        counted& operator=(counted &&other) = default;
+
+        bool operator<(const counted &other) const {
+            return this->val < other.val;
+        }
+    };
+
     template <const size_t N>
     data::SortedArray<int, N> make_array() {
         data::SortedArray<int, N> arr;
@@ -29,6 +66,31 @@ namespace {
 
         return arr;
     }
+
+    /**
+     * Checks the search against std::lower_bound for every length up to `max_len`, with duplicates,
+     * and for needles below, between, on and above the items.
+     */
+    template <typename T>
+    void check_lower_bound(size_t max_len) {
+        for (size_t len = 0; len <= max_len; len++) {
+            std::vector<T> items;
+
+            for (size_t i = 0; i < len; i++) {
+                items.push_back((T) (rand() % (len + 1) * 2));
+            }
+
+            std::sort(std::begin(items), std::end(items));
+
+            for (int needle = -1; needle <= (int) (len + 1) * 2 + 1; needle++) {
+                const T item = (T) needle;
+                const size_t exp_index = std::lower_bound(std::begin(items), std::end(items), item) - std::begin(items);
+
+                expect(data::lower_bound(items.data(), items.size(), item) == exp_index);
+                expect(data::count_less(items.data(), items.size(), item) == exp_index);
+            }
+        }
+    }
 }
 
 void sorted_array_tests() {
@@ -167,4 +229,59 @@ void sorted_array_tests() {
             expect(arr.size() == 128 - i - 1);
         }
     };
+
+    data::test::tests["sorted array"]["searching arithmetic types"] = []() {
+        check_lower_bound<int32_t>(200);
+        check_lower_bound<int64_t>(200);
+        check_lower_bound<uint32_t>(200);
+        check_lower_bound<int16_t>(200);
+        check_lower_bound<float>(200);
+        check_lower_bound<double>(200);
+
+        // SortedArray and SortedVec search the same way
+        data::SortedArray<double, 64> arr;
+        data::SortedVec<double> vec;
+
+        for (size_t i = 0; i < 64; i++) {
+            arr.put(i * 0.5);
+            vec.put(i * 0.5);
+        }
+
+        for (size_t i = 0; i < 64; i++) {
+            expect(arr.lower_bound(i * 0.5) == i);
+            expect(arr.lower_bound(i * 0.5 - 0.25) == i);
+            expect(vec.lower_bound(i * 0.5) == i);
+            expect(vec.lower_bound(i * 0.5 + 0.25) == i + 1);
+        }
+    };
+
+    data::test::tests["sorted array"]["moves items instead of copying them"] = []() {
+        data::SortedArray<counted, 64> arr;
+        copies = 0;
+
+        for (int i = 0; i < 64; i++) {
+            if (i % 2) {
+                arr.put(counted((i * 37) % 64));
+            } else {
+                arr.emplace((i * 37) % 64);
+            }
+        }
+
+        for (size_t i = 0; i < 64; i++) {
+            expect(arr[i].val == (int) i);
+        }
+
+        for (int i = 0; i < 32; i++) {
+            expect(arr.del(10).val == 10 + i);
+        }
+
+        expect(arr.size() == 32);
+        expect(copies == 0);
+
+        // Putting an lvalue has to copy it once, but shifting the others still doesn't
+        const counted item(10);
+        expect(arr.put(item) == 10);
+        expect(copies == 1);
+        expect(arr[11].val == 42);
+    };
 }
@@ -1,9 +1,63 @@
+#include <algorithm>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "../include/utils.h"
 #include "../../include/structures/sorted_vec.h"
 
 namespace {
+    /**
+     * Can be moved but not copied.
+     */
+    struct move_only {
+        std::unique_ptr<int> val;
+
+        move_only() : val(nullptr) {}
+
+        move_only(int val) : val(std::make_unique<int>(val)) {}
+
+        bool operator<(const move_only &other) const {
+            return *this->val < *other.val;
+        }
+    };
+
+    /**
+     * Has no default constructor, and counts how many instances are alive.
+     */
+    struct tracked {
+        static inline int live = 0;
+
+        int val;
+
+        tracked(int val) : val(val) {
+            live++;
+        }
+
+        tracked(const tracked &other) : val(other.val) {
+            live++;
+        }
+
+        ~tracked() {
+            live--;
+        }
+
+        tracked& operator=(const tracked &other) = default;
+
+        bool operator<(const tracked &other) const {
+            return this->val < other.val;
+        }
+    };
+
+    /**
+     * Grows by a fixed number of items at a time.
+     */
+    struct grow_by_ten {
+        static size_t next_capacity(size_t capacity, size_t needed) {
+            return std::max(needed, capacity + 10);
+        }
+    };
+
     data::SortedVec<int> make_vec() {
         data::SortedVec<int> vec;
 
@@ -30,6 +84,26 @@ namespace {
 
         return vec;
     }
+
+    /**
+     * Checks that a SortedVec holds exactly the items of a multiset, in order. An empty SortedVec has
+     * no storage, so the items are compared by index instead of through a pointer to the first one.
+     */
+    bool has_items(const data::SortedVec<int> &vec, const std::multiset<int> &items) {
+        if (vec.size() != items.size()) {
+            return false;
+        }
+
+        size_t i = 0;
+
+        for (int item : items) {
+            if (!(vec[i++] == item)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
 }
 
 void sorted_vec_tests() {
@@ -62,7 +136,9 @@ void sorted_vec_tests() {
             expect(vec.size() == i + 1);
         }
 
-        expect(vec.cap() == 2048);
+        // The vector grows by half again whenever it fills up
+        const size_t cap = vec.cap();
+        expect(cap >= 1000 && cap < 1500);
 
         auto it = std::begin(exp_set);
 
@@ -78,9 +154,11 @@ void sorted_vec_tests() {
             expect(vec.del(i) == *rit);
         }
 
-        expect(vec.cap() == 2048);
-        vec.shrink();
-        expect(vec.cap() == 1024);
+        expect(vec.cap() == cap);
+        vec.shrink_to_fit();
+        expect(vec.cap() == 500);
+
+        expect(std::is_sorted(&vec[0], &vec[0] + vec.size()));
     };
 
     data::test::tests["sorted vec"]["sorts complex types"] = []() {
@@ -180,7 +258,7 @@ void sorted_vec_tests() {
             exp_set.insert(item);
         }
 
-        expect(vec.cap() == 1024);
+        expect(vec.cap() >= 400 && vec.cap() < 600);
     };
 
     data::test::tests["sorted vec"]["equality"] = []() {
@@ -232,4 +310,165 @@ void sorted_vec_tests() {
             expect(vec[i] <= vec[i + 1]);
         }
     };
+
+    data::test::tests["sorted vec"]["holds move only types"] = []() {
+        data::SortedVec<move_only> vec;
+
+        // Enough to make the vector grow a few times
+        for (int i = 0; i < 500; i++) {
+            if (i % 2) {
+                vec.put(move_only((i * 7) % 500));
+            } else {
+                vec.emplace((i * 7) % 500);
+            }
+        }
+
+        for (size_t i = 0; i < 500; i++) {
+            expect(*vec[i].val == (int) i);
+        }
+
+        for (int i = 0; i < 250; i++) {
+            move_only item = vec.del(100);
+            expect(*item.val == 100 + i);
+        }
+
+        expect(vec.size() == 250);
+        expect(*vec[99].val == 99);
+        expect(*vec[100].val == 350);
+    };
+
+    data::test::tests["sorted vec"]["batch inserts and merges"] = []() {
+        data::SortedVec<int> vec;
+        std::multiset<int> exp_set;
+
+        for (size_t round = 0; round < 20; round++) {
+            std::vector<int> batch;
+            const size_t batch_size = rand() % 300;
+
+            for (size_t i = 0; i < batch_size; i++) {
+                batch.push_back(rand() % 1000);
+            }
+
+            if (round % 2) {
+                vec.put_batch(batch);
+            } else {
+                data::SortedVec<int> other;
+
+                for (int item : batch) {
+                    other.put(item);
+                }
+
+                vec.merge(other);
+            }
+
+            exp_set.insert(std::begin(batch), std::end(batch));
+
+            expect(vec.size() == exp_set.size());
+            expect(vec.size() <= vec.cap());
+            expect(has_items(vec, exp_set));
+        }
+
+        // Merging a vector into itself doubles every item
+        const std::multiset<int> old_set = exp_set;
+        vec.merge(vec);
+        exp_set.insert(std::begin(old_set), std::end(old_set));
+
+        expect(vec.size() == exp_set.size());
+        expect(has_items(vec, exp_set));
+
+        // Batches of move only items are moved in
+        data::SortedVec<move_only> moved;
+        std::vector<move_only> batch;
+
+        for (int i = 0; i < 100; i++) {
+            batch.emplace_back((i * 13) % 100);
+        }
+
+        moved.put_batch(std::move(batch));
+
+        for (int i = 0; i < 100; i++) {
+            expect(*moved[i].val == i);
+        }
+    };
+
+    data::test::tests["sorted vec"]["reserving and shrinking capacity"] = []() {
+        {
+            data::SortedVec<tracked> vec;
+
+            // Nothing is allocated or constructed until an item is put in
+            expect(vec.cap() == 0);
+            expect(tracked::live == 0);
+
+            vec.reserve(100);
+            expect(vec.cap() == 100);
+            expect(tracked::live == 0);
+
+            for (int i = 0; i < 100; i++) {
+                vec.put(tracked((i * 37) % 100));
+            }
+
+            expect(vec.cap() == 100);
+            expect(tracked::live == 100);
+
+            // Reserving less than the current capacity does nothing
+            vec.reserve(10);
+            expect(vec.cap() == 100);
+
+            vec.put(tracked(100));
+            expect(vec.cap() == 150);
+            expect(tracked::live == 101);
+
+            for (int i = 0; i < 101; i++) {
+                expect(vec[i].val == i);
+            }
+
+            for (int i = 0; i < 51; i++) {
+                expect(vec.del(0).val == i);
+            }
+
+            expect(tracked::live == 50);
+            expect(vec.cap() == 150);
+
+            vec.shrink_to_fit();
+            expect(vec.cap() == 50);
+            expect(tracked::live == 50);
+            expect(vec[0].val == 51);
+
+            data::SortedVec<tracked> copy(vec);
+            expect(copy.cap() == 50);
+            expect(tracked::live == 100);
+
+            copy = data::SortedVec<tracked>();
+            expect(tracked::live == 50);
+
+            while (vec.size()) {
+                vec.del(vec.size() - 1);
+            }
+
+            vec.shrink_to_fit();
+            expect(vec.cap() == 0);
+            expect(tracked::live == 0);
+
+            vec.put(tracked(1));
+            expect(vec.cap() == 4);
+        }
+
+        expect(tracked::live == 0);
+
+        data::SortedVec<int, grow_by_ten> vec;
+
+        for (int i = 0; i < 25; i++) {
+            vec.put(i);
+        }
+
+        expect(vec.cap() == 30);
+
+        data::SortedVec<int, data::DoublingGrowth> doubling;
+
+        for (int i = 0; i < 25; i++) {
+            doubling.put(i);
+        }
+
+        expect(doubling.cap() == 32);
+    };
 }
@@ -1,6 +1,56 @@
+#include <map>
+#include <string>
+#include <vector>
+
 #include "../include/utils.h"
 #include "../../include/structures/trie.h"
 
+namespace {
+    /**
+     * Puts and deletes random keys over an alphabet of the given symbols, and checks the trie against
+     * a map after every operation. Every key is deleted at the end, which should leave no nodes.
+     */
+    template <typename K, typename C>
+    void churn_against_map(const std::vector<K> &alphabet, size_t ops) {
+        data::Trie<K, int, C> trie;
+        std::map<std::basic_string<K>, int> exp_map;
+
+        for (size_t i = 0; i < ops; i++) {
+            std::basic_string<K> key;
+            const size_t key_len = 1 + rand() % 6;
+
+            for (size_t j = 0; j < key_len; j++) {
+                key.push_back(alphabet[rand() % alphabet.size()]);
+            }
+
+            auto it = exp_map.find(key);
+            const std::optional<int> exp_val = it == std::end(exp_map) ? std::nullopt : std::optional<int>(it->second);
+
+            if (rand() % 3) {
+                const int val = rand();
+
+                trie.put(key.data(), key.size(), val);
+                exp_map[key] = val;
+                expect(trie.get(key.data(), key.size()) == val);
+            } else {
+                expect(trie.del(key.data(), key.size()) == exp_val);
+                expect(!trie.get(key.data(), key.size()).has_value());
+                exp_map.erase(key);
+            }
+        }
+
+        for (const auto &[key, val] : exp_map) {
+            expect(trie.get(key.data(), key.size()) == val);
+        }
+
+        for (const auto &[key, val] : exp_map) {
+            expect(trie.del(key.data(), key.size()) == val);
+        }
+
+        expect(trie.node_count() == 0);
+    }
+}
+
 void trie_tests() {
     data::test::tests["trie"]["inserting, getting, and deleting elements"] = []() {
         data::Trie<char, int> trie;
@@ -35,4 +85,66 @@ void trie_tests() {
         expect(trie.del("adb", 3) == 8);
         expect(trie.node_count() == 0);
     };
+
+    data::test::tests["trie"]["missing symbols end the search"] = []() {
+        data::Trie<char, int> trie;
+
+        trie.put("a", 1, 1);
+
+        // "ax" has no node for 'x', so it must not find or delete "a"
+        expect(!trie.get("ax", 2).has_value());
+        expect(!trie.del("ax", 2).has_value());
+        expect(trie.get("a", 1) == 1);
+    };
+
+    data::test::tests["trie"]["child indices match a map"] = []() {
+        std::vector<char> bytes;
+
+        for (int i = -128; i < 128; i++) {
+            bytes.push_back((char) i);
+        }
+
+        churn_against_map<char, data::BitmapChildren>(bytes, 20000);
+        churn_against_map<char, data::BitmapChildren>({ 'A', 'C', 'G', 'T' }, 20000);
+        churn_against_map<char, data::ListChildren>(bytes, 20000);
+        churn_against_map<uint8_t, data::DenseChildren<4>>({ 0, 1, 2, 3 }, 20000);
+        churn_against_map<int, data::ListChildren>({ -1000, 7, 1 << 20, 42 }, 20000);
+    };
+
+    data::test::tests["trie"]["dense indices reject symbols outside of the alphabet"] = []() {
+        data::Trie<uint8_t, int, data::DenseChildren<4>> trie;
+        const uint8_t key[] = { 0, 4 };
+
+        expect(!trie.get(key, 2).has_value());
+
+        try {
+            trie.put(key, 2, 1);
+            fail_test();
+        } catch (const char * const err) {}
+    };
+
+    data::test::tests["trie"]["moving a trie keeps its nodes"] = []() {
+        data::Trie<char, std::string> trie;
+        data::Trie<uint8_t, std::string, data::DenseChildren<4>> dense;
+        const uint8_t dense_key[] = { 1, 2, 3 };
+
+        trie.put("abc", 3, "first value, long enough to be on the heap");
+        trie.put("abd", 3, "second value, long enough to be on the heap");
+        dense.put(dense_key, 3, "a dense value, long enough to be on the heap");
+
+        // The moved-from tries are destroyed at the end without touching the nodes they gave away
+        data::Trie<char, std::string> moved(std::move(trie));
+        data::Trie<uint8_t, std::string, data::DenseChildren<4>> dense_moved(std::move(dense));
+
+        expect(moved.get("abc", 3) == "first value, long enough to be on the heap");
+        expect(moved.get("abd", 3) == "second value, long enough to be on the heap");
+        expect(dense_moved.get(dense_key, 3) == "a dense value, long enough to be on the heap");
+        expect(!trie.get("abc", 3).has_value());
+        expect(!dense.get(dense_key, 3).has_value());
+
+        trie.put("abc", 3, "the moved-from trie can be used again");
+
+        expect(trie.get("abc", 3) == "the moved-from trie can be used again");
+        expect(moved.del("abc", 3) == "first value, long enough to be on the heap");
+    };
 }